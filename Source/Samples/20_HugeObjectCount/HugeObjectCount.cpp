@@ -47,7 +47,8 @@ URHO3D_DEFINE_APPLICATION_MAIN(HugeObjectCount)
 HugeObjectCount::HugeObjectCount(Context* context) :
     Sample(context),
     animate_(false),
-    useGroups_(false)
+    useGroups_(false),
+    useAABBTree_(false)
 {
 }
 
@@ -85,8 +86,9 @@ void HugeObjectCount::CreateScene()
     }
 
     // Create the Octree component to the scene so that drawable objects can be rendered. Use default volume
-    // (-1000, -1000, -1000) to (1000, 1000, 1000)
-    scene_->CreateComponent<Octree>();
+    // (-1000, -1000, -1000) to (1000, 1000, 1000). Optionally use the AABB tree spatial index for comparison
+    Octree* octree = scene_->CreateComponent<Octree>();
+    octree->SetSpatialIndex(useAABBTree_ ? SPATIAL_AABBTREE : SPATIAL_OCTREE);
 
     // Create a Zone for ambient light & fog control
     Node* zoneNode = scene_->CreateChild("Zone");
@@ -171,7 +173,8 @@ void HugeObjectCount::CreateInstructions()
     instructionText->SetText(
         "Use WASD keys and mouse/touch to move\n"
         "Space to toggle animation\n"
-        "G to toggle object group optimization"
+        "G to toggle object group optimization\n"
+        "I to toggle octree / AABB tree spatial index"
     );
     instructionText->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
     // The text has multiple rows. Center them in relation to each other
@@ -262,6 +265,13 @@ void HugeObjectCount::HandleUpdate(StringHash eventType, VariantMap& eventData)
         CreateScene();
     }
 
+    // Toggle octree / AABB tree spatial index
+    if (input->GetKeyPress(KEY_I))
+    {
+        useAABBTree_ = !useAABBTree_;
+        scene_->GetComponent<Octree>()->SetSpatialIndex(useAABBTree_ ? SPATIAL_AABBTREE : SPATIAL_OCTREE);
+    }
+
     // Move the camera, scale movement with time step
     MoveCamera(timeStep);
 
@@ -95,4 +95,6 @@ private:
     bool animate_;
     /// Group optimization flag.
     bool useGroups_;
+    /// AABB tree spatial index flag.
+    bool useAABBTree_;
 };
@@ -170,6 +170,8 @@ bool noOverwriteTexture_ = false;
 bool noOverwriteNewerTexture_ = false;
 bool checkUniqueModel_ = true;
 bool moveToBindPose_ = false;
+bool compressAnimations_ = false;
+float animationTolerance_ = 0.001f;
 unsigned maxBones_ = 64;
 Vector<String> nonSkinningBoneIncludes_;
 Vector<String> nonSkinningBoneExcludes_;
@@ -313,6 +315,9 @@ void Run(const Vector<String>& arguments)
             "-split <start> <end> (animation model only)\n"
             "            Split animation, will only import from start frame to end frame\n"
             "-np         Do not suppress $fbx pivot nodes (FBX files only)\n"
+            "-ca [tol]   Save compressed animations. Keyframes that can be interpolated\n"
+            "            within the tolerance are removed; position and scale tolerance is\n"
+            "            in units and rotation tolerance in radians. Default 0.001\n"
         );
     }
 
@@ -463,6 +468,15 @@ void Run(const Vector<String>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "ca")
+            {
+                compressAnimations_ = true;
+                if (value.Length() && value[0] != '-')
+                {
+                    animationTolerance_ = ToFloat(value);
+                    ++i;
+                }
+            }
             else if (argument == "split")
             {
                 String value2 = i + 2 < arguments.Size() ? arguments[i + 2] : String::EMPTY;
@@ -1484,6 +1498,9 @@ void BuildAndSaveAnimations(OutModel* model)
             }
         }
 
+        if (compressAnimations_)
+            outAnim->Compress(animationTolerance_, animationTolerance_, animationTolerance_);
+
         File outFile(context_);
         if (!outFile.Open(animOutName, FILE_WRITE))
             ErrorExit("Could not open output file " + animOutName);
@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned NUM_REPEATS = 100;
+static const float POSITION_RANGE = 1000.0f;
+
+/// Network transform encoding to compare.
+struct TransformEncoding
+{
+    /// Name.
+    const char* name_;
+    /// Position quantization.
+    AttributeQuantization position_;
+    /// Rotation quantization.
+    AttributeQuantization rotation_;
+};
+
+/// Write the latest data update, which holds the network position and rotation, of each node.
+struct EncodeTransformsTest
+{
+    /// Construct.
+    EncodeTransformsTest(const PODVector<Node*>& nodes) :
+        nodes_(nodes)
+    {
+    }
+
+    /// Encode the transforms of all nodes.
+    void operator ()()
+    {
+        buffer_.Clear();
+        for (unsigned i = 0; i < nodes_.Size(); ++i)
+            nodes_[i]->WriteLatestDataUpdate(buffer_, 0);
+    }
+
+    /// Nodes.
+    const PODVector<Node*>& nodes_;
+    /// Encoded updates.
+    VectorBuffer buffer_;
+};
+
+/// Read and apply the latest data update of each node.
+struct DecodeTransformsTest
+{
+    /// Construct.
+    DecodeTransformsTest(const PODVector<Node*>& nodes, const VectorBuffer& buffer) :
+        nodes_(nodes),
+        buffer_(buffer)
+    {
+    }
+
+    /// Decode the transforms of all nodes.
+    void operator ()()
+    {
+        MemoryBuffer source(buffer_.GetData(), buffer_.GetSize());
+        for (unsigned i = 0; i < nodes_.Size(); ++i)
+            nodes_[i]->ReadLatestDataUpdate(source);
+    }
+
+    /// Nodes.
+    const PODVector<Node*>& nodes_;
+    /// Encoded updates.
+    const VectorBuffer& buffer_;
+};
+
+/// Create nodes with random transforms and allocate their network state.
+static void CreateNodes(Scene* scene, unsigned numNodes, PODVector<Node*>& nodes)
+{
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = scene->CreateChild("Node");
+        node->SetPosition(Vector3(Random(-POSITION_RANGE, POSITION_RANGE), Random(-POSITION_RANGE, POSITION_RANGE),
+            Random(-POSITION_RANGE, POSITION_RANGE)));
+        node->SetRotation(Quaternion(Random(360.0f), Random(360.0f), Random(360.0f)));
+        node->PrepareNetworkUpdate();
+        nodes.Push(node);
+    }
+}
+
+void RunAttributeBenchmark(Context* context, const Vector<String>& arguments)
+{
+    static const TransformEncoding encodings[] = {
+        {"Full precision", AttributeQuantization(), AttributeQuantization()},
+        {"Rotation 12 bits (default)", AttributeQuantization(), AttributeQuantization(12)},
+        {"Position 20 bits, rotation 12", AttributeQuantization(-POSITION_RANGE, POSITION_RANGE, 20), AttributeQuantization(12)}
+    };
+
+    unsigned numNodes = Max(GetArgument(arguments, 0, 10000), 1U);
+    RegisterSceneLibrary(context);
+
+    PrintLine(FormatLine("Network transform encoding: %u nodes, positions within +-%.0f, average of %u repeats", numNodes,
+        POSITION_RANGE, NUM_REPEATS));
+    PrintLine("Encoding                        Bytes/node   Encode ns   Decode ns   Max position error   Max rotation error deg");
+
+    for (unsigned i = 0; i < sizeof encodings / sizeof encodings[0]; ++i)
+    {
+        const TransformEncoding& encoding = encodings[i];
+        context->SetAttributeQuantization<Node>("Network Position", encoding.position_);
+        context->SetAttributeQuantization<Node>("Network Rotation", encoding.rotation_);
+
+        SetRandomSeed(1);
+        SharedPtr<Scene> serverScene(new Scene(context));
+        SharedPtr<Scene> clientScene(new Scene(context));
+        PODVector<Node*> serverNodes;
+        PODVector<Node*> clientNodes;
+        CreateNodes(serverScene, numNodes, serverNodes);
+        CreateNodes(clientScene, numNodes, clientNodes);
+
+        EncodeTransformsTest encodeTest(serverNodes);
+        float encodeUSec = MeasureUSec(encodeTest, NUM_REPEATS);
+        DecodeTransformsTest decodeTest(clientNodes, encodeTest.buffer_);
+        float decodeUSec = MeasureUSec(decodeTest, NUM_REPEATS);
+
+        float maxPositionError = 0.0f;
+        float maxRotationError = 0.0f;
+        for (unsigned j = 0; j < numNodes; ++j)
+        {
+            maxPositionError = Max(maxPositionError, (serverNodes[j]->GetPosition() - clientNodes[j]->GetPosition()).Length());
+            // The angle from the difference rotation's vector part stays precise for small errors, unlike acos of the dot product
+            Quaternion difference = serverNodes[j]->GetRotation().Conjugate() * clientNodes[j]->GetRotation();
+            float sinHalfAngle = sqrtf(difference.x_ * difference.x_ + difference.y_ * difference.y_ + difference.z_ * difference.z_);
+            maxRotationError = Max(maxRotationError, 2.0f * atan2f(sinHalfAngle, Abs(difference.w_)) * M_RADTODEG);
+        }
+
+        PrintLine(FormatLine("%-30s   %10.2f   %9.1f   %9.1f   %18.5f   %22.4f", encoding.name_,
+            (float)encodeTest.buffer_.GetSize() / numNodes, encodeUSec * 1000.0f / numNodes, decodeUSec * 1000.0f / numNodes,
+            maxPositionError, maxRotationError));
+    }
+}
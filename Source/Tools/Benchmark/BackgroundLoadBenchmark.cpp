@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Resource/Image.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned NUM_ROUNDS = 3;
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+
+/// Return the names of all PNG and JPEG images in the resource directories.
+static Vector<String> GetImageNames(ResourceCache* cache, FileSystem* fileSystem)
+{
+    static const char* filters[] = {"*.png", "*.jpg"};
+
+    Vector<String> names;
+    const Vector<String>& resourceDirs = cache->GetResourceDirs();
+    for (unsigned i = 0; i < resourceDirs.Size(); ++i)
+    {
+        for (unsigned j = 0; j < sizeof filters / sizeof filters[0]; ++j)
+        {
+            Vector<String> files;
+            fileSystem->ScanDir(files, resourceDirs[i], filters[j], SCAN_FILES, true);
+            names.Push(files);
+        }
+    }
+
+    return names;
+}
+
+/// Background load the images and run frames until all of them have been finished. Return the time in milliseconds.
+static float LoadImages(ResourceCache* cache, Time* time, const Vector<String>& names)
+{
+    // Release the images from a previous round so that they are loaded again
+    cache->ReleaseResources(Image::GetTypeStatic(), true);
+
+    HiresTimer timer;
+    for (unsigned i = 0; i < names.Size(); ++i)
+        cache->BackgroundLoadResource<Image>(names[i]);
+
+    // Finishing the resources happens on the begin frame event, as in the application main loop
+    while (cache->GetNumBackgroundLoadResources())
+    {
+        Time::Sleep(1);
+        time->BeginFrame(FRAME_TIME_STEP);
+        time->EndFrame();
+    }
+
+    return (float)timer.GetUSec(false) / 1000.0f;
+}
+
+void RunBackgroundLoadBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned maxThreads = Max(GetArgument(arguments, 0, Max(GetNumLogicalCPUs(), 4U)), 1U);
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+    ResourceCache* cache = engine->GetSubsystem<ResourceCache>();
+    Time* time = engine->GetSubsystem<Time>();
+    // Finish all loaded resources on each frame so that the main thread budget does not limit the loader threads
+    cache->SetFinishBackgroundResourcesMs(1000);
+
+    Vector<String> names = GetImageNames(cache, engine->GetSubsystem<FileSystem>());
+    if (names.Empty())
+        ErrorExit("Could not find images to load");
+
+    unsigned long long totalSize = 0;
+    for (unsigned i = 0; i < names.Size(); ++i)
+    {
+        SharedPtr<File> file = cache->GetFile(names[i]);
+        if (file)
+            totalSize += file->GetSize();
+    }
+
+    PrintLine(FormatLine("Background loading: %u images (%.1f MB compressed), %u logical CPUs, best of %u rounds",
+        names.Size(), (float)totalSize / (1024.0f * 1024.0f), GetNumLogicalCPUs(), NUM_ROUNDS));
+    PrintLine("Threads   Load time ms   Speedup");
+
+    // Load once untimed so that the files are in the operating system cache
+    LoadImages(cache, time, names);
+
+    float singleThreadMs = 0.0f;
+    for (unsigned threads = 1; threads <= maxThreads; ++threads)
+    {
+        cache->SetNumBackgroundLoadThreads(threads);
+
+        float bestMs = M_INFINITY;
+        for (unsigned i = 0; i < NUM_ROUNDS; ++i)
+            bestMs = Min(bestMs, LoadImages(cache, time, names));
+
+        if (threads == 1)
+            singleThreadMs = bestMs;
+        PrintLine(FormatLine("%7u   %12.2f   %7.2f", threads, bestMs, singleThreadMs / bestMs));
+    }
+}
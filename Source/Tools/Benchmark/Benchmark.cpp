@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+
+#include "Benchmark.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+/// Benchmark description.
+struct BenchmarkInfo
+{
+    /// Name on the command line.
+    const char* name_;
+    /// Usage description.
+    const char* usage_;
+    /// Benchmark function.
+    void (* function_)(Context*, const Vector<String>&);
+};
+
+static const BenchmarkInfo benchmarks[] = {
+    {"workqueue", "workqueue [max threads] [items per frame] [iterations per item]", RunWorkQueueBenchmark},
+    {"hashmap", "hashmap [max map size]", RunHashMapBenchmark},
+    {"skinning", "skinning [characters]", RunSkinningBenchmark},
+    {"backgroundload", "backgroundload [max threads]", RunBackgroundLoadBenchmark},
+    {"network", "network [max clients] [nodes] [worker threads]", RunNetworkBenchmark},
+    {"attributes", "attributes [nodes]", RunAttributeBenchmark},
+    {"events", "events [receivers]", RunEventBenchmark},
+    {"culling", "culling [octree levels ...]", RunCullingBenchmark},
+    {"spatialindex", "spatialindex [frames]", RunSpatialIndexBenchmark},
+    {"sceneload", "sceneload [nodes]", RunSceneLoadBenchmark},
+    {"transforms", "transforms [frames]", RunTransformBenchmark},
+    {"raycast", "raycast [rays]", RunRaycastBenchmark},
+    {"occlusion", "occlusion [max threads]", RunOcclusionBenchmark},
+    {0, 0, 0}
+};
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    String usage = "Usage: Benchmark <benchmark> [options]\n\nBenchmarks:\n";
+    for (const BenchmarkInfo* i = benchmarks; i->name_; ++i)
+        usage += String(i->usage_) + "\n";
+
+    if (arguments.Empty())
+        ErrorExit(usage);
+
+    for (const BenchmarkInfo* i = benchmarks; i->name_; ++i)
+    {
+        if (arguments[0].Compare(i->name_, false))
+            continue;
+
+        // The time subsystem initializes the high-resolution timer
+        SharedPtr<Context> context(new Context());
+        context->RegisterSubsystem(new Time(context));
+        Vector<String> benchmarkArguments(arguments);
+        benchmarkArguments.Erase(0);
+        i->function_(context, benchmarkArguments);
+        return;
+    }
+
+    ErrorExit("Unknown benchmark " + arguments[0] + "\n\n" + usage);
+}
+
+unsigned GetArgument(const Vector<String>& arguments, unsigned index, unsigned defaultValue)
+{
+    return index < arguments.Size() ? ToUInt(arguments[index]) : defaultValue;
+}
+
+SharedPtr<Engine> CreateHeadlessEngine(Context* context)
+{
+    VariantMap parameters = Engine::ParseParameters(Vector<String>());
+    parameters[EP_HEADLESS] = true;
+    parameters[EP_LOG_NAME] = String::EMPTY;
+    parameters[EP_LOG_QUIET] = true;
+    // Find the resource directories from either the bin or the bin/tool directory, unless set from the environment
+    if (!parameters.Contains(EP_RESOURCE_PREFIX_PATHS))
+        parameters[EP_RESOURCE_PREFIX_PATHS] = ";..";
+
+    SharedPtr<Engine> engine(new Engine(context));
+    if (!engine->Initialize(parameters))
+        ErrorExit("Could not initialize the engine");
+
+    return engine;
+}
+
+String FormatLine(const char* format, ...)
+{
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof line, format, args);
+    va_end(args);
+    return String(line);
+}
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Core/Timer.h>
+
+namespace Urho3D
+{
+
+class Context;
+class Engine;
+
+}
+
+using namespace Urho3D;
+
+/// Return an unsigned benchmark argument, or the default value if not specified.
+unsigned GetArgument(const Vector<String>& arguments, unsigned index, unsigned defaultValue);
+/// Format a line of results with printf-style field widths and precision.
+String FormatLine(const char* format, ...);
+/// Create and initialize a headless engine with the Data and CoreData resource directories. Exit on failure.
+SharedPtr<Engine> CreateHeadlessEngine(Context* context);
+
+/// Execute a function a number of times and return the average time in microseconds, after one untimed warm-up call.
+template <class Function> float MeasureUSec(Function& function, unsigned repeats)
+{
+    function();
+
+    HiresTimer timer;
+    for (unsigned i = 0; i < repeats; ++i)
+        function();
+
+    return (float)timer.GetUSec(false) / (float)repeats;
+}
+
+/// Measure WorkQueue frame times with increasing worker thread counts.
+void RunWorkQueueBenchmark(Context* context, const Vector<String>& arguments);
+/// Compare HashMap and FlatHashMap insert, lookup and clear-and-refill times.
+void RunHashMapBenchmark(Context* context, const Vector<String>& arguments);
+/// Measure the skin matrix multiply and the animation and skinning update of characters.
+void RunSkinningBenchmark(Context* context, const Vector<String>& arguments);
+/// Measure background loading of the images in the resource directories with increasing loader thread counts.
+void RunBackgroundLoadBenchmark(Context* context, const Vector<String>& arguments);
+/// Measure the server network update time with increasing numbers of loopback client connections.
+void RunNetworkBenchmark(Context* context, const Vector<String>& arguments);
+/// Compare the size, encoding and decoding time and precision of full precision and quantized network transforms.
+void RunAttributeBenchmark(Context* context, const Vector<String>& arguments);
+/// Measure the time and heap allocations of sending events to specific and non-specific receivers.
+void RunEventBenchmark(Context* context, const Vector<String>& arguments);
+/// Compare octree update and frustum culling times with and without packed drawable bounds.
+void RunCullingBenchmark(Context* context, const Vector<String>& arguments);
+/// Compare octree update, frustum query and raycast times between the octree and AABB tree spatial indices.
+void RunSpatialIndexBenchmark(Context* context, const Vector<String>& arguments);
+/// Compare scene load times from the binary and indexed binary formats.
+void RunSceneLoadBenchmark(Context* context, const Vector<String>& arguments);
+/// Compare lazy and batched scene node world transform updates.
+void RunTransformBenchmark(Context* context, const Vector<String>& arguments);
+/// Compare batched and per-ray closest hit raycasts, and the four triangle and one triangle at a time hit tests.
+void RunRaycastBenchmark(Context* context, const Vector<String>& arguments);
+/// Compare the coverage and drawing time of the scanline and threaded tiled occlusion rasterizers.
+void RunOcclusionBenchmark(Context* context, const Vector<String>& arguments);
@@ -0,0 +1,226 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned NUM_FRAMES = 50;
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+static const unsigned NUM_SCATTERED_BOXES = 100000;
+static const unsigned NUM_SCATTERED_MOVING = 100;
+static const unsigned minPackedDrawables[] = {4, 16, 64, M_MAX_UNSIGNED};
+
+/// Culling test content.
+struct CullingContent
+{
+    /// Construct.
+    CullingContent() :
+        numMoving_(0),
+        rotateBoxes_(false)
+    {
+    }
+
+    /// Name.
+    String name_;
+    /// Scene.
+    SharedPtr<Scene> scene_;
+    /// Octree.
+    Octree* octree_;
+    /// Camera node.
+    Node* cameraNode_;
+    /// Box nodes.
+    PODVector<Node*> boxNodes_;
+    /// Initial box node positions.
+    PODVector<Vector3> positions_;
+    /// Number of box nodes moved each frame.
+    unsigned numMoving_;
+    /// Whether all boxes rotate each frame instead of some moving.
+    bool rotateBoxes_;
+};
+
+/// Create the scene, octree and camera of culling test content.
+static void CreateCullingScene(Context* context, CullingContent& content, const Vector3& cameraPosition, float farClip)
+{
+    content.scene_ = new Scene(context);
+    content.octree_ = content.scene_->CreateComponent<Octree>();
+    content.cameraNode_ = content.scene_->CreateChild("Camera");
+    content.cameraNode_->SetPosition(cameraPosition);
+    content.cameraNode_->CreateComponent<Camera>()->SetFarClip(farClip);
+}
+
+/// Create a box in culling test content.
+static void CreateBox(CullingContent& content, Model* model, const Vector3& position, float scale)
+{
+    Node* node = content.scene_->CreateChild("Box");
+    node->SetPosition(position);
+    node->SetScale(scale);
+    node->CreateComponent<StaticModel>()->SetModel(model);
+    content.boxNodes_.Push(node);
+    content.positions_.Push(position);
+}
+
+/// Create the HugeObjectCount sample grid of boxes, with the sample's camera.
+static void CreateGridScene(Context* context, CullingContent& content, Model* model)
+{
+    CreateCullingScene(context, content, Vector3(0.0f, 10.0f, -100.0f), 300.0f);
+    for (int y = -125; y < 125; ++y)
+    {
+        for (int x = -125; x < 125; ++x)
+            CreateBox(content, model, Vector3(x * 0.3f, 0.0f, y * 0.3f), 0.25f);
+    }
+}
+
+/// Run frames of moving boxes and a rotating camera. Return the average octree update and frustum query times in
+/// microseconds, and a checksum of the query results.
+static void RunCullingFrames(CullingContent& content, float& updateUSec, float& queryUSec, unsigned& checksum)
+{
+    // Start from the same transforms, which also queues all boxes for reinsertion after an octree resize
+    for (unsigned i = 0; i < content.boxNodes_.Size(); ++i)
+        content.boxNodes_[i]->SetTransform(content.positions_[i], Quaternion::IDENTITY);
+
+    Camera* camera = content.cameraNode_->GetComponent<Camera>();
+    FrameInfo frame;
+    frame.frameNumber_ = 0;
+    frame.timeStep_ = FRAME_TIME_STEP;
+    frame.camera_ = camera;
+    content.octree_->Update(frame);
+
+    PODVector<Drawable*> result;
+    long long updateTime = 0;
+    long long queryTime = 0;
+    checksum = 0;
+
+    for (unsigned i = 0; i < NUM_FRAMES; ++i)
+    {
+        ++frame.frameNumber_;
+        if (content.rotateBoxes_)
+        {
+            // As in the HugeObjectCount sample, which rotates every box each frame
+            Quaternion rotation(15.0f * FRAME_TIME_STEP, Vector3::FORWARD);
+            for (unsigned j = 0; j < content.boxNodes_.Size(); ++j)
+                content.boxNodes_[j]->Rotate(rotation);
+        }
+        for (unsigned j = 0; j < content.numMoving_; ++j)
+            content.boxNodes_[(i * content.numMoving_ + j) % content.boxNodes_.Size()]->Translate(Vector3(0.1f, 0.0f, 0.0f));
+
+        HiresTimer updateTimer;
+        content.octree_->Update(frame);
+        updateTime += updateTimer.GetUSec(false);
+
+        content.cameraNode_->SetRotation(Quaternion(10.0f + (float)(i % 5), (float)i * 7.0f, 0.0f));
+        result.Clear();
+        FrustumOctreeQuery query(result, camera->GetFrustum(), DRAWABLE_GEOMETRY);
+        HiresTimer queryTimer;
+        content.octree_->GetDrawables(query);
+        queryTime += queryTimer.GetUSec(false);
+
+        for (unsigned j = 0; j < result.Size(); ++j)
+            checksum = checksum * 31 + result[j]->GetID();
+        checksum += result.Size();
+    }
+
+    updateUSec = (float)updateTime / NUM_FRAMES;
+    queryUSec = (float)queryTime / NUM_FRAMES;
+}
+
+void RunCullingBenchmark(Context* context, const Vector<String>& arguments)
+{
+    PODVector<unsigned> levels;
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+        levels.Push(Clamp(GetArgument(arguments, i, 0), 1U, 16U));
+    if (levels.Empty())
+    {
+        levels.Push(4);
+        levels.Push(6);
+        levels.Push(8);
+    }
+
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+    Model* model = engine->GetSubsystem<ResourceCache>()->GetResource<Model>("Models/Box.mdl");
+    if (!model)
+        ErrorExit("Could not load the box model");
+
+    Vector<CullingContent> contents(3);
+
+    // The HugeObjectCount sample grid of boxes, both with the sample's rotation animation and static
+    CullingContent& grid = contents[0];
+    grid.name_ = "HugeObjectCount grid: 62500 boxes rotating each frame";
+    grid.rotateBoxes_ = true;
+    CreateGridScene(context, grid, model);
+    CullingContent& staticGrid = contents[1];
+    staticGrid.name_ = "HugeObjectCount grid: 62500 static boxes";
+    CreateGridScene(context, staticGrid, model);
+
+    // Boxes scattered sparsely in a large volume, some of them moving
+    SetRandomSeed(1);
+    CullingContent& scattered = contents[2];
+    scattered.name_ = FormatLine("Scattered: %u boxes within +-450, %u moving each frame", NUM_SCATTERED_BOXES, NUM_SCATTERED_MOVING);
+    scattered.numMoving_ = NUM_SCATTERED_MOVING;
+    CreateCullingScene(context, scattered, Vector3::ZERO, 1000.0f);
+    for (unsigned i = 0; i < NUM_SCATTERED_BOXES; ++i)
+        CreateBox(scattered, model, Vector3(Random(-450.0f, 450.0f), Random(-450.0f, 450.0f), Random(-450.0f, 450.0f)), 2.0f);
+
+    for (unsigned i = 0; i < contents.Size(); ++i)
+    {
+        CullingContent& content = contents[i];
+        PrintLine(FormatLine("Culling: %s, average of %u frames", content.name_.CString(), NUM_FRAMES));
+        PrintLine("Levels   Min packed   Update ms   Query ms");
+
+        for (unsigned j = 0; j < levels.Size(); ++j)
+        {
+            unsigned referenceChecksum = 0;
+
+            for (unsigned k = 0; k < sizeof minPackedDrawables / sizeof minPackedDrawables[0]; ++k)
+            {
+                content.octree_->SetMinPackedDrawables(minPackedDrawables[k]);
+                content.octree_->SetSize(BoundingBox(-1000.0f, 1000.0f), levels[j]);
+
+                float updateUSec;
+                float queryUSec;
+                unsigned checksum;
+                RunCullingFrames(content, updateUSec, queryUSec, checksum);
+
+                // All settings must give the same query results
+                if (!k)
+                    referenceChecksum = checksum;
+                else if (checksum != referenceChecksum)
+                    ErrorExit("Culling results differ between packed and per-drawable tests");
+
+                String minPacked = minPackedDrawables[k] == M_MAX_UNSIGNED ? String("off") : String(minPackedDrawables[k]);
+                PrintLine(FormatLine("%6u   %10s   %9.3f   %8.3f", levels[j], minPacked.CString(), updateUSec / 1000.0f,
+                    queryUSec / 1000.0f));
+            }
+        }
+    }
+}
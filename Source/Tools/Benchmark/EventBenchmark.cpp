@@ -0,0 +1,322 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Container/HashSet.h>
+
+#include "Benchmark.h"
+
+#include <cstdlib>
+#include <new>
+
+// The global allocation functions are replaced in this executable to count heap allocations during event dispatch, so the
+// debug allocation tracking is not included
+
+/// Number of heap allocations made with operator new.
+static unsigned numAllocations = 0;
+
+#if __cplusplus >= 201103L
+#define BENCHMARK_NOEXCEPT noexcept
+#define BENCHMARK_THROW_BAD_ALLOC
+#else
+#define BENCHMARK_NOEXCEPT throw()
+#define BENCHMARK_THROW_BAD_ALLOC throw(std::bad_alloc)
+#endif
+
+void* operator new(size_t size) BENCHMARK_THROW_BAD_ALLOC
+{
+    ++numAllocations;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) BENCHMARK_THROW_BAD_ALLOC
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) BENCHMARK_NOEXCEPT
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) BENCHMARK_NOEXCEPT
+{
+    free(ptr);
+}
+
+static const unsigned NUM_SENDS = 10000;
+static const unsigned NUM_REPEATS = 10;
+
+URHO3D_EVENT(E_BENCHMARKEVENT, BenchmarkEvent)
+{
+    URHO3D_PARAM(P_VALUE, Value);                  // unsigned
+}
+
+/// Event receiver that counts the events it handles.
+class BenchmarkReceiver : public Object
+{
+    URHO3D_OBJECT(BenchmarkReceiver, Object);
+
+public:
+    /// Construct.
+    BenchmarkReceiver(Context* context) :
+        Object(context),
+        numEvents_(0)
+    {
+    }
+
+    /// Subscribe to the benchmark event, from the sender only if specified.
+    void Subscribe(Object* sender)
+    {
+        if (sender)
+            SubscribeToEvent(sender, E_BENCHMARKEVENT, URHO3D_HANDLER(BenchmarkReceiver, HandleBenchmarkEvent));
+        else
+            SubscribeToEvent(E_BENCHMARKEVENT, URHO3D_HANDLER(BenchmarkReceiver, HandleBenchmarkEvent));
+    }
+
+    /// Handle the benchmark event.
+    void HandleBenchmarkEvent(StringHash eventType, VariantMap& eventData) { ++numEvents_; }
+
+    /// Number of events handled.
+    unsigned numEvents_;
+};
+
+/// Event receiver that overrides OnEvent() and records the timestep of the update event it sees there.
+class OverridingReceiver : public Object
+{
+    URHO3D_OBJECT(OverridingReceiver, Object);
+
+public:
+    /// Construct.
+    OverridingReceiver(Context* context) :
+        Object(context),
+        timeStep_(0.0f)
+    {
+        SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(OverridingReceiver, HandleUpdate));
+    }
+
+    /// Handle an event before the event handler.
+    virtual void OnEvent(Object* sender, StringHash eventType, VariantMap& eventData)
+    {
+        if (eventType == E_UPDATE)
+            timeStep_ = eventData[Update::P_TIMESTEP].GetFloat();
+        Object::OnEvent(sender, eventType, eventData);
+    }
+
+    /// Handle the update event.
+    void HandleUpdate(StringHash eventType, VariantMap& eventData) { }
+
+    /// Timestep seen in OnEvent().
+    float timeStep_;
+};
+
+/// Event sender.
+class BenchmarkSender : public Object
+{
+    URHO3D_OBJECT(BenchmarkSender, Object);
+
+public:
+    /// Construct.
+    BenchmarkSender(Context* context) :
+        Object(context)
+    {
+    }
+};
+
+/// Send events with or without event data.
+struct SendEventsTest
+{
+    /// Construct.
+    SendEventsTest(Object* sender, bool sendEventData) :
+        sender_(sender),
+        sendEventData_(sendEventData)
+    {
+    }
+
+    /// Send a batch of events.
+    void operator ()()
+    {
+        for (unsigned i = 0; i < NUM_SENDS; ++i)
+        {
+            if (sendEventData_)
+            {
+                using namespace BenchmarkEvent;
+
+                VariantMap& eventData = sender_->GetEventDataMap();
+                eventData[P_VALUE] = i;
+                sender_->SendEvent(E_BENCHMARKEVENT, eventData);
+            }
+            else
+                sender_->SendEvent(E_BENCHMARKEVENT);
+        }
+    }
+
+    /// Sender.
+    Object* sender_;
+    /// Whether to send event data.
+    bool sendEventData_;
+};
+
+/// Construct an empty event data map, as SendEvent() without parameters did before sending.
+struct EmptyEventDataTest
+{
+    /// Construct.
+    EmptyEventDataTest() :
+        size_(0)
+    {
+    }
+
+    /// Construct a batch of maps.
+    void operator ()()
+    {
+        for (unsigned i = 0; i < NUM_SENDS; ++i)
+        {
+            VariantMap eventData;
+            size_ += eventData.Size();
+        }
+    }
+
+    /// Sum of map sizes to keep the construction from being optimized away.
+    unsigned size_;
+};
+
+/// Fill a local set of receivers, as SendEvent() did when the sender had specific receivers.
+struct ProcessedSetTest
+{
+    /// Construct.
+    ProcessedSetTest(const Vector<SharedPtr<BenchmarkReceiver> >& receivers) :
+        receivers_(receivers),
+        size_(0)
+    {
+    }
+
+    /// Fill a batch of sets.
+    void operator ()()
+    {
+        for (unsigned i = 0; i < NUM_SENDS; ++i)
+        {
+            HashSet<Object*> processed;
+            for (unsigned j = 0; j < receivers_.Size(); ++j)
+                processed.Insert(receivers_[j]);
+            size_ += processed.Size();
+        }
+    }
+
+    /// Receivers.
+    const Vector<SharedPtr<BenchmarkReceiver> >& receivers_;
+    /// Sum of set sizes to keep the filling from being optimized away.
+    unsigned size_;
+};
+
+/// Measure a batch of sends or of removed work and print the time and allocations per send.
+template <class Function> void PrintEventTest(const char* name, Function& function)
+{
+    float usec = MeasureUSec(function, NUM_REPEATS);
+    unsigned allocationsBefore = numAllocations;
+    function();
+    float allocations = (float)(numAllocations - allocationsBefore) / NUM_SENDS;
+
+    PrintLine(FormatLine("%-42s   %9.1f   %16.2f", name, usec * 1000.0f / NUM_SENDS, allocations));
+}
+
+/// Check that each receiver has handled every event sent to it.
+static void CheckReceivers(const Vector<SharedPtr<BenchmarkReceiver> >& receivers, unsigned numEvents)
+{
+    for (unsigned i = 0; i < receivers.Size(); ++i)
+    {
+        if (receivers[i]->numEvents_ != numEvents)
+            ErrorExit(FormatLine("Receiver handled %u events instead of %u", receivers[i]->numEvents_, numEvents));
+        receivers[i]->numEvents_ = 0;
+    }
+}
+
+void RunEventBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned numReceivers = Max(GetArgument(arguments, 0, 10), 1U);
+    // Each test runs one warm-up batch, the timed batches and one batch counting allocations
+    unsigned numEvents = NUM_SENDS * (NUM_REPEATS + 2);
+
+    SharedPtr<BenchmarkSender> sender(new BenchmarkSender(context));
+    Vector<SharedPtr<BenchmarkReceiver> > receivers;
+    Vector<SharedPtr<BenchmarkReceiver> > specificReceivers;
+    for (unsigned i = 0; i < numReceivers; ++i)
+    {
+        receivers.Push(SharedPtr<BenchmarkReceiver>(new BenchmarkReceiver(context)));
+        receivers.Back()->Subscribe(0);
+        specificReceivers.Push(SharedPtr<BenchmarkReceiver>(new BenchmarkReceiver(context)));
+    }
+
+    PrintLine(FormatLine("Event dispatch: %u receivers of each kind, average of %u batches of %u sends", numReceivers, NUM_REPEATS,
+        NUM_SENDS));
+    PrintLine("Test                                         ns/send   Allocations/send");
+
+    SendEventsTest sendTest(sender, false);
+    PrintEventTest("Non-specific receivers, no event data", sendTest);
+    CheckReceivers(receivers, numEvents);
+
+    SendEventsTest sendDataTest(sender, true);
+    PrintEventTest("Non-specific receivers, event data", sendDataTest);
+    CheckReceivers(receivers, numEvents);
+
+    // With receivers specific to the sender too, the dispatch tracks which receivers have handled the event
+    for (unsigned i = 0; i < numReceivers; ++i)
+        specificReceivers[i]->Subscribe(sender);
+
+    PrintEventTest("Specific and non-specific, no event data", sendTest);
+    CheckReceivers(receivers, numEvents);
+    CheckReceivers(specificReceivers, numEvents);
+
+    PrintEventTest("Specific and non-specific, event data", sendDataTest);
+    CheckReceivers(receivers, numEvents);
+    CheckReceivers(specificReceivers, numEvents);
+
+    // A send without event data must not clear the event data map that the caller has already filled
+    {
+        using namespace BenchmarkEvent;
+
+        VariantMap& eventData = sender->GetEventDataMap();
+        eventData[P_VALUE] = numEvents;
+        sender->SendEvent(E_BENCHMARKEVENT);
+        if (eventData[P_VALUE].GetUInt() != numEvents)
+            ErrorExit("Sending an event without event data cleared the event data map of the caller");
+    }
+
+    // A typed event to a VariantMap handler must go through an overridden OnEvent()
+    {
+        SharedPtr<OverridingReceiver> receiver(new OverridingReceiver(context));
+        UpdateEventData eventData(0.5f);
+        sender->SendTypedEvent(E_UPDATE, eventData);
+        if (receiver->timeStep_ != 0.5f)
+            ErrorExit("A typed event did not go through the overridden OnEvent() of the receiver");
+    }
+
+    // Work done per send before dispatch used the preallocated event data map and the reused receiver set
+    EmptyEventDataTest emptyEventDataTest;
+    PrintEventTest("Removed: empty event data map", emptyEventDataTest);
+    ProcessedSetTest processedSetTest(specificReceivers);
+    PrintEventTest("Removed: local set of specific receivers", processedSetTest);
+}
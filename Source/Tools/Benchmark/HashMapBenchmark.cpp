@@ -0,0 +1,200 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/FlatHashMap.h>
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Math/StringHash.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+/// Approximate number of map operations per measurement.
+static const unsigned OPERATIONS_PER_TEST = 2000000;
+/// Map sizes to measure.
+static const unsigned mapSizes[] = {16, 256, 4096, 65536};
+/// Number of map sizes.
+static const unsigned NUM_MAP_SIZES = sizeof mapSizes / sizeof mapSizes[0];
+
+/// Object used as a pointer key. Pointer keys are hashed by their address divided by the object size.
+struct KeyObject
+{
+    /// Object data.
+    unsigned char data_[64];
+};
+
+/// Insert test: fill a new map, which also includes its growth and destruction.
+template <class Map, class Key> struct MapInsertTest
+{
+    /// Construct.
+    MapInsertTest(const Key* keys, unsigned numKeys) :
+        keys_(keys),
+        numKeys_(numKeys),
+        checksum_(0)
+    {
+    }
+
+    /// Run the test once.
+    void operator ()()
+    {
+        Map map;
+        for (unsigned i = 0; i < numKeys_; ++i)
+            map[keys_[i]] = i;
+        checksum_ += map.Size();
+    }
+
+    /// Keys to insert.
+    const Key* keys_;
+    /// Number of keys.
+    unsigned numKeys_;
+    /// Checksum of the results.
+    unsigned checksum_;
+};
+
+/// Lookup test: find every key of a filled map, and the same number of keys that are not in the map.
+template <class Map, class Key> struct MapLookupTest
+{
+    /// Construct and fill the map.
+    MapLookupTest(const Key* keys, unsigned numKeys) :
+        keys_(keys),
+        numKeys_(numKeys),
+        checksum_(0)
+    {
+        for (unsigned i = 0; i < numKeys_; ++i)
+            map_[keys_[i]] = i;
+    }
+
+    /// Run the test once.
+    void operator ()()
+    {
+        for (unsigned i = 0; i < numKeys_; ++i)
+        {
+            typename Map::ConstIterator j = map_.Find(keys_[i]);
+            if (j != map_.End())
+                checksum_ += j->second_;
+        }
+
+        for (unsigned i = numKeys_; i < numKeys_ * 2; ++i)
+        {
+            if (map_.Contains(keys_[i]))
+                ++checksum_;
+        }
+    }
+
+    /// Map to search.
+    Map map_;
+    /// Keys to find, followed by the same number of missing keys.
+    const Key* keys_;
+    /// Number of keys in the map.
+    unsigned numKeys_;
+    /// Checksum of the results.
+    unsigned checksum_;
+};
+
+/// Clear and refill test: clear a map and fill it again, as the per-frame render maps are used.
+template <class Map, class Key> struct MapRefillTest
+{
+    /// Construct.
+    MapRefillTest(const Key* keys, unsigned numKeys) :
+        keys_(keys),
+        numKeys_(numKeys),
+        checksum_(0)
+    {
+    }
+
+    /// Run the test once.
+    void operator ()()
+    {
+        map_.Clear();
+        for (unsigned i = 0; i < numKeys_; ++i)
+            map_[keys_[i]] = i;
+        checksum_ += map_.Size();
+    }
+
+    /// Map to refill.
+    Map map_;
+    /// Keys to insert.
+    const Key* keys_;
+    /// Number of keys.
+    unsigned numKeys_;
+    /// Checksum of the results.
+    unsigned checksum_;
+};
+
+/// Measure a test with HashMap and FlatHashMap, verify that both produced the same results and print the times per operation.
+template <template <class, class> class Test, class Key> void CompareMaps(const char* keyName, const char* testName,
+    const Key* keys, unsigned numKeys, unsigned operationsPerRun)
+{
+    unsigned repeats = Max(OPERATIONS_PER_TEST / operationsPerRun, 10U);
+
+    Test<HashMap<Key, unsigned>, Key> hashMapTest(keys, numKeys);
+    float hashMapUSec = MeasureUSec(hashMapTest, repeats);
+    Test<FlatHashMap<Key, unsigned>, Key> flatHashMapTest(keys, numKeys);
+    float flatHashMapUSec = MeasureUSec(flatHashMapTest, repeats);
+
+    if (hashMapTest.checksum_ != flatHashMapTest.checksum_)
+        ErrorExit(FormatLine("FlatHashMap result mismatch in %s test with %u %s keys", testName, numKeys, keyName));
+
+    float hashMapNSec = hashMapUSec * 1000.0f / operationsPerRun;
+    float flatHashMapNSec = flatHashMapUSec * 1000.0f / operationsPerRun;
+    PrintLine(FormatLine("%-10s %6u  %-7s  %10.2f  %14.2f  %7.2f", keyName, numKeys, testName, hashMapNSec, flatHashMapNSec,
+        hashMapNSec / flatHashMapNSec));
+}
+
+/// Run all tests with one key type. The key array holds twice the maximum map size, the second half for missed lookups.
+template <class Key> void CompareMaps(const char* keyName, const PODVector<Key>& keys, unsigned maxSize)
+{
+    for (unsigned i = 0; i < NUM_MAP_SIZES && mapSizes[i] <= maxSize; ++i)
+    {
+        unsigned size = mapSizes[i];
+        CompareMaps<MapInsertTest>(keyName, "insert", keys.Buffer(), size, size);
+        CompareMaps<MapLookupTest>(keyName, "lookup", keys.Buffer(), size, size * 2);
+        CompareMaps<MapRefillTest>(keyName, "refill", keys.Buffer(), size, size);
+    }
+}
+
+void RunHashMapBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned maxSize = GetArgument(arguments, 0, mapSizes[NUM_MAP_SIZES - 1]);
+    unsigned numKeys = mapSizes[NUM_MAP_SIZES - 1] * 2;
+    SetRandomSeed(1);
+
+    // String hash keys, as used by the event maps
+    PODVector<StringHash> hashKeys(numKeys);
+    for (unsigned i = 0; i < numKeys; ++i)
+        hashKeys[i] = StringHash("Key" + String(i));
+
+    // Pointer keys, as used by the render remapping maps. Use shuffled addresses of objects
+    PODVector<KeyObject> objects(numKeys);
+    PODVector<KeyObject*> pointerKeys(numKeys);
+    for (unsigned i = 0; i < numKeys; ++i)
+        pointerKeys[i] = &objects[i];
+    for (unsigned i = numKeys - 1; i > 0; --i)
+        Swap(pointerKeys[i], pointerKeys[((unsigned)Rand() * 32768 + (unsigned)Rand()) % (i + 1)]);
+
+    PrintLine("Time per operation in nanoseconds. Lookups include the same number of missing keys");
+    PrintLine("Key          Size  Test        HashMap     FlatHashMap  Speedup");
+    CompareMaps("StringHash", hashKeys, maxSize);
+    CompareMaps("Pointer", pointerKeys, maxSize);
+}
@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Network/Connection.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned short SERVER_PORT = 2346;
+static const unsigned NUM_TICKS = 60;
+static const unsigned CONNECT_TIMEOUT_MS = 30000;
+static const float TICK_TIME_STEP = 1.0f / 30.0f;
+
+/// Client in its own context, connected to the server in the same process over the loopback interface.
+class LoopbackClient : public RefCounted
+{
+public:
+    /// Construct and connect to the server.
+    LoopbackClient()
+    {
+        context_ = new Context();
+        context_->RegisterSubsystem(new FileSystem(context_));
+        context_->RegisterSubsystem(new ResourceCache(context_));
+        network_ = new Network(context_);
+        context_->RegisterSubsystem(network_);
+        RegisterSceneLibrary(context_);
+
+        scene_ = new Scene(context_);
+        if (!network_->Connect("127.0.0.1", SERVER_PORT, scene_))
+            ErrorExit("Could not connect to the loopback server");
+    }
+
+    /// Process received messages and send the client update.
+    void Update()
+    {
+        network_->Update(TICK_TIME_STEP);
+        network_->PostUpdate(TICK_TIME_STEP);
+    }
+
+    /// Context.
+    SharedPtr<Context> context_;
+    /// Network subsystem.
+    Network* network_;
+    /// Replicated scene.
+    SharedPtr<Scene> scene_;
+};
+
+/// Run the server and client network updates until all clients have loaded the scene.
+static void WaitForClients(Network* network, Scene* scene, Vector<SharedPtr<LoopbackClient> >& clients)
+{
+    Timer timer;
+    for (;;)
+    {
+        network->Update(TICK_TIME_STEP);
+        network->PostUpdate(TICK_TIME_STEP);
+        for (unsigned i = 0; i < clients.Size(); ++i)
+            clients[i]->Update();
+
+        Vector<SharedPtr<Connection> > connections = network->GetClientConnections();
+        unsigned numLoaded = 0;
+        for (unsigned i = 0; i < connections.Size(); ++i)
+        {
+            if (!connections[i]->GetScene())
+                connections[i]->SetScene(scene);
+            else if (connections[i]->IsSceneLoaded())
+                ++numLoaded;
+        }
+
+        if (numLoaded == clients.Size())
+            return;
+        if (timer.GetMSec(false) > CONNECT_TIMEOUT_MS)
+            ErrorExit("Timed out waiting for the clients to load the scene");
+
+        Time::Sleep(1);
+    }
+}
+
+void RunNetworkBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned maxClients = Max(GetArgument(arguments, 0, 64), 1U);
+    unsigned numNodes = Max(GetArgument(arguments, 1, 1000), 1U);
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+    Network* network = engine->GetSubsystem<Network>();
+    WorkQueue* queue = engine->GetSubsystem<WorkQueue>();
+    // Worker threads can be created only once, so an explicit count applies only when the engine did not create any
+    if (arguments.Size() > 2 && !queue->GetNumThreads())
+        queue->CreateThreads(GetArgument(arguments, 2, 0));
+
+    if (!network->StartServer(SERVER_PORT))
+        ErrorExit("Could not start the loopback server");
+
+    SetRandomSeed(1);
+    SharedPtr<Scene> scene(new Scene(context));
+    PODVector<Node*> nodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = scene->CreateChild("Node");
+        node->SetPosition(Vector3(Random(100.0f), 0.0f, Random(100.0f)));
+        nodes.Push(node);
+    }
+
+    PrintLine(FormatLine("Network: %u replicated nodes moving every tick, %u worker threads, average of %u ticks", numNodes,
+        queue->GetNumThreads(), NUM_TICKS));
+    PrintLine("Clients   Server tick ms   Per client us");
+
+    Vector<SharedPtr<LoopbackClient> > clients;
+    for (unsigned numClients = 1; numClients <= maxClients; numClients *= 2)
+    {
+        while (clients.Size() < numClients)
+            clients.Push(SharedPtr<LoopbackClient>(new LoopbackClient()));
+        WaitForClients(network, scene, clients);
+
+        long long tickUSec = 0;
+        for (unsigned i = 0; i <= NUM_TICKS; ++i)
+        {
+            for (unsigned j = 0; j < nodes.Size(); ++j)
+                nodes[j]->Translate(Vector3(Random(0.1f), 0.0f, Random(0.1f)));
+
+            network->Update(TICK_TIME_STEP);
+            HiresTimer timer;
+            network->PostUpdate(TICK_TIME_STEP);
+            // Skip the first tick as a warm-up
+            if (i)
+                tickUSec += timer.GetUSec(false);
+
+            for (unsigned j = 0; j < clients.Size(); ++j)
+                clients[j]->Update();
+        }
+
+        float tickMs = (float)tickUSec / (1000.0f * NUM_TICKS);
+        PrintLine(FormatLine("%7u   %14.3f   %13.1f", numClients, tickMs, tickMs * 1000.0f / numClients));
+    }
+
+    clients.Clear();
+    network->StopServer();
+}
@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/OcclusionBuffer.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned NUM_REPEATS = 20;
+static const unsigned NUM_BUILDINGS = 150;
+static const unsigned NUM_PROPS = 100;
+static const unsigned NUM_TEST_BOXES = 10000;
+static const unsigned MAX_COVERAGE_DIFFS_PER_MILLION = 1000;
+static const int bufferWidths[] = {256, 512, 1024};
+static const unsigned NUM_BUFFER_WIDTHS = sizeof(bufferWidths) / sizeof(bufferWidths[0]);
+
+/// Draw the occluders into an occlusion buffer and build its depth hierarchy.
+struct DrawOccludersTest
+{
+    /// Construct.
+    DrawOccludersTest(OcclusionBuffer* buffer, Camera* camera, const PODVector<StaticModel*>& occluders) :
+        buffer_(buffer),
+        camera_(camera),
+        occluders_(occluders)
+    {
+    }
+
+    /// Draw all occluders. Unlike the non-threaded path of View, the occluders are not tested against the buffer before
+    /// drawing, so that both rasterizers draw the same triangles. There is also no triangle limit.
+    void operator ()()
+    {
+        buffer_->SetView(camera_);
+        buffer_->SetMaxTriangles(M_MAX_UNSIGNED);
+        buffer_->Clear();
+        for (unsigned i = 0; i < occluders_.Size(); ++i)
+            occluders_[i]->DrawOcclusion(buffer_);
+        buffer_->DrawTriangles();
+        buffer_->BuildDepthHierarchy();
+    }
+
+    /// Occlusion buffer.
+    OcclusionBuffer* buffer_;
+    /// Camera to render from.
+    Camera* camera_;
+    /// Occluders.
+    const PODVector<StaticModel*>& occluders_;
+};
+
+/// Create a static model occluder.
+static StaticModel* CreateOccluder(Scene* scene, Model* model, const Vector3& position, const Quaternion& rotation,
+    const Vector3& scale)
+{
+    Node* node = scene->CreateChild("Occluder");
+    node->SetTransform(position, rotation, scale);
+    StaticModel* staticModel = node->CreateComponent<StaticModel>();
+    staticModel->SetModel(model);
+    staticModel->SetOccluder(true);
+    return staticModel;
+}
+
+/// Return a tiled occlusion buffer drawn with the given number of threads, including the main thread, and the average
+/// draw time in microseconds.
+static SharedPtr<OcclusionBuffer> DrawTiled(Context* context, unsigned numThreads, int width, Camera* camera,
+    const PODVector<StaticModel*>& occluders, float& usec)
+{
+    // Worker threads can only be created once, so use a new queue for each thread count. The buffer allocates its
+    // per-thread triangle bins according to the queue's thread count when its size is set
+    SharedPtr<WorkQueue> queue(new WorkQueue(context));
+    if (numThreads > 1)
+        queue->CreateThreads(numThreads - 1);
+    context->RegisterSubsystem(queue);
+
+    SharedPtr<OcclusionBuffer> buffer(new OcclusionBuffer(context));
+    buffer->SetSize(width, width * 9 / 16, true);
+    if (!buffer->IsThreaded())
+        ErrorExit("Could not enable threaded occlusion rendering");
+    DrawOccludersTest draw(buffer, camera, occluders);
+    usec = MeasureUSec(draw, NUM_REPEATS);
+    return buffer;
+}
+
+void RunOcclusionBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned maxThreads = Max(GetArgument(arguments, 0, GetNumLogicalCPUs()), 1U);
+
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+    ResourceCache* cache = engine->GetSubsystem<ResourceCache>();
+    Model* boxModel = cache->GetResource<Model>("Models/Box.mdl");
+    Model* cylinderModel = cache->GetResource<Model>("Models/Cylinder.mdl");
+    Model* coneModel = cache->GetResource<Model>("Models/Cone.mdl");
+    if (!boxModel || !cylinderModel || !coneModel)
+        ErrorExit("Could not load the box, cylinder and cone models");
+
+    // A street of buildings and props in front of the camera, some of them crossing the near plane
+    SetRandomSeed(1);
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->CreateComponent<Octree>();
+    PODVector<StaticModel*> occluders;
+    for (unsigned i = 0; i < NUM_BUILDINGS; ++i)
+    {
+        float side = (i & 1) ? 1.0f : -1.0f;
+        Vector3 size(Random(5.0f, 15.0f), Random(5.0f, 40.0f), Random(5.0f, 15.0f));
+        occluders.Push(CreateOccluder(scene, boxModel, Vector3(side * Random(8.0f, 60.0f), size.y_ * 0.5f,
+            Random(-5.0f, 250.0f)), Quaternion(0.0f, Random(-20.0f, 20.0f), 0.0f), size));
+    }
+    for (unsigned i = 0; i < NUM_PROPS; ++i)
+    {
+        Model* model = (i & 1) ? cylinderModel : coneModel;
+        occluders.Push(CreateOccluder(scene, model, Vector3(Random(-8.0f, 8.0f), 0.0f, Random(0.0f, 150.0f)),
+            Quaternion(0.0f, Random(360.0f), 0.0f), Vector3::ONE * Random(1.0f, 4.0f)));
+    }
+
+    Node* cameraNode = scene->CreateChild("Camera");
+    cameraNode->SetPosition(Vector3(0.0f, 2.0f, -10.0f));
+    cameraNode->SetRotation(Quaternion(5.0f, 10.0f, 0.0f));
+    Camera* camera = cameraNode->CreateComponent<Camera>();
+    camera->SetAspectRatio(16.0f / 9.0f);
+    camera->SetFarClip(300.0f);
+
+    // Boxes of varying size in the view frustum for the visibility tests
+    PODVector<BoundingBox> testBoxes(NUM_TEST_BOXES);
+    for (unsigned i = 0; i < NUM_TEST_BOXES; ++i)
+    {
+        Vector3 center = cameraNode->GetWorldTransform() * Vector3(Random(-60.0f, 60.0f), Random(-10.0f, 30.0f),
+            Random(1.0f, 250.0f));
+        Vector3 halfSize = Vector3::ONE * Random(0.2f, 4.0f);
+        testBoxes[i] = BoundingBox(center - halfSize, center + halfSize);
+    }
+
+    SharedPtr<WorkQueue> originalQueue(context->GetSubsystem<WorkQueue>());
+
+    PrintLine(FormatLine("Occlusion: %u buildings and %u props, 16:9 buffers, %u visibility test boxes, average of %u "
+        "repeats", NUM_BUILDINGS, NUM_PROPS, NUM_TEST_BOXES, NUM_REPEATS));
+
+    for (unsigned i = 0; i < NUM_BUFFER_WIDTHS; ++i)
+    {
+        int width = bufferWidths[i];
+        int height = width * 9 / 16;
+
+        SharedPtr<OcclusionBuffer> scanline(new OcclusionBuffer(context));
+        scanline->SetSize(width, height, false);
+        DrawOccludersTest draw(scanline, camera, occluders);
+        float scanlineUSec = MeasureUSec(draw, NUM_REPEATS);
+
+        float tiledUSec;
+        SharedPtr<OcclusionBuffer> tiled = DrawTiled(context, 1, width, camera, occluders, tiledUSec);
+
+        // Compare the coverage and depth of each pixel. The tiled rasterizer interpolates depth relative to the first vertex
+        // and the scanline rasterizer along the edges, so the depths differ slightly
+        const int* scanlineData = scanline->GetBuffer();
+        const int* tiledData = tiled->GetBuffer();
+        int clearValue = (int)OCCLUSION_Z_SCALE;
+        unsigned numPixels = (unsigned)(width * scanline->GetHeight());
+        unsigned covered = 0;
+        unsigned coverageDiffs = 0;
+        int maxCloser = 0;
+        int maxFarther = 0;
+        for (unsigned j = 0; j < numPixels; ++j)
+        {
+            bool scanlineCovered = scanlineData[j] < clearValue;
+            bool tiledCovered = tiledData[j] < clearValue;
+            if (scanlineCovered != tiledCovered)
+                ++coverageDiffs;
+            else if (scanlineCovered)
+            {
+                ++covered;
+                maxCloser = Max(maxCloser, scanlineData[j] - tiledData[j]);
+                maxFarther = Max(maxFarther, tiledData[j] - scanlineData[j]);
+            }
+        }
+
+        // The edges of the two rasterizers may round differently on a few pixels, but more indicates a broken rasterizer
+        if ((unsigned long long)coverageDiffs * 1000000 > (unsigned long long)numPixels * MAX_COVERAGE_DIFFS_PER_MILLION)
+            ErrorExit(FormatLine("Coverage differs on %u of %u pixels at %dx%d", coverageDiffs, numPixels, width,
+                scanline->GetHeight()));
+
+        unsigned visibilityDiffs = 0;
+        unsigned visible = 0;
+        for (unsigned j = 0; j < NUM_TEST_BOXES; ++j)
+        {
+            bool scanlineVisible = scanline->IsVisible(testBoxes[j]);
+            if (scanlineVisible != tiled->IsVisible(testBoxes[j]))
+                ++visibilityDiffs;
+            if (scanlineVisible)
+                ++visible;
+        }
+
+        PrintLine("");
+        PrintLine(FormatLine("%dx%d: %u triangles, %u covered pixels", width, scanline->GetHeight(),
+            scanline->GetNumTriangles(), covered));
+        PrintLine(FormatLine("Coverage differs on %u pixels. Tiled depth up to %d units closer and %d units farther",
+            coverageDiffs, maxCloser, maxFarther));
+        PrintLine(FormatLine("Visibility agrees on %.2f%% of boxes (%u of %u visible with the scanline buffer)",
+            100.0f * (NUM_TEST_BOXES - visibilityDiffs) / NUM_TEST_BOXES, visible, NUM_TEST_BOXES));
+        PrintLine("Rasterizer   Threads   Draw ms   Speedup");
+        PrintLine(FormatLine("Scanline     %7u   %7.3f   %7.2f", 1, scanlineUSec / 1000.0f, 1.0f));
+        PrintLine(FormatLine("Tiled        %7u   %7.3f   %7.2f", 1, tiledUSec / 1000.0f, scanlineUSec / tiledUSec));
+
+        for (unsigned numThreads = 2; numThreads <= maxThreads; ++numThreads)
+        {
+            DrawTiled(context, numThreads, width, camera, occluders, tiledUSec);
+            PrintLine(FormatLine("Tiled        %7u   %7.3f   %7.2f", numThreads, tiledUSec / 1000.0f,
+                scanlineUSec / tiledUSec));
+        }
+    }
+
+    context->RegisterSubsystem(originalQueue);
+}
@@ -0,0 +1,323 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned NUM_OBJECTS = 5000;
+static const unsigned NUM_REPEATS = 5;
+static const unsigned NUM_KERNEL_RAYS = 2000;
+static const float SCENE_SIZE = 200.0f;
+static const float MAX_DISTANCE = 500.0f;
+static const float DISTANCE_EPSILON = 1.0e-4f;
+static const char* modelNames[] = {"Box", "Sphere", "Cylinder", "Cone", "Pyramid", "Torus", "Mushroom", "TeaPot"};
+static const unsigned NUM_MODELS = sizeof(modelNames) / sizeof(modelNames[0]);
+static const char* indexNames[] = {"Octree", "AABB tree"};
+static const char* levelNames[] = {"AABB", "OBB", "Triangle"};
+
+/// Cast each ray of a batch separately with the per-ray closest hit query.
+struct PerRayRaycastTest
+{
+    /// Construct.
+    PerRayRaycastTest(Octree* octree, const PODVector<Ray>& rays, RayQueryLevel level) :
+        octree_(octree),
+        rays_(rays),
+        level_(level)
+    {
+    }
+
+    /// Cast all rays.
+    void operator ()()
+    {
+        results_.Resize(rays_.Size());
+        for (unsigned i = 0; i < rays_.Size(); ++i)
+        {
+            RayOctreeQuery query(rayResult_, rays_[i], level_, MAX_DISTANCE, DRAWABLE_GEOMETRY);
+            octree_->RaycastSingle(query);
+            if (rayResult_.Size())
+                results_[i] = rayResult_[0];
+            else
+            {
+                results_[i].drawable_ = 0;
+                results_[i].distance_ = M_INFINITY;
+            }
+        }
+    }
+
+    /// Octree.
+    Octree* octree_;
+    /// Rays.
+    const PODVector<Ray>& rays_;
+    /// Query level.
+    RayQueryLevel level_;
+    /// Result of one ray.
+    PODVector<RayQueryResult> rayResult_;
+    /// Closest hit of each ray.
+    PODVector<RayQueryResult> results_;
+};
+
+/// Cast a batch of rays with the batched closest hit query.
+struct BatchedRaycastTest
+{
+    /// Construct.
+    BatchedRaycastTest(Octree* octree, const PODVector<Ray>& rays, RayQueryLevel level) :
+        octree_(octree),
+        rays_(rays),
+        level_(level)
+    {
+    }
+
+    /// Cast all rays.
+    void operator ()()
+    {
+        octree_->RaycastSingle(rays_, results_, level_, MAX_DISTANCE, DRAWABLE_GEOMETRY);
+    }
+
+    /// Octree.
+    Octree* octree_;
+    /// Rays.
+    const PODVector<Ray>& rays_;
+    /// Query level.
+    RayQueryLevel level_;
+    /// Closest hit of each ray.
+    PODVector<RayQueryResult> results_;
+};
+
+/// Return the hit distance to a geometry by testing one triangle at a time, as Ray::HitDistance() did before the four
+/// triangle kernel.
+static float GetScalarHitDistance(const Ray& ray, const Geometry* geometry)
+{
+    const unsigned char* vertexData;
+    const unsigned char* indexData;
+    unsigned vertexSize;
+    unsigned indexSize;
+    const PODVector<VertexElement>* elements;
+    geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+
+    float nearest = M_INFINITY;
+    if (indexData)
+    {
+        unsigned start = geometry->GetIndexStart();
+        unsigned end = start + geometry->GetIndexCount();
+        for (unsigned i = start; i + 2 < end; i += 3)
+        {
+            unsigned indices[3];
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                indices[j] = indexSize == sizeof(unsigned short) ? ((const unsigned short*)indexData)[i + j] :
+                    ((const unsigned*)indexData)[i + j];
+            }
+            nearest = Min(nearest, ray.HitDistance(*(const Vector3*)(vertexData + indices[0] * vertexSize),
+                *(const Vector3*)(vertexData + indices[1] * vertexSize), *(const Vector3*)(vertexData + indices[2] * vertexSize)));
+        }
+    }
+    else
+    {
+        unsigned start = geometry->GetVertexStart();
+        unsigned end = start + geometry->GetVertexCount();
+        for (unsigned i = start; i + 2 < end; i += 3)
+        {
+            nearest = Min(nearest, ray.HitDistance(*(const Vector3*)(vertexData + i * vertexSize),
+                *(const Vector3*)(vertexData + (i + 1) * vertexSize), *(const Vector3*)(vertexData + (i + 2) * vertexSize)));
+        }
+    }
+
+    return nearest;
+}
+
+/// Test rays against a geometry with the four triangle kernel or one triangle at a time.
+struct TriangleKernelTest
+{
+    /// Construct.
+    TriangleKernelTest(const Geometry* geometry, const PODVector<Ray>& rays, bool scalar) :
+        geometry_(geometry),
+        rays_(rays),
+        scalar_(scalar)
+    {
+    }
+
+    /// Test all rays.
+    void operator ()()
+    {
+        distances_.Resize(rays_.Size());
+        for (unsigned i = 0; i < rays_.Size(); ++i)
+            distances_[i] = scalar_ ? GetScalarHitDistance(rays_[i], geometry_) : geometry_->GetHitDistance(rays_[i]);
+    }
+
+    /// Geometry.
+    const Geometry* geometry_;
+    /// Rays in the geometry's space.
+    const PODVector<Ray>& rays_;
+    /// Whether to test one triangle at a time.
+    bool scalar_;
+    /// Hit distance of each ray.
+    PODVector<float> distances_;
+};
+
+/// Return whether two hit distances agree. The four triangle kernel may differ from the scalar calculation in the last bit.
+static bool DistancesMatch(float a, float b)
+{
+    if (a == M_INFINITY || b == M_INFINITY)
+        return a == b;
+    return Abs(a - b) <= DISTANCE_EPSILON * Max(1.0f, Abs(a));
+}
+
+/// Return a random ray starting above the scene and pointing down into it.
+static Ray GetRandomRay()
+{
+    Vector3 origin(Random(-SCENE_SIZE, SCENE_SIZE), Random(20.0f, 60.0f), Random(-SCENE_SIZE, SCENE_SIZE));
+    Vector3 target(Random(-SCENE_SIZE, SCENE_SIZE), 0.0f, Random(-SCENE_SIZE, SCENE_SIZE));
+    // Aim three quarters of the rays steeply down so that most hit something at triangle level
+    if (Rand() & 3)
+        target = Vector3(origin.x_ + Random(-30.0f, 30.0f), 0.0f, origin.z_ + Random(-30.0f, 30.0f));
+    return Ray(origin, target - origin);
+}
+
+void RunRaycastBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned numRays = Max(GetArgument(arguments, 0, 4000), 1U);
+
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+    ResourceCache* cache = engine->GetSubsystem<ResourceCache>();
+    Model* models[NUM_MODELS];
+    for (unsigned i = 0; i < NUM_MODELS; ++i)
+    {
+        models[i] = cache->GetResource<Model>(String("Models/") + modelNames[i] + ".mdl");
+        if (!models[i])
+            ErrorExit(String("Could not load model ") + modelNames[i]);
+    }
+
+    SetRandomSeed(1);
+    SharedPtr<Scene> scene(new Scene(context));
+    Octree* octree = scene->CreateComponent<Octree>();
+    for (unsigned i = 0; i < NUM_OBJECTS; ++i)
+    {
+        Node* node = scene->CreateChild("Object");
+        node->SetTransform(Vector3(Random(-SCENE_SIZE, SCENE_SIZE), Random(0.0f, 10.0f), Random(-SCENE_SIZE, SCENE_SIZE)),
+            Quaternion(Random(360.0f), Random(360.0f), Random(360.0f)), Random(0.5f, 3.0f));
+        node->CreateComponent<StaticModel>()->SetModel(models[Rand() % NUM_MODELS]);
+    }
+
+    PODVector<Ray> rays(numRays);
+    for (unsigned i = 0; i < numRays; ++i)
+        rays[i] = GetRandomRay();
+
+    FrameInfo frame;
+    frame.frameNumber_ = 0;
+    frame.timeStep_ = 0.0f;
+    frame.camera_ = 0;
+
+    PrintLine(FormatLine("Raycast: %u models of %u kinds, %u closest hit rays, average of %u repeats", NUM_OBJECTS,
+        NUM_MODELS, numRays, NUM_REPEATS));
+    PrintLine("Index       Level      Hits   Per-ray ms   Batched ms   Speedup");
+
+    for (unsigned i = SPATIAL_OCTREE; i <= SPATIAL_AABBTREE; ++i)
+    {
+        octree->SetSpatialIndex((SpatialIndex)i);
+        octree->Update(frame);
+
+        for (unsigned j = RAY_AABB; j <= RAY_TRIANGLE; ++j)
+        {
+            if (j == RAY_OBB)
+                continue;
+
+            PerRayRaycastTest perRay(octree, rays, (RayQueryLevel)j);
+            float perRayUSec = MeasureUSec(perRay, NUM_REPEATS);
+            BatchedRaycastTest batched(octree, rays, (RayQueryLevel)j);
+            float batchedUSec = MeasureUSec(batched, NUM_REPEATS);
+
+            // The batch must find the same closest hits. Equally distant hits on different drawables may go either way
+            unsigned hits = 0;
+            for (unsigned k = 0; k < numRays; ++k)
+            {
+                const RayQueryResult& expected = perRay.results_[k];
+                const RayQueryResult& actual = batched.results_[k];
+                if (!DistancesMatch(expected.distance_, actual.distance_) || (expected.drawable_ != actual.drawable_ &&
+                    expected.distance_ != actual.distance_))
+                {
+                    ErrorExit(FormatLine("%s %s ray %u: batched hit at %f, per-ray hit at %f", indexNames[i], levelNames[j], k,
+                        actual.distance_, expected.distance_));
+                }
+                if (expected.drawable_)
+                    ++hits;
+            }
+
+            PrintLine(FormatLine("%-9s   %-8s   %4u   %10.3f   %10.3f   %6.2fx", indexNames[i], levelNames[j], hits,
+                perRayUSec / 1000.0f, batchedUSec / 1000.0f, perRayUSec / batchedUSec));
+        }
+    }
+
+    PrintLine("");
+    PrintLine(FormatLine("Triangle kernel: %u rays per model against LOD 0 of the first geometry", NUM_KERNEL_RAYS));
+    PrintLine("Model       Triangles   Hits   One at a time ms   Four at a time ms   Speedup");
+
+    for (unsigned i = 0; i < NUM_MODELS; ++i)
+    {
+        const Geometry* geometry = models[i]->GetGeometry(0, 0);
+        const BoundingBox& box = models[i]->GetBoundingBox();
+        Vector3 halfSize = box.HalfSize();
+
+        // Rays from outside the bounding box towards random points inside it
+        PODVector<Ray> modelRays(NUM_KERNEL_RAYS);
+        for (unsigned j = 0; j < NUM_KERNEL_RAYS; ++j)
+        {
+            Vector3 direction(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f));
+            Vector3 target = box.Center() + Vector3(Random(-halfSize.x_, halfSize.x_), Random(-halfSize.y_, halfSize.y_),
+                Random(-halfSize.z_, halfSize.z_));
+            modelRays[j] = Ray(target - direction.Normalized() * box.Size().Length(), direction);
+        }
+
+        TriangleKernelTest scalar(geometry, modelRays, true);
+        float scalarUSec = MeasureUSec(scalar, NUM_REPEATS);
+        TriangleKernelTest kernel(geometry, modelRays, false);
+        float kernelUSec = MeasureUSec(kernel, NUM_REPEATS);
+
+        unsigned hits = 0;
+        for (unsigned j = 0; j < NUM_KERNEL_RAYS; ++j)
+        {
+            if (!DistancesMatch(scalar.distances_[j], kernel.distances_[j]))
+            {
+                ErrorExit(FormatLine("%s ray %u: four at a time hit at %f, one at a time hit at %f", modelNames[i], j,
+                    kernel.distances_[j], scalar.distances_[j]));
+            }
+            if (kernel.distances_[j] != M_INFINITY)
+                ++hits;
+        }
+
+        unsigned numTriangles = (geometry->GetIndexCount() ? geometry->GetIndexCount() : geometry->GetVertexCount()) / 3;
+        PrintLine(FormatLine("%-9s   %9u   %4u   %16.3f   %17.3f   %6.2fx", modelNames[i], numTriangles, hits,
+            scalarUSec / 1000.0f, kernelUSec / 1000.0f, scalarUSec / kernelUSec));
+    }
+}
@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned NUM_REPEATS = 5;
+static const unsigned CHILDREN_PER_GROUP = 9;
+static const char* formatNames[] = {"Binary", "Indexed"};
+
+/// Load a scene from saved data.
+struct LoadSceneTest
+{
+    /// Construct.
+    LoadSceneTest(Scene* scene, const VectorBuffer& data) :
+        scene_(scene),
+        data_(data)
+    {
+    }
+
+    /// Load the scene.
+    void operator ()()
+    {
+        MemoryBuffer buffer(data_.GetData(), data_.GetSize());
+        if (!scene_->Load(buffer))
+            ErrorExit("Could not load the scene");
+    }
+
+    /// Scene.
+    Scene* scene_;
+    /// Saved scene data.
+    const VectorBuffer& data_;
+};
+
+/// Save a scene in the binary or indexed format.
+static void SaveScene(Scene* scene, bool indexed, VectorBuffer& dest)
+{
+    dest.Clear();
+    if (!(indexed ? scene->SaveIndexed(dest) : scene->Save(dest)))
+        ErrorExit("Could not save the scene");
+}
+
+/// Load saved data into a new scene and return it saved again in the binary format.
+static void ResaveScene(Context* context, const VectorBuffer& data, VectorBuffer& dest)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    LoadSceneTest load(scene, data);
+    load();
+    SaveScene(scene, false, dest);
+}
+
+/// Return whether two saved scenes are identical.
+static bool CompareSavedScenes(const VectorBuffer& lhs, const VectorBuffer& rhs)
+{
+    return lhs.GetSize() == rhs.GetSize() && (!lhs.GetSize() || !memcmp(lhs.GetData(), rhs.GetData(), lhs.GetSize()));
+}
+
+void RunSceneLoadBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned numNodes = Max(GetArgument(arguments, 0, 20000), CHILDREN_PER_GROUP + 1);
+
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+    Model* model = engine->GetSubsystem<ResourceCache>()->GetResource<Model>("Models/Box.mdl");
+    if (!model)
+        ErrorExit("Could not load the box model");
+
+    // Groups of a light and static models with varying transforms and names
+    SetRandomSeed(1);
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->CreateComponent<Octree>();
+    unsigned numGroups = numNodes / (CHILDREN_PER_GROUP + 1);
+    for (unsigned i = 0; i < numGroups; ++i)
+    {
+        Node* group = scene->CreateChild("Group" + String(i));
+        group->SetPosition(Vector3(Random(-500.0f, 500.0f), 0.0f, Random(-500.0f, 500.0f)));
+        group->SetRotation(Quaternion(0.0f, Random(360.0f), 0.0f));
+        group->CreateComponent<Light>()->SetRange(Random(5.0f, 20.0f));
+
+        for (unsigned j = 0; j < CHILDREN_PER_GROUP; ++j)
+        {
+            Node* child = group->CreateChild("Box" + String(j));
+            child->SetPosition(Vector3(Random(-5.0f, 5.0f), Random(0.0f, 5.0f), Random(-5.0f, 5.0f)));
+            child->SetScale(Random(0.5f, 2.0f));
+            child->CreateComponent<StaticModel>()->SetModel(model);
+        }
+    }
+
+    VectorBuffer saved[2];
+    SaveScene(scene, false, saved[0]);
+    SaveScene(scene, true, saved[1]);
+
+    PrintLine(FormatLine("Scene load: %u nodes in groups of a light and %u static models, average of %u loads",
+        numGroups * (CHILDREN_PER_GROUP + 1), CHILDREN_PER_GROUP, NUM_REPEATS));
+    PrintLine("Format    Size KB   Load ms");
+
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        // Both formats must load into the same scene
+        VectorBuffer resaved;
+        ResaveScene(context, saved[i], resaved);
+        if (!CompareSavedScenes(resaved, saved[0]))
+            ErrorExit(String(formatNames[i]) + " scene did not load identically");
+
+        SharedPtr<Scene> loadScene(new Scene(context));
+        LoadSceneTest load(loadScene, saved[i]);
+        float loadUSec = MeasureUSec(load, NUM_REPEATS);
+        PrintLine(FormatLine("%-7s   %7.1f   %7.3f", formatNames[i], saved[i].GetSize() / 1024.0f, loadUSec / 1000.0f));
+    }
+
+    // In a context where only the scene library is registered, the drawable components are unknown. Their attribute
+    // data must survive loading from either format
+    SharedPtr<Context> sceneContext(new Context());
+    RegisterSceneLibrary(sceneContext);
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        VectorBuffer resaved;
+        ResaveScene(sceneContext, saved[i], resaved);
+        if (!CompareSavedScenes(resaved, saved[0]))
+            ErrorExit("Unknown components lost attribute data when loaded from the " + String(formatNames[i]).ToLower() + " format");
+    }
+    PrintLine("Unknown components keep their attribute data in both formats");
+}
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/ParallelFor.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/Animation.h>
+#include <Urho3D/Graphics/AnimationState.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned NUM_FRAMES = 50;
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+
+/// Parallel loop body for skinning animated models, as View updates the geometries.
+struct SkinModelsLoop
+{
+    /// Construct.
+    SkinModelsLoop(const FrameInfo& frame) :
+        frame_(frame)
+    {
+    }
+
+    /// Update the skinning of a range of models.
+    void operator ()(AnimatedModel** start, AnimatedModel** end, unsigned threadIndex)
+    {
+        while (start != end)
+            (*start++)->UpdateGeometry(frame_);
+    }
+
+    /// Frame info.
+    const FrameInfo& frame_;
+};
+
+/// Skin matrix multiply alone, with the bone world transforms already up to date, to show its share of the skinning time.
+struct SkinMultiplyTest
+{
+    /// Construct.
+    SkinMultiplyTest(const PODVector<AnimatedModel*>& models) :
+        models_(models)
+    {
+    }
+
+    /// Multiply the skin matrices of all models.
+    void operator ()()
+    {
+        for (unsigned i = 0; i < models_.Size(); ++i)
+        {
+            const Vector<Bone>& bones = models_[i]->GetSkeleton().GetBones();
+            skinMatrices_.Resize(bones.Size());
+            for (unsigned j = 0; j < bones.Size(); ++j)
+                skinMatrices_[j] = bones[j].node_->GetWorldTransform() * bones[j].offsetMatrix_;
+        }
+    }
+
+    /// Models.
+    const PODVector<AnimatedModel*>& models_;
+    /// Skin matrices of one model.
+    PODVector<Matrix3x4> skinMatrices_;
+};
+
+void RunSkinningBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned numCharacters = Max(GetArgument(arguments, 0, 1000), 1U);
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+    ResourceCache* cache = engine->GetSubsystem<ResourceCache>();
+    WorkQueue* queue = engine->GetSubsystem<WorkQueue>();
+
+    Model* model = cache->GetResource<Model>("Models/Jack.mdl");
+    Animation* animation = cache->GetResource<Animation>("Models/Jack_Walk.ani");
+    if (!model || !animation)
+        ErrorExit("Could not load the character model and animation");
+
+    unsigned numBones = model->GetSkeleton().GetNumBones();
+    PrintLine(FormatLine("Skinning: %u characters with %u bones, %u worker threads, average of %u frames", numCharacters,
+        numBones, queue->GetNumThreads(), NUM_FRAMES));
+
+    SetRandomSeed(1);
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->CreateComponent<Octree>();
+    PODVector<AnimatedModel*> models;
+    unsigned rowLength = (unsigned)sqrtf((float)numCharacters) + 1;
+    for (unsigned i = 0; i < numCharacters; ++i)
+    {
+        Node* node = scene->CreateChild("Character");
+        node->SetPosition(Vector3((float)(i % rowLength) * 2.0f, 0.0f, (float)(i / rowLength) * 2.0f));
+        AnimatedModel* animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+        AnimationState* state = animatedModel->AddAnimationState(animation);
+        state->SetWeight(1.0f);
+        state->SetLooped(true);
+        state->SetTime(Random(animation->GetLength()));
+        models.Push(animatedModel);
+    }
+
+    FrameInfo frame;
+    frame.frameNumber_ = 0;
+    frame.timeStep_ = FRAME_TIME_STEP;
+    frame.camera_ = 0;
+    SkinModelsLoop loop(frame);
+    float animationUSec = 0.0f;
+    float skinningUSec = 0.0f;
+
+    for (unsigned i = 0; i <= NUM_FRAMES; ++i)
+    {
+        ++frame.frameNumber_;
+
+        HiresTimer animationTimer;
+        for (unsigned j = 0; j < models.Size(); ++j)
+        {
+            models[j]->GetAnimationStates()[0]->AddTime(FRAME_TIME_STEP);
+            models[j]->Update(frame);
+        }
+        long long animationTime = animationTimer.GetUSec(false);
+
+        HiresTimer skinningTimer;
+        ParallelFor(queue, models.Buffer(), models.Buffer() + models.Size(), loop);
+        long long skinningTime = skinningTimer.GetUSec(false);
+
+        // Skip the first frame as a warm-up
+        if (i)
+        {
+            animationUSec += (float)animationTime / NUM_FRAMES;
+            skinningUSec += (float)skinningTime / NUM_FRAMES;
+        }
+    }
+
+    SkinMultiplyTest multiplyTest(models);
+    float multiplyUSec = MeasureUSec(multiplyTest, NUM_FRAMES);
+
+    PrintLine(FormatLine("Character update per frame: animation %.3f ms, skinning %.3f ms (%.1f ns per bone)",
+        animationUSec / 1000.0f, skinningUSec / 1000.0f, skinningUSec * 1000.0f / (numCharacters * numBones)));
+    PrintLine(FormatLine("Skin matrix multiply alone: %.3f ms (%.1f ns per bone)", multiplyUSec / 1000.0f,
+        multiplyUSec * 1000.0f / (numCharacters * numBones)));
+}
@@ -0,0 +1,355 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+static const unsigned NUM_PHYSICS_OBJECTS = 1000;
+static const unsigned NUM_MUSHROOMS = 50;
+static const unsigned NUM_SETTLE_FRAMES = 600;
+static const unsigned NUM_RAYS_PER_AXIS = 8;
+static const int NUM_TERRAIN_PATCHES_PER_AXIS = 32;
+static const unsigned NUM_LONG_OBJECTS = 1000;
+static const unsigned NUM_PROPS = 5000;
+static const unsigned NUM_MOVING_PROPS = 500;
+static const char* indexNames[] = {"Octree", "AABB tree"};
+
+/// Spatial index test content.
+struct SpatialIndexContent
+{
+    /// Construct.
+    SpatialIndexContent() :
+        rotateNodes_(false)
+    {
+    }
+
+    /// Name.
+    String name_;
+    /// Scene.
+    SharedPtr<Scene> scene_;
+    /// Octree.
+    Octree* octree_;
+    /// Camera node.
+    Node* cameraNode_;
+    /// Moving nodes.
+    PODVector<Node*> nodes_;
+    /// Recorded node positions, one set per frame after the initial set.
+    PODVector<Vector3> positions_;
+    /// Recorded node rotations, one set per frame after the initial set.
+    PODVector<Quaternion> rotations_;
+    /// Whether all nodes rotate each frame instead of replaying the recorded transforms.
+    bool rotateNodes_;
+};
+
+/// Create the scene, octree and camera of spatial index test content.
+static void CreateSpatialIndexScene(Context* context, SpatialIndexContent& content, const Vector3& cameraPosition)
+{
+    content.scene_ = new Scene(context);
+    content.octree_ = content.scene_->CreateComponent<Octree>();
+    content.cameraNode_ = content.scene_->CreateChild("Camera");
+    content.cameraNode_->SetPosition(cameraPosition);
+    content.cameraNode_->CreateComponent<Camera>()->SetFarClip(300.0f);
+}
+
+/// Create a static model node.
+static Node* CreateObject(Scene* scene, Model* model, const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+{
+    Node* node = scene->CreateChild("Object");
+    node->SetTransform(position, rotation, scale);
+    node->CreateComponent<StaticModel>()->SetModel(model);
+    return node;
+}
+
+/// Create the HugeObjectCount sample grid of rotating boxes, with the sample's camera.
+static void CreateGridContent(Context* context, SpatialIndexContent& content, Model* boxModel)
+{
+    content.name_ = "HugeObjectCount: 62500 boxes rotating each frame";
+    content.rotateNodes_ = true;
+    CreateSpatialIndexScene(context, content, Vector3(0.0f, 10.0f, -100.0f));
+    for (int y = -125; y < 125; ++y)
+    {
+        for (int x = -125; x < 125; ++x)
+        {
+            Node* node = CreateObject(content.scene_, boxModel, Vector3(x * 0.3f, 0.0f, y * 0.3f), Quaternion::IDENTITY,
+                Vector3(0.25f, 0.25f, 0.25f));
+            content.nodes_.Push(node);
+            content.positions_.Push(node->GetPosition());
+            content.rotations_.Push(node->GetRotation());
+        }
+    }
+}
+
+/// Create the PhysicsStressTest sample floor, mushrooms and falling boxes, with the sample's camera. Simulate the
+/// physics and record the box transforms, so that both indices are measured with the same movement and without the
+/// physics simulation cost.
+static void CreatePhysicsContent(Context* context, SpatialIndexContent& content, Model* boxModel, Model* mushroomModel,
+    unsigned numFrames)
+{
+    content.name_ = FormatLine("PhysicsStressTest: %u falling boxes, %u mushrooms, after %u physics frames",
+        NUM_PHYSICS_OBJECTS, NUM_MUSHROOMS, NUM_SETTLE_FRAMES);
+    CreateSpatialIndexScene(context, content, Vector3(0.0f, 3.0f, -20.0f));
+    content.scene_->CreateComponent<PhysicsWorld>();
+
+    Node* floorNode = CreateObject(content.scene_, boxModel, Vector3(0.0f, -0.5f, 0.0f), Quaternion::IDENTITY,
+        Vector3(500.0f, 1.0f, 500.0f));
+    floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    SetRandomSeed(1);
+    for (unsigned i = 0; i < NUM_MUSHROOMS; ++i)
+    {
+        Node* node = CreateObject(content.scene_, mushroomModel, Vector3(Random(400.0f) - 200.0f, 0.0f,
+            Random(400.0f) - 200.0f), Quaternion(0.0f, Random(360.0f), 0.0f), Vector3::ONE * (5.0f + Random(5.0f)));
+        node->CreateComponent<RigidBody>();
+        node->CreateComponent<CollisionShape>()->SetTriangleMesh(mushroomModel);
+    }
+
+    for (unsigned i = 0; i < NUM_PHYSICS_OBJECTS; ++i)
+    {
+        Node* node = CreateObject(content.scene_, boxModel, Vector3(0.0f, i * 2.0f + 100.0f, 0.0f), Quaternion::IDENTITY,
+            Vector3::ONE);
+        RigidBody* body = node->CreateComponent<RigidBody>();
+        body->SetMass(1.0f);
+        body->SetFriction(1.0f);
+        body->SetCollisionEventMode(COLLISION_NEVER);
+        node->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+        content.nodes_.Push(node);
+    }
+
+    // Let the lowest boxes land and pile up, then record the frames to replay
+    for (unsigned i = 0; i < NUM_SETTLE_FRAMES; ++i)
+        content.scene_->Update(FRAME_TIME_STEP);
+    for (unsigned i = 0; i <= numFrames; ++i)
+    {
+        if (i)
+            content.scene_->Update(FRAME_TIME_STEP);
+        for (unsigned j = 0; j < content.nodes_.Size(); ++j)
+        {
+            content.positions_.Push(content.nodes_[j]->GetPosition());
+            content.rotations_.Push(content.nodes_[j]->GetRotation());
+        }
+    }
+}
+
+/// Create a scene of terrain patches, long objects such as roads and fences in random directions, and small props, some
+/// of which move each frame. The large and long objects straddle octant boundaries, so the octree holds them high up.
+static void CreateLargeObjectContent(Context* context, SpatialIndexContent& content, Model* boxModel, unsigned numFrames)
+{
+    content.name_ = FormatLine("Large objects: %d terrain patches, %u long objects, %u props of which %u move each frame",
+        NUM_TERRAIN_PATCHES_PER_AXIS * NUM_TERRAIN_PATCHES_PER_AXIS, NUM_LONG_OBJECTS, NUM_PROPS, NUM_MOVING_PROPS);
+    CreateSpatialIndexScene(context, content, Vector3(0.0f, 30.0f, -200.0f));
+
+    float patchSize = 1920.0f / NUM_TERRAIN_PATCHES_PER_AXIS;
+    for (int y = 0; y < NUM_TERRAIN_PATCHES_PER_AXIS; ++y)
+    {
+        for (int x = 0; x < NUM_TERRAIN_PATCHES_PER_AXIS; ++x)
+        {
+            CreateObject(content.scene_, boxModel, Vector3((x + 0.5f) * patchSize - 960.0f, -0.5f, (y + 0.5f) * patchSize -
+                960.0f), Quaternion::IDENTITY, Vector3(patchSize, 1.0f, patchSize));
+        }
+    }
+
+    SetRandomSeed(1);
+    for (unsigned i = 0; i < NUM_LONG_OBJECTS; ++i)
+    {
+        CreateObject(content.scene_, boxModel, Vector3(Random(-800.0f, 800.0f), 0.5f, Random(-800.0f, 800.0f)),
+            Quaternion(0.0f, Random(360.0f), 0.0f), Vector3(Random(50.0f, 300.0f), 1.0f, 2.0f));
+    }
+
+    for (unsigned i = 0; i < NUM_PROPS; ++i)
+    {
+        Node* node = CreateObject(content.scene_, boxModel, Vector3(Random(-900.0f, 900.0f), 1.0f, Random(-900.0f, 900.0f)),
+            Quaternion(0.0f, Random(360.0f), 0.0f), Vector3::ONE);
+        if (i < NUM_MOVING_PROPS)
+            content.nodes_.Push(node);
+    }
+
+    // Record the props driving along their facing direction
+    for (unsigned i = 0; i <= numFrames; ++i)
+    {
+        for (unsigned j = 0; j < content.nodes_.Size(); ++j)
+        {
+            Node* node = content.nodes_[j];
+            content.positions_.Push(node->GetPosition() + node->GetRotation() * Vector3::FORWARD * (float)i * 0.5f);
+            content.rotations_.Push(node->GetRotation());
+        }
+    }
+}
+
+/// Set the node transforms of a frame.
+static void SetFrameTransforms(SpatialIndexContent& content, unsigned frame)
+{
+    if (content.rotateNodes_)
+    {
+        // As in the HugeObjectCount sample, which rotates every box each frame
+        if (!frame)
+        {
+            for (unsigned i = 0; i < content.nodes_.Size(); ++i)
+                content.nodes_[i]->SetTransform(content.positions_[i], content.rotations_[i]);
+        }
+        else
+        {
+            Quaternion rotation(15.0f * FRAME_TIME_STEP, Vector3::FORWARD);
+            for (unsigned i = 0; i < content.nodes_.Size(); ++i)
+                content.nodes_[i]->Rotate(rotation);
+        }
+    }
+    else
+    {
+        unsigned offset = frame * content.nodes_.Size();
+        for (unsigned i = 0; i < content.nodes_.Size(); ++i)
+            content.nodes_[i]->SetTransform(content.positions_[offset + i], content.rotations_[offset + i]);
+    }
+}
+
+/// Run frames with the given spatial index. Return the average octree update, frustum query and raycast times in
+/// microseconds, and order independent checksums of the query and raycast results.
+static void RunSpatialIndexFrames(SpatialIndexContent& content, SpatialIndex index, unsigned numFrames, float& updateUSec,
+    float& queryUSec, float& raycastUSec, unsigned& queryChecksum, unsigned& raycastChecksum)
+{
+    Camera* camera = content.cameraNode_->GetComponent<Camera>();
+    FrameInfo frame;
+    frame.frameNumber_ = 0;
+    frame.timeStep_ = FRAME_TIME_STEP;
+    frame.camera_ = camera;
+
+    content.octree_->SetSpatialIndex(index);
+    SetFrameTransforms(content, 0);
+    content.octree_->Update(frame);
+
+    PODVector<Drawable*> result;
+    PODVector<RayQueryResult> rayResult;
+    long long updateTime = 0;
+    long long queryTime = 0;
+    long long raycastTime = 0;
+    queryChecksum = 0;
+    raycastChecksum = 0;
+
+    for (unsigned i = 1; i <= numFrames; ++i)
+    {
+        ++frame.frameNumber_;
+        SetFrameTransforms(content, i);
+
+        HiresTimer updateTimer;
+        content.octree_->Update(frame);
+        updateTime += updateTimer.GetUSec(false);
+
+        content.cameraNode_->SetRotation(Quaternion(10.0f + (float)(i % 5), (float)i * 3.0f, 0.0f));
+        result.Clear();
+        FrustumOctreeQuery query(result, camera->GetFrustum(), DRAWABLE_GEOMETRY);
+        HiresTimer queryTimer;
+        content.octree_->GetDrawables(query);
+        queryTime += queryTimer.GetUSec(false);
+
+        for (unsigned j = 0; j < result.Size(); ++j)
+            queryChecksum += result[j]->GetID() * 2654435761U;
+        queryChecksum += result.Size();
+
+        for (unsigned y = 0; y < NUM_RAYS_PER_AXIS; ++y)
+        {
+            for (unsigned x = 0; x < NUM_RAYS_PER_AXIS; ++x)
+            {
+                Ray ray = camera->GetScreenRay((x + 0.5f) / NUM_RAYS_PER_AXIS, (y + 0.5f) / NUM_RAYS_PER_AXIS);
+                rayResult.Clear();
+                RayOctreeQuery rayQuery(rayResult, ray, RAY_AABB, camera->GetFarClip(), DRAWABLE_GEOMETRY);
+                HiresTimer raycastTimer;
+                content.octree_->Raycast(rayQuery);
+                raycastTime += raycastTimer.GetUSec(false);
+
+                for (unsigned j = 0; j < rayResult.Size(); ++j)
+                    raycastChecksum += rayResult[j].drawable_->GetID() * 2654435761U;
+                raycastChecksum += rayResult.Size();
+            }
+        }
+    }
+
+    updateUSec = (float)updateTime / numFrames;
+    queryUSec = (float)queryTime / numFrames;
+    raycastUSec = (float)raycastTime / numFrames;
+}
+
+void RunSpatialIndexBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned numFrames = Max(GetArgument(arguments, 0, 60), 1U);
+
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+    ResourceCache* cache = engine->GetSubsystem<ResourceCache>();
+    Model* boxModel = cache->GetResource<Model>("Models/Box.mdl");
+    Model* mushroomModel = cache->GetResource<Model>("Models/Mushroom.mdl");
+    if (!boxModel || !mushroomModel)
+        ErrorExit("Could not load the box and mushroom models");
+
+    Vector<SpatialIndexContent> contents(3);
+    CreateGridContent(context, contents[0], boxModel);
+    CreatePhysicsContent(context, contents[1], boxModel, mushroomModel, numFrames);
+    CreateLargeObjectContent(context, contents[2], boxModel, numFrames);
+
+    for (unsigned i = 0; i < contents.Size(); ++i)
+    {
+        SpatialIndexContent& content = contents[i];
+        PrintLine(FormatLine("Spatial index: %s, average of %u frames, %u rays per frame", content.name_.CString(),
+            numFrames, NUM_RAYS_PER_AXIS * NUM_RAYS_PER_AXIS));
+        PrintLine("Index       Update ms   Query ms   Raycast ms");
+
+        unsigned referenceQueryChecksum = 0;
+        unsigned referenceRaycastChecksum = 0;
+
+        for (unsigned j = SPATIAL_OCTREE; j <= SPATIAL_AABBTREE; ++j)
+        {
+            float updateUSec;
+            float queryUSec;
+            float raycastUSec;
+            unsigned queryChecksum;
+            unsigned raycastChecksum;
+            RunSpatialIndexFrames(content, (SpatialIndex)j, numFrames, updateUSec, queryUSec, raycastUSec, queryChecksum,
+                raycastChecksum);
+
+            // Both indices must give the same query results
+            if (j == SPATIAL_OCTREE)
+            {
+                referenceQueryChecksum = queryChecksum;
+                referenceRaycastChecksum = raycastChecksum;
+            }
+            else if (queryChecksum != referenceQueryChecksum || raycastChecksum != referenceRaycastChecksum)
+                ErrorExit("Query results differ between the octree and the AABB tree");
+
+            PrintLine(FormatLine("%-9s   %9.3f   %8.3f   %10.3f", indexNames[j], updateUSec / 1000.0f, queryUSec / 1000.0f,
+                raycastUSec / 1000.0f));
+        }
+    }
+}
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const float FRAME_TIME_STEP = 1.0f / 60.0f;
+static const char* modeNames[] = {"Lazy", "Batched"};
+
+/// Transform test content.
+struct TransformContent
+{
+    /// Construct.
+    TransformContent() :
+        movingStep_(1)
+    {
+    }
+
+    /// Name.
+    String name_;
+    /// Scene.
+    SharedPtr<Scene> scene_;
+    /// All nodes, whose world transforms are read each frame.
+    PODVector<Node*> nodes_;
+    /// Nodes rotated each frame.
+    PODVector<Node*> movingNodes_;
+    /// Step between the moving nodes rotated in one frame.
+    unsigned movingStep_;
+};
+
+/// Create a node in transform test content.
+static Node* CreateNode(TransformContent& content, Node* parent, const Vector3& position)
+{
+    Node* node = parent->CreateChild("Node", LOCAL);
+    node->SetPosition(position);
+    content.nodes_.Push(node);
+    return node;
+}
+
+/// Create the HugeObjectCount sample grid of boxes without their drawables.
+static void CreateGridScene(Context* context, TransformContent& content)
+{
+    content.scene_ = new Scene(context);
+    for (int y = -125; y < 125; ++y)
+    {
+        for (int x = -125; x < 125; ++x)
+            content.movingNodes_.Push(CreateNode(content, content.scene_, Vector3(x * 0.3f, 0.0f, y * 0.3f)));
+    }
+}
+
+/// Run frames of rotating nodes, reading all world transforms after each scene update as the renderer would. Return the
+/// average scene update and transform read times in microseconds, and the final world positions.
+static void RunTransformFrames(TransformContent& content, unsigned frames, float& updateUSec, float& readUSec,
+    PODVector<Vector3>& positions)
+{
+    // Start from the same transforms
+    for (unsigned i = 0; i < content.movingNodes_.Size(); ++i)
+        content.movingNodes_[i]->SetRotation(Quaternion::IDENTITY);
+    content.scene_->Update(FRAME_TIME_STEP);
+
+    Quaternion rotation(15.0f * FRAME_TIME_STEP, Vector3::FORWARD);
+    long long updateTime = 0;
+    long long readTime = 0;
+    Vector3 sum;
+
+    for (unsigned i = 0; i < frames; ++i)
+    {
+        for (unsigned j = i % content.movingStep_; j < content.movingNodes_.Size(); j += content.movingStep_)
+            content.movingNodes_[j]->Rotate(rotation);
+
+        HiresTimer updateTimer;
+        content.scene_->Update(FRAME_TIME_STEP);
+        updateTime += updateTimer.GetUSec(false);
+
+        HiresTimer readTimer;
+        for (unsigned j = 0; j < content.nodes_.Size(); ++j)
+            sum += content.nodes_[j]->GetWorldPosition();
+        readTime += readTimer.GetUSec(false);
+    }
+
+    positions.Resize(content.nodes_.Size());
+    for (unsigned i = 0; i < content.nodes_.Size(); ++i)
+        positions[i] = content.nodes_[i]->GetWorldPosition();
+
+    // Keep the reads from being optimized away
+    if (sum.x_ == M_INFINITY)
+        PrintLine("");
+
+    updateUSec = (float)updateTime / frames;
+    readUSec = (float)readTime / frames;
+}
+
+void RunTransformBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned frames = Max(GetArgument(arguments, 0, 60), 1U);
+
+    SharedPtr<Engine> engine = CreateHeadlessEngine(context);
+
+    Vector<TransformContent> contents(3);
+
+    // The HugeObjectCount sample grid, with all boxes rotating each frame as in the sample, and with 1% of them
+    TransformContent& grid = contents[0];
+    grid.name_ = "HugeObjectCount grid: 62500 nodes rotating each frame";
+    CreateGridScene(context, grid);
+    TransformContent& sparseGrid = contents[1];
+    sparseGrid.name_ = "HugeObjectCount grid: 62500 nodes, 1% rotating each frame";
+    sparseGrid.movingStep_ = 100;
+    CreateGridScene(context, sparseGrid);
+
+    // Rotating groups with static children, so that whole subtrees become dirty
+    TransformContent& groups = contents[2];
+    groups.name_ = "2500 groups rotating each frame, each with 5 children of 4 grandchildren";
+    groups.scene_ = new Scene(context);
+    for (unsigned i = 0; i < 2500; ++i)
+    {
+        Node* group = CreateNode(groups, groups.scene_, Vector3((float)(i % 50) * 4.0f, 0.0f, (float)(i / 50) * 4.0f));
+        groups.movingNodes_.Push(group);
+        for (unsigned j = 0; j < 5; ++j)
+        {
+            Node* child = CreateNode(groups, group, Vector3((float)j, 0.5f, 0.0f));
+            for (unsigned k = 0; k < 4; ++k)
+                CreateNode(groups, child, Vector3(0.0f, 0.5f, (float)k * 0.25f));
+        }
+    }
+
+    for (unsigned i = 0; i < contents.Size(); ++i)
+    {
+        TransformContent& content = contents[i];
+        PrintLine(FormatLine("Transforms: %s, average of %u frames", content.name_.CString(), frames));
+        PrintLine("Mode      Update ms   Read ms   Total ms");
+
+        PODVector<Vector3> referencePositions;
+        for (unsigned j = 0; j < 2; ++j)
+        {
+            content.scene_->SetBatchedTransforms(j == 1);
+
+            float updateUSec;
+            float readUSec;
+            PODVector<Vector3> positions;
+            RunTransformFrames(content, frames, updateUSec, readUSec, positions);
+
+            // Both modes must give the same world transforms
+            if (!j)
+                referencePositions = positions;
+            else
+            {
+                for (unsigned k = 0; k < positions.Size(); ++k)
+                {
+                    if (!positions[k].Equals(referencePositions[k]))
+                        ErrorExit("World transforms differ between lazy and batched updates");
+                }
+            }
+
+            PrintLine(FormatLine("%-7s   %9.3f   %7.3f   %8.3f", modeNames[j], updateUSec / 1000.0f, readUSec / 1000.0f,
+                (updateUSec + readUSec) / 1000.0f));
+        }
+    }
+}
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include "Benchmark.h"
+
+#include <Urho3D/DebugNew.h>
+
+static const unsigned NUM_FRAMES = 100;
+
+/// Work function performing a fixed amount of arithmetic. The start pointer points to the result and the aux pointer to the iteration count.
+static void BenchmarkWork(const WorkItem* item, unsigned threadIndex)
+{
+    unsigned iterations = *reinterpret_cast<const unsigned*>(item->aux_);
+    float value = 1.0f;
+    for (unsigned i = 0; i < iterations; ++i)
+        value = value * 0.999f + 0.001f * (float)i;
+
+    *reinterpret_cast<float*>(item->start_) = value;
+}
+
+/// Benchmark frame which executes the work items directly in the main thread, to measure the cost without the queue.
+struct DirectFrame
+{
+    /// Construct.
+    DirectFrame(unsigned numItems, unsigned iterations) :
+        results_(numItems),
+        iterations_(iterations)
+    {
+    }
+
+    /// Execute the items.
+    void operator ()()
+    {
+        WorkItem item;
+        item.aux_ = &iterations_;
+        for (unsigned i = 0; i < results_.Size(); ++i)
+        {
+            item.start_ = &results_[i];
+            BenchmarkWork(&item, 0);
+        }
+    }
+
+    /// Results of the items.
+    PODVector<float> results_;
+    /// Iterations per item.
+    unsigned iterations_;
+};
+
+/// Benchmark frame which adds the work items to the work queue and completes them, as the engine subsystems do each frame.
+struct WorkQueueFrame
+{
+    /// Construct.
+    WorkQueueFrame(WorkQueue* queue, unsigned numItems, unsigned iterations) :
+        queue_(queue),
+        results_(numItems),
+        iterations_(iterations)
+    {
+    }
+
+    /// Add and complete the items.
+    void operator ()()
+    {
+        for (unsigned i = 0; i < results_.Size(); ++i)
+        {
+            SharedPtr<WorkItem> item = queue_->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = BenchmarkWork;
+            item->start_ = &results_[i];
+            item->aux_ = &iterations_;
+            queue_->AddWorkItem(item);
+        }
+
+        queue_->Complete(M_MAX_UNSIGNED);
+    }
+
+    /// Work queue.
+    WorkQueue* queue_;
+    /// Results of the items.
+    PODVector<float> results_;
+    /// Iterations per item.
+    unsigned iterations_;
+};
+
+void RunWorkQueueBenchmark(Context* context, const Vector<String>& arguments)
+{
+    unsigned maxThreads = Max(GetArgument(arguments, 0, GetNumLogicalCPUs()), 1U);
+    unsigned numItems = Max(GetArgument(arguments, 1, 512), 1U);
+    unsigned iterations = GetArgument(arguments, 2, 500);
+
+    PrintLine(FormatLine("WorkQueue: %u items per frame, %u iterations per item, average of %u frames", numItems, iterations,
+        NUM_FRAMES));
+
+    DirectFrame direct(numItems, iterations);
+    float directUSec = MeasureUSec(direct, NUM_FRAMES);
+    PrintLine(FormatLine("Direct call: %.3f ms per frame", directUSec / 1000.0f));
+    PrintLine("Threads  Frame ms  Overhead us/item  Speedup");
+
+    float singleThreadUSec = 0.0f;
+    for (unsigned numThreads = 1; numThreads <= maxThreads; ++numThreads)
+    {
+        // Worker threads can only be created once, so use a new queue for each thread count. The main thread also executes
+        // work while completing, so it counts as one of the threads
+        SharedPtr<WorkQueue> queue(new WorkQueue(context));
+        if (numThreads > 1)
+            queue->CreateThreads(numThreads - 1);
+
+        WorkQueueFrame frame(queue, numItems, iterations);
+        float usec = MeasureUSec(frame, NUM_FRAMES);
+        if (numThreads == 1)
+            singleThreadUSec = usec;
+
+        PrintLine(FormatLine("%7u  %8.3f  %16.3f  %7.2f", numThreads, usec / 1000.0f,
+            (usec * numThreads - directUSec) / numItems, singleThreadUSec / usec));
+    }
+}
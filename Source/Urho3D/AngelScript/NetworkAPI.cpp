@@ -28,6 +28,7 @@
 #include "../Network/HttpRequest.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkPriority.h"
+#include "../Network/RelevanceFilter.h"
 
 namespace Urho3D
 {
@@ -45,6 +46,18 @@ static void RegisterNetworkPriority(asIScriptEngine* engine)
     engine->RegisterObjectMethod("NetworkPriority", "bool get_alwaysUpdateOwner() const", asMETHOD(NetworkPriority, GetAlwaysUpdateOwner), asCALL_THISCALL);
 }
 
+static void RegisterRelevanceFilter(asIScriptEngine* engine)
+{
+    RegisterObject<RelevanceFilter>(engine, "RelevanceFilter");
+    RegisterObject<OctreeRelevanceFilter>(engine, "OctreeRelevanceFilter");
+    RegisterObjectConstructor<OctreeRelevanceFilter>(engine, "OctreeRelevanceFilter");
+    RegisterSubclass<RelevanceFilter, OctreeRelevanceFilter>(engine, "RelevanceFilter", "OctreeRelevanceFilter");
+    engine->RegisterObjectMethod("OctreeRelevanceFilter", "void set_radius(float)", asMETHOD(OctreeRelevanceFilter, SetRadius), asCALL_THISCALL);
+    engine->RegisterObjectMethod("OctreeRelevanceFilter", "float get_radius() const", asMETHOD(OctreeRelevanceFilter, GetRadius), asCALL_THISCALL);
+    engine->RegisterObjectMethod("OctreeRelevanceFilter", "void set_viewMask(uint)", asMETHOD(OctreeRelevanceFilter, SetViewMask), asCALL_THISCALL);
+    engine->RegisterObjectMethod("OctreeRelevanceFilter", "uint get_viewMask() const", asMETHOD(OctreeRelevanceFilter, GetViewMask), asCALL_THISCALL);
+}
+
 void SendRemoteEvent(const String& eventType, bool inOrder, const VariantMap& eventData, Connection* ptr)
 {
     ptr->SendRemoteEvent(eventType, inOrder, eventData);
@@ -67,6 +80,10 @@ static void RegisterConnection(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Connection", "Scene@+ get_scene() const", asMETHOD(Connection, GetScene), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "void set_logStatistics(bool)", asMETHOD(Connection, SetLogStatistics), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "bool get_logStatistics() const", asMETHOD(Connection, GetLogStatistics), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "void set_relevanceFilter(RelevanceFilter@+)", asMETHOD(Connection, SetRelevanceFilter), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "RelevanceFilter@+ get_relevanceFilter() const", asMETHOD(Connection, GetRelevanceFilter), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "void set_snapshotDeltas(bool)", asMETHOD(Connection, SetSnapshotDeltas), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Connection", "bool get_snapshotDeltas() const", asMETHOD(Connection, GetSnapshotDeltas), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "bool get_client() const", asMETHOD(Connection, IsClient), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "bool get_connected() const", asMETHOD(Connection, IsConnected), asCALL_THISCALL);
     engine->RegisterObjectMethod("Connection", "bool get_connectPending() const", asMETHOD(Connection, IsConnectPending), asCALL_THISCALL);
@@ -199,6 +216,7 @@ void RegisterNetwork(asIScriptEngine* engine)
 void RegisterNetworkAPI(asIScriptEngine* engine)
 {
     RegisterNetworkPriority(engine);
+    RegisterRelevanceFilter(engine);
     RegisterConnection(engine);
     RegisterHttpRequest(engine);
     RegisterNetwork(engine);
@@ -22,17 +22,24 @@
 
 #include "../Precompiled.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+static volatile long numContainerAllocations = 0;
+
 AllocatorBlock* AllocatorReserveBlock(AllocatorBlock* allocator, unsigned nodeSize, unsigned capacity)
 {
     if (!capacity)
         capacity = 1;
 
     unsigned char* blockPtr = new unsigned char[sizeof(AllocatorBlock) + capacity * (sizeof(AllocatorNode) + nodeSize)];
+    RecordContainerAllocation();
     AllocatorBlock* newBlock = reinterpret_cast<AllocatorBlock*>(blockPtr);
     newBlock->nodeSize_ = nodeSize;
     newBlock->capacity_ = capacity;
@@ -119,4 +126,19 @@ void AllocatorFree(AllocatorBlock* allocator, void* ptr)
     allocator->free_ = node;
 }
 
+void RecordContainerAllocation()
+{
+    // Worker threads allocate too, so increment atomically
+#ifdef _MSC_VER
+    _InterlockedIncrement(&numContainerAllocations);
+#else
+    __sync_fetch_and_add(&numContainerAllocations, 1);
+#endif
+}
+
+unsigned GetNumContainerAllocations()
+{
+    return (unsigned)numContainerAllocations;
+}
+
 }
@@ -66,6 +66,10 @@ URHO3D_API void AllocatorUninitialize(AllocatorBlock* allocator);
 URHO3D_API void* AllocatorReserve(AllocatorBlock* allocator);
 /// Free a node. Does not free any blocks.
 URHO3D_API void AllocatorFree(AllocatorBlock* allocator, void* ptr);
+/// Record a heap allocation made for container storage.
+URHO3D_API void RecordContainerAllocation();
+/// Return the number of heap allocations made for container storage (vector buffers, hash buckets, allocator and frame allocator blocks) since program start, counted atomically from all threads. Other heap allocations are not counted.
+URHO3D_API unsigned GetNumContainerAllocations();
 
 /// %Allocator template class. Allocates objects of a specific class.
 template <class T> class Allocator
@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/FlatHashBase.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+unsigned FlatHashBase::CalculateNumSlots(unsigned size)
+{
+    // Keep the load factor at or below 3/4
+    unsigned numSlots = FLAT_HASH_MIN_SLOTS;
+    while (numSlots - (numSlots >> 2) < size)
+        numSlots <<= 1;
+    return numSlots;
+}
+
+unsigned char* FlatHashBase::AllocateStorage(unsigned size)
+{
+    if (allocator_)
+    {
+        // Storage from an earlier frame must have been dropped by clearing
+        assert(!IsStale());
+        generation_ = allocator_->GetGeneration();
+        return static_cast<unsigned char*>(allocator_->Allocate(size));
+    }
+
+    RecordContainerAllocation();
+    return new unsigned char[size];
+}
+
+void FlatHashBase::ReleaseStorage()
+{
+    // Remember the capacity as a hint for the next storage
+    if (capacity_ > clearedCapacity_)
+        clearedCapacity_ = capacity_;
+    FreeStorage(slots_);
+    FreeStorage(entries_);
+    slots_ = 0;
+    entries_ = 0;
+    numSlots_ = 0;
+    shift_ = 0;
+    size_ = 0;
+    capacity_ = 0;
+}
+
+void FlatHashBase::DropStaleStorage()
+{
+    clearedCapacity_ = capacity_;
+    slots_ = 0;
+    entries_ = 0;
+    numSlots_ = 0;
+    shift_ = 0;
+    size_ = 0;
+    capacity_ = 0;
+}
+
+void FlatHashBase::AllocateSlots(unsigned numSlots)
+{
+    FreeStorage(slots_);
+
+    slots_ = reinterpret_cast<FlatHashSlot*>(AllocateStorage(numSlots * sizeof(FlatHashSlot)));
+    numSlots_ = numSlots;
+
+    shift_ = 32;
+    while (numSlots > 1)
+    {
+        numSlots >>= 1;
+        --shift_;
+    }
+
+    ResetSlots();
+}
+
+void FlatHashBase::ResetSlots()
+{
+    if (slots_)
+        memset(slots_, 0xff, numSlots_ * sizeof(FlatHashSlot));
+}
+
+void FlatHashBase::InsertSlot(unsigned hash, unsigned index)
+{
+    unsigned mask = numSlots_ - 1;
+    unsigned pos = HomeSlot(hash);
+    while (slots_[pos].index_ != FLAT_HASH_EMPTY)
+        pos = (pos + 1) & mask;
+
+    slots_[pos].hash_ = hash;
+    slots_[pos].index_ = index;
+}
+
+unsigned FlatHashBase::FindSlot(unsigned hash, unsigned index) const
+{
+    unsigned mask = numSlots_ - 1;
+    unsigned pos = HomeSlot(hash);
+    while (slots_[pos].index_ != index)
+        pos = (pos + 1) & mask;
+
+    return pos;
+}
+
+void FlatHashBase::EraseSlot(unsigned pos)
+{
+    unsigned mask = numSlots_ - 1;
+    unsigned next = (pos + 1) & mask;
+
+    while (slots_[next].index_ != FLAT_HASH_EMPTY)
+    {
+        // Move the slot back into the hole if the hole lies between its home slot and its current position
+        unsigned home = HomeSlot(slots_[next].hash_);
+        if (((next - home) & mask) >= ((next - pos) & mask))
+        {
+            slots_[pos] = slots_[next];
+            pos = next;
+        }
+        next = (next + 1) & mask;
+    }
+
+    slots_[pos].index_ = FLAT_HASH_EMPTY;
+}
+
+}
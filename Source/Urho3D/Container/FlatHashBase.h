@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include "../Container/Allocator.h"
+#include "../Container/FrameAllocator.h"
+#include "../Container/Hash.h"
+#include "../Container/Swap.h"
+
+namespace Urho3D
+{
+
+/// Slot index value marking an empty slot.
+static const unsigned FLAT_HASH_EMPTY = 0xffffffff;
+/// Minimum number of slots allocated for a flat hash table.
+static const unsigned FLAT_HASH_MIN_SLOTS = 8;
+
+/// Flat hash table slot: hash of the key and index of the entry in the dense entry array.
+struct FlatHashSlot
+{
+    /// Full hash of the key.
+    unsigned hash_;
+    /// Entry index, or FLAT_HASH_EMPTY.
+    unsigned index_;
+};
+
+/// Flat hash set/map base class. Entries are stored contiguously in insertion order (until erased) and located through an open-addressing slot table with linear probing, so lookups touch one or two cache lines and inserts do not allocate as long as the capacity suffices. Pointers and iterators to entries are invalidated by insertion and erasure. The storage can optionally come from a frame allocator, see SetAllocator() in the derived classes.
+class URHO3D_API FlatHashBase
+{
+public:
+    /// Construct.
+    FlatHashBase() :
+        slots_(0),
+        entries_(0),
+        numSlots_(0),
+        shift_(0),
+        size_(0),
+        capacity_(0),
+        allocator_(0),
+        generation_(0),
+        clearedCapacity_(0)
+    {
+    }
+
+    /// Destruct. Derived classes must destroy the entries.
+    ~FlatHashBase()
+    {
+        FreeStorage(slots_);
+        FreeStorage(entries_);
+    }
+
+    /// Swap with another flat hash set or map.
+    void Swap(FlatHashBase& rhs)
+    {
+        Urho3D::Swap(slots_, rhs.slots_);
+        Urho3D::Swap(entries_, rhs.entries_);
+        Urho3D::Swap(numSlots_, rhs.numSlots_);
+        Urho3D::Swap(shift_, rhs.shift_);
+        Urho3D::Swap(size_, rhs.size_);
+        Urho3D::Swap(capacity_, rhs.capacity_);
+        Urho3D::Swap(allocator_, rhs.allocator_);
+        Urho3D::Swap(generation_, rhs.generation_);
+        Urho3D::Swap(clearedCapacity_, rhs.clearedCapacity_);
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+
+    /// Return number of elements that fit without rehashing.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return number of slots.
+    unsigned NumSlots() const { return numSlots_; }
+
+    /// Return whether has no elements.
+    bool Empty() const { return size_ == 0; }
+
+    /// Return the frame allocator, or null if the storage comes from the heap.
+    FrameAllocator* GetAllocator() const { return allocator_; }
+
+    /// Return whether the storage came from the frame allocator before its last reset, so that it must not be accessed.
+    bool IsStale() const { return allocator_ && (slots_ || entries_) && generation_ != allocator_->GetGeneration(); }
+
+protected:
+    /// Return the first slot to probe for a hash. Uses multiplicative hashing so that pointer and small integer keys spread over the table. Do not call if the slots have not been allocated.
+    unsigned HomeSlot(unsigned hash) const { return (hash * 2654435769u) >> shift_; }
+
+    /// Return the number of slots needed to hold a number of elements.
+    static unsigned CalculateNumSlots(unsigned size);
+
+    /// Allocate slot or entry storage from the frame allocator if set, otherwise from the heap.
+    unsigned char* AllocateStorage(unsigned size);
+
+    /// Free slot or entry storage. Does nothing for frame allocator storage, which is reclaimed when the allocator is reset.
+    void FreeStorage(void* storage)
+    {
+        if (!allocator_)
+            delete[] static_cast<unsigned char*>(storage);
+    }
+
+    /// Free the storage and reset to empty. The entries must have been destroyed.
+    void ReleaseStorage();
+
+    /// Drop stale frame allocator storage without accessing it, remembering the capacity so that the next insertion reserves it at once. The entries must have been destroyed or need no destruction.
+    void DropStaleStorage();
+
+    /// Allocate a new slot table with a power of two size and mark all slots empty. Frees the old table.
+    void AllocateSlots(unsigned numSlots);
+
+    /// Mark all slots empty.
+    void ResetSlots();
+
+    /// Insert an entry index into the slot table. The key must not already exist and there must be a free slot.
+    void InsertSlot(unsigned hash, unsigned index);
+
+    /// Return the slot position holding an entry index. The entry must exist.
+    unsigned FindSlot(unsigned hash, unsigned index) const;
+
+    /// Empty a slot, shifting back the following slots of the probe sequence so that no tombstones are needed.
+    void EraseSlot(unsigned pos);
+
+    /// Slot table.
+    FlatHashSlot* slots_;
+    /// Dense entry storage.
+    unsigned char* entries_;
+    /// Number of slots, zero or a power of two.
+    unsigned numSlots_;
+    /// Right shift applied to the multiplied hash to get the home slot.
+    unsigned shift_;
+    /// Number of entries.
+    unsigned size_;
+    /// Number of entries that fit in the entry storage.
+    unsigned capacity_;
+    /// Frame allocator for the storage, or null to use the heap.
+    FrameAllocator* allocator_;
+    /// Frame allocator generation when the storage was allocated.
+    unsigned generation_;
+    /// Capacity of the storage dropped by the last clear after a frame allocator reset.
+    unsigned clearedCapacity_;
+
+private:
+    /// Prevent copy construction.
+    FlatHashBase(const FlatHashBase& rhs);
+    /// Prevent assignment.
+    FlatHashBase& operator =(const FlatHashBase& rhs);
+};
+
+}
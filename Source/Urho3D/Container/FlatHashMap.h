@@ -0,0 +1,407 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Pair.h"
+#include "../Container/Vector.h"
+
+#include <new>
+
+namespace Urho3D
+{
+
+/// Open-addressing hash map template class. Same interface as HashMap, but the pairs are stored in one contiguous array, so insertion after reserving and Clear() do not allocate. Erasing moves the last pair into the hole, so iteration order is insertion order only until the first erase. Unlike HashMap, inserting or erasing invalidates pointers and iterators to the pairs.
+template <class T, class U> class FlatHashMap : public FlatHashBase
+{
+public:
+    typedef T KeyType;
+    typedef U ValueType;
+
+    /// Flat hash map key-value pair with const key.
+    class KeyValue
+    {
+    public:
+        /// Construct with key and value.
+        KeyValue(const T& first, const U& second) :
+            first_(first),
+            second_(second)
+        {
+        }
+
+        /// Copy-construct.
+        KeyValue(const KeyValue& value) :
+            first_(value.first_),
+            second_(value.second_)
+        {
+        }
+
+        /// Test for equality with another pair.
+        bool operator ==(const KeyValue& rhs) const { return first_ == rhs.first_ && second_ == rhs.second_; }
+
+        /// Test for inequality with another pair.
+        bool operator !=(const KeyValue& rhs) const { return first_ != rhs.first_ || second_ != rhs.second_; }
+
+        /// Key.
+        const T first_;
+        /// Value.
+        U second_;
+
+    private:
+        /// Prevent assignment.
+        KeyValue& operator =(const KeyValue& rhs);
+    };
+
+    /// Flat hash map iterator.
+    typedef RandomAccessIterator<KeyValue> Iterator;
+    /// Flat hash map const iterator.
+    typedef RandomAccessConstIterator<KeyValue> ConstIterator;
+
+    /// Construct empty.
+    FlatHashMap()
+    {
+    }
+
+    /// Construct from another flat hash map.
+    FlatHashMap(const FlatHashMap<T, U>& map)
+    {
+        *this = map;
+    }
+
+    /// Destruct.
+    ~FlatHashMap()
+    {
+        // Entries in stale frame allocator storage must not be accessed
+        if (!IsStale())
+            DestroyEntries();
+    }
+
+    /// Assign a flat hash map.
+    FlatHashMap& operator =(const FlatHashMap<T, U>& rhs)
+    {
+        if (&rhs != this)
+        {
+            Clear();
+            if (rhs.IsStale())
+                return *this;
+            Reserve(rhs.Size());
+            for (ConstIterator i = rhs.Begin(); i != rhs.End(); ++i)
+                Insert(*i);
+        }
+        return *this;
+    }
+
+    /// Test for equality with another flat hash map.
+    bool operator ==(const FlatHashMap<T, U>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            ConstIterator j = rhs.Find(i->first_);
+            if (j == rhs.End() || j->second_ != i->second_)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another flat hash map.
+    bool operator !=(const FlatHashMap<T, U>& rhs) const { return !(*this == rhs); }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        bool exists;
+        return InsertEntry(key, MakeHash(key), exists)->second_;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    U* operator [](const T& key) const
+    {
+        unsigned index = FindIndex(key, MakeHash(key));
+        return index != FLAT_HASH_EMPTY ? &Entries()[index].second_ : 0;
+    }
+
+    /// Insert a pair. Return an iterator to it. If the key already exists, its value is replaced.
+    Iterator Insert(const Pair<T, U>& pair)
+    {
+        bool exists;
+        return Insert(pair, exists);
+    }
+
+    /// Insert a pair. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const Pair<T, U>& pair, bool& exists)
+    {
+        KeyValue* entry = InsertEntry(pair.first_, MakeHash(pair.first_), exists, &pair.second_);
+        if (exists)
+            entry->second_ = pair.second_;
+        return Iterator(entry);
+    }
+
+    /// Insert a key-value pair. Return an iterator to it. If the key already exists, its value is replaced.
+    Iterator Insert(const KeyValue& pair)
+    {
+        bool exists;
+        KeyValue* entry = InsertEntry(pair.first_, MakeHash(pair.first_), exists, &pair.second_);
+        if (exists)
+            entry->second_ = pair.second_;
+        return Iterator(entry);
+    }
+
+    /// Erase a pair by key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        if (!numSlots_)
+            return false;
+
+        unsigned hash = MakeHash(key);
+        unsigned mask = numSlots_ - 1;
+        KeyValue* entries = Entries();
+        for (unsigned pos = HomeSlot(hash); slots_[pos].index_ != FLAT_HASH_EMPTY; pos = (pos + 1) & mask)
+        {
+            if (slots_[pos].hash_ == hash && entries[slots_[pos].index_].first_ == key)
+            {
+                EraseEntry(pos);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// Erase a pair by iterator. Return iterator to the next pair, which is the former last pair moved into the erased position.
+    Iterator Erase(const Iterator& it)
+    {
+        unsigned index = (unsigned)(it.ptr_ - Entries());
+        if (index >= size_)
+            return End();
+
+        EraseEntry(FindSlot(MakeHash(it->first_), index));
+        return Iterator(Entries() + index);
+    }
+
+    /// Clear the map. Keeps the allocated storage, except frame allocator storage from before the allocator's last reset, which is dropped.
+    void Clear()
+    {
+        if (IsStale())
+        {
+            DropStaleStorage();
+            return;
+        }
+
+        DestroyEntries();
+        ResetSlots();
+        size_ = 0;
+    }
+
+    /// Set a frame allocator for the storage, or null to use the heap. Clears the map. With an allocator, the map must be cleared before use after each reset of the allocator; the next insertion then reserves the previous capacity at once. The pairs left in the map at a reset are never destroyed, so they must not own resources.
+    void SetAllocator(FrameAllocator* allocator)
+    {
+        Clear();
+        if (allocator != allocator_)
+        {
+            ReleaseStorage();
+            allocator_ = allocator;
+        }
+    }
+
+    /// Make room for at least the given number of pairs.
+    void Reserve(unsigned size)
+    {
+        if (size > capacity_)
+            Rehash(CalculateNumSlots(size));
+    }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned index = FindIndex(key, MakeHash(key));
+        return index != FLAT_HASH_EMPTY ? Iterator(Entries() + index) : End();
+    }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned index = FindIndex(key, MakeHash(key));
+        return index != FLAT_HASH_EMPTY ? ConstIterator(Entries() + index) : End();
+    }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindIndex(key, MakeHash(key)) != FLAT_HASH_EMPTY; }
+
+    /// Try to copy value to output. Return true if was found.
+    bool TryGetValue(const T& key, U& out) const
+    {
+        unsigned index = FindIndex(key, MakeHash(key));
+        if (index == FLAT_HASH_EMPTY)
+            return false;
+
+        out = Entries()[index].second_;
+        return true;
+    }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->first_);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->second_);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return Iterator(Entries()); }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(Entries()); }
+
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(Entries() + size_); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(Entries() + size_); }
+
+    /// Return first pair.
+    const KeyValue& Front() const { return Entries()[0]; }
+
+    /// Return last pair.
+    const KeyValue& Back() const { return Entries()[size_ - 1]; }
+
+private:
+    /// Return the entry array.
+    KeyValue* Entries() const { return reinterpret_cast<KeyValue*>(entries_); }
+
+    /// Return index of the entry with key, or FLAT_HASH_EMPTY if not found.
+    unsigned FindIndex(const T& key, unsigned hash) const
+    {
+        if (!numSlots_)
+            return FLAT_HASH_EMPTY;
+
+        unsigned mask = numSlots_ - 1;
+        const KeyValue* entries = Entries();
+        for (unsigned pos = HomeSlot(hash); slots_[pos].index_ != FLAT_HASH_EMPTY; pos = (pos + 1) & mask)
+        {
+            if (slots_[pos].hash_ == hash && entries[slots_[pos].index_].first_ == key)
+                return slots_[pos].index_;
+        }
+
+        return FLAT_HASH_EMPTY;
+    }
+
+    /// Return the entry with key, appending it if it does not exist. A new entry is constructed from the value if given, otherwise default-constructed.
+    KeyValue* InsertEntry(const T& key, unsigned hash, bool& exists, const U* value = 0)
+    {
+        unsigned index = FindIndex(key, hash);
+        exists = index != FLAT_HASH_EMPTY;
+        if (exists)
+            return Entries() + index;
+
+        if (size_ >= capacity_)
+        {
+            unsigned newSize = size_ + 1 > capacity_ * 2 ? size_ + 1 : capacity_ * 2;
+            Rehash(CalculateNumSlots(newSize > clearedCapacity_ ? newSize : clearedCapacity_));
+        }
+
+        KeyValue* entry = Entries() + size_;
+        if (value)
+            new(entry) KeyValue(key, *value);
+        else
+            new(entry) KeyValue(key, U());
+        InsertSlot(hash, size_);
+        ++size_;
+        return entry;
+    }
+
+    /// Erase the entry referenced by a slot position. The last entry is moved into its place.
+    void EraseEntry(unsigned pos)
+    {
+        unsigned index = slots_[pos].index_;
+        unsigned last = size_ - 1;
+        KeyValue* entries = Entries();
+
+        EraseSlot(pos);
+        if (index != last)
+        {
+            slots_[FindSlot(MakeHash(entries[last].first_), last)].index_ = index;
+            (entries + index)->~KeyValue();
+            new(entries + index) KeyValue(entries[last]);
+        }
+        (entries + last)->~KeyValue();
+        --size_;
+    }
+
+    /// Destroy all entries.
+    void DestroyEntries()
+    {
+        KeyValue* entries = Entries();
+        for (unsigned i = 0; i < size_; ++i)
+            (entries + i)->~KeyValue();
+    }
+
+    /// Reallocate the entry storage and rebuild the slot table.
+    void Rehash(unsigned numSlots)
+    {
+        unsigned capacity = numSlots - (numSlots >> 2);
+        unsigned char* newEntries = AllocateStorage(capacity * sizeof(KeyValue));
+
+        KeyValue* src = Entries();
+        KeyValue* dest = reinterpret_cast<KeyValue*>(newEntries);
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            new(dest + i) KeyValue(src[i]);
+            (src + i)->~KeyValue();
+        }
+
+        FreeStorage(entries_);
+        entries_ = newEntries;
+        capacity_ = capacity;
+
+        AllocateSlots(numSlots);
+        for (unsigned i = 0; i < size_; ++i)
+            InsertSlot(MakeHash(dest[i].first_), i);
+    }
+};
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator begin(const Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator end(const Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator begin(Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator end(Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+}
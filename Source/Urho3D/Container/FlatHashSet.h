@@ -0,0 +1,301 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Vector.h"
+
+#include <new>
+
+namespace Urho3D
+{
+
+/// Open-addressing hash set template class. Same interface as HashSet, but the keys are stored in one contiguous array, so insertion after reserving and Clear() do not allocate. Erasing moves the last key into the hole. Unlike HashSet, inserting or erasing invalidates pointers and iterators to the keys.
+template <class T> class FlatHashSet : public FlatHashBase
+{
+public:
+    /// Flat hash set iterator.
+    typedef RandomAccessIterator<T> Iterator;
+    /// Flat hash set const iterator.
+    typedef RandomAccessConstIterator<T> ConstIterator;
+
+    /// Construct empty.
+    FlatHashSet()
+    {
+    }
+
+    /// Construct from another flat hash set.
+    FlatHashSet(const FlatHashSet<T>& set)
+    {
+        *this = set;
+    }
+
+    /// Destruct.
+    ~FlatHashSet()
+    {
+        // Entries in stale frame allocator storage must not be accessed
+        if (!IsStale())
+            DestroyEntries();
+    }
+
+    /// Assign a flat hash set.
+    FlatHashSet& operator =(const FlatHashSet<T>& rhs)
+    {
+        if (&rhs != this)
+        {
+            Clear();
+            if (rhs.IsStale())
+                return *this;
+            Reserve(rhs.Size());
+            for (ConstIterator i = rhs.Begin(); i != rhs.End(); ++i)
+                Insert(*i);
+        }
+        return *this;
+    }
+
+    /// Test for equality with another flat hash set.
+    bool operator ==(const FlatHashSet<T>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            if (!rhs.Contains(*i))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another flat hash set.
+    bool operator !=(const FlatHashSet<T>& rhs) const { return !(*this == rhs); }
+
+    /// Insert a key. Return an iterator to it.
+    Iterator Insert(const T& key)
+    {
+        bool exists;
+        return Insert(key, exists);
+    }
+
+    /// Insert a key. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const T& key, bool& exists)
+    {
+        unsigned hash = MakeHash(key);
+        unsigned index = FindIndex(key, hash);
+        exists = index != FLAT_HASH_EMPTY;
+        if (exists)
+            return Iterator(Entries() + index);
+
+        if (size_ >= capacity_)
+        {
+            unsigned newSize = size_ + 1 > capacity_ * 2 ? size_ + 1 : capacity_ * 2;
+            Rehash(CalculateNumSlots(newSize > clearedCapacity_ ? newSize : clearedCapacity_));
+        }
+
+        T* entry = Entries() + size_;
+        new(entry) T(key);
+        InsertSlot(hash, size_);
+        ++size_;
+        return Iterator(entry);
+    }
+
+    /// Erase a key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        if (!numSlots_)
+            return false;
+
+        unsigned hash = MakeHash(key);
+        unsigned mask = numSlots_ - 1;
+        T* entries = Entries();
+        for (unsigned pos = HomeSlot(hash); slots_[pos].index_ != FLAT_HASH_EMPTY; pos = (pos + 1) & mask)
+        {
+            if (slots_[pos].hash_ == hash && entries[slots_[pos].index_] == key)
+            {
+                EraseEntry(pos);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// Erase a key by iterator. Return iterator to the next key, which is the former last key moved into the erased position.
+    Iterator Erase(const Iterator& it)
+    {
+        unsigned index = (unsigned)(it.ptr_ - Entries());
+        if (index >= size_)
+            return End();
+
+        EraseEntry(FindSlot(MakeHash(*it), index));
+        return Iterator(Entries() + index);
+    }
+
+    /// Clear the set. Keeps the allocated storage, except frame allocator storage from before the allocator's last reset, which is dropped.
+    void Clear()
+    {
+        if (IsStale())
+        {
+            DropStaleStorage();
+            return;
+        }
+
+        DestroyEntries();
+        ResetSlots();
+        size_ = 0;
+    }
+
+    /// Set a frame allocator for the storage, or null to use the heap. Clears the set. With an allocator, the set must be cleared before use after each reset of the allocator; the next insertion then reserves the previous capacity at once. The keys left in the set at a reset are never destroyed, so they must not own resources.
+    void SetAllocator(FrameAllocator* allocator)
+    {
+        Clear();
+        if (allocator != allocator_)
+        {
+            ReleaseStorage();
+            allocator_ = allocator;
+        }
+    }
+
+    /// Make room for at least the given number of keys.
+    void Reserve(unsigned size)
+    {
+        if (size > capacity_)
+            Rehash(CalculateNumSlots(size));
+    }
+
+    /// Return iterator to the key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned index = FindIndex(key, MakeHash(key));
+        return index != FLAT_HASH_EMPTY ? Iterator(Entries() + index) : End();
+    }
+
+    /// Return const iterator to the key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned index = FindIndex(key, MakeHash(key));
+        return index != FLAT_HASH_EMPTY ? ConstIterator(Entries() + index) : End();
+    }
+
+    /// Return whether contains a key.
+    bool Contains(const T& key) const { return FindIndex(key, MakeHash(key)) != FLAT_HASH_EMPTY; }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return Iterator(Entries()); }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(Entries()); }
+
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(Entries() + size_); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(Entries() + size_); }
+
+    /// Return first key.
+    const T& Front() const { return Entries()[0]; }
+
+    /// Return last key.
+    const T& Back() const { return Entries()[size_ - 1]; }
+
+private:
+    /// Return the entry array.
+    T* Entries() const { return reinterpret_cast<T*>(entries_); }
+
+    /// Return index of the key, or FLAT_HASH_EMPTY if not found.
+    unsigned FindIndex(const T& key, unsigned hash) const
+    {
+        if (!numSlots_)
+            return FLAT_HASH_EMPTY;
+
+        unsigned mask = numSlots_ - 1;
+        const T* entries = Entries();
+        for (unsigned pos = HomeSlot(hash); slots_[pos].index_ != FLAT_HASH_EMPTY; pos = (pos + 1) & mask)
+        {
+            if (slots_[pos].hash_ == hash && entries[slots_[pos].index_] == key)
+                return slots_[pos].index_;
+        }
+
+        return FLAT_HASH_EMPTY;
+    }
+
+    /// Erase the key referenced by a slot position. The last key is moved into its place.
+    void EraseEntry(unsigned pos)
+    {
+        unsigned index = slots_[pos].index_;
+        unsigned last = size_ - 1;
+        T* entries = Entries();
+
+        EraseSlot(pos);
+        if (index != last)
+        {
+            slots_[FindSlot(MakeHash(entries[last]), last)].index_ = index;
+            entries[index] = entries[last];
+        }
+        (entries + last)->~T();
+        --size_;
+    }
+
+    /// Destroy all keys.
+    void DestroyEntries()
+    {
+        T* entries = Entries();
+        for (unsigned i = 0; i < size_; ++i)
+            (entries + i)->~T();
+    }
+
+    /// Reallocate the key storage and rebuild the slot table.
+    void Rehash(unsigned numSlots)
+    {
+        unsigned capacity = numSlots - (numSlots >> 2);
+        unsigned char* newEntries = AllocateStorage(capacity * sizeof(T));
+
+        T* src = Entries();
+        T* dest = reinterpret_cast<T*>(newEntries);
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            new(dest + i) T(src[i]);
+            (src + i)->~T();
+        }
+
+        FreeStorage(entries_);
+        entries_ = newEntries;
+        capacity_ = capacity;
+
+        AllocateSlots(numSlots);
+        for (unsigned i = 0; i < size_; ++i)
+            InsertSlot(MakeHash(dest[i]), i);
+    }
+};
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator begin(const Urho3D::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator end(const Urho3D::FlatHashSet<T>& v) { return v.End(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::Iterator begin(Urho3D::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::Iterator end(Urho3D::FlatHashSet<T>& v) { return v.End(); }
+
+}
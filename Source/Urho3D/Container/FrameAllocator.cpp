@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/FrameAllocator.h"
+#include "../Math/MathDefs.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned MIN_FRAME_ALLOCATOR_BLOCK_SIZE = 64 * 1024;
+
+/// %Frame allocator memory block.
+struct FrameAllocatorBlock
+{
+    /// Size of the data.
+    unsigned size_;
+    /// Previous block.
+    FrameAllocatorBlock* previous_;
+    /// Data follows.
+};
+
+FrameAllocator::FrameAllocator(unsigned initialCapacity) :
+    block_(0),
+    offset_(0),
+    usedSize_(0),
+    capacity_(0),
+    generation_(0),
+    numBlockAllocations_(0)
+{
+    if (initialCapacity)
+        AllocateBlock(initialCapacity);
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    FreeBlocks();
+}
+
+void* FrameAllocator::Allocate(unsigned size, unsigned alignment)
+{
+    assert(alignment && !(alignment & (alignment - 1)));
+
+    unsigned char* data = block_ ? reinterpret_cast<unsigned char*>(block_ + 1) : 0;
+    unsigned padding = data ? (unsigned)((alignment - ((size_t)(data + offset_) & (alignment - 1))) & (alignment - 1)) : 0;
+
+    if (!block_ || offset_ + padding + size > block_->size_)
+    {
+        // Grow geometrically so that the number of blocks stays small before the next reset combines them
+        AllocateBlock(Max(Max(size + alignment, capacity_), MIN_FRAME_ALLOCATOR_BLOCK_SIZE));
+        data = reinterpret_cast<unsigned char*>(block_ + 1);
+        padding = (unsigned)((alignment - ((size_t)data & (alignment - 1))) & (alignment - 1));
+    }
+
+    void* ptr = data + offset_ + padding;
+    offset_ += padding + size;
+    usedSize_ += padding + size;
+    return ptr;
+}
+
+void FrameAllocator::Reset()
+{
+    // If the frame needed more than one block, replace them with a single block for the whole capacity
+    if (block_ && block_->previous_)
+    {
+        unsigned totalCapacity = capacity_;
+        FreeBlocks();
+        AllocateBlock(totalCapacity);
+    }
+
+    offset_ = 0;
+    usedSize_ = 0;
+    ++generation_;
+}
+
+void FrameAllocator::AllocateBlock(unsigned size)
+{
+    FrameAllocatorBlock* newBlock = reinterpret_cast<FrameAllocatorBlock*>(new unsigned char[sizeof(FrameAllocatorBlock) + size]);
+    newBlock->size_ = size;
+    newBlock->previous_ = block_;
+    RecordContainerAllocation();
+    ++numBlockAllocations_;
+
+    block_ = newBlock;
+    offset_ = 0;
+    capacity_ += size;
+}
+
+void FrameAllocator::FreeBlocks()
+{
+    while (block_)
+    {
+        FrameAllocatorBlock* previous = block_->previous_;
+        delete[] reinterpret_cast<unsigned char*>(block_);
+        block_ = previous;
+    }
+
+    capacity_ = 0;
+}
+
+}
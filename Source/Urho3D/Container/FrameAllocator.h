@@ -0,0 +1,304 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Allocator.h"
+#include "../Container/RefCounted.h"
+#include "../Container/VectorBase.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace Urho3D
+{
+
+struct FrameAllocatorBlock;
+
+/// Linear allocator for memory that only needs to live until the end of the frame. Allocation bumps a pointer and individual allocations are never freed; Reset() releases everything at once. Not thread-safe, so use one allocator per thread.
+class URHO3D_API FrameAllocator : public RefCounted
+{
+public:
+    /// Construct with optional initial capacity in bytes.
+    FrameAllocator(unsigned initialCapacity = 0);
+    /// Destruct. Free all blocks.
+    ~FrameAllocator();
+
+    /// Allocate memory which stays valid until the next reset. The alignment must be a power of two.
+    void* Allocate(unsigned size, unsigned alignment = 16);
+    /// Release all allocations. If the memory of the last frame was spread over several blocks, they are replaced with one block large enough to hold all of it, so that a steady state frame does not allocate.
+    void Reset();
+
+    /// Return bytes allocated since the last reset, including alignment padding.
+    unsigned GetUsedSize() const { return usedSize_; }
+    /// Return total capacity of the blocks.
+    unsigned GetCapacity() const { return capacity_; }
+    /// Return number of resets. Memory allocated before a reset must not be accessed after it.
+    unsigned GetGeneration() const { return generation_; }
+    /// Return number of heap allocations made for blocks.
+    unsigned GetNumBlockAllocations() const { return numBlockAllocations_; }
+
+private:
+    /// Prevent copy construction.
+    FrameAllocator(const FrameAllocator& rhs);
+    /// Prevent assignment.
+    FrameAllocator& operator =(const FrameAllocator& rhs);
+
+    /// Allocate a new block and make it current.
+    void AllocateBlock(unsigned size);
+    /// Free all blocks.
+    void FreeBlocks();
+
+    /// Current block. Older blocks are chained from it.
+    FrameAllocatorBlock* block_;
+    /// Allocation offset within the current block.
+    unsigned offset_;
+    /// Bytes allocated since the last reset.
+    unsigned usedSize_;
+    /// Total capacity of all blocks.
+    unsigned capacity_;
+    /// Number of resets.
+    unsigned generation_;
+    /// Number of heap allocations made for blocks.
+    unsigned numBlockAllocations_;
+};
+
+/// %Vector of POD elements whose buffer is allocated from a frame allocator. Clearing it drops the buffer without freeing, as the memory is reclaimed when the allocator is reset; it must be cleared before being refilled on a later frame. Without an allocator it falls back to the heap like PODVector.
+template <class T> class FrameVector
+{
+public:
+    typedef T ValueType;
+    typedef RandomAccessIterator<T> Iterator;
+    typedef RandomAccessConstIterator<T> ConstIterator;
+
+    /// Construct empty with an optional allocator.
+    FrameVector(FrameAllocator* allocator = 0) :
+        allocator_(allocator),
+        buffer_(0),
+        size_(0),
+        capacity_(0),
+        clearedCapacity_(0),
+        generation_(0)
+    {
+    }
+
+    /// Construct from another vector. The copy uses the same allocator.
+    FrameVector(const FrameVector<T>& vector) :
+        allocator_(vector.allocator_),
+        buffer_(0),
+        size_(0),
+        capacity_(0),
+        clearedCapacity_(0),
+        generation_(0)
+    {
+        *this = vector;
+    }
+
+    /// Destruct.
+    ~FrameVector()
+    {
+        Clear();
+    }
+
+    /// Assign from another vector. A vector whose frame allocator has been reset since counts as empty.
+    FrameVector<T>& operator =(const FrameVector<T>& rhs)
+    {
+        if (&rhs != this)
+        {
+            Clear();
+            if (rhs.IsStale())
+                return *this;
+            Reserve(rhs.size_);
+            if (rhs.size_)
+                memcpy(buffer_, rhs.buffer_, rhs.size_ * sizeof(T));
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    /// Return element at index.
+    T& operator [](unsigned index)
+    {
+        assert(index < size_);
+        return buffer_[index];
+    }
+
+    /// Return const element at index.
+    const T& operator [](unsigned index) const
+    {
+        assert(index < size_);
+        return buffer_[index];
+    }
+
+    /// Set the allocator. Clears the vector.
+    void SetAllocator(FrameAllocator* allocator)
+    {
+        Clear();
+        allocator_ = allocator;
+    }
+
+    /// Add an element at the end.
+    void Push(const T& value)
+    {
+        if (size_ == capacity_)
+            Grow(size_ + 1);
+        buffer_[size_++] = value;
+    }
+
+    /// Add another vector at the end.
+    void Push(const FrameVector<T>& vector)
+    {
+        if (vector.IsStale() || !vector.size_)
+            return;
+        if (size_ + vector.size_ > capacity_)
+            Grow(size_ + vector.size_);
+        memcpy(buffer_ + size_, vector.buffer_, vector.size_ * sizeof(T));
+        size_ += vector.size_;
+    }
+
+    /// Resize the vector. New elements are left uninitialized.
+    void Resize(unsigned newSize)
+    {
+        if (newSize > capacity_)
+            Grow(newSize);
+        size_ = newSize;
+    }
+
+    /// Reserve space for at least the given number of elements.
+    void Reserve(unsigned newCapacity)
+    {
+        if (newCapacity <= capacity_)
+            return;
+
+        // Memory from a previous frame may already be in use by someone else
+        assert(!allocator_ || !buffer_ || generation_ == allocator_->GetGeneration());
+
+        T* newBuffer;
+        if (allocator_)
+        {
+            newBuffer = static_cast<T*>(allocator_->Allocate((unsigned)(newCapacity * sizeof(T))));
+            generation_ = allocator_->GetGeneration();
+        }
+        else
+        {
+            newBuffer = reinterpret_cast<T*>(new unsigned char[newCapacity * sizeof(T)]);
+            RecordContainerAllocation();
+        }
+
+        if (size_)
+            memcpy(newBuffer, buffer_, size_ * sizeof(T));
+        if (!allocator_)
+            delete[] reinterpret_cast<unsigned char*>(buffer_);
+
+        buffer_ = newBuffer;
+        capacity_ = newCapacity;
+    }
+
+    /// Remove all elements and drop the buffer. With an allocator, the next growth reserves the dropped capacity at once, so that a vector refilled every frame reaches its size with one allocation.
+    void Clear()
+    {
+        if (capacity_ > clearedCapacity_)
+            clearedCapacity_ = capacity_;
+        if (!allocator_)
+            delete[] reinterpret_cast<unsigned char*>(buffer_);
+
+        buffer_ = 0;
+        size_ = 0;
+        capacity_ = 0;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return Iterator(buffer_); }
+
+    /// Return const iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(buffer_); }
+
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(buffer_ + size_); }
+
+    /// Return const iterator to the end.
+    ConstIterator End() const { return ConstIterator(buffer_ + size_); }
+
+    /// Return first element.
+    T& Front() { return buffer_[0]; }
+
+    /// Return const first element.
+    const T& Front() const { return buffer_[0]; }
+
+    /// Return last element.
+    T& Back()
+    {
+        assert(size_);
+        return buffer_[size_ - 1];
+    }
+
+    /// Return const last element.
+    const T& Back() const
+    {
+        assert(size_);
+        return buffer_[size_ - 1];
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+
+    /// Return capacity of vector.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return whether vector is empty.
+    bool Empty() const { return size_ == 0; }
+
+    /// Return the buffer.
+    T* Buffer() const { return buffer_; }
+
+    /// Return the allocator.
+    FrameAllocator* GetAllocator() const { return allocator_; }
+
+    /// Return whether the buffer came from the allocator before its last reset and must not be accessed.
+    bool IsStale() const { return allocator_ && buffer_ && generation_ != allocator_->GetGeneration(); }
+
+private:
+    /// Grow the capacity to hold at least the given number of elements.
+    void Grow(unsigned minCapacity)
+    {
+        unsigned newCapacity = capacity_ ? capacity_ + ((capacity_ + 1) >> 1) : 4;
+        if (allocator_ && clearedCapacity_ > newCapacity)
+            newCapacity = clearedCapacity_;
+        Reserve(newCapacity > minCapacity ? newCapacity : minCapacity);
+    }
+
+    /// Allocator, or null to use the heap.
+    FrameAllocator* allocator_;
+    /// Buffer.
+    T* buffer_;
+    /// Number of elements.
+    unsigned size_;
+    /// Buffer capacity.
+    unsigned capacity_;
+    /// Largest capacity dropped by Clear(), reserved at once on the next growth when using an allocator.
+    unsigned clearedCapacity_;
+    /// Allocator generation when the buffer was allocated.
+    unsigned generation_;
+};
+
+}
@@ -33,6 +33,7 @@ void HashBase::AllocateBuckets(unsigned size, unsigned numBuckets)
         delete[] ptrs_;
 
     HashNodeBase** ptrs = new HashNodeBase* [numBuckets + 2];
+    RecordContainerAllocation();
     unsigned* data = reinterpret_cast<unsigned*>(ptrs);
     data[0] = size;
     data[1] = numBuckets;
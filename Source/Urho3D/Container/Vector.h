@@ -340,7 +340,7 @@ public:
         Iterator i = Find(value);
         if (i != End())
         {
-            EraseSwap(i);
+            EraseSwap((unsigned)(i - Begin()));
             return true;
         }
         else
@@ -908,7 +908,7 @@ public:
         Iterator i = Find(value);
         if (i != End())
         {
-            EraseSwap(i);
+            EraseSwap((unsigned)(i - Begin()));
             return true;
         }
         else
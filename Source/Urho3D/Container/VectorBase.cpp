@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Allocator.h"
 #include "../Container/VectorBase.h"
 
 #include "../DebugNew.h"
@@ -31,6 +32,7 @@ namespace Urho3D
 
 unsigned char* VectorBase::AllocateBuffer(unsigned size)
 {
+    RecordContainerAllocation();
     return new unsigned char[size];
 }
 
@@ -51,6 +51,48 @@ static const unsigned AM_FILEREADONLY = 0x81;
 
 class Serializable;
 
+/// Network quantization of a float, vector or quaternion attribute. Components are sent bit-packed with the given amount of
+/// bits instead of full precision floats. Quaternions use the smallest three components, so the range is not used for them.
+struct AttributeQuantization
+{
+    /// Construct as disabled.
+    AttributeQuantization() :
+        min_(0.0f),
+        max_(0.0f),
+        bits_(0)
+    {
+    }
+
+    /// Construct with component range and bits per component.
+    AttributeQuantization(float minValue, float maxValue, unsigned bits) :
+        min_(minValue),
+        max_(maxValue),
+        bits_(bits)
+    {
+    }
+
+    /// Construct with bits per component only. Used for quaternions.
+    explicit AttributeQuantization(unsigned bits) :
+        min_(-1.0f),
+        max_(1.0f),
+        bits_(bits)
+    {
+    }
+
+    /// Return whether quantization is used.
+    bool IsEnabled() const { return bits_ != 0; }
+
+    /// Minimum component value.
+    float min_;
+    /// Maximum component value.
+    float max_;
+    /// Bits per component, 0 for full precision.
+    unsigned bits_;
+};
+
+/// Maximum bits per component in attribute quantization.
+static const unsigned MAX_QUANTIZATION_BITS = 24;
+
 /// Abstract base class for invoking attribute accessors.
 class URHO3D_API AttributeAccessor : public RefCounted
 {
@@ -162,6 +204,8 @@ struct AttributeInfo
     unsigned mode_;
     /// Attribute data pointer if elsewhere than in the Serializable.
     void* ptr_;
+    /// Network quantization.
+    AttributeQuantization quantization_;
 };
 
 }
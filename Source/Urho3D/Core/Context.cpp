@@ -104,6 +104,25 @@ void RemoveNamedAttribute(HashMap<StringHash, Vector<AttributeInfo> >& attribute
         attributes.Erase(i);
 }
 
+void SetNamedAttributeQuantization(HashMap<StringHash, Vector<AttributeInfo> >& attributes, StringHash objectType, const char* name,
+    const AttributeQuantization& quantization)
+{
+    HashMap<StringHash, Vector<AttributeInfo> >::Iterator i = attributes.Find(objectType);
+    if (i == attributes.End())
+        return;
+
+    Vector<AttributeInfo>& infos = i->second_;
+
+    for (Vector<AttributeInfo>::Iterator j = infos.Begin(); j != infos.End(); ++j)
+    {
+        if (!j->name_.Compare(name, true))
+        {
+            j->quantization_ = quantization;
+            break;
+        }
+    }
+}
+
 Context::Context() :
     eventHandler_(0)
 {
@@ -133,6 +152,14 @@ Context::~Context()
     for (PODVector<VariantMap*>::Iterator i = eventDataMaps_.Begin(); i != eventDataMaps_.End(); ++i)
         delete *i;
     eventDataMaps_.Clear();
+
+    for (PODVector<VariantMap*>::Iterator i = emptyEventDataMaps_.Begin(); i != emptyEventDataMaps_.End(); ++i)
+        delete *i;
+    emptyEventDataMaps_.Clear();
+
+    for (PODVector<FlatHashSet<Object*>*>::Iterator i = processedEventReceivers_.Begin(); i != processedEventReceivers_.End(); ++i)
+        delete *i;
+    processedEventReceivers_.Clear();
 }
 
 SharedPtr<Object> Context::CreateObject(StringHash objectType)
@@ -206,6 +233,31 @@ void Context::UpdateAttributeDefaultValue(StringHash objectType, const char* nam
         info->defaultValue_ = defaultValue;
 }
 
+void Context::SetAttributeQuantization(StringHash objectType, const char* name, const AttributeQuantization& quantization)
+{
+    AttributeInfo* info = GetAttribute(objectType, name);
+    if (!info)
+        return;
+
+    if (quantization.IsEnabled())
+    {
+        if (info->type_ != VAR_FLOAT && info->type_ != VAR_VECTOR2 && info->type_ != VAR_VECTOR3 && info->type_ != VAR_VECTOR4 &&
+            info->type_ != VAR_QUATERNION)
+        {
+            URHO3D_LOGERROR("Can not quantize attribute " + String(name) + " of type " + Variant::GetTypeName(info->type_));
+            return;
+        }
+        if (quantization.bits_ > MAX_QUANTIZATION_BITS || (info->type_ != VAR_QUATERNION && quantization.max_ <= quantization.min_))
+        {
+            URHO3D_LOGERROR("Invalid quantization for attribute " + String(name));
+            return;
+        }
+    }
+
+    SetNamedAttributeQuantization(attributes_, objectType, name, quantization);
+    SetNamedAttributeQuantization(networkAttributes_, objectType, name, quantization);
+}
+
 VariantMap& Context::GetEventDataMap()
 {
     unsigned nestingLevel = eventSenders_.Size();
@@ -358,10 +410,10 @@ void Context::AddEventReceiver(Object* receiver, Object* sender, StringHash even
 
 void Context::RemoveEventSender(Object* sender)
 {
-    HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
+    HashMap<Object*, FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
     if (i != specificEventReceivers_.End())
     {
-        for (HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+        for (FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
         {
             for (PODVector<Object*>::Iterator k = j->second_->receivers_.Begin(); k != j->second_->receivers_.End(); ++k)
             {
@@ -402,7 +454,7 @@ void Context::BeginSendEvent(Object* sender, StringHash eventType)
     eventSenders_.Push(sender);
 }
 
-void Context::EndSendEvent()
+void Context::EndSendEvent(StringHash eventType, unsigned numHandlers)
 {
     eventSenders_.Pop();
 
@@ -411,9 +463,35 @@ void Context::EndSendEvent()
     {
         EventProfiler* eventProfiler = GetSubsystem<EventProfiler>();
         if (eventProfiler)
+        {
+            eventProfiler->CountDispatch(eventType, numHandlers);
             eventProfiler->EndBlock();
+        }
     }
 #endif
 }
 
+FlatHashSet<Object*>& Context::GetProcessedEventReceivers()
+{
+    // Called after BeginSendEvent(), so the current nesting level is one less than the sender stack size
+    unsigned nestingLevel = eventSenders_.Size() - 1;
+    while (processedEventReceivers_.Size() < nestingLevel + 1)
+        processedEventReceivers_.Push(new FlatHashSet<Object*>());
+
+    FlatHashSet<Object*>& ret = *processedEventReceivers_[nestingLevel];
+    ret.Clear();
+    return ret;
+}
+
+VariantMap& Context::GetEmptyEventDataMap()
+{
+    unsigned nestingLevel = eventSenders_.Size();
+    while (emptyEventDataMaps_.Size() < nestingLevel + 1)
+        emptyEventDataMaps_.Push(new VariantMap());
+
+    VariantMap& ret = *emptyEventDataMaps_[nestingLevel];
+    ret.Clear();
+    return ret;
+}
+
 }
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
+#include "../Container/FlatHashSet.h"
 #include "../Container/HashSet.h"
 #include "../Core/Attribute.h"
 #include "../Core/Object.h"
@@ -94,6 +96,8 @@ public:
     void RemoveAttribute(StringHash objectType, const char* name);
     /// Update object attribute's default value.
     void UpdateAttributeDefaultValue(StringHash objectType, const char* name, const Variant& defaultValue);
+    /// Set object attribute's network quantization. Must be set identically on the server and the clients.
+    void SetAttributeQuantization(StringHash objectType, const char* name, const AttributeQuantization& quantization);
     /// Return a preallocated map for event data. Used for optimization to avoid constant re-allocation of event data maps.
     VariantMap& GetEventDataMap();
     /// Initialises the specified SDL systems, if not already. Returns true if successful. This call must be matched with ReleaseSDL() when SDL functions are no longer required, even if this call fails.
@@ -117,6 +121,8 @@ public:
     template <class T, class U> void CopyBaseAttributes();
     /// Template version of updating an object attribute's default value.
     template <class T> void UpdateAttributeDefaultValue(const char* name, const Variant& defaultValue);
+    /// Template version of setting an object attribute's network quantization.
+    template <class T> void SetAttributeQuantization(const char* name, const AttributeQuantization& quantization);
 
     /// Return subsystem by type.
     Object* GetSubsystem(StringHash type) const;
@@ -174,10 +180,10 @@ public:
     /// Return event receivers for a sender and event type, or null if they do not exist.
     EventReceiverGroup* GetEventReceivers(Object* sender, StringHash eventType)
     {
-        HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
+        HashMap<Object*, FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
         if (i != specificEventReceivers_.End())
         {
-            HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Find(eventType);
+            FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Find(eventType);
             return j != i->second_.End() ? j->second_ : (EventReceiverGroup*)0;
         }
         else
@@ -187,7 +193,7 @@ public:
     /// Return event receivers for an event type, or null if they do not exist.
     EventReceiverGroup* GetEventReceivers(StringHash eventType)
     {
-        HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator i = eventReceivers_.Find(eventType);
+        FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator i = eventReceivers_.Find(eventType);
         return i != eventReceivers_.End() ? i->second_ : (EventReceiverGroup*)0;
     }
 
@@ -204,8 +210,12 @@ private:
     void RemoveEventReceiver(Object* receiver, StringHash eventType);
     /// Begin event send.
     void BeginSendEvent(Object* sender, StringHash eventType);
-    /// End event send. Clean up event receivers removed in the meanwhile.
-    void EndSendEvent();
+    /// End event send with the number of handlers the event was dispatched to. Clean up event receivers removed in the meanwhile.
+    void EndSendEvent(StringHash eventType, unsigned numHandlers);
+    /// Return a cleared set for the receivers already processed by the event send of the current nesting level. Called by Object.
+    FlatHashSet<Object*>& GetProcessedEventReceivers();
+    /// Return a cleared map for the parameters of an event sent without them. Separate from the preallocated event data maps, so that a map already filled by the caller is not cleared. Called by Object.
+    VariantMap& GetEmptyEventDataMap();
 
     /// Set current event handler. Called by Object.
     void SetEventHandler(EventHandler* handler) { eventHandler_ = handler; }
@@ -219,13 +229,17 @@ private:
     /// Network replication attribute descriptions per object type.
     HashMap<StringHash, Vector<AttributeInfo> > networkAttributes_;
     /// Event receivers for non-specific events.
-    HashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
-    /// Event receivers for specific senders' events.
-    HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
+    FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
+    /// Event receivers for specific senders' events. The outer map stays node-based so that erasing a sender does not move the other senders' maps.
+    HashMap<Object*, FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
     /// Event sender stack.
     PODVector<Object*> eventSenders_;
     /// Event data stack.
     PODVector<VariantMap*> eventDataMaps_;
+    /// Event data maps for events sent without parameters per nesting level.
+    PODVector<VariantMap*> emptyEventDataMaps_;
+    /// Processed event receiver sets per nesting level, reused to avoid allocating during event send.
+    PODVector<FlatHashSet<Object*>*> processedEventReceivers_;
     /// Active event handler. Not stored in a stack for performance reasons; is needed only in esoteric cases.
     EventHandler* eventHandler_;
     /// Object categories.
@@ -258,4 +272,9 @@ template <class T> void Context::UpdateAttributeDefaultValue(const char* name, c
     UpdateAttributeDefaultValue(T::GetTypeStatic(), name, defaultValue);
 }
 
+template <class T> void Context::SetAttributeQuantization(const char* name, const AttributeQuantization& quantization)
+{
+    SetAttributeQuantization(T::GetTypeStatic(), name, quantization);
+}
+
 }
@@ -58,6 +58,26 @@ URHO3D_EVENT(E_POSTRENDERUPDATE, PostRenderUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed payload of the application-wide update events (E_UPDATE, E_POSTUPDATE, E_RENDERUPDATE and E_POSTRENDERUPDATE.)
+struct UpdateEventData
+{
+    URHO3D_EVENT_PAYLOAD(UpdateEventData)
+
+    /// Construct.
+    UpdateEventData(float timeStep = 0.0f) :
+        timeStep_(timeStep)
+    {
+    }
+
+    /// Copy parameters to a VariantMap.
+    void ToVariantMap(VariantMap& eventData) const { eventData[Update::P_TIMESTEP] = timeStep_; }
+    /// Copy parameters from a VariantMap.
+    void FromVariantMap(VariantMap& eventData) { timeStep_ = eventData[Update::P_TIMESTEP].GetFloat(); }
+
+    /// Timestep.
+    float timeStep_;
+};
+
 /// Frame end event.
 URHO3D_EVENT(E_ENDFRAME, EndFrame)
 {
@@ -22,8 +22,11 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
 #include "../Core/EventProfiler.h"
 
+#include <cstdio>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -31,6 +34,11 @@ namespace Urho3D
 
 bool EventProfiler::active = false;
 
+static bool CompareDispatchCounts(const Pair<StringHash, EventDispatchCount>& lhs, const Pair<StringHash, EventDispatchCount>& rhs)
+{
+    return lhs.second_.sends_ > rhs.second_.sends_;
+}
+
 EventProfiler::EventProfiler(Context* context) :
     Profiler(context)
 {
@@ -42,4 +50,28 @@ EventProfiler::EventProfiler(Context* context) :
     memcpy(root_->name_, "RunFrame", sizeof("RunFrame"));
 }
 
+String EventProfiler::PrintDispatchCounts(unsigned maxEventTypes) const
+{
+    static const int LINE_MAX_LENGTH = 256;
+
+    Vector<Pair<StringHash, EventDispatchCount> > counts;
+    counts.Reserve(dispatchCounts_.Size());
+    for (FlatHashMap<StringHash, EventDispatchCount>::ConstIterator i = dispatchCounts_.Begin(); i != dispatchCounts_.End(); ++i)
+        counts.Push(MakePair(i->first_, i->second_));
+    Sort(counts.Begin(), counts.End(), CompareDispatchCounts);
+
+    String output = "Event                              Sends   Handlers\n\n";
+    char line[LINE_MAX_LENGTH];
+
+    for (unsigned i = 0; i < counts.Size() && i < maxEventTypes; ++i)
+    {
+        const String& name = EventNameRegistrar::GetEventName(counts[i].first_);
+        sprintf(line, "%-30s %9u %10u\n", name.Empty() ? counts[i].first_.ToString().CString() : name.CString(),
+            counts[i].second_.sends_, counts[i].second_.handlers_);
+        output.Append(line);
+    }
+
+    return output;
+}
+
 }
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Core/Profiler.h"
 
 namespace Urho3D
@@ -58,6 +59,22 @@ public:
     StringHash eventID_;
 };
 
+/// Dispatch counts of one event type.
+struct EventDispatchCount
+{
+    /// Construct.
+    EventDispatchCount() :
+        sends_(0),
+        handlers_(0)
+    {
+    }
+
+    /// Number of times the event was sent.
+    unsigned sends_;
+    /// Number of event handler invocations.
+    unsigned handlers_;
+};
+
 /// Hierarchical performance event profiler subsystem.
 class URHO3D_API EventProfiler : public Profiler
 {
@@ -83,7 +100,28 @@ public:
         current_->Begin();
     }
 
+    /// Count a send of an event and the number of handlers it was dispatched to. Called by Context.
+    void CountDispatch(StringHash eventID, unsigned numHandlers)
+    {
+        if (!Thread::IsMainThread())
+            return;
+
+        EventDispatchCount& count = dispatchCounts_[eventID];
+        ++count.sends_;
+        count.handlers_ += numHandlers;
+    }
+
+    /// Reset the dispatch counts.
+    void ResetDispatchCounts() { dispatchCounts_.Clear(); }
+    /// Return dispatch counts by event type since the last reset.
+    const FlatHashMap<StringHash, EventDispatchCount>& GetDispatchCounts() const { return dispatchCounts_; }
+    /// Return the dispatch counts as text, most sent event types first.
+    String PrintDispatchCounts(unsigned maxEventTypes = M_MAX_UNSIGNED) const;
+
 private:
+    /// Dispatch counts by event type.
+    FlatHashMap<StringHash, EventDispatchCount> dispatchCounts_;
+
     /// Profiler active. Default false.
     static bool active;
 };
@@ -87,38 +87,11 @@ void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData
 {
     // Make a copy of the context pointer in case the object is destroyed during event handler invocation
     Context* context = context_;
-    EventHandler* specific = 0;
-    EventHandler* nonSpecific = 0;
-
-    EventHandler* handler = eventHandlers_.First();
-    while (handler)
-    {
-        if (handler->GetEventType() == eventType)
-        {
-            if (!handler->GetSender())
-                nonSpecific = handler;
-            else if (handler->GetSender() == sender)
-            {
-                specific = handler;
-                break;
-            }
-        }
-        handler = eventHandlers_.Next(handler);
-    }
-
-    // Specific event handlers have priority, so if found, invoke first
-    if (specific)
-    {
-        context->SetEventHandler(specific);
-        specific->Invoke(eventData);
-        context->SetEventHandler(0);
-        return;
-    }
-
-    if (nonSpecific)
+    EventHandler* handler = FindInvokedEventHandler(sender, eventType);
+    if (handler)
     {
-        context->SetEventHandler(nonSpecific);
-        nonSpecific->Invoke(eventData);
+        context->SetEventHandler(handler);
+        handler->Invoke(eventData);
         context->SetEventHandler(0);
     }
 }
@@ -288,12 +261,24 @@ void Object::UnsubscribeFromAllEventsExcept(const PODVector<StringHash>& excepti
 
 void Object::SendEvent(StringHash eventType)
 {
-    VariantMap noEventData;
+    if (!Thread::IsMainThread())
+    {
+        URHO3D_LOGERROR("Sending events is only supported from the main thread");
+        return;
+    }
 
-    SendEvent(eventType, noEventData);
+    // Use a preallocated empty map of the current nesting level instead of constructing one. Not the event data map,
+    // which the caller may have filled for an event it is about to send
+    SendEvent(eventType, context_->GetEmptyEventDataMap());
 }
 
 void Object::SendEvent(StringHash eventType, VariantMap& eventData)
+{
+    EventPayload payload(eventData);
+    SendEventPayload(eventType, payload);
+}
+
+void Object::SendEventPayload(StringHash eventType, EventPayload& payload)
 {
     if (!Thread::IsMainThread())
     {
@@ -301,10 +286,17 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
         return;
     }
 
+    // A typed payload uses a preallocated empty map of the current nesting level for VariantMap handlers. Not the event
+    // data map, which the caller may have filled for an event it is about to send
+    if (!payload.eventData_)
+        payload.eventData_ = &context_->GetEmptyEventDataMap();
+
     // Make a weak pointer to self to check for destruction during event handling
     WeakPtr<Object> self(this);
     Context* context = context_;
-    HashSet<Object*> processed;
+    // Set of specific receivers, reused per nesting level to avoid allocation. Acquired only if there are specific receivers
+    FlatHashSet<Object*>* processed = 0;
+    unsigned numHandlers = 0;
 
     context->BeginSendEvent(this, eventType);
 
@@ -314,6 +306,7 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     if (group)
     {
         group->BeginSendEvent();
+        processed = &context->GetProcessedEventReceivers();
 
         for (unsigned i = 0; i < group->receivers_.Size(); ++i)
         {
@@ -322,17 +315,18 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             if (!receiver)
                 continue;
 
-            receiver->OnEvent(this, eventType, eventData);
+            receiver->OnEventPayload(this, eventType, payload);
+            ++numHandlers;
 
             // If self has been destroyed as a result of event handling, exit
             if (self.Expired())
             {
                 group->EndSendEvent();
-                context->EndSendEvent();
+                context->EndSendEvent(eventType, numHandlers);
                 return;
             }
 
-            processed.Insert(receiver);
+            processed->Insert(receiver);
         }
 
         group->EndSendEvent();
@@ -344,7 +338,7 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     {
         group->BeginSendEvent();
 
-        if (processed.Empty())
+        if (!processed || processed->Empty())
         {
             for (unsigned i = 0; i < group->receivers_.Size(); ++i)
             {
@@ -352,12 +346,13 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
                 if (!receiver)
                     continue;
 
-                receiver->OnEvent(this, eventType, eventData);
+                receiver->OnEventPayload(this, eventType, payload);
+                ++numHandlers;
 
                 if (self.Expired())
                 {
                     group->EndSendEvent();
-                    context->EndSendEvent();
+                    context->EndSendEvent(eventType, numHandlers);
                     return;
                 }
             }
@@ -368,15 +363,16 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             for (unsigned i = 0; i < group->receivers_.Size(); ++i)
             {
                 Object* receiver = group->receivers_[i];
-                if (!receiver || processed.Contains(receiver))
+                if (!receiver || processed->Contains(receiver))
                     continue;
 
-                receiver->OnEvent(this, eventType, eventData);
+                receiver->OnEventPayload(this, eventType, payload);
+                ++numHandlers;
 
                 if (self.Expired())
                 {
                     group->EndSendEvent();
-                    context->EndSendEvent();
+                    context->EndSendEvent(eventType, numHandlers);
                     return;
                 }
             }
@@ -385,7 +381,28 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
         group->EndSendEvent();
     }
 
-    context->EndSendEvent();
+    context->EndSendEvent(eventType, numHandlers);
+}
+
+void Object::OnEventPayload(Object* sender, StringHash eventType, EventPayload& payload)
+{
+    // A typed payload goes directly to a typed handler of the same payload type
+    if (payload.IsTyped())
+    {
+        Context* context = context_;
+        EventHandler* handler = FindInvokedEventHandler(sender, eventType);
+        if (handler && handler->AcceptsPayload(payload))
+        {
+            context->SetEventHandler(handler);
+            handler->InvokeWithPayload(payload);
+            context->SetEventHandler(0);
+            return;
+        }
+    }
+
+    // Otherwise go through OnEvent() with the parameters in the VariantMap, so that subclasses overriding it still receive
+    // them. Modifications are copied back to a typed payload when it is next accessed
+    OnEvent(sender, eventType, payload.GetEventData());
 }
 
 VariantMap& Object::GetEventDataMap() const
@@ -502,6 +519,26 @@ EventHandler* Object::FindSpecificEventHandler(Object* sender, StringHash eventT
     return 0;
 }
 
+EventHandler* Object::FindInvokedEventHandler(Object* sender, StringHash eventType) const
+{
+    EventHandler* nonSpecific = 0;
+
+    EventHandler* handler = eventHandlers_.First();
+    while (handler)
+    {
+        if (handler->GetEventType() == eventType)
+        {
+            if (!handler->GetSender())
+                nonSpecific = handler;
+            else if (handler->GetSender() == sender)
+                return handler;
+        }
+        handler = eventHandlers_.Next(handler);
+    }
+
+    return nonSpecific;
+}
+
 void Object::RemoveEventSender(Object* sender)
 {
     EventHandler* handler = eventHandlers_.First();
@@ -33,6 +33,7 @@ namespace Urho3D
 
 class Context;
 class EventHandler;
+class EventPayload;
 
 /// Type info.
 class URHO3D_API TypeInfo
@@ -130,6 +131,8 @@ public:
     void SendEvent(StringHash eventType);
     /// Send event with parameters to all subscribers.
     void SendEvent(StringHash eventType, VariantMap& eventData);
+    /// Send event with a typed payload to all subscribers. Typed handlers receive the payload directly, other handlers receive its parameters in a VariantMap.
+    template <class T> void SendTypedEvent(StringHash eventType, T& payload);
     /// Return a preallocated map for event data. Used for optimization to avoid constant re-allocation of event data maps.
     VariantMap& GetEventDataMap() const;
 #if URHO3D_CXX11
@@ -178,8 +181,14 @@ private:
     EventHandler* FindSpecificEventHandler(Object* sender, EventHandler** previous = 0) const;
     /// Find the first event handler with specific sender and event type.
     EventHandler* FindSpecificEventHandler(Object* sender, StringHash eventType, EventHandler** previous = 0) const;
+    /// Find the event handler to invoke for an event from a sender. Specific event handlers have priority.
+    EventHandler* FindInvokedEventHandler(Object* sender, StringHash eventType) const;
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
+    /// Send an event with either VariantMap or typed parameters to all subscribers.
+    void SendEventPayload(StringHash eventType, EventPayload& payload);
+    /// Handle an event with either VariantMap or typed parameters.
+    void OnEventPayload(Object* sender, StringHash eventType, EventPayload& payload);
 
     /// Event handlers. Sender is null for non-specific handlers.
     LinkedList<EventHandler> eventHandlers_;
@@ -187,6 +196,95 @@ private:
 
 template <class T> T* Object::GetSubsystem() const { return static_cast<T*>(GetSubsystem(T::GetTypeStatic())); }
 
+/// Declare a typed event payload struct. The struct must be default constructible and define ToVariantMap(VariantMap&) const and FromVariantMap(VariantMap&), which exchange its parameters with VariantMap event handlers such as script.
+#define URHO3D_EVENT_PAYLOAD(typeName) \
+    public: \
+        static Urho3D::StringHash GetPayloadTypeStatic() { static const Urho3D::StringHash payloadTypeStatic(#typeName); return payloadTypeStatic; } \
+
+/// Parameters of an event being sent: either a VariantMap, or a typed payload which is copied to a VariantMap only when a VariantMap handler needs it.
+class URHO3D_API EventPayload
+{
+    friend class Object;
+
+public:
+    /// Construct for VariantMap parameters.
+    explicit EventPayload(VariantMap& eventData) :
+        payload_(0),
+        toVariantMap_(0),
+        fromVariantMap_(0),
+        eventData_(&eventData),
+        eventDataCurrent_(true)
+    {
+    }
+
+    /// Construct for a typed payload.
+    template <class T> explicit EventPayload(T& payload) :
+        payload_(&payload),
+        payloadType_(T::GetPayloadTypeStatic()),
+        toVariantMap_(&PayloadToVariantMap<T>),
+        fromVariantMap_(&PayloadFromVariantMap<T>),
+        eventData_(0),
+        eventDataCurrent_(false)
+    {
+    }
+
+    /// Return the typed payload if it is of the specified type, or null otherwise. Copies back parameters modified by VariantMap handlers.
+    template <class T> T* GetPayload()
+    {
+        if (!payload_ || payloadType_ != T::GetPayloadTypeStatic())
+            return 0;
+        if (eventDataCurrent_)
+        {
+            fromVariantMap_(payload_, *eventData_);
+            eventDataCurrent_ = false;
+        }
+        return static_cast<T*>(payload_);
+    }
+
+    /// Return the parameters as a VariantMap. Copies parameters from the typed payload if it may have been modified since.
+    VariantMap& GetEventData()
+    {
+        if (!eventDataCurrent_)
+        {
+            toVariantMap_(payload_, *eventData_);
+            eventDataCurrent_ = true;
+        }
+        return *eventData_;
+    }
+
+    /// Return whether has a typed payload.
+    bool IsTyped() const { return payload_ != 0; }
+    /// Return the typed payload type. Zero for VariantMap parameters.
+    StringHash GetPayloadType() const { return payloadType_; }
+
+private:
+    /// Copy typed payload parameters to a VariantMap.
+    template <class T> static void PayloadToVariantMap(void* payload, VariantMap& eventData) { static_cast<T*>(payload)->ToVariantMap(eventData); }
+    /// Copy typed payload parameters from a VariantMap.
+    template <class T> static void PayloadFromVariantMap(void* payload, VariantMap& eventData) { static_cast<T*>(payload)->FromVariantMap(eventData); }
+
+    /// Typed payload. Null for VariantMap parameters.
+    void* payload_;
+    /// Typed payload type.
+    StringHash payloadType_;
+    /// Typed payload to VariantMap copy function.
+    void (*toVariantMap_)(void*, VariantMap&);
+    /// Typed payload from VariantMap copy function.
+    void (*fromVariantMap_)(void*, VariantMap&);
+    /// VariantMap parameters.
+    VariantMap* eventData_;
+    /// Whether the VariantMap holds the most recent parameters.
+    bool eventDataCurrent_;
+};
+
+template <class T> void Object::SendTypedEvent(StringHash eventType, T& payload)
+{
+    EventPayload eventPayload(payload);
+    SendEventPayload(eventType, eventPayload);
+    // Copy back parameters modified by VariantMap handlers
+    eventPayload.GetPayload<T>();
+}
+
 /// Base class for object factories.
 class URHO3D_API ObjectFactory : public RefCounted
 {
@@ -259,6 +357,10 @@ public:
 
     /// Invoke event handler function.
     virtual void Invoke(VariantMap& eventData) = 0;
+    /// Invoke event handler function with either VariantMap or typed parameters. By default passes them as a VariantMap.
+    virtual void InvokeWithPayload(EventPayload& payload) { Invoke(payload.GetEventData()); }
+    /// Return whether takes the typed payload directly.
+    virtual bool AcceptsPayload(const EventPayload& payload) const { return false; }
     /// Return a unique copy of the event handler.
     virtual EventHandler* Clone() const = 0;
 
@@ -318,6 +420,61 @@ private:
     HandlerFunctionPtr function_;
 };
 
+/// Template implementation of the event handler invoke helper for a typed event payload (stores a function pointer of specific class.)
+template <class T, class P> class TypedEventHandlerImpl : public EventHandler
+{
+public:
+    typedef void (T::*HandlerFunctionPtr)(StringHash, P&);
+
+    /// Construct with receiver and function pointers and userdata.
+    TypedEventHandlerImpl(T* receiver, HandlerFunctionPtr function, void* userData = 0) :
+        EventHandler(receiver, userData),
+        function_(function)
+    {
+        assert(receiver_);
+        assert(function_);
+    }
+
+    /// Invoke event handler function with parameters converted from a VariantMap, and copy them back afterward.
+    virtual void Invoke(VariantMap& eventData)
+    {
+        P payload;
+        payload.FromVariantMap(eventData);
+        T* receiver = static_cast<T*>(receiver_);
+        (receiver->*function_)(eventType_, payload);
+        payload.ToVariantMap(eventData);
+    }
+
+    /// Invoke event handler function. Uses the typed payload directly if it is of the expected type.
+    virtual void InvokeWithPayload(EventPayload& payload)
+    {
+        P* typedPayload = payload.GetPayload<P>();
+        if (typedPayload)
+        {
+            T* receiver = static_cast<T*>(receiver_);
+            (receiver->*function_)(eventType_, *typedPayload);
+        }
+        else
+            Invoke(payload.GetEventData());
+    }
+
+    /// Return whether takes the typed payload directly.
+    virtual bool AcceptsPayload(const EventPayload& payload) const
+    {
+        return payload.IsTyped() && payload.GetPayloadType() == P::GetPayloadTypeStatic();
+    }
+
+    /// Return a unique copy of the event handler.
+    virtual EventHandler* Clone() const
+    {
+        return new TypedEventHandlerImpl(static_cast<T*>(receiver_), function_, userData_);
+    }
+
+private:
+    /// Class-specific pointer to handler function.
+    HandlerFunctionPtr function_;
+};
+
 #if URHO3D_CXX11
 /// Template implementation of the event handler invoke helper (std::function instance).
 class EventHandler11Impl : public EventHandler
@@ -368,5 +525,7 @@ struct URHO3D_API EventNameRegistrar
 #define URHO3D_HANDLER(className, function) (new Urho3D::EventHandlerImpl<className>(this, &className::function))
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function, and also defines a userdata pointer.
 #define URHO3D_HANDLER_USERDATA(className, function, userData) (new Urho3D::EventHandlerImpl<className>(this, &className::function, userData))
+/// Convenience macro to construct an EventHandler that points to a receiver object and its member function taking a typed event payload.
+#define URHO3D_TYPED_HANDLER(className, payloadName, function) (new Urho3D::TypedEventHandlerImpl<className, payloadName>(this, &className::function))
 
 }
@@ -0,0 +1,201 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+
+namespace Urho3D
+{
+
+/// Minimum duration in microseconds that a parallel loop chunk should take, so that the work item overhead stays small.
+static const float PARALLEL_FOR_MIN_CHUNK_USEC = 20.0f;
+/// Maximum number of chunks per thread in a parallel loop. More than one allows load balancing when item costs vary.
+static const unsigned PARALLEL_FOR_CHUNKS_PER_THREAD = 4;
+
+/// Measured cost of a parallel loop body, kept separately for each body type.
+template <class Function> struct ParallelForCost
+{
+    /// Smoothed cost of one item in microseconds, including the scheduling overhead. Zero until measured.
+    static float usecPerItem_;
+    /// Chunk execution time in microseconds per thread, accumulated by asynchronous loops until the next asynchronous loop of the same body type.
+    static PODVector<long long> asyncUSec_;
+    /// Processed items per thread, accumulated by asynchronous loops until the next asynchronous loop of the same body type.
+    static PODVector<unsigned> asyncItems_;
+};
+
+template <class Function> float ParallelForCost<Function>::usecPerItem_ = 0.0f;
+template <class Function> PODVector<long long> ParallelForCost<Function>::asyncUSec_;
+template <class Function> PODVector<unsigned> ParallelForCost<Function>::asyncItems_;
+
+/// Body wrapper for parallel reduction, which passes each thread's own partial result to the actual body.
+template <class T, class Result, class Function> struct ParallelReduceBody
+{
+    /// Construct.
+    ParallelReduceBody(Function& function, Vector<Result>& partials) :
+        function_(function),
+        partials_(partials)
+    {
+    }
+
+    /// Process a chunk.
+    void operator ()(T* start, T* end, unsigned threadIndex) { function_(start, end, partials_[threadIndex]); }
+
+    /// Actual loop body.
+    Function& function_;
+    /// Per-thread partial results.
+    Vector<Result>& partials_;
+};
+
+/// Work function for parallel loop chunks. The aux pointer points to the loop body.
+template <class T, class Function> void ParallelForWork(const WorkItem* item, unsigned threadIndex)
+{
+    Function& function = *reinterpret_cast<Function*>(item->aux_);
+    function(reinterpret_cast<T*>(item->start_), reinterpret_cast<T*>(item->end_), threadIndex);
+}
+
+/// Work function for asynchronous parallel loop chunks. Also records the chunk's execution time into the executing thread's own slot.
+template <class T, class Function> void ParallelForAsyncWork(const WorkItem* item, unsigned threadIndex)
+{
+    HiresTimer timer;
+    ParallelForWork<T, Function>(item, threadIndex);
+    ParallelForCost<Function>::asyncUSec_[threadIndex] += timer.GetUSec(false);
+    ParallelForCost<Function>::asyncItems_[threadIndex] += (unsigned)(reinterpret_cast<T*>(item->end_) - reinterpret_cast<T*>(item->start_));
+}
+
+/// Return the chunk size for a parallel loop, given the item count, number of worker threads, minimum chunk size and measured cost per item.
+inline unsigned GetParallelForChunkSize(unsigned count, unsigned numThreads, unsigned grainSize, float usecPerItem)
+{
+    if (!numThreads)
+        return count;
+
+    // Split into a few chunks per thread (worker threads + main thread) for load balancing
+    unsigned maxChunks = (numThreads + 1) * PARALLEL_FOR_CHUNKS_PER_THREAD;
+    unsigned chunkSize = (count + maxChunks - 1) / maxChunks;
+
+    // Do not make chunks so small that the work item overhead dominates
+    if (usecPerItem > 0.0f)
+        chunkSize = Max(chunkSize, (unsigned)Min(PARALLEL_FOR_MIN_CHUNK_USEC / usecPerItem, (float)count));
+
+    return Max(chunkSize, Max(grainSize, 1U));
+}
+
+/// Queue the chunks of a parallel loop as maximum priority work items.
+template <class T, class Function> void AddParallelForItems(WorkQueue* queue, T* begin, T* end, Function& function, unsigned chunkSize,
+    void (*workFunction)(const WorkItem*, unsigned))
+{
+    for (T* start = begin; start < end; start += chunkSize)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = workFunction;
+        item->aux_ = &function;
+        item->start_ = start;
+        item->end_ = end - start > (int)chunkSize ? start + chunkSize : end;
+        queue->AddWorkItem(item);
+    }
+}
+
+/// Execute a loop body over a range of items in the worker threads and the main thread, and wait for completion. The body is called as function(T* start, T* end, unsigned threadIndex) for consecutive chunks of the range. The chunk size is chosen from the thread count and the measured cost per item of the body type, but is at least the grain size. If the range fits in one chunk, the body is called directly. Uses pooled work items, so does not allocate once warmed up. Must be called from the main thread. Completes also other queued work with the maximum priority.
+template <class T, class Function> void ParallelFor(WorkQueue* queue, T* begin, T* end, Function& function, unsigned grainSize = 1)
+{
+    unsigned count = (unsigned)(end - begin);
+    if (!count)
+        return;
+
+    unsigned numThreads = queue->GetNumThreads();
+    float& usecPerItem = ParallelForCost<Function>::usecPerItem_;
+    unsigned chunkSize = GetParallelForChunkSize(count, numThreads, grainSize, usecPerItem);
+    unsigned numChunks = (count + chunkSize - 1) / chunkSize;
+
+    HiresTimer timer;
+
+    if (numChunks == 1)
+        function(begin, end, 0);
+    else
+    {
+        AddParallelForItems(queue, begin, end, function, chunkSize, ParallelForWork<T, Function>);
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+
+    // Estimate the cost per item from the elapsed time and the number of threads that were busy
+    float measured = (float)timer.GetUSec(false) * (float)Min(numChunks, numThreads + 1) / (float)count;
+    usecPerItem = usecPerItem > 0.0f ? Lerp(usecPerItem, measured, 0.25f) : measured;
+}
+
+/// Queue a loop body over a range of items for the worker threads without waiting, so that the main thread can do other work meanwhile. The range is split as in ParallelFor, but is always queued even if it fits in one chunk. As the loop's total time is not known, each chunk records its own execution time, and these are folded into the cost per item of the body type by the next asynchronous loop of the same type. The measured cost therefore excludes the scheduling overhead. The caller must keep the body and the range alive and call Complete(M_MAX_UNSIGNED) on the work queue to finish the loop before the next asynchronous loop of the same body type. Must be called from the main thread.
+template <class T, class Function> void ParallelForAsync(WorkQueue* queue, T* begin, T* end, Function& function, unsigned grainSize = 1)
+{
+    unsigned count = (unsigned)(end - begin);
+    if (!count)
+        return;
+
+    // Fold the chunk times of the previous asynchronous loops into the cost per item, then reset the per-thread slots
+    float& usecPerItem = ParallelForCost<Function>::usecPerItem_;
+    PODVector<long long>& asyncUSec = ParallelForCost<Function>::asyncUSec_;
+    PODVector<unsigned>& asyncItems = ParallelForCost<Function>::asyncItems_;
+    long long totalUSec = 0;
+    unsigned totalItems = 0;
+    for (unsigned i = 0; i < asyncItems.Size(); ++i)
+    {
+        totalUSec += asyncUSec[i];
+        totalItems += asyncItems[i];
+    }
+    if (totalItems)
+    {
+        float measured = (float)totalUSec / (float)totalItems;
+        usecPerItem = usecPerItem > 0.0f ? Lerp(usecPerItem, measured, 0.25f) : measured;
+    }
+
+    unsigned numThreads = queue->GetNumThreads();
+    asyncUSec.Resize(numThreads + 1);
+    asyncItems.Resize(numThreads + 1);
+    for (unsigned i = 0; i <= numThreads; ++i)
+    {
+        asyncUSec[i] = 0;
+        asyncItems[i] = 0;
+    }
+
+    unsigned chunkSize = GetParallelForChunkSize(count, numThreads, grainSize, usecPerItem);
+    AddParallelForItems(queue, begin, end, function, chunkSize, ParallelForAsyncWork<T, Function>);
+}
+
+/// Execute a loop body over a range of items in parallel and combine the per-thread partial results. The body is called as function(T* start, T* end, Result& partial), where the partial result belongs to the executing thread. The partials vector is kept by the caller to avoid reallocation; it is resized to the thread count and each element is reset to the initial value before the loop. Afterward the partials are combined in thread order as combine(Result& total, Result& partial) into the first element, which is returned.
+template <class T, class Result, class Function, class Combine> Result& ParallelReduce(WorkQueue* queue, T* begin, T* end,
+    Function& function, Combine& combine, const Result& initial, Vector<Result>& partials, unsigned grainSize = 1)
+{
+    partials.Resize(queue->GetNumThreads() + 1);
+    for (unsigned i = 0; i < partials.Size(); ++i)
+        partials[i] = initial;
+
+    ParallelReduceBody<T, Result, Function> body(function, partials);
+    ParallelFor(queue, begin, end, body, grainSize);
+
+    for (unsigned i = 1; i < partials.Size(); ++i)
+        combine(partials[0], partials[i]);
+
+    return partials[0];
+}
+
+}
@@ -35,7 +35,9 @@ Profiler::Profiler(Context* context) :
     Object(context),
     current_(0),
     root_(0),
-    intervalFrames_(0)
+    intervalFrames_(0),
+    frameStartContainerAllocations_(0),
+    frameContainerAllocations_(0)
 {
     current_ = root_ = new ProfilerBlock(0, "RunFrame");
 }
@@ -52,6 +54,7 @@ void Profiler::BeginFrame()
     if (root_->count_)
         EndFrame();
 
+    frameStartContainerAllocations_ = GetNumContainerAllocations();
     root_->Begin();
 }
 
@@ -60,6 +63,7 @@ void Profiler::EndFrame()
     EndBlock();
     ++intervalFrames_;
     root_->EndFrame();
+    frameContainerAllocations_ = GetNumContainerAllocations() - frameStartContainerAllocations_;
     current_ = root_;
 }
 
@@ -85,6 +89,7 @@ const String& Profiler::PrintData(bool showUnused, bool showTotal, unsigned maxD
         maxDepth = 1;
 
     PrintData(root_, output, 0, maxDepth, showUnused, showTotal);
+    output.AppendWithFormat("\nContainer allocations in last frame: %u\n", frameContainerAllocations_);
 
     return output;
 }
@@ -214,6 +214,8 @@ public:
     const ProfilerBlock* GetCurrentBlock() { return current_; }
     /// Return the root profiling block.
     const ProfilerBlock* GetRootBlock() { return root_; }
+    /// Return the number of container storage heap allocations during the last frame.
+    unsigned GetFrameContainerAllocations() const { return frameContainerAllocations_; }
 
 protected:
     /// Return profiling data as text output for a specified profiling block.
@@ -225,6 +227,10 @@ protected:
     ProfilerBlock* root_;
     /// Frames in the current interval.
     unsigned intervalFrames_;
+    /// Container storage heap allocation count at frame start.
+    unsigned frameStartContainerAllocations_;
+    /// Container storage heap allocations during the last frame.
+    unsigned frameContainerAllocations_;
 };
 
 /// Helper class for automatically beginning and ending a profiling block
@@ -60,8 +60,132 @@ private:
     unsigned index_;
 };
 
+/// Items of one priority inside a work item queue.
+struct WorkItemBand
+{
+    /// Construct.
+    WorkItemBand(unsigned priority = 0) :
+        priority_(priority),
+        head_(0)
+    {
+    }
+
+    /// Priority of all items in the band.
+    unsigned priority_;
+    /// Queued items. Items before the head have already been taken.
+    PODVector<WorkItem*> items_;
+    /// Index of the next item to take.
+    unsigned head_;
+};
+
+/// Prioritized work item queue owned by one thread. Other threads may steal from it when their own queue runs dry.
+class WorkItemQueue : public RefCounted
+{
+public:
+    /// Construct.
+    WorkItemQueue() :
+        numItems_(0),
+        topPriority_(0)
+    {
+    }
+
+    /// Add an item to the end of its priority band. The mutex must be held.
+    void Push(WorkItem* item)
+    {
+        // Bands are sorted from highest to lowest priority. There are only a few distinct priorities in use, so a linear
+        // search is cheap, and empty bands are kept to reuse their storage
+        unsigned i = 0;
+        while (i < bands_.Size() && bands_[i].priority_ > item->priority_)
+            ++i;
+        if (i == bands_.Size() || bands_[i].priority_ != item->priority_)
+            bands_.Insert(i, WorkItemBand(item->priority_));
+
+        bands_[i].items_.Push(item);
+        ++numItems_;
+        UpdateTopPriority();
+    }
+
+    /// Take the first item of the highest priority band, if it has at least the specified priority. The mutex must be held.
+    WorkItem* Pop(unsigned minPriority)
+    {
+        for (Vector<WorkItemBand>::Iterator i = bands_.Begin(); i != bands_.End(); ++i)
+        {
+            if (i->head_ == i->items_.Size())
+                continue;
+            if (i->priority_ < minPriority)
+                return 0;
+
+            WorkItem* item = i->items_[i->head_++];
+            if (i->head_ == i->items_.Size())
+            {
+                i->items_.Clear();
+                i->head_ = 0;
+            }
+            --numItems_;
+            UpdateTopPriority();
+            return item;
+        }
+
+        return 0;
+    }
+
+    /// Remove an item that has not been taken yet. Return true if found. The mutex must be held.
+    bool Remove(WorkItem* item)
+    {
+        for (Vector<WorkItemBand>::Iterator i = bands_.Begin(); i != bands_.End(); ++i)
+        {
+            if (i->priority_ != item->priority_)
+                continue;
+
+            for (unsigned j = i->head_; j < i->items_.Size(); ++j)
+            {
+                if (i->items_[j] == item)
+                {
+                    i->items_.Erase(j);
+                    if (i->head_ == i->items_.Size())
+                    {
+                        i->items_.Clear();
+                        i->head_ = 0;
+                    }
+                    --numItems_;
+                    UpdateTopPriority();
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /// Queue mutex.
+    Mutex mutex_;
+    /// Priority bands from highest to lowest.
+    Vector<WorkItemBand> bands_;
+    /// Number of queued items. May be read without holding the mutex as a hint.
+    volatile unsigned numItems_;
+    /// Priority of the front item. May be read without holding the mutex as a hint.
+    volatile unsigned topPriority_;
+
+private:
+    /// Update the front item priority hint.
+    void UpdateTopPriority()
+    {
+        for (Vector<WorkItemBand>::ConstIterator i = bands_.Begin(); i != bands_.End(); ++i)
+        {
+            if (i->head_ < i->items_.Size())
+            {
+                topPriority_ = i->priority_;
+                return;
+            }
+        }
+
+        topPriority_ = 0;
+    }
+};
+
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
+    nextQueue_(0),
     shutDown_(false),
     pausing_(false),
     paused_(false),
@@ -70,7 +194,11 @@ WorkQueue::WorkQueue(Context* context) :
     lastSize_(0),
     maxNonThreadedWorkMs_(5)
 {
+    queues_.Push(SharedPtr<WorkItemQueue>(new WorkItemQueue()));
+    frameAllocators_.Push(SharedPtr<FrameAllocator>(new FrameAllocator()));
+
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(WorkQueue, HandleEndFrame));
 }
 
 WorkQueue::~WorkQueue()
@@ -97,6 +225,8 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     for (unsigned i = 0; i < numThreads; ++i)
     {
         SharedPtr<WorkerThread> thread(new WorkerThread(this, i + 1));
+        queues_.Push(SharedPtr<WorkItemQueue>(new WorkItemQueue()));
+        frameAllocators_.Push(SharedPtr<FrameAllocator>(new FrameAllocator()));
         thread->Run();
         threads_.Push(thread);
     }
@@ -138,36 +268,41 @@ void WorkQueue::AddWorkItem(SharedPtr<WorkItem> item)
     workItems_.Push(item);
     item->completed_ = false;
 
-    // Make sure worker threads' list is safe to modify
-    if (threads_.Size() && !paused_)
-        queueMutex_.Acquire();
-
-    // Find position for new item
-    if (queue_.Empty())
-        queue_.Push(item);
-    else
+    // An item with pending parents is queued by the last parent to complete. The count can not increase after the item
+    // has been added, so only need to lock when it has parents
+    if (item->numPendingParents_)
     {
-        bool inserted = false;
-
-        for (List<WorkItem*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
-        {
-            if ((*i)->priority_ <= item->priority_)
-            {
-                queue_.Insert(i, item);
-                inserted = true;
-                break;
-            }
-        }
-
-        if (!inserted)
-            queue_.Push(item);
+        MutexLock lock(dependencyMutex_);
+        item->added_ = true;
+        if (item->numPendingParents_)
+            return;
     }
+    else
+        item->added_ = true;
+
+    // Distribute items round-robin to the per-thread queues. Idle threads steal from the others, so the queue choice
+    // only affects how much the threads contend on the same queue mutex
+    QueueItem(item, nextQueue_);
+    if (++nextQueue_ >= queues_.Size())
+        nextQueue_ = 0;
 
     if (threads_.Size())
+        Resume();
+}
+
+void WorkQueue::AddDependency(WorkItem* item, WorkItem* parent)
+{
+    if (!item || !parent || item == parent)
     {
-        queueMutex_.Release();
-        paused_ = false;
+        URHO3D_LOGERROR("Invalid work item dependency");
+        return;
     }
+
+    // The dependents list is read without locking when the parent completes, so it must not change afterward
+    assert(!item->added_ && !parent->added_);
+
+    parent->dependents_.Push(item);
+    ++item->numPendingParents_;
 }
 
 bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
@@ -175,18 +310,23 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
     if (!item)
         return false;
 
-    MutexLock lock(queueMutex_);
+    // Can only remove successfully if the item was not yet taken by threads for execution. Items with dependents can not
+    // be removed, as the dependents would never execute
+    if (!item->dependents_.Empty())
+        return false;
 
-    // Can only remove successfully if the item was not yet taken by threads for execution
-    List<WorkItem*>::Iterator i = queue_.Find(item.Get());
-    if (i != queue_.End())
+    List<SharedPtr<WorkItem> >::Iterator i = workItems_.Find(item);
+    if (i == workItems_.End())
+        return false;
+
+    for (unsigned j = 0; j < queues_.Size(); ++j)
     {
-        List<SharedPtr<WorkItem> >::Iterator j = workItems_.Find(item);
-        if (j != workItems_.End())
+        MutexLock lock(queues_[j]->mutex_);
+        if (queues_[j]->Remove(item.Get()))
         {
-            queue_.Erase(i);
+            item->added_ = false;
             ReturnToPool(item);
-            workItems_.Erase(j);
+            workItems_.Erase(i);
             return true;
         }
     }
@@ -196,23 +336,12 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
 
 unsigned WorkQueue::RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items)
 {
-    MutexLock lock(queueMutex_);
     unsigned removed = 0;
 
     for (Vector<SharedPtr<WorkItem> >::ConstIterator i = items.Begin(); i != items.End(); ++i)
     {
-        List<WorkItem*>::Iterator j = queue_.Find(i->Get());
-        if (j != queue_.End())
-        {
-            List<SharedPtr<WorkItem> >::Iterator k = workItems_.Find(*i);
-            if (k != workItems_.End())
-            {
-                queue_.Erase(j);
-                ReturnToPool(*k);
-                workItems_.Erase(k);
-                ++removed;
-            }
-        }
+        if (RemoveWorkItem(*i))
+            ++removed;
     }
 
     return removed;
@@ -224,7 +353,7 @@ void WorkQueue::Pause()
     {
         pausing_ = true;
 
-        queueMutex_.Acquire();
+        pauseMutex_.Acquire();
         paused_ = true;
 
         pausing_ = false;
@@ -235,8 +364,8 @@ void WorkQueue::Resume()
 {
     if (paused_)
     {
-        queueMutex_.Release();
         paused_ = false;
+        pauseMutex_.Release();
     }
 }
 
@@ -249,44 +378,26 @@ void WorkQueue::Complete(unsigned priority)
     {
         Resume();
 
-        // Take work items also in the main thread until queue empty or no high-priority items anymore
-        while (!queue_.Empty())
+        // Take work items also in the main thread until queues empty or no high-priority items anymore, then wait for
+        // threaded work to complete. Dependent items may be queued while waiting, so keep taking them
+        for (;;)
         {
-            queueMutex_.Acquire();
-            if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
-            {
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
-                queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
-            }
-            else
-            {
-                queueMutex_.Release();
-                break;
-            }
-        }
+            while (WorkItem* item = TakeItem(0, priority))
+                ExecuteItem(item, 0);
 
-        // Wait for threaded work to complete
-        while (!IsCompleted(priority))
-        {
+            if (IsCompleted(priority))
+                break;
         }
 
         // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.Empty())
+        if (!HasQueuedItems())
             Pause();
     }
     else
     {
         // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.Empty() && queue_.Front()->priority_ >= priority)
-        {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
-        }
+        while (WorkItem* item = TakeItem(0, priority))
+            ExecuteItem(item, 0);
     }
 
     PurgeCompleted(priority);
@@ -315,30 +426,107 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
 
         if (pausing_ && !wasActive)
             Time::Sleep(0);
+        else if (paused_)
+        {
+            // Block until resumed
+            pauseMutex_.Acquire();
+            pauseMutex_.Release();
+        }
         else
         {
-            queueMutex_.Acquire();
-            if (!queue_.Empty())
+            WorkItem* item = TakeItem(threadIndex, 0);
+            if (item)
             {
                 wasActive = true;
 
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
-                queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
-                item->completed_ = true;
+                ExecuteItem(item, threadIndex);
             }
             else
             {
                 wasActive = false;
 
-                queueMutex_.Release();
                 Time::Sleep(0);
             }
         }
     }
 }
 
+void WorkQueue::ExecuteItem(WorkItem* item, unsigned threadIndex)
+{
+    item->workFunction_(item, threadIndex);
+
+    // Queue the dependents whose last parent this was to the own queue, so that they are likely to continue in the same
+    // thread. The dependents list does not change after the item has been added, so it can be checked without locking
+    if (!item->dependents_.Empty())
+    {
+        MutexLock lock(dependencyMutex_);
+
+        for (PODVector<WorkItem*>::ConstIterator i = item->dependents_.Begin(); i != item->dependents_.End(); ++i)
+        {
+            WorkItem* dependent = *i;
+            if (!--dependent->numPendingParents_ && dependent->added_)
+                QueueItem(dependent, threadIndex);
+        }
+    }
+
+    item->completed_ = true;
+}
+
+void WorkQueue::QueueItem(WorkItem* item, unsigned queueIndex)
+{
+    WorkItemQueue* queue = queues_[queueIndex];
+    MutexLock lock(queue->mutex_);
+    queue->Push(item);
+}
+
+WorkItem* WorkQueue::TakeItem(unsigned threadIndex, unsigned minPriority)
+{
+    unsigned numQueues = queues_.Size();
+
+    for (;;)
+    {
+        // Find the queue with the highest priority front item, starting from the own queue so that on equal priority
+        // the threads spread out instead of converging on the same victim. The hints are read without locking
+        WorkItemQueue* best = 0;
+        unsigned bestPriority = 0;
+
+        for (unsigned i = 0; i < numQueues; ++i)
+        {
+            WorkItemQueue* queue = queues_[(threadIndex + i) % numQueues];
+            if (!queue->numItems_)
+                continue;
+
+            unsigned topPriority = queue->topPriority_;
+            if (topPriority >= minPriority && (!best || topPriority > bestPriority))
+            {
+                best = queue;
+                bestPriority = topPriority;
+            }
+        }
+
+        if (!best)
+            return 0;
+
+        MutexLock lock(best->mutex_);
+        WorkItem* item = best->Pop(minPriority);
+        if (item)
+            return item;
+
+        // Lost the race for the item to another thread, look again
+    }
+}
+
+bool WorkQueue::HasQueuedItems() const
+{
+    for (unsigned i = 0; i < queues_.Size(); ++i)
+    {
+        if (queues_[i]->numItems_)
+            return true;
+    }
+
+    return false;
+}
+
 void WorkQueue::PurgeCompleted(unsigned priority)
 {
     // Purge completed work items and send completion events. Do not signal items lower than priority threshold,
@@ -357,6 +545,10 @@ void WorkQueue::PurgeCompleted(unsigned priority)
                 SendEvent(E_WORKITEMCOMPLETED, eventData);
             }
 
+            // Reset dependency state in case a non-pooled item is reused
+            (*i)->dependents_.Clear();
+            (*i)->added_ = false;
+
             ReturnToPool(*i);
             i = workItems_.Erase(i);
         }
@@ -393,6 +585,9 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
         item->priority_ = M_MAX_UNSIGNED;
         item->sendEvent_ = false;
         item->completed_ = false;
+        item->dependents_.Clear();
+        item->numPendingParents_ = 0;
+        item->added_ = false;
 
         poolItems_.Push(item);
     }
@@ -401,18 +596,18 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     // If no worker threads, complete low-priority work here
-    if (threads_.Empty() && !queue_.Empty())
+    if (threads_.Empty() && HasQueuedItems())
     {
         URHO3D_PROFILE(CompleteWorkNonthreaded);
 
         HiresTimer timer;
 
-        while (!queue_.Empty() && timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000)
+        while (timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000)
         {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            WorkItem* item = TakeItem(0, 0);
+            if (!item)
+                break;
+            ExecuteItem(item, 0);
         }
     }
 
@@ -421,4 +616,11 @@ void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
     PurgePool();
 }
 
+void WorkQueue::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    // Per-frame data is not accessed by work items after the frame has been rendered, so the allocators can be reset
+    for (unsigned i = 0; i < frameAllocators_.Size(); ++i)
+        frameAllocators_[i]->Reset();
+}
+
 }
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/FrameAllocator.h"
 #include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
@@ -36,6 +37,7 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
 }
 
 class WorkerThread;
+class WorkItemQueue;
 
 /// Work queue item.
 struct WorkItem : public RefCounted
@@ -48,6 +50,8 @@ public:
         priority_(0),
         sendEvent_(false),
         completed_(false),
+        numPendingParents_(0),
+        added_(false),
         pooled_(false)
     {
     }
@@ -68,6 +72,13 @@ public:
     volatile bool completed_;
 
 private:
+    /// Items to queue for execution once this item has completed.
+    PODVector<WorkItem*> dependents_;
+    /// Number of parent items that have not completed yet.
+    unsigned numPendingParents_;
+    /// Whether the item has been added to the work queue.
+    bool added_;
+    /// Whether the item belongs to the item pool.
     bool pooled_;
 };
 
@@ -88,8 +99,10 @@ public:
     void CreateThreads(unsigned numThreads);
     /// Get pointer to an usable WorkItem from the item pool. Allocate one if no more free items.
     SharedPtr<WorkItem> GetFreeItem();
-    /// Add a work item and resume worker threads.
+    /// Add a work item and resume worker threads. If the item has dependencies, it is queued for execution once all its parent items have completed.
     void AddWorkItem(SharedPtr<WorkItem> item);
+    /// Make a work item a continuation of a parent item, so that it only starts executing after the parent has completed. Must be called before either item is added. The parent should have at least the priority of the dependent item, as Complete() will not execute the parent otherwise.
+    void AddDependency(WorkItem* item, WorkItem* parent);
     /// Remove a work item before it has started executing. Return true if successfully removed.
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
@@ -109,6 +122,8 @@ public:
 
     /// Return number of worker threads.
     unsigned GetNumThreads() const { return threads_.Size(); }
+    /// Return the frame allocator of a thread (0 = main thread.) Its memory is reclaimed at the end of each frame. May only be used from the thread in question.
+    FrameAllocator* GetFrameAllocator(unsigned threadIndex) const { return frameAllocators_[threadIndex]; }
 
     /// Return whether all work with at least the specified priority is finished.
     bool IsCompleted(unsigned priority) const;
@@ -124,6 +139,14 @@ public:
 private:
     /// Process work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Execute a work item, then queue the dependent items whose last parent it was and mark it completed.
+    void ExecuteItem(WorkItem* item, unsigned threadIndex);
+    /// Push a work item to a thread's queue.
+    void QueueItem(WorkItem* item, unsigned queueIndex);
+    /// Take the highest priority queued item which has at least the specified priority. Prefer the thread's own queue and steal from others when it is empty. Return null if none.
+    WorkItem* TakeItem(unsigned threadIndex, unsigned minPriority);
+    /// Return whether any work item is queued and not yet taken for execution.
+    bool HasQueuedItems() const;
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
     /// Purge the pool to reduce allocation where its unneeded.
@@ -132,6 +155,8 @@ private:
     void ReturnToPool(SharedPtr<WorkItem>& item);
     /// Handle frame start event. Purge completed work from the main thread queue, and perform work if no threads at all.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle frame end event. Reset the frame allocators.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
 
     /// Worker threads.
     Vector<SharedPtr<WorkerThread> > threads_;
@@ -139,16 +164,22 @@ private:
     List<SharedPtr<WorkItem> > poolItems_;
     /// Work item collection. Accessed only by the main thread.
     List<SharedPtr<WorkItem> > workItems_;
-    /// Work item prioritized queue for worker threads. Pointers are guaranteed to be valid (point to workItems.)
-    List<WorkItem*> queue_;
-    /// Worker queue mutex.
-    Mutex queueMutex_;
+    /// Per-thread frame allocators, index 0 belongs to the main thread.
+    Vector<SharedPtr<FrameAllocator> > frameAllocators_;
+    /// Per-thread prioritized queues, index 0 belongs to the main thread. Pointers are guaranteed to be valid (point to workItems.)
+    Vector<SharedPtr<WorkItemQueue> > queues_;
+    /// Dependency mutex. Protects the pending parent counts of items which have parents.
+    Mutex dependencyMutex_;
+    /// Pause mutex. Held by the main thread while paused so that idle worker threads block on it.
+    Mutex pauseMutex_;
+    /// Queue to receive the next added work item.
+    unsigned nextQueue_;
     /// Shutting down flag.
     volatile bool shutDown_;
-    /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
+    /// Pausing flag. Indicates the worker threads should not contend for the pause mutex.
     volatile bool pausing_;
-    /// Paused flag. Indicates the queue mutex being locked to prevent worker threads using up CPU time.
-    bool paused_;
+    /// Paused flag. Indicates the pause mutex being locked to prevent worker threads using up CPU time.
+    volatile bool paused_;
     /// Completing work in the main thread flag.
     bool completing_;
     /// Tolerance for the shared pool before it begins to deallocate.
@@ -655,20 +655,17 @@ void Engine::Update()
     URHO3D_PROFILE(Update);
 
     // Logic update event
-    using namespace Update;
-
-    VariantMap& eventData = GetEventDataMap();
-    eventData[P_TIMESTEP] = timeStep_;
-    SendEvent(E_UPDATE, eventData);
+    UpdateEventData eventData(timeStep_);
+    SendTypedEvent(E_UPDATE, eventData);
 
     // Logic post-update event
-    SendEvent(E_POSTUPDATE, eventData);
+    SendTypedEvent(E_POSTUPDATE, eventData);
 
     // Rendering update event
-    SendEvent(E_RENDERUPDATE, eventData);
+    SendTypedEvent(E_RENDERUPDATE, eventData);
 
     // Post-render update event
-    SendEvent(E_POSTRENDERUPDATE, eventData);
+    SendTypedEvent(E_POSTRENDERUPDATE, eventData);
 }
 
 void Engine::Render()
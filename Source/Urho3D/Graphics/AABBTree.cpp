@@ -0,0 +1,550 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/AABBTree.h"
+#include "../Graphics/DebugRenderer.h"
+#include "../Graphics/Drawable.h"
+#include "../Graphics/OctreeQuery.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Leaf bounding box enlargement relative to the drawable's size, so that small movements do not require reinsertion.
+static const float AABBTREE_MARGIN = 0.1f;
+/// Minimum leaf bounding box enlargement.
+static const float AABBTREE_MIN_MARGIN = 0.1f;
+/// Maximum leaf to drawable bounding box surface area ratio before a shrunk drawable is reinserted.
+static const float AABBTREE_MAX_AREA_RATIO = 4.0f;
+/// Maximum depth of the traversal stack. The tree is balanced, so this is never reached in practice.
+static const unsigned AABBTREE_MAX_STACK = 256;
+/// Number of drawables collected before passing them to the query.
+static const unsigned AABBTREE_QUERY_BATCH = 64;
+
+static inline float GetSurfaceArea(const BoundingBox& box)
+{
+    Vector3 size = box.Size();
+    return 2.0f * (size.x_ * size.y_ + size.y_ * size.z_ + size.z_ * size.x_);
+}
+
+static inline BoundingBox GetMerged(const BoundingBox& lhs, const BoundingBox& rhs)
+{
+    BoundingBox ret(lhs);
+    ret.Merge(rhs);
+    return ret;
+}
+
+static inline BoundingBox GetLeafBox(const BoundingBox& box)
+{
+    // Place drawables without a bounding box at the origin
+    if (!box.Defined())
+        return BoundingBox(-AABBTREE_MIN_MARGIN, AABBTREE_MIN_MARGIN);
+
+    Vector3 margin = box.Size() * AABBTREE_MARGIN + Vector3(AABBTREE_MIN_MARGIN, AABBTREE_MIN_MARGIN, AABBTREE_MIN_MARGIN);
+    return BoundingBox(box.min_ - margin, box.max_ + margin);
+}
+
+AABBTree::AABBTree() :
+    rootIndex_(AABBTREE_NULL_NODE),
+    freeList_(AABBTREE_NULL_NODE),
+    numLeaves_(0)
+{
+}
+
+unsigned AABBTree::InsertLeaf(Drawable* drawable, const BoundingBox& box)
+{
+    unsigned index = AllocateNode();
+    AABBTreeNode& node = nodes_[index];
+    node.box_ = GetLeafBox(box);
+    node.drawable_ = drawable;
+    node.height_ = 0;
+
+    InsertLeafNode(index);
+    ++numLeaves_;
+    return index;
+}
+
+void AABBTree::RemoveLeaf(unsigned index)
+{
+    assert(index < nodes_.Size() && nodes_[index].IsLeaf());
+
+    RemoveLeafNode(index);
+    FreeNode(index);
+    --numLeaves_;
+}
+
+bool AABBTree::MoveLeaf(unsigned index, const BoundingBox& box)
+{
+    if (CheckLeafFit(index, box))
+        return false;
+
+    RemoveLeafNode(index);
+    nodes_[index].box_ = GetLeafBox(box);
+    InsertLeafNode(index);
+    return true;
+}
+
+void AABBTree::Clear()
+{
+    nodes_.Clear();
+    rootIndex_ = AABBTREE_NULL_NODE;
+    freeList_ = AABBTREE_NULL_NODE;
+    numLeaves_ = 0;
+}
+
+void AABBTree::GetDrawables(OctreeQuery& query) const
+{
+    if (rootIndex_ == AABBTREE_NULL_NODE)
+        return;
+
+    unsigned stack[AABBTREE_MAX_STACK];
+    bool insideStack[AABBTREE_MAX_STACK];
+    unsigned stackSize = 0;
+    // Collect drawables of leaves that were reached through fully inside nodes separately, so that they need not be tested
+    Drawable* testDrawables[AABBTREE_QUERY_BATCH];
+    Drawable* insideDrawables[AABBTREE_QUERY_BATCH];
+    unsigned numTest = 0;
+    unsigned numInside = 0;
+
+    stack[stackSize] = rootIndex_;
+    insideStack[stackSize++] = false;
+
+    while (stackSize)
+    {
+        --stackSize;
+        const AABBTreeNode& node = nodes_[stack[stackSize]];
+        bool inside = insideStack[stackSize];
+
+        if (node.IsLeaf())
+        {
+            // The query tests the drawable's own bounding box
+            if (inside)
+            {
+                insideDrawables[numInside++] = node.drawable_;
+                if (numInside == AABBTREE_QUERY_BATCH)
+                {
+                    query.TestDrawables(insideDrawables, insideDrawables + numInside, true);
+                    numInside = 0;
+                }
+            }
+            else
+            {
+                testDrawables[numTest++] = node.drawable_;
+                if (numTest == AABBTREE_QUERY_BATCH)
+                {
+                    query.TestDrawables(testDrawables, testDrawables + numTest, false);
+                    numTest = 0;
+                }
+            }
+            continue;
+        }
+
+        Intersection res = query.TestOctant(node.box_, inside);
+        if (res == OUTSIDE)
+            continue;
+        inside = res == INSIDE;
+
+        if (stackSize + 2 > AABBTREE_MAX_STACK)
+            continue;
+        stack[stackSize] = node.child1_;
+        insideStack[stackSize++] = inside;
+        stack[stackSize] = node.child2_;
+        insideStack[stackSize++] = inside;
+    }
+
+    if (numTest)
+        query.TestDrawables(testDrawables, testDrawables + numTest, false);
+    if (numInside)
+        query.TestDrawables(insideDrawables, insideDrawables + numInside, true);
+}
+
+void AABBTree::GetDrawables(RayOctreeQuery& query) const
+{
+    if (rootIndex_ == AABBTREE_NULL_NODE)
+        return;
+
+    unsigned stack[AABBTREE_MAX_STACK];
+    unsigned stackSize = 0;
+    stack[stackSize++] = rootIndex_;
+
+    while (stackSize)
+    {
+        const AABBTreeNode& node = nodes_[stack[--stackSize]];
+        if (query.ray_.HitDistance(node.box_) >= query.maxDistance_)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            Drawable* drawable = node.drawable_;
+            if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
+                drawable->ProcessRayQuery(query, query.result_);
+        }
+        else if (stackSize + 2 <= AABBTREE_MAX_STACK)
+        {
+            stack[stackSize++] = node.child1_;
+            stack[stackSize++] = node.child2_;
+        }
+    }
+}
+
+void AABBTree::GetDrawablesOnly(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const
+{
+    if (rootIndex_ == AABBTREE_NULL_NODE)
+        return;
+
+    unsigned stack[AABBTREE_MAX_STACK];
+    unsigned stackSize = 0;
+    stack[stackSize++] = rootIndex_;
+
+    while (stackSize)
+    {
+        const AABBTreeNode& node = nodes_[stack[--stackSize]];
+        if (query.ray_.HitDistance(node.box_) >= query.maxDistance_)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            Drawable* drawable = node.drawable_;
+            if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
+                drawables.Push(drawable);
+        }
+        else if (stackSize + 2 <= AABBTREE_MAX_STACK)
+        {
+            stack[stackSize++] = node.child1_;
+            stack[stackSize++] = node.child2_;
+        }
+    }
+}
+
+void AABBTree::GetDrawables(RayPacketOctreeQuery& query) const
+{
+    if (rootIndex_ == AABBTREE_NULL_NODE)
+        return;
+
+    unsigned stack[AABBTREE_MAX_STACK];
+    unsigned stackSize = 0;
+    stack[stackSize++] = rootIndex_;
+
+    while (stackSize)
+    {
+        const AABBTreeNode& node = nodes_[stack[--stackSize]];
+        if (!query.TestBox(node.box_))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            Drawable* drawable = node.drawable_;
+            query.TestDrawables(&drawable, &drawable + 1);
+        }
+        else if (stackSize + 2 <= AABBTREE_MAX_STACK)
+        {
+            stack[stackSize++] = node.child1_;
+            stack[stackSize++] = node.child2_;
+        }
+    }
+}
+
+void AABBTree::GetAllDrawables(PODVector<Drawable*>& drawables) const
+{
+    for (PODVector<AABBTreeNode>::ConstIterator i = nodes_.Begin(); i != nodes_.End(); ++i)
+    {
+        if (i->height_ == 0)
+            drawables.Push(i->drawable_);
+    }
+}
+
+void AABBTree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const
+{
+    if (!debug)
+        return;
+
+    for (PODVector<AABBTreeNode>::ConstIterator i = nodes_.Begin(); i != nodes_.End(); ++i)
+    {
+        if (i->height_ > 0 && debug->IsInside(i->box_))
+            debug->AddBoundingBox(i->box_, Color(0.25f, 0.25f, 0.25f), depthTest);
+    }
+}
+
+bool AABBTree::CheckLeafFit(unsigned index, const BoundingBox& box) const
+{
+    const BoundingBox& leafBox = nodes_[index].box_;
+    if (!box.Defined())
+        return leafBox == GetLeafBox(box);
+
+    // Reinsert also if the drawable has shrunk considerably, so that the leaf does not remain too loose
+    return leafBox.IsInside(box) == INSIDE && GetSurfaceArea(leafBox) <= AABBTREE_MAX_AREA_RATIO * GetSurfaceArea(GetLeafBox(box));
+}
+
+unsigned AABBTree::AllocateNode()
+{
+    unsigned index;
+    if (freeList_ != AABBTREE_NULL_NODE)
+    {
+        index = freeList_;
+        freeList_ = nodes_[index].parent_;
+    }
+    else
+    {
+        index = nodes_.Size();
+        nodes_.Resize(index + 1);
+    }
+
+    AABBTreeNode& node = nodes_[index];
+    node.drawable_ = 0;
+    node.parent_ = AABBTREE_NULL_NODE;
+    node.child1_ = AABBTREE_NULL_NODE;
+    node.child2_ = AABBTREE_NULL_NODE;
+    node.height_ = 0;
+    return index;
+}
+
+void AABBTree::FreeNode(unsigned index)
+{
+    AABBTreeNode& node = nodes_[index];
+    node.drawable_ = 0;
+    node.parent_ = freeList_;
+    node.height_ = -1;
+    freeList_ = index;
+}
+
+void AABBTree::InsertLeafNode(unsigned leaf)
+{
+    if (rootIndex_ == AABBTREE_NULL_NODE)
+    {
+        rootIndex_ = leaf;
+        nodes_[leaf].parent_ = AABBTREE_NULL_NODE;
+        return;
+    }
+
+    // Find the best sibling by descending to the child whose bounds grow least, using surface area as the cost
+    BoundingBox leafBox = nodes_[leaf].box_;
+    unsigned index = rootIndex_;
+    while (!nodes_[index].IsLeaf())
+    {
+        const AABBTreeNode& node = nodes_[index];
+        float area = GetSurfaceArea(node.box_);
+        float combinedArea = GetSurfaceArea(GetMerged(node.box_, leafBox));
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const AABBTreeNode& child1 = nodes_[node.child1_];
+        float cost1 = GetSurfaceArea(GetMerged(child1.box_, leafBox)) + inheritanceCost;
+        if (!child1.IsLeaf())
+            cost1 -= GetSurfaceArea(child1.box_);
+        const AABBTreeNode& child2 = nodes_[node.child2_];
+        float cost2 = GetSurfaceArea(GetMerged(child2.box_, leafBox)) + inheritanceCost;
+        if (!child2.IsLeaf())
+            cost2 -= GetSurfaceArea(child2.box_);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+        index = cost1 < cost2 ? node.child1_ : node.child2_;
+    }
+
+    // Create a new parent for the sibling and the leaf. Allocating may reallocate the node array, so use indices only
+    unsigned sibling = index;
+    unsigned oldParent = nodes_[sibling].parent_;
+    unsigned newParent = AllocateNode();
+    AABBTreeNode& parentNode = nodes_[newParent];
+    parentNode.parent_ = oldParent;
+    parentNode.box_ = GetMerged(leafBox, nodes_[sibling].box_);
+    parentNode.height_ = nodes_[sibling].height_ + 1;
+    parentNode.child1_ = sibling;
+    parentNode.child2_ = leaf;
+
+    if (oldParent != AABBTREE_NULL_NODE)
+    {
+        if (nodes_[oldParent].child1_ == sibling)
+            nodes_[oldParent].child1_ = newParent;
+        else
+            nodes_[oldParent].child2_ = newParent;
+    }
+    else
+        rootIndex_ = newParent;
+
+    nodes_[sibling].parent_ = newParent;
+    nodes_[leaf].parent_ = newParent;
+
+    Refit(newParent);
+}
+
+void AABBTree::RemoveLeafNode(unsigned leaf)
+{
+    if (leaf == rootIndex_)
+    {
+        rootIndex_ = AABBTREE_NULL_NODE;
+        return;
+    }
+
+    // Replace the parent with the sibling
+    unsigned parent = nodes_[leaf].parent_;
+    unsigned grandParent = nodes_[parent].parent_;
+    unsigned sibling = nodes_[parent].child1_ == leaf ? nodes_[parent].child2_ : nodes_[parent].child1_;
+
+    if (grandParent != AABBTREE_NULL_NODE)
+    {
+        if (nodes_[grandParent].child1_ == parent)
+            nodes_[grandParent].child1_ = sibling;
+        else
+            nodes_[grandParent].child2_ = sibling;
+        nodes_[sibling].parent_ = grandParent;
+        FreeNode(parent);
+        Refit(grandParent);
+    }
+    else
+    {
+        rootIndex_ = sibling;
+        nodes_[sibling].parent_ = AABBTREE_NULL_NODE;
+        FreeNode(parent);
+    }
+}
+
+void AABBTree::Refit(unsigned index)
+{
+    while (index != AABBTREE_NULL_NODE)
+    {
+        index = Balance(index);
+
+        AABBTreeNode& node = nodes_[index];
+        const AABBTreeNode& child1 = nodes_[node.child1_];
+        const AABBTreeNode& child2 = nodes_[node.child2_];
+        node.height_ = 1 + Max(child1.height_, child2.height_);
+        node.box_ = GetMerged(child1.box_, child2.box_);
+
+        index = node.parent_;
+    }
+}
+
+unsigned AABBTree::Balance(unsigned indexA)
+{
+    AABBTreeNode* a = &nodes_[indexA];
+    if (a->IsLeaf() || a->height_ < 2)
+        return indexA;
+
+    unsigned indexB = a->child1_;
+    unsigned indexC = a->child2_;
+    AABBTreeNode* b = &nodes_[indexB];
+    AABBTreeNode* c = &nodes_[indexC];
+    int balance = c->height_ - b->height_;
+
+    if (balance > 1)
+    {
+        // Rotate C up: it takes the place of A, and A takes the place of C's lower child
+        unsigned indexF = c->child1_;
+        unsigned indexG = c->child2_;
+        AABBTreeNode* f = &nodes_[indexF];
+        AABBTreeNode* g = &nodes_[indexG];
+
+        c->child1_ = indexA;
+        c->parent_ = a->parent_;
+        a->parent_ = indexC;
+
+        if (c->parent_ != AABBTREE_NULL_NODE)
+        {
+            if (nodes_[c->parent_].child1_ == indexA)
+                nodes_[c->parent_].child1_ = indexC;
+            else
+                nodes_[c->parent_].child2_ = indexC;
+        }
+        else
+            rootIndex_ = indexC;
+
+        if (f->height_ > g->height_)
+        {
+            c->child2_ = indexF;
+            a->child2_ = indexG;
+            g->parent_ = indexA;
+            a->box_ = GetMerged(b->box_, g->box_);
+            c->box_ = GetMerged(a->box_, f->box_);
+            a->height_ = 1 + Max(b->height_, g->height_);
+            c->height_ = 1 + Max(a->height_, f->height_);
+        }
+        else
+        {
+            c->child2_ = indexG;
+            a->child2_ = indexF;
+            f->parent_ = indexA;
+            a->box_ = GetMerged(b->box_, f->box_);
+            c->box_ = GetMerged(a->box_, g->box_);
+            a->height_ = 1 + Max(b->height_, f->height_);
+            c->height_ = 1 + Max(a->height_, g->height_);
+        }
+
+        return indexC;
+    }
+
+    if (balance < -1)
+    {
+        // Rotate B up
+        unsigned indexD = b->child1_;
+        unsigned indexE = b->child2_;
+        AABBTreeNode* d = &nodes_[indexD];
+        AABBTreeNode* e = &nodes_[indexE];
+
+        b->child1_ = indexA;
+        b->parent_ = a->parent_;
+        a->parent_ = indexB;
+
+        if (b->parent_ != AABBTREE_NULL_NODE)
+        {
+            if (nodes_[b->parent_].child1_ == indexA)
+                nodes_[b->parent_].child1_ = indexB;
+            else
+                nodes_[b->parent_].child2_ = indexB;
+        }
+        else
+            rootIndex_ = indexB;
+
+        if (d->height_ > e->height_)
+        {
+            b->child2_ = indexD;
+            a->child1_ = indexE;
+            e->parent_ = indexA;
+            a->box_ = GetMerged(c->box_, e->box_);
+            b->box_ = GetMerged(a->box_, d->box_);
+            a->height_ = 1 + Max(c->height_, e->height_);
+            b->height_ = 1 + Max(a->height_, d->height_);
+        }
+        else
+        {
+            b->child2_ = indexE;
+            a->child1_ = indexD;
+            d->parent_ = indexA;
+            a->box_ = GetMerged(c->box_, d->box_);
+            b->box_ = GetMerged(a->box_, e->box_);
+            a->height_ = 1 + Max(c->height_, d->height_);
+            b->height_ = 1 + Max(a->height_, e->height_);
+        }
+
+        return indexB;
+    }
+
+    return indexA;
+}
+
+}
@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Math/BoundingBox.h"
+
+namespace Urho3D
+{
+
+class DebugRenderer;
+class Drawable;
+class OctreeQuery;
+class RayOctreeQuery;
+class RayPacketOctreeQuery;
+
+static const unsigned AABBTREE_NULL_NODE = M_MAX_UNSIGNED;
+
+/// %AABB tree node.
+struct AABBTreeNode
+{
+    /// Return whether is a leaf node.
+    bool IsLeaf() const { return child1_ == AABBTREE_NULL_NODE; }
+
+    /// Bounding box. For leaf nodes the drawable's world bounding box enlarged with a margin.
+    BoundingBox box_;
+    /// Drawable object. Null for branch nodes.
+    Drawable* drawable_;
+    /// Parent node index, or next free node index when in the free list.
+    unsigned parent_;
+    /// First child node index.
+    unsigned child1_;
+    /// Second child node index.
+    unsigned child2_;
+    /// Height of the subtree, zero for leaf nodes and -1 for free nodes.
+    int height_;
+};
+
+/// Dynamic bounding volume hierarchy of drawable objects. Leaves are refitted only when a drawable moves outside its enlarged bounding box, and the tree is kept balanced by rotations on insertion and removal.
+class URHO3D_API AABBTree
+{
+public:
+    /// Construct empty.
+    AABBTree();
+
+    /// Insert a drawable object with a world bounding box. Return the leaf node index.
+    unsigned InsertLeaf(Drawable* drawable, const BoundingBox& box);
+    /// Remove a leaf node.
+    void RemoveLeaf(unsigned index);
+    /// Update the world bounding box of a leaf node. Return true if the leaf had to be reinserted. The leaf node index does not change.
+    bool MoveLeaf(unsigned index, const BoundingBox& box);
+    /// Remove all nodes.
+    void Clear();
+
+    /// Return drawable objects by a query.
+    void GetDrawables(OctreeQuery& query) const;
+    /// Return drawable objects by a ray query.
+    void GetDrawables(RayOctreeQuery& query) const;
+    /// Return drawable objects only for a ray query, without testing the drawables.
+    void GetDrawablesOnly(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const;
+    /// Return drawable objects by a ray packet query.
+    void GetDrawables(RayPacketOctreeQuery& query) const;
+    /// Return all drawable objects.
+    void GetAllDrawables(PODVector<Drawable*>& drawables) const;
+    /// Draw node bounds to the debug graphics.
+    void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const;
+
+    /// Return whether a world bounding box still fits a leaf node without reinsertion. Does not modify the tree.
+    bool CheckLeafFit(unsigned index, const BoundingBox& box) const;
+    /// Return number of leaf nodes.
+    unsigned GetNumLeaves() const { return numLeaves_; }
+    /// Return height of the tree.
+    unsigned GetHeight() const { return rootIndex_ != AABBTREE_NULL_NODE ? (unsigned)nodes_[rootIndex_].height_ : 0; }
+    /// Return root node index, or AABBTREE_NULL_NODE if empty.
+    unsigned GetRootIndex() const { return rootIndex_; }
+    /// Return all nodes, including free ones.
+    const PODVector<AABBTreeNode>& GetNodes() const { return nodes_; }
+
+private:
+    /// Allocate a node from the free list or by growing the node array.
+    unsigned AllocateNode();
+    /// Return a node to the free list.
+    void FreeNode(unsigned index);
+    /// Link an allocated leaf node to the tree.
+    void InsertLeafNode(unsigned leaf);
+    /// Unlink a leaf node from the tree without freeing it.
+    void RemoveLeafNode(unsigned leaf);
+    /// Recalculate bounds and heights from a node up to the root, rebalancing on the way.
+    void Refit(unsigned index);
+    /// Rotate a branch node if its children are unbalanced. Return the index of the node now at its place.
+    unsigned Balance(unsigned index);
+
+    /// Nodes.
+    PODVector<AABBTreeNode> nodes_;
+    /// Root node index.
+    unsigned rootIndex_;
+    /// First free node index.
+    unsigned freeList_;
+    /// Number of leaf nodes.
+    unsigned numLeaves_;
+};
+
+}
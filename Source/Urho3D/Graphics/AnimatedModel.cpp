@@ -135,6 +135,15 @@ bool AnimatedModel::Load(Deserializer& source, bool setInstanceDefault)
     return success;
 }
 
+bool AnimatedModel::LoadAttributeValues(const PODVector<const Variant*>& values, bool setInstanceDefault)
+{
+    loading_ = true;
+    bool success = Component::LoadAttributeValues(values, setInstanceDefault);
+    loading_ = false;
+
+    return success;
+}
+
 bool AnimatedModel::LoadXML(const XMLElement& source, bool setInstanceDefault)
 {
     loading_ = true;
@@ -931,7 +940,7 @@ void AnimatedModel::UpdateBoneBoundingBox()
     }
 
     boneBoundingBoxDirty_ = false;
-    worldBoundingBoxDirty_ = true;
+    MarkWorldBoundingBoxDirty();
 }
 
 void AnimatedModel::OnNodeSet(Node* node)
@@ -49,6 +49,8 @@ public:
 
     /// Load from binary data. Return true if successful.
     virtual bool Load(Deserializer& source, bool setInstanceDefault = false);
+    /// Load from attribute values that have already been read from binary data. Return true if successful.
+    virtual bool LoadAttributeValues(const PODVector<const Variant*>& values, bool setInstanceDefault = false);
     /// Load from XML data. Return true if successful.
     virtual bool LoadXML(const XMLElement& source, bool setInstanceDefault = false);
     /// Load from JSON data. Return true if successful.
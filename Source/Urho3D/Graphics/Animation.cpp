@@ -39,6 +39,11 @@
 namespace Urho3D
 {
 
+/// Largest absolute value of the three smallest components of a normalized quaternion.
+static const float SMALLEST_THREE_RANGE = 0.70710678f;
+/// Maximum number of source keyframes spanned by one interpolated segment during keyframe reduction. Bounds the compression time of long tracks.
+static const unsigned MAX_REDUCED_KEYFRAME_SPAN = 256;
+
 inline bool CompareTriggers(AnimationTriggerPoint& lhs, AnimationTriggerPoint& rhs)
 {
     return lhs.time_ < rhs.time_;
@@ -55,6 +60,7 @@ void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFra
     {
         keyFrames_[index] = keyFrame;
         Urho3D::Sort(keyFrames_.Begin(), keyFrames_.End(), CompareKeyFrames);
+        uniformInterval_ = 0.0f;
     }
     else if (index == keyFrames_.Size())
         AddKeyFrame(keyFrame);
@@ -66,22 +72,329 @@ void AnimationTrack::AddKeyFrame(const AnimationKeyFrame& keyFrame)
     keyFrames_.Push(keyFrame);
     if (needSort)
         Urho3D::Sort(keyFrames_.Begin(), keyFrames_.End(), CompareKeyFrames);
+    uniformInterval_ = 0.0f;
 }
 
 void AnimationTrack::InsertKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
     keyFrames_.Insert(index, keyFrame);
     Urho3D::Sort(keyFrames_.Begin(), keyFrames_.End(), CompareKeyFrames);
+    uniformInterval_ = 0.0f;
 }
 
 void AnimationTrack::RemoveKeyFrame(unsigned index)
 {
     keyFrames_.Erase(index);
+    uniformInterval_ = 0.0f;
 }
 
 void AnimationTrack::RemoveAllKeyFrames()
 {
     keyFrames_.Clear();
+    uniformInterval_ = 0.0f;
+}
+
+void AnimationTrack::Resample(float interval)
+{
+    if (keyFrames_.Size() < 2 || interval <= 0.0f)
+        return;
+
+    float startTime = keyFrames_.Front().time_;
+    float duration = keyFrames_.Back().time_ - startTime;
+    if (duration <= 0.0f)
+        return;
+
+    unsigned numIntervals = Max((unsigned)(duration / interval + 0.5f), 1U);
+    interval = duration / numIntervals;
+
+    Vector<AnimationKeyFrame> newKeyFrames(numIntervals + 1);
+    unsigned frame = 0;
+    for (unsigned i = 0; i <= numIntervals; ++i)
+    {
+        AnimationKeyFrame& newKeyFrame = newKeyFrames[i];
+        newKeyFrame.time_ = i < numIntervals ? startTime + i * interval : keyFrames_.Back().time_;
+
+        GetKeyFrameIndex(newKeyFrame.time_, frame);
+        const AnimationKeyFrame& keyFrame = keyFrames_[frame];
+        if (frame + 1 < keyFrames_.Size())
+        {
+            const AnimationKeyFrame& nextKeyFrame = keyFrames_[frame + 1];
+            float timeInterval = nextKeyFrame.time_ - keyFrame.time_;
+            float t = timeInterval > 0.0f ? (newKeyFrame.time_ - keyFrame.time_) / timeInterval : 0.0f;
+            newKeyFrame.position_ = keyFrame.position_.Lerp(nextKeyFrame.position_, t);
+            newKeyFrame.rotation_ = keyFrame.rotation_.Slerp(nextKeyFrame.rotation_, t);
+            newKeyFrame.scale_ = keyFrame.scale_.Lerp(nextKeyFrame.scale_, t);
+        }
+        else
+        {
+            newKeyFrame.position_ = keyFrame.position_;
+            newKeyFrame.rotation_ = keyFrame.rotation_;
+            newKeyFrame.scale_ = keyFrame.scale_;
+        }
+    }
+
+    keyFrames_.Swap(newKeyFrames);
+    uniformInterval_ = interval;
+}
+
+void AnimationTrack::UpdateUniformInterval()
+{
+    uniformInterval_ = 0.0f;
+    if (keyFrames_.Size() < 2)
+        return;
+
+    float startTime = keyFrames_.Front().time_;
+    float interval = (keyFrames_.Back().time_ - startTime) / (keyFrames_.Size() - 1);
+    if (interval <= 0.0f)
+        return;
+
+    // Allow small deviation, as exporters often store times rounded from frame numbers
+    float tolerance = interval * 0.01f;
+    for (unsigned i = 1; i < keyFrames_.Size() - 1; ++i)
+    {
+        if (Abs(keyFrames_[i].time_ - (startTime + i * interval)) > tolerance)
+            return;
+    }
+
+    uniformInterval_ = interval;
+}
+
+static unsigned short Quantize(float value, float maxValue)
+{
+    return (unsigned short)Clamp(value + 0.5f, 0.0f, maxValue);
+}
+
+static void EncodeRotation(const Quaternion& rotation, unsigned short* dest)
+{
+    Quaternion normalized = rotation.Normalized();
+    const float* components = normalized.Data();
+
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largest]))
+            largest = i;
+    }
+
+    // Negate if necessary so that the omitted largest component is positive and can be reconstructed from the others
+    float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+    float smallest[3];
+    for (unsigned i = 0, j = 0; i < 4; ++i)
+    {
+        if (i != largest)
+            smallest[j++] = (components[i] * sign / SMALLEST_THREE_RANGE) * 0.5f + 0.5f;
+    }
+
+    // Store the largest component's index in the high bits of the first two values
+    dest[0] = (unsigned short)(Quantize(smallest[0] * 32767.0f, 32767.0f) | ((largest & 1) << 15));
+    dest[1] = (unsigned short)(Quantize(smallest[1] * 32767.0f, 32767.0f) | ((largest >> 1) << 15));
+    dest[2] = Quantize(smallest[2] * 65535.0f, 65535.0f);
+}
+
+static float GetKeyFrameError(const Vector3& lhs, const Vector3& rhs)
+{
+    return (lhs - rhs).Length();
+}
+
+static float GetKeyFrameError(const Quaternion& lhs, const Quaternion& rhs)
+{
+    return 2.0f * acosf(Min(Abs(lhs.DotProduct(rhs)), 1.0f));
+}
+
+static Vector3 InterpolateKeyFrames(const Vector3& lhs, const Vector3& rhs, float t)
+{
+    return lhs.Lerp(rhs, t);
+}
+
+static Quaternion InterpolateKeyFrames(const Quaternion& lhs, const Quaternion& rhs, float t)
+{
+    return lhs.Slerp(rhs, t);
+}
+
+/// Select the keyframes of a channel that reproduce it within the tolerance when interpolated.
+template <class T> static void ReduceKeyFrames(const Vector<AnimationKeyFrame>& keyFrames, T AnimationKeyFrame::*member,
+    float tolerance, PODVector<unsigned>& dest)
+{
+    dest.Clear();
+    unsigned numKeyFrames = keyFrames.Size();
+    if (!numKeyFrames)
+        return;
+
+    dest.Push(0);
+
+    // A constant channel needs only one keyframe
+    bool constant = true;
+    for (unsigned i = 1; i < numKeyFrames; ++i)
+    {
+        if (GetKeyFrameError(keyFrames[i].*member, keyFrames[0].*member) > tolerance)
+        {
+            constant = false;
+            break;
+        }
+    }
+    if (constant)
+        return;
+
+    // Extend the segment from the last kept keyframe for as long as the keyframes it skips can be interpolated
+    unsigned start = 0;
+    for (unsigned end = 2; end < numKeyFrames; ++end)
+    {
+        bool removable = end - start <= MAX_REDUCED_KEYFRAME_SPAN;
+        float startTime = keyFrames[start].time_;
+        float duration = keyFrames[end].time_ - startTime;
+
+        for (unsigned i = start + 1; i < end && removable; ++i)
+        {
+            float t = duration > 0.0f ? (keyFrames[i].time_ - startTime) / duration : 0.0f;
+            T interpolated = InterpolateKeyFrames(keyFrames[start].*member, keyFrames[end].*member, t);
+            if (GetKeyFrameError(interpolated, keyFrames[i].*member) > tolerance)
+                removable = false;
+        }
+
+        if (!removable)
+        {
+            dest.Push(end - 1);
+            start = end - 1;
+        }
+    }
+
+    dest.Push(numKeyFrames - 1);
+}
+
+static void QuantizeKeyFrameTimes(const Vector<AnimationKeyFrame>& keyFrames, const PODVector<unsigned>& indices,
+    CompressedAnimationChannel& dest)
+{
+    dest.times_.Resize(indices.Size());
+    for (unsigned i = 0; i < indices.Size(); ++i)
+    {
+        float time = keyFrames[indices[i]].time_;
+        dest.times_[i] = dest.timeScale_ > 0.0f ? Quantize(time / dest.timeScale_, 65535.0f) : (unsigned short)0;
+    }
+}
+
+static void CompressVector3Channel(const Vector<AnimationKeyFrame>& keyFrames, Vector3 AnimationKeyFrame::*member,
+    float tolerance, CompressedAnimationChannel& dest)
+{
+    PODVector<unsigned> indices;
+    ReduceKeyFrames(keyFrames, member, tolerance, indices);
+    QuantizeKeyFrameTimes(keyFrames, indices, dest);
+    if (indices.Empty())
+        return;
+
+    Vector3 minValue = keyFrames[indices[0]].*member;
+    Vector3 maxValue = minValue;
+    for (unsigned i = 1; i < indices.Size(); ++i)
+    {
+        const Vector3& value = keyFrames[indices[i]].*member;
+        minValue = VectorMin(minValue, value);
+        maxValue = VectorMax(maxValue, value);
+    }
+
+    dest.min_ = minValue;
+    dest.range_ = (maxValue - minValue) / 65535.0f;
+
+    dest.values_.Resize(indices.Size() * 3);
+    for (unsigned i = 0; i < indices.Size(); ++i)
+    {
+        const Vector3& value = keyFrames[indices[i]].*member;
+        unsigned short* quantized = &dest.values_[i * 3];
+        quantized[0] = dest.range_.x_ > 0.0f ? Quantize((value.x_ - minValue.x_) / dest.range_.x_, 65535.0f) : (unsigned short)0;
+        quantized[1] = dest.range_.y_ > 0.0f ? Quantize((value.y_ - minValue.y_) / dest.range_.y_, 65535.0f) : (unsigned short)0;
+        quantized[2] = dest.range_.z_ > 0.0f ? Quantize((value.z_ - minValue.z_) / dest.range_.z_, 65535.0f) : (unsigned short)0;
+    }
+}
+
+static void CompressRotationChannel(const Vector<AnimationKeyFrame>& keyFrames, float tolerance, CompressedAnimationChannel& dest)
+{
+    PODVector<unsigned> indices;
+    ReduceKeyFrames(keyFrames, &AnimationKeyFrame::rotation_, tolerance, indices);
+    QuantizeKeyFrameTimes(keyFrames, indices, dest);
+
+    dest.values_.Resize(indices.Size() * 3);
+    for (unsigned i = 0; i < indices.Size(); ++i)
+        EncodeRotation(keyFrames[indices[i]].rotation_, &dest.values_[i * 3]);
+}
+
+Quaternion CompressedAnimationChannel::GetQuaternion(unsigned index) const
+{
+    const unsigned short* value = &values_[index * 3];
+    unsigned largest = (unsigned)((value[0] >> 15) | ((value[1] >> 15) << 1));
+
+    float smallest[3];
+    smallest[0] = ((value[0] & 0x7fff) * (2.0f / 32767.0f) - 1.0f) * SMALLEST_THREE_RANGE;
+    smallest[1] = ((value[1] & 0x7fff) * (2.0f / 32767.0f) - 1.0f) * SMALLEST_THREE_RANGE;
+    smallest[2] = (value[2] * (2.0f / 65535.0f) - 1.0f) * SMALLEST_THREE_RANGE;
+
+    float components[4];
+    float sumSquares = 0.0f;
+    for (unsigned i = 0, j = 0; i < 4; ++i)
+    {
+        if (i != largest)
+        {
+            components[i] = smallest[j++];
+            sumSquares += components[i] * components[i];
+        }
+    }
+    components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+    return Quaternion(components[0], components[1], components[2], components[3]);
+}
+
+void CompressedAnimationChannel::GetKeyFrameIndex(float time, unsigned& index) const
+{
+    unsigned numKeyFrames = times_.Size();
+    if (index >= numKeyFrames)
+        index = numKeyFrames - 1;
+
+    float quantizedTime = timeScale_ > 0.0f ? time / timeScale_ : 0.0f;
+
+    // Check whether the previous index is still valid, or whether playback has advanced to the next keyframe
+    if (!index || quantizedTime >= times_[index])
+    {
+        if (index + 1 >= numKeyFrames || quantizedTime < times_[index + 1])
+            return;
+        if (index + 2 >= numKeyFrames || quantizedTime < times_[index + 2])
+        {
+            ++index;
+            return;
+        }
+    }
+
+    unsigned low = 0;
+    unsigned high = numKeyFrames;
+    while (low + 1 < high)
+    {
+        unsigned middle = (low + high) >> 1;
+        if (quantizedTime < times_[middle])
+            high = middle;
+        else
+            low = middle;
+    }
+    index = low;
+}
+
+void AnimationTrack::Compress(float animationLength, float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    if (compressed_)
+        return;
+
+    float timeScale = animationLength > 0.0f ? animationLength / 65535.0f : 0.0f;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        compressedChannels_[i] = CompressedAnimationChannel();
+        compressedChannels_[i].timeScale_ = timeScale;
+    }
+
+    if (channelMask_ & CHANNEL_POSITION)
+        CompressVector3Channel(keyFrames_, &AnimationKeyFrame::position_, positionTolerance, compressedChannels_[0]);
+    if (channelMask_ & CHANNEL_ROTATION)
+        CompressRotationChannel(keyFrames_, rotationTolerance, compressedChannels_[1]);
+    if (channelMask_ & CHANNEL_SCALE)
+        CompressVector3Channel(keyFrames_, &AnimationKeyFrame::scale_, scaleTolerance, compressedChannels_[2]);
+
+    keyFrames_.Clear();
+    uniformInterval_ = 0.0f;
+    compressed_ = true;
 }
 
 AnimationKeyFrame* AnimationTrack::GetKeyFrame(unsigned index)
@@ -89,21 +402,90 @@ AnimationKeyFrame* AnimationTrack::GetKeyFrame(unsigned index)
     return index < keyFrames_.Size() ? &keyFrames_[index] : (AnimationKeyFrame*)0;
 }
 
+static unsigned ReadCompressedChannel(Deserializer& source, bool hasRange, CompressedAnimationChannel& dest)
+{
+    unsigned keyFrames = source.ReadUInt();
+    if (hasRange)
+    {
+        dest.min_ = source.ReadVector3();
+        dest.range_ = source.ReadVector3();
+    }
+
+    dest.times_.Resize(keyFrames);
+    dest.values_.Resize(keyFrames * 3);
+    if (keyFrames)
+    {
+        source.Read(&dest.times_[0], keyFrames * sizeof(unsigned short));
+        source.Read(&dest.values_[0], keyFrames * 3 * sizeof(unsigned short));
+    }
+
+    return keyFrames * 4 * sizeof(unsigned short);
+}
+
+static void WriteCompressedChannel(Serializer& dest, bool hasRange, const CompressedAnimationChannel& channel)
+{
+    unsigned keyFrames = channel.GetNumKeyFrames();
+    dest.WriteUInt(keyFrames);
+    if (hasRange)
+    {
+        dest.WriteVector3(channel.min_);
+        dest.WriteVector3(channel.range_);
+    }
+
+    if (keyFrames)
+    {
+        dest.Write(&channel.times_[0], keyFrames * sizeof(unsigned short));
+        dest.Write(&channel.values_[0], keyFrames * 3 * sizeof(unsigned short));
+    }
+}
+
 void AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
 {
     if (time < 0.0f)
         time = 0.0f;
 
-    if (index >= keyFrames_.Size())
-        index = keyFrames_.Size() - 1;
+    unsigned numKeyFrames = keyFrames_.Size();
+    if (index >= numKeyFrames)
+        index = numKeyFrames - 1;
 
-    // Check for being too far ahead
-    while (index && time < keyFrames_[index].time_)
-        --index;
+    // Check whether the previous index is still valid, or whether playback has advanced to the next keyframe
+    if (time >= keyFrames_[index].time_ || !index)
+    {
+        if (index + 1 >= numKeyFrames || time < keyFrames_[index + 1].time_)
+            return;
+        if (index + 2 >= numKeyFrames || time < keyFrames_[index + 2].time_)
+        {
+            ++index;
+            return;
+        }
+    }
 
-    // Check for being too far behind
-    while (index < keyFrames_.Size() - 1 && time >= keyFrames_[index + 1].time_)
-        ++index;
+    if (uniformInterval_ > 0.0f)
+    {
+        // Evenly spaced keyframes: compute the index, then correct for rounding
+        float position = (time - keyFrames_[0].time_) / uniformInterval_;
+        index = position > 0.0f ? Min((unsigned)position, numKeyFrames - 1) : 0;
+        if (index && time < keyFrames_[index].time_)
+            --index;
+        else if (index + 1 < numKeyFrames && time >= keyFrames_[index + 1].time_)
+            ++index;
+        // If the keyframes were modified directly without updating the interval, fall back to searching
+        if ((!index || time >= keyFrames_[index].time_) && (index + 1 >= numKeyFrames || time < keyFrames_[index + 1].time_))
+            return;
+    }
+
+    // Binary search for the last keyframe not after the time
+    unsigned low = 0;
+    unsigned high = numKeyFrames;
+    while (low + 1 < high)
+    {
+        unsigned middle = (low + high) >> 1;
+        if (time < keyFrames_[middle].time_)
+            high = middle;
+        else
+            low = middle;
+    }
+    index = low;
 }
 
 Animation::Animation(Context* context) :
@@ -126,7 +508,9 @@ bool Animation::BeginLoad(Deserializer& source)
     unsigned memoryUse = sizeof(Animation);
 
     // Check ID
-    if (source.ReadFileID() != "UANI")
+    String fileID = source.ReadFileID();
+    bool compressed = fileID == "UANC";
+    if (fileID != "UANI" && !compressed)
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid animation file");
         return false;
@@ -147,6 +531,20 @@ bool Animation::BeginLoad(Deserializer& source)
         AnimationTrack* newTrack = CreateTrack(source.ReadString());
         newTrack->channelMask_ = source.ReadUByte();
 
+        if (compressed)
+        {
+            float timeScale = length_ / 65535.0f;
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                CompressedAnimationChannel& channel = newTrack->compressedChannels_[j];
+                channel.timeScale_ = timeScale;
+                if (newTrack->channelMask_ & (1 << j))
+                    memoryUse += ReadCompressedChannel(source, j != 1, channel);
+            }
+            newTrack->compressed_ = true;
+            continue;
+        }
+
         unsigned keyFrames = source.ReadUInt();
         newTrack->keyFrames_.Resize(keyFrames);
         memoryUse += keyFrames * sizeof(AnimationKeyFrame);
@@ -163,6 +561,8 @@ bool Animation::BeginLoad(Deserializer& source)
             if (newTrack->channelMask_ & CHANNEL_SCALE)
                 newKeyFrame.scale_ = source.ReadVector3();
         }
+
+        newTrack->UpdateUniformInterval();
     }
 
     // Optionally read triggers from an XML file
@@ -223,8 +623,10 @@ bool Animation::BeginLoad(Deserializer& source)
 
 bool Animation::Save(Serializer& dest) const
 {
+    bool compressed = IsCompressed();
+
     // Write ID, name and length
-    dest.WriteFileID("UANI");
+    dest.WriteFileID(compressed ? "UANC" : "UANI");
     dest.WriteString(animationName_);
     dest.WriteFloat(length_);
 
@@ -235,6 +637,27 @@ bool Animation::Save(Serializer& dest) const
         const AnimationTrack& track = i->second_;
         dest.WriteString(track.name_);
         dest.WriteUByte(track.channelMask_);
+
+        if (compressed)
+        {
+            // Tracks added after compressing are compressed losslessly apart from quantization
+            AnimationTrack compressedTrack;
+            const AnimationTrack* source = &track;
+            if (!track.compressed_)
+            {
+                compressedTrack = track;
+                compressedTrack.Compress(length_, 0.0f, 0.0f, 0.0f);
+                source = &compressedTrack;
+            }
+
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                if (track.channelMask_ & (1 << j))
+                    WriteCompressedChannel(dest, j != 1, source->compressedChannels_[j]);
+            }
+            continue;
+        }
+
         dest.WriteUInt(track.keyFrames_.Size());
 
         // Write keyframes of the track
@@ -378,6 +801,23 @@ SharedPtr<Animation> Animation::Clone(const String& cloneName) const
     return ret;
 }
 
+void Animation::Compress(float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+        i->second_.Compress(length_, positionTolerance, rotationTolerance, scaleTolerance);
+}
+
+bool Animation::IsCompressed() const
+{
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        if (i->second_.compressed_)
+            return true;
+    }
+
+    return false;
+}
+
 AnimationTrack* Animation::GetTrack(const String& name)
 {
     HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Find(StringHash(name));
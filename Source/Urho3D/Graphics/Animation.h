@@ -50,12 +50,52 @@ struct AnimationKeyFrame
     Vector3 scale_;
 };
 
+/// Compressed keyframes of one channel (position, rotation or scale) of an animation track. Keyframe times are quantized to 16 bits relative to the animation length, positions and scales to 16 bits per component within the channel's value range, and rotations with smallest-three encoding into 48 bits.
+struct URHO3D_API CompressedAnimationChannel
+{
+    /// Construct.
+    CompressedAnimationChannel() :
+        timeScale_(0.0f),
+        min_(Vector3::ZERO),
+        range_(Vector3::ZERO)
+    {
+    }
+
+    /// Return number of keyframes. A channel whose value does not change has a single keyframe.
+    unsigned GetNumKeyFrames() const { return times_.Size(); }
+    /// Return keyframe time.
+    float GetTime(unsigned index) const { return times_[index] * timeScale_; }
+    /// Decode a position or scale keyframe.
+    Vector3 GetVector3(unsigned index) const
+    {
+        const unsigned short* value = &values_[index * 3];
+        return Vector3(min_.x_ + value[0] * range_.x_, min_.y_ + value[1] * range_.y_, min_.z_ + value[2] * range_.z_);
+    }
+    /// Decode a rotation keyframe.
+    Quaternion GetQuaternion(unsigned index) const;
+    /// Return keyframe index based on time and previous index.
+    void GetKeyFrameIndex(float time, unsigned& index) const;
+
+    /// Quantized keyframe times.
+    PODVector<unsigned short> times_;
+    /// Quantized keyframe values, three per keyframe.
+    PODVector<unsigned short> values_;
+    /// Time of one quantization step.
+    float timeScale_;
+    /// Minimum position or scale value.
+    Vector3 min_;
+    /// Position or scale value of one quantization step.
+    Vector3 range_;
+};
+
 /// Skeletal animation track, stores keyframes of a single bone.
 struct URHO3D_API AnimationTrack
 {
     /// Construct.
     AnimationTrack() :
-        channelMask_(0)
+        channelMask_(0),
+        uniformInterval_(0.0f),
+        compressed_(false)
     {
     }
 
@@ -69,12 +109,22 @@ struct URHO3D_API AnimationTrack
     void RemoveKeyFrame(unsigned index);
     /// Remove all keyframes.
     void RemoveAllKeyFrames();
+    /// Resample the keyframes at a fixed time interval between the first and last keyframe. The interval is adjusted slightly so that the last keyframe is kept.
+    void Resample(float interval);
+    /// Check whether the keyframes are evenly spaced, which allows constant time keyframe lookup. Called on load and after resampling; call manually after modifying keyFrames_ directly.
+    void UpdateUniformInterval();
+    /// Compress the keyframes into the compressed channels and remove them. Channels that stay within the tolerance of their first value are stored as a single keyframe, and keyframes that can be interpolated from their neighbours within the tolerance are removed. Position and scale tolerances are in units, the rotation tolerance in radians.
+    void Compress(float animationLength, float positionTolerance, float rotationTolerance, float scaleTolerance);
 
     /// Return keyframe at index, or null if not found.
     AnimationKeyFrame* GetKeyFrame(unsigned index);
     /// Return number of keyframes.
     unsigned GetNumKeyFrames() const { return keyFrames_.Size(); }
-    /// Return keyframe index based on time and previous index.
+    /// Return keyframe interval if the keyframes are evenly spaced, or zero if not.
+    float GetUniformInterval() const { return uniformInterval_; }
+    /// Return whether the track is compressed. A compressed track has no keyframes, only compressed channels.
+    bool IsCompressed() const { return compressed_; }
+    /// Return keyframe index based on time and previous index. The previous index acts as a cursor: advancing to the next keyframe is checked first, otherwise the index is computed directly for evenly spaced keyframes or found with a binary search.
     void GetKeyFrameIndex(float time, unsigned& index) const;
 
     /// Bone or scene node name.
@@ -85,6 +135,12 @@ struct URHO3D_API AnimationTrack
     unsigned char channelMask_;
     /// Keyframes.
     Vector<AnimationKeyFrame> keyFrames_;
+    /// Keyframe interval if evenly spaced, zero if not.
+    float uniformInterval_;
+    /// Compressed position, rotation and scale channels.
+    CompressedAnimationChannel compressedChannels_[3];
+    /// Compressed flag.
+    bool compressed_;
 };
 
 /// %Animation trigger point.
@@ -148,6 +204,8 @@ public:
     void SetNumTriggers(unsigned num);
     /// Clone the animation.
     SharedPtr<Animation> Clone(const String& cloneName = String::EMPTY) const;
+    /// Compress all tracks. Compressed animations are saved in the compressed format and decoded during playback. Position and scale tolerances are in units, the rotation tolerance in radians.
+    void Compress(float positionTolerance = 0.001f, float rotationTolerance = 0.001f, float scaleTolerance = 0.001f);
 
     /// Return animation name.
     const String& GetAnimationName() const { return animationName_; }
@@ -164,6 +222,9 @@ public:
     /// Return number of animation tracks.
     unsigned GetNumTracks() const { return tracks_.Size(); }
 
+    /// Return whether any track is compressed.
+    bool IsCompressed() const;
+
     /// Return animation track by name.
     AnimationTrack* GetTrack(const String& name);
     /// Return animation track by name hash.
@@ -33,12 +33,39 @@
 namespace Urho3D
 {
 
+/// Find the keyframes of a compressed channel to interpolate between and return the interpolation factor.
+static float GetCompressedKeyFrames(const CompressedAnimationChannel& channel, float time, float length, bool looped,
+    unsigned& frame, unsigned& nextFrame)
+{
+    channel.GetKeyFrameIndex(time, frame);
+
+    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+    nextFrame = frame + 1;
+    if (nextFrame >= channel.GetNumKeyFrames())
+    {
+        if (!looped)
+        {
+            nextFrame = frame;
+            return 0.0f;
+        }
+        else
+            nextFrame = 0;
+    }
+
+    float frameTime = channel.GetTime(frame);
+    float timeInterval = channel.GetTime(nextFrame) - frameTime;
+    if (timeInterval < 0.0f)
+        timeInterval += length;
+    return timeInterval > 0.0f ? (time - frameTime) / timeInterval : 1.0f;
+}
+
 AnimationStateTrack::AnimationStateTrack() :
     track_(0),
     bone_(0),
     weight_(1.0f),
     keyFrame_(0)
 {
+    compressedKeyFrames_[0] = compressedKeyFrames_[1] = compressedKeyFrames_[2] = 0;
 }
 
 AnimationStateTrack::~AnimationStateTrack()
@@ -483,58 +510,67 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
     const AnimationTrack* track = stateTrack.track_;
     Node* node = stateTrack.node_;
 
-    if (track->keyFrames_.Empty() || !node)
+    if ((track->keyFrames_.Empty() && !track->compressed_) || !node)
         return;
 
-    unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
-
-    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-    unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.Size())
-    {
-        if (!looped_)
-        {
-            nextFrame = frame;
-            interpolate = false;
-        }
-        else
-            nextFrame = 0;
-    }
-
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
     unsigned char channelMask = track->channelMask_;
 
     Vector3 newPosition;
     Quaternion newRotation;
     Vector3 newScale;
 
-    if (interpolate)
+    if (track->compressed_)
     {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
-
-        if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
-        if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
-        if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
+        if (!SampleCompressedTrack(stateTrack, newPosition, newRotation, newScale))
+            return;
     }
     else
     {
-        if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_;
-        if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_;
-        if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_;
+        unsigned& frame = stateTrack.keyFrame_;
+        track->GetKeyFrameIndex(time_, frame);
+
+        // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+        unsigned nextFrame = frame + 1;
+        bool interpolate = true;
+        if (nextFrame >= track->keyFrames_.Size())
+        {
+            if (!looped_)
+            {
+                nextFrame = frame;
+                interpolate = false;
+            }
+            else
+                nextFrame = 0;
+        }
+
+        const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
+
+        if (interpolate)
+        {
+            const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
+            float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
+            if (timeInterval < 0.0f)
+                timeInterval += animation_->GetLength();
+            float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
+
+            if (channelMask & CHANNEL_POSITION)
+                newPosition = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
+            if (channelMask & CHANNEL_ROTATION)
+                newRotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
+            if (channelMask & CHANNEL_SCALE)
+                newScale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
+        }
+        else
+        {
+            if (channelMask & CHANNEL_POSITION)
+                newPosition = keyFrame->position_;
+            if (channelMask & CHANNEL_ROTATION)
+                newRotation = keyFrame->rotation_;
+            if (channelMask & CHANNEL_SCALE)
+                newScale = keyFrame->scale_;
+        }
     }
-    
+
     if (blendingMode_ == ABM_ADDITIVE) // not ABM_LERP
     {
         if (channelMask & CHANNEL_POSITION)
@@ -588,4 +624,43 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
     }
 }
 
+bool AnimationState::SampleCompressedTrack(AnimationStateTrack& stateTrack, Vector3& position, Quaternion& rotation, Vector3& scale)
+{
+    const AnimationTrack* track = stateTrack.track_;
+    unsigned char channelMask = track->channelMask_;
+    float length = animation_->GetLength();
+    unsigned nextFrame;
+
+    if (channelMask & CHANNEL_POSITION)
+    {
+        const CompressedAnimationChannel& channel = track->compressedChannels_[0];
+        if (!channel.GetNumKeyFrames())
+            return false;
+        unsigned& frame = stateTrack.compressedKeyFrames_[0];
+        float t = GetCompressedKeyFrames(channel, time_, length, looped_, frame, nextFrame);
+        position = channel.GetVector3(frame).Lerp(channel.GetVector3(nextFrame), t);
+    }
+    if (channelMask & CHANNEL_ROTATION)
+    {
+        const CompressedAnimationChannel& channel = track->compressedChannels_[1];
+        if (!channel.GetNumKeyFrames())
+            return false;
+        unsigned& frame = stateTrack.compressedKeyFrames_[1];
+        float t = GetCompressedKeyFrames(channel, time_, length, looped_, frame, nextFrame);
+        rotation = frame != nextFrame ? channel.GetQuaternion(frame).Slerp(channel.GetQuaternion(nextFrame), t) :
+            channel.GetQuaternion(frame);
+    }
+    if (channelMask & CHANNEL_SCALE)
+    {
+        const CompressedAnimationChannel& channel = track->compressedChannels_[2];
+        if (!channel.GetNumKeyFrames())
+            return false;
+        unsigned& frame = stateTrack.compressedKeyFrames_[2];
+        float t = GetCompressedKeyFrames(channel, time_, length, looped_, frame, nextFrame);
+        scale = channel.GetVector3(frame).Lerp(channel.GetVector3(nextFrame), t);
+    }
+
+    return true;
+}
+
 }
@@ -63,6 +63,8 @@ struct AnimationStateTrack
     float weight_;
     /// Last key frame.
     unsigned keyFrame_;
+    /// Last key frames of the position, rotation and scale channels of a compressed track.
+    unsigned compressedKeyFrames_[3];
 };
 
 /// %Animation instance.
@@ -152,6 +154,8 @@ private:
     void ApplyToNodes();
     /// Apply track.
     void ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent);
+    /// Decode and interpolate the channels of a compressed track. Return false if a channel has no keyframes.
+    bool SampleCompressedTrack(AnimationStateTrack& stateTrack, Vector3& position, Quaternion& rotation, Vector3& scale);
 
     /// Animated model (model mode.)
     WeakPtr<AnimatedModel> model_;
@@ -643,12 +643,24 @@ void Batch::Draw(View* view, Camera* camera, bool allowDepthWrite) const
 }
 
 void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
+{
+    if (ReserveInstancingData(freeIndex))
+        WriteInstancingData(lockedData, stride);
+}
+
+bool BatchGroup::ReserveInstancingData(unsigned& freeIndex)
 {
     // Do not use up buffer space if not going to draw as instanced
     if (geometryType_ != GEOM_INSTANCED)
-        return;
+        return false;
 
     startIndex_ = freeIndex;
+    freeIndex += instances_.Size();
+    return true;
+}
+
+void BatchGroup::WriteInstancingData(void* lockedData, unsigned stride) const
+{
     unsigned char* buffer = static_cast<unsigned char*>(lockedData) + startIndex_ * stride;
 
     for (unsigned i = 0; i < instances_.Size(); ++i)
@@ -661,8 +673,6 @@ void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned&
 
         buffer += stride;
     }
-
-    freeIndex += instances_.Size();
 }
 
 void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
@@ -717,16 +727,19 @@ unsigned BatchGroupKey::ToHash() const
                       (size_t)material_ / sizeof(Material) + (size_t)geometry_ / sizeof(Geometry)) + renderOrder_;
 }
 
-void BatchQueue::Clear(int maxSortedInstances)
+void BatchQueue::Clear(int maxSortedInstances, FrameAllocator* allocator)
 {
     batches_.Clear();
     sortedBatches_.Clear();
-    batchGroups_.Clear();
+    sortedBatchGroups_.Clear();
+    batchGroups_.SetAllocator(allocator);
     maxSortedInstances_ = (unsigned)maxSortedInstances;
 }
 
-void BatchQueue::SortBackToFront()
+void BatchQueue::SortBackToFront(FrameAllocator* allocator)
 {
+    sortedBatches_.SetAllocator(allocator);
+    sortedBatchGroups_.SetAllocator(allocator);
     sortedBatches_.Resize(batches_.Size());
 
     for (unsigned i = 0; i < batches_.Size(); ++i)
@@ -737,15 +750,19 @@ void BatchQueue::SortBackToFront()
     sortedBatchGroups_.Resize(batchGroups_.Size());
     
     unsigned index = 0;
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
-        sortedBatchGroups_[index++] = &i->second_;
+    for (FlatHashMap<BatchGroupKey, BatchGroup*>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+        sortedBatchGroups_[index++] = i->second_;
     
     Sort(sortedBatchGroups_.Begin(), sortedBatchGroups_.End(), CompareBatchGroupOrder);
 }
 
-void BatchQueue::SortFrontToBack()
+void BatchQueue::SortFrontToBack(FrameAllocator* allocator)
 {
-    sortedBatches_.Clear();
+    sortedBatches_.SetAllocator(allocator);
+    sortedBatchGroups_.SetAllocator(allocator);
+    shaderRemapping_.SetAllocator(allocator);
+    materialRemapping_.SetAllocator(allocator);
+    geometryRemapping_.SetAllocator(allocator);
 
     for (unsigned i = 0; i < batches_.Size(); ++i)
         sortedBatches_.Push(&batches_[i]);
@@ -753,33 +770,34 @@ void BatchQueue::SortFrontToBack()
     SortFrontToBack2Pass(sortedBatches_);
 
     // Sort each group front to back
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup*>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
     {
-        if (i->second_.instances_.Size() <= maxSortedInstances_)
+        BatchGroup* group = i->second_;
+        if (group->instances_.Size() <= maxSortedInstances_)
         {
-            Sort(i->second_.instances_.Begin(), i->second_.instances_.End(), CompareInstancesFrontToBack);
-            if (i->second_.instances_.Size())
-                i->second_.distance_ = i->second_.instances_[0].distance_;
+            Sort(group->instances_.Begin(), group->instances_.End(), CompareInstancesFrontToBack);
+            if (group->instances_.Size())
+                group->distance_ = group->instances_[0].distance_;
         }
         else
         {
             float minDistance = M_INFINITY;
-            for (PODVector<InstanceData>::ConstIterator j = i->second_.instances_.Begin(); j != i->second_.instances_.End(); ++j)
+            for (FrameVector<InstanceData>::ConstIterator j = group->instances_.Begin(); j != group->instances_.End(); ++j)
                 minDistance = Min(minDistance, j->distance_);
-            i->second_.distance_ = minDistance;
+            group->distance_ = minDistance;
         }
     }
 
     sortedBatchGroups_.Resize(batchGroups_.Size());
 
     unsigned index = 0;
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
-        sortedBatchGroups_[index++] = &i->second_;
+    for (FlatHashMap<BatchGroupKey, BatchGroup*>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+        sortedBatchGroups_[index++] = i->second_;
 
-    SortFrontToBack2Pass(reinterpret_cast<PODVector<Batch*>& >(sortedBatchGroups_));
+    SortFrontToBack2Pass(reinterpret_cast<FrameVector<Batch*>& >(sortedBatchGroups_));
 }
 
-void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
+void BatchQueue::SortFrontToBack2Pass(FrameVector<Batch*>& batches)
 {
     // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant. The 2-pass
     // method is also time consuming, so just sort with state having priority
@@ -793,12 +811,12 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
     unsigned short freeMaterialID = 0;
     unsigned short freeGeometryID = 0;
 
-    for (PODVector<Batch*>::Iterator i = batches.Begin(); i != batches.End(); ++i)
+    for (FrameVector<Batch*>::Iterator i = batches.Begin(); i != batches.End(); ++i)
     {
         Batch* batch = *i;
 
         unsigned shaderID = (unsigned)(batch->sortKey_ >> 32);
-        HashMap<unsigned, unsigned>::ConstIterator j = shaderRemapping_.Find(shaderID);
+        FlatHashMap<unsigned, unsigned>::ConstIterator j = shaderRemapping_.Find(shaderID);
         if (j != shaderRemapping_.End())
             shaderID = j->second_;
         else
@@ -808,7 +826,7 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
         }
 
         unsigned short materialID = (unsigned short)(batch->sortKey_ & 0xffff0000);
-        HashMap<unsigned short, unsigned short>::ConstIterator k = materialRemapping_.Find(materialID);
+        FlatHashMap<unsigned short, unsigned short>::ConstIterator k = materialRemapping_.Find(materialID);
         if (k != materialRemapping_.End())
             materialID = k->second_;
         else
@@ -818,7 +836,7 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
         }
 
         unsigned short geometryID = (unsigned short)(batch->sortKey_ & 0xffff);
-        HashMap<unsigned short, unsigned short>::ConstIterator l = geometryRemapping_.Find(geometryID);
+        FlatHashMap<unsigned short, unsigned short>::ConstIterator l = geometryRemapping_.Find(geometryID);
         if (l != geometryRemapping_.End())
             geometryID = l->second_;
         else
@@ -841,8 +859,17 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
 
 void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
 {
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
-        i->second_.SetInstancingData(lockedData, stride, freeIndex);
+    for (FlatHashMap<BatchGroupKey, BatchGroup*>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+        i->second_->SetInstancingData(lockedData, stride, freeIndex);
+}
+
+void BatchQueue::ReserveInstancingData(unsigned& freeIndex, PODVector<BatchGroup*>& groups)
+{
+    for (FlatHashMap<BatchGroupKey, BatchGroup*>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    {
+        if (i->second_->ReserveInstancingData(freeIndex))
+            groups.Push(i->second_);
+    }
 }
 
 void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const
@@ -861,7 +888,7 @@ void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool using
     }
 
     // Instanced
-    for (PODVector<BatchGroup*>::ConstIterator i = sortedBatchGroups_.Begin(); i != sortedBatchGroups_.End(); ++i)
+    for (FrameVector<BatchGroup*>::ConstIterator i = sortedBatchGroups_.Begin(); i != sortedBatchGroups_.End(); ++i)
     {
         BatchGroup* group = *i;
         if (markToStencil)
@@ -870,7 +897,7 @@ void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool using
         group->Draw(view, camera, allowDepthWrite);
     }
     // Non-instanced
-    for (PODVector<Batch*>::ConstIterator i = sortedBatches_.Begin(); i != sortedBatches_.End(); ++i)
+    for (FrameVector<Batch*>::ConstIterator i = sortedBatches_.Begin(); i != sortedBatches_.End(); ++i)
     {
         Batch* batch = *i;
         if (markToStencil)
@@ -892,10 +919,10 @@ unsigned BatchQueue::GetNumInstances() const
 {
     unsigned total = 0;
 
-    for (HashMap<BatchGroupKey, BatchGroup>::ConstIterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup*>::ConstIterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
     {
-        if (i->second_.geometryType_ == GEOM_INSTANCED)
-            total += i->second_.instances_.Size();
+        if (i->second_->geometryType_ == GEOM_INSTANCED)
+            total += i->second_->instances_.Size();
     }
 
     return total;
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
+#include "../Container/FrameAllocator.h"
 #include "../Container/Ptr.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Material.h"
@@ -173,11 +175,15 @@ struct BatchGroup : public Batch
 
     /// Pre-set the instance data. Buffer must be big enough to hold all data.
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
+    /// Reserve space for the instance data without writing it yet. Return true if instance data is needed.
+    bool ReserveInstancingData(unsigned& freeIndex);
+    /// Write the instance data to the previously reserved space.
+    void WriteInstancingData(void* lockedData, unsigned stride) const;
     /// Prepare and draw.
     void Draw(View* view, Camera* camera, bool allowDepthWrite) const;
 
-    /// Instance data.
-    PODVector<InstanceData> instances_;
+    /// Instance data. Allocated from the main thread frame allocator.
+    FrameVector<InstanceData> instances_;
     /// Instance stream start index, or M_MAX_UNSIGNED if transforms not pre-set.
     unsigned startIndex_;
 };
@@ -236,16 +242,18 @@ struct BatchGroupKey
 struct BatchQueue
 {
 public:
-    /// Clear for new frame by clearing all groups and batches.
-    void Clear(int maxSortedInstances);
-    /// Sort non-instanced draw calls back to front.
-    void SortBackToFront();
-    /// Sort instanced and non-instanced draw calls front to back.
-    void SortFrontToBack();
+    /// Clear for new frame by clearing all groups and batches. The group map storage is taken from the frame allocator if given.
+    void Clear(int maxSortedInstances, FrameAllocator* allocator = 0);
+    /// Sort non-instanced draw calls back to front. The sorted vectors are taken from the executing thread's frame allocator if given.
+    void SortBackToFront(FrameAllocator* allocator = 0);
+    /// Sort instanced and non-instanced draw calls front to back. The sorted vectors and remapping tables are taken from the executing thread's frame allocator if given.
+    void SortFrontToBack(FrameAllocator* allocator = 0);
     /// Sort batches front to back while also maintaining state sorting.
-    void SortFrontToBack2Pass(PODVector<Batch*>& batches);
+    void SortFrontToBack2Pass(FrameVector<Batch*>& batches);
     /// Pre-set instance data of all groups. The vertex buffer must be big enough to hold all data.
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
+    /// Reserve instance data space for all groups and collect the groups which need their data written.
+    void ReserveInstancingData(unsigned& freeIndex, PODVector<BatchGroup*>& groups);
     /// Draw.
     void Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const;
     /// Return the combined amount of instances.
@@ -254,21 +262,21 @@ public:
     /// Return whether the batch group is empty.
     bool IsEmpty() const { return batches_.Empty() && batchGroups_.Empty(); }
 
-    /// Instanced draw calls.
-    HashMap<BatchGroupKey, BatchGroup> batchGroups_;
+    /// Instanced draw calls. The groups are allocated from the main thread frame allocator, so rehashing moves only pointers.
+    FlatHashMap<BatchGroupKey, BatchGroup*> batchGroups_;
     /// Shader remapping table for 2-pass state and distance sort.
-    HashMap<unsigned, unsigned> shaderRemapping_;
+    FlatHashMap<unsigned, unsigned> shaderRemapping_;
     /// Material remapping table for 2-pass state and distance sort.
-    HashMap<unsigned short, unsigned short> materialRemapping_;
+    FlatHashMap<unsigned short, unsigned short> materialRemapping_;
     /// Geometry remapping table for 2-pass state and distance sort.
-    HashMap<unsigned short, unsigned short> geometryRemapping_;
+    FlatHashMap<unsigned short, unsigned short> geometryRemapping_;
 
     /// Unsorted non-instanced draw calls.
     PODVector<Batch> batches_;
     /// Sorted non-instanced draw calls.
-    PODVector<Batch*> sortedBatches_;
+    FrameVector<Batch*> sortedBatches_;
     /// Sorted instanced draw calls.
-    PODVector<BatchGroup*> sortedBatchGroups_;
+    FrameVector<BatchGroup*> sortedBatchGroups_;
     /// Maximum sorted instances.
     unsigned maxSortedInstances_;
     /// Whether the pass command contains extra shader defines.
@@ -91,6 +91,7 @@ Drawable::Drawable(Context* context, unsigned char drawableFlags) :
     updateQueued_(false),
     zoneDirty_(false),
     octant_(0),
+    treeLeaf_(M_MAX_UNSIGNED),
     zone_(0),
     viewMask_(DEFAULT_VIEWMASK),
     lightMask_(DEFAULT_LIGHTMASK),
@@ -211,6 +212,8 @@ void Drawable::SetLodBias(float bias)
 void Drawable::SetViewMask(unsigned mask)
 {
     viewMask_ = mask;
+    if (octant_)
+        octant_->MarkBoundsDirty();
     MarkNetworkUpdate();
 }
 
@@ -391,9 +394,16 @@ void Drawable::OnSceneSet(Scene* scene)
         RemoveFromOctree();
 }
 
-void Drawable::OnMarkedDirty(Node* node)
+void Drawable::MarkWorldBoundingBoxDirty()
 {
     worldBoundingBoxDirty_ = true;
+    if (octant_)
+        octant_->MarkBoundsDirty();
+}
+
+void Drawable::OnMarkedDirty(Node* node)
+{
+    MarkWorldBoundingBoxDirty();
     if (!updateQueued_ && octant_)
         octant_->GetRoot()->QueueUpdate(this);
 
@@ -321,6 +321,8 @@ protected:
 
     /// Move into another octree octant.
     void SetOctant(Octant* octant) { octant_ = octant; }
+    /// Mark the world-space bounding box dirty, and the octant's packed bounds for rebuild.
+    void MarkWorldBoundingBoxDirty();
 
     /// World-space bounding box.
     BoundingBox worldBoundingBox_;
@@ -344,6 +346,8 @@ protected:
     bool zoneDirty_;
     /// Octree octant.
     Octant* octant_;
+    /// Leaf node index in the octree's AABB tree, or M_MAX_UNSIGNED if not in an AABB tree.
+    unsigned treeLeaf_;
     /// Current zone.
     Zone* zone_;
     /// View mask.
@@ -22,12 +22,16 @@
 
 #include "../Precompiled.h"
 
-#include "../Core/WorkQueue.h"
+#include "../Core/ParallelFor.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -40,21 +44,61 @@ static const unsigned CLIPMASK_Y_NEG = 0x8;
 static const unsigned CLIPMASK_Z_POS = 0x10;
 static const unsigned CLIPMASK_Z_NEG = 0x20;
 
-void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
+/// Parallel loop body for setting up and binning the triangles of occlusion batches.
+struct SetupOcclusionBatchesLoop
 {
-    OcclusionBuffer* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
-    OcclusionBatch& batch = *reinterpret_cast<OcclusionBatch*>(item->start_);
-    buffer->DrawBatch(batch, threadIndex);
-}
+    /// Construct.
+    SetupOcclusionBatchesLoop(OcclusionBuffer* buffer) :
+        buffer_(buffer)
+    {
+    }
+
+    /// Set up a range of batches.
+    void operator ()(const OcclusionBatch* start, const OcclusionBatch* end, unsigned threadIndex)
+    {
+        for (const OcclusionBatch* i = start; i < end; ++i)
+            buffer_->DrawBatch(*i, threadIndex);
+    }
+
+    /// Occlusion buffer.
+    OcclusionBuffer* buffer_;
+};
+
+/// Parallel loop body for drawing occlusion screen tiles.
+struct DrawOcclusionTilesLoop
+{
+    /// Construct.
+    DrawOcclusionTilesLoop(OcclusionBuffer* buffer, const IntRect* tiles) :
+        buffer_(buffer),
+        tiles_(tiles)
+    {
+    }
+
+    /// Draw a range of tiles.
+    void operator ()(const IntRect* start, const IntRect* end, unsigned threadIndex)
+    {
+        for (const IntRect* i = start; i < end; ++i)
+            buffer_->DrawTile((unsigned)(i - tiles_));
+    }
+
+    /// Occlusion buffer.
+    OcclusionBuffer* buffer_;
+    /// First tile.
+    const IntRect* tiles_;
+};
 
 OcclusionBuffer::OcclusionBuffer(Context* context) :
     Object(context),
+    data_(0),
+    numTilesX_(0),
     width_(0),
     height_(0),
     numTriangles_(0),
     maxTriangles_(OCCLUSION_DEFAULT_MAX_TRIANGLES),
     cullMode_(CULL_CCW),
+    firstDirtyMipLevel_(0),
     depthHierarchyDirty_(true),
+    threaded_(false),
     reverseCulling_(false),
     nearClip_(0.0f),
     farClip_(0.0f)
@@ -71,7 +115,12 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     if (height & 1)
         ++height;
 
-    if (width == width_ && height == height_)
+    // Threading requires the width to be a multiple of the tile size. Tiles are drawn in groups of four pixels, which must not
+    // reach into the next row, and their first mip levels are built independently, which must not read texels of the next
+    // row at odd mip widths. A power of two width of at least one tile also fulfills this
+    threaded = threaded && width >= OCCLUSION_TILE_SIZE && !(width & (OCCLUSION_TILE_SIZE - 1));
+
+    if (width == width_ && height == height_ && threaded == threaded_)
         return true;
 
     if (width <= 0 || height <= 0)
@@ -85,17 +134,28 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
 
     width_ = width;
     height_ = height;
-
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
-    buffers_.Resize(numThreadBuffers);
-    for (unsigned i = 0; i < numThreadBuffers; ++i)
+    threaded_ = threaded;
+
+    // Reserve extra memory in case 3D clipping is not exact
+    dataWithSafety_ = new int[width * (height + 2) + 2];
+    data_ = dataWithSafety_.Get() + width + 1;
+
+    // Build screen tiles and per-thread triangle bins for threading. Threads bin triangles independently, after which
+    // each tile is drawn by one thread, so no merging of thread results is needed
+    tiles_.Clear();
+    threadData_.Clear();
+    numTilesX_ = (width + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE;
+    if (threaded)
     {
-        // Reserve extra memory in case 3D clipping is not exact
-        OcclusionBufferData& buffer = buffers_[i];
-        buffer.dataWithSafety_ = new int[width * (height + 2) + 2];
-        buffer.data_ = buffer.dataWithSafety_.Get() + width + 1;
-        buffer.used_ = false;
+        for (int y = 0; y < height; y += OCCLUSION_TILE_SIZE)
+        {
+            for (int x = 0; x < width; x += OCCLUSION_TILE_SIZE)
+                tiles_.Push(IntRect(x, y, Min(x + OCCLUSION_TILE_SIZE, width), Min(y + OCCLUSION_TILE_SIZE, height)));
+        }
+
+        threadData_.Resize(GetSubsystem<WorkQueue>()->GetNumThreads() + 1);
+        for (unsigned i = 0; i < threadData_.Size(); ++i)
+            threadData_[i].bins_.Resize(tiles_.Size());
     }
 
     mipBuffers_.Clear();
@@ -113,7 +173,7 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     }
 
     URHO3D_LOGDEBUG("Set occlusion buffer size " + String(width_) + "x" + String(height_) + " with " +
-             String(mipBuffers_.Size()) + " mip levels and " + String(numThreadBuffers) + " thread buffers");
+             String(mipBuffers_.Size()) + " mip levels and " + String(tiles_.Size()) + " threaded tiles");
 
     CalculateViewport();
     return true;
@@ -159,12 +219,9 @@ void OcclusionBuffer::Reset()
 void OcclusionBuffer::Clear()
 {
     Reset();
+    ClearBuffer();
 
-    // Only clear the main thread buffer. Rest are cleared on-demand when drawing the first batch
-    ClearBuffer(0);
-    for (unsigned i = 1; i < buffers_.Size(); ++i)
-        buffers_[i].used_ = false;
-
+    firstDirtyMipLevel_ = 0;
     depthHierarchyDirty_ = true;
 }
 
@@ -206,32 +263,45 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.Size() == 1)
+    if (data_ && !threaded_)
     {
-        // Not threaded
         for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
             DrawBatch(*i, 0);
 
+        firstDirtyMipLevel_ = 0;
         depthHierarchyDirty_ = true;
     }
-    else if (buffers_.Size() > 1)
+    else if (threaded_)
     {
-        // Threaded
         WorkQueue* queue = GetSubsystem<WorkQueue>();
 
-        for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
+        for (unsigned i = 0; i < threadData_.Size(); ++i)
+        {
+            OcclusionThreadData& data = threadData_[i];
+            data.triangles_.Clear();
+            for (unsigned j = 0; j < data.bins_.Size(); ++j)
+                data.bins_[j].Clear();
+            data.numTriangles_ = 0;
+        }
+
+        // Transform, clip and bin the triangles of each batch
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = DrawOcclusionBatchWork;
-            item->aux_ = this;
-            item->start_ = &(*i);
-            queue->AddWorkItem(item);
+            URHO3D_PROFILE(SetupOcclusionTriangles);
+            SetupOcclusionBatchesLoop loop(this);
+            ParallelFor(queue, batches_.Buffer(), batches_.Buffer() + batches_.Size(), loop);
         }
 
-        queue->Complete(M_MAX_UNSIGNED);
+        for (unsigned i = 0; i < threadData_.Size(); ++i)
+            numTriangles_ += threadData_[i].numTriangles_;
 
-        MergeBuffers();
+        // Draw the tiles. The depth hierarchy levels that fit inside a tile are built at the same time
+        {
+            URHO3D_PROFILE(DrawOcclusionTiles);
+            DrawOcclusionTilesLoop loop(this, tiles_.Buffer());
+            ParallelFor(queue, tiles_.Buffer(), tiles_.Buffer() + tiles_.Size(), loop);
+        }
+
+        firstDirtyMipLevel_ = Min((unsigned)OCCLUSION_TILE_SHIFT, mipBuffers_.Size());
         depthHierarchyDirty_ = true;
     }
 
@@ -240,98 +310,12 @@ void OcclusionBuffer::DrawTriangles()
 
 void OcclusionBuffer::BuildDepthHierarchy()
 {
-    if (buffers_.Empty() || !depthHierarchyDirty_)
+    if (!data_ || !depthHierarchyDirty_)
         return;
 
     URHO3D_PROFILE(BuildDepthHierarchy);
 
-    // Build the first mip level from the pixel-level data
-    int width = (width_ + 1) / 2;
-    int height = (height_ + 1) / 2;
-    if (mipBuffers_.Size())
-    {
-        for (int y = 0; y < height; ++y)
-        {
-            int* src = buffers_[0].data_ + (y * 2) * width_;
-            DepthValue* dest = mipBuffers_[0].Get() + y * width;
-            DepthValue* end = dest + width;
-
-            if (y * 2 + 1 < height_)
-            {
-                int* src2 = src + width_;
-                while (dest < end)
-                {
-                    int minUpper = Min(src[0], src[1]);
-                    int minLower = Min(src2[0], src2[1]);
-                    dest->min_ = Min(minUpper, minLower);
-                    int maxUpper = Max(src[0], src[1]);
-                    int maxLower = Max(src2[0], src2[1]);
-                    dest->max_ = Max(maxUpper, maxLower);
-
-                    src += 2;
-                    src2 += 2;
-                    ++dest;
-                }
-            }
-            else
-            {
-                while (dest < end)
-                {
-                    dest->min_ = Min(src[0], src[1]);
-                    dest->max_ = Max(src[0], src[1]);
-
-                    src += 2;
-                    ++dest;
-                }
-            }
-        }
-    }
-
-    // Build the rest of the mip levels
-    for (unsigned i = 1; i < mipBuffers_.Size(); ++i)
-    {
-        int prevWidth = width;
-        int prevHeight = height;
-        width = (width + 1) / 2;
-        height = (height + 1) / 2;
-
-        for (int y = 0; y < height; ++y)
-        {
-            DepthValue* src = mipBuffers_[i - 1].Get() + (y * 2) * prevWidth;
-            DepthValue* dest = mipBuffers_[i].Get() + y * width;
-            DepthValue* end = dest + width;
-
-            if (y * 2 + 1 < prevHeight)
-            {
-                DepthValue* src2 = src + prevWidth;
-                while (dest < end)
-                {
-                    int minUpper = Min(src[0].min_, src[1].min_);
-                    int minLower = Min(src2[0].min_, src2[1].min_);
-                    dest->min_ = Min(minUpper, minLower);
-                    int maxUpper = Max(src[0].max_, src[1].max_);
-                    int maxLower = Max(src2[0].max_, src2[1].max_);
-                    dest->max_ = Max(maxUpper, maxLower);
-
-                    src += 2;
-                    src2 += 2;
-                    ++dest;
-                }
-            }
-            else
-            {
-                while (dest < end)
-                {
-                    dest->min_ = Min(src[0].min_, src[1].min_);
-                    dest->max_ = Max(src[0].max_, src[1].max_);
-
-                    src += 2;
-                    ++dest;
-                }
-            }
-        }
-    }
-
+    BuildDepthHierarchy(IntRect(0, 0, width_, height_), firstDirtyMipLevel_, mipBuffers_.Size());
     depthHierarchyDirty_ = false;
 }
 
@@ -342,7 +326,7 @@ void OcclusionBuffer::ResetUseTimer()
 
 bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
 {
-    if (buffers_.Empty())
+    if (!data_)
         return true;
 
     // Transform corners to projection space
@@ -447,8 +431,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     }
 
     // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
+    int* row = data_ + rect.top_ * width_;
+    int* endRow = data_ + rect.bottom_ * width_;
     while (row <= endRow)
     {
         int* src = row + rect.left_;
@@ -473,13 +457,6 @@ unsigned OcclusionBuffer::GetUseTimer()
 
 void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
-    {
-        ClearBuffer(threadIndex);
-        buffers_[threadIndex].used_ = true;
-    }
-
     Matrix4 modelViewProj = viewProj_ * batch.model_;
 
     // Theoretical max. amount of vertices if each of the 6 clipping planes doubles the triangle count
@@ -550,6 +527,22 @@ void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadInde
     }
 }
 
+void OcclusionBuffer::DrawTile(unsigned index)
+{
+    const IntRect& tile = tiles_[index];
+
+    for (unsigned i = 0; i < threadData_.Size(); ++i)
+    {
+        const OcclusionThreadData& data = threadData_[i];
+        const PODVector<unsigned>& bin = data.bins_[index];
+        for (unsigned j = 0; j < bin.Size(); ++j)
+            DrawTileTriangle(data.triangles_[bin[j]], tile);
+    }
+
+    // The tile is aligned to the mip texels of these levels, so they do not depend on the other tiles
+    BuildDepthHierarchy(tile, 0, Min((unsigned)OCCLUSION_TILE_SHIFT, mipBuffers_.Size()));
+}
+
 inline Vector4 OcclusionBuffer::ModelTransform(const Matrix4& transform, const Vector3& vertex) const
 {
     return Vector4(
@@ -643,7 +636,10 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            if (threaded_)
+                BinTriangle(projected, threadIndex);
+            else
+                DrawTriangle2D(projected, clockwise);
             drawOk = true;
         }
     }
@@ -681,7 +677,10 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    if (threaded_)
+                        BinTriangle(projected, threadIndex);
+                    else
+                        DrawTriangle2D(projected, clockwise);
                     drawOk = true;
                 }
             }
@@ -689,7 +688,12 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
     }
 
     if (drawOk)
-        ++numTriangles_;
+    {
+        if (threaded_)
+            ++threadData_[threadIndex].numTriangles_;
+        else
+            ++numTriangles_;
+    }
 }
 
 void OcclusionBuffer::ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles)
@@ -822,7 +826,7 @@ struct Edge
     int invZStep_;
 };
 
-void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise)
 {
     int top, middle, bottom;
     bool middleIsRight;
@@ -898,7 +902,7 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     Edge topToBottom(gradients, vertices[top], vertices[bottom], topY);
     Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
 
-    int* bufferData = buffers_[threadIndex].data_;
+    int* bufferData = data_;
 
     if (middleIsRight)
     {
@@ -994,36 +998,310 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     }
 }
 
-void OcclusionBuffer::MergeBuffers()
+void OcclusionBuffer::BinTriangle(const Vector3* vertices, unsigned threadIndex)
 {
-    URHO3D_PROFILE(MergeBuffers);
+    const Vector3& v0 = vertices[0];
+    const Vector3& v1 = vertices[1];
+    const Vector3& v2 = vertices[2];
+
+    // Twice the signed area. Check for degenerate triangle
+    float area = (v1.x_ - v0.x_) * (v2.y_ - v0.y_) - (v1.y_ - v0.y_) * (v2.x_ - v0.x_);
+    if (area == 0.0f)
+        return;
+
+    // Pixel (x, y) is sampled at (x + 1, y + 1) due to the half pixel offset in the viewport transform, same as when
+    // drawing scanlines. The bounding rectangle is expanded to be conservative
+    OcclusionTriangle triangle;
+    IntRect& rect = triangle.rect_;
+    rect.left_ = Max((int)Min(Min(v0.x_, v1.x_), v2.x_) - 1, 0);
+    rect.top_ = Max((int)Min(Min(v0.y_, v1.y_), v2.y_) - 1, 0);
+    rect.right_ = Min((int)Max(Max(v0.x_, v1.x_), v2.x_), width_ - 1);
+    rect.bottom_ = Min((int)Max(Max(v0.y_, v1.y_), v2.y_), height_ - 1);
+    if (rect.left_ > rect.right_ || rect.top_ > rect.bottom_)
+        return;
 
-    for (unsigned i = 1; i < buffers_.Size(); ++i)
+    // Orient the edge functions to be positive inside regardless of winding, and include the sample offset in the constants
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+    for (unsigned i = 0; i < 3; ++i)
     {
-        if (!buffers_[i].used_)
-            continue;
+        const Vector3& a = vertices[i];
+        const Vector3& b = vertices[i < 2 ? i + 1 : 0];
+        triangle.edgeX_[i] = (a.y_ - b.y_) * sign;
+        triangle.edgeY_[i] = (b.x_ - a.x_) * sign;
+        triangle.edgeConstant_[i] = triangle.edgeX_[i] * (1.0f - a.x_) + triangle.edgeY_[i] * (1.0f - a.y_);
+    }
 
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
+    // Interpolate depth relative to the first vertex to preserve precision
+    float invArea = 1.0f / area;
+    triangle.dZdX_ = ((v1.z_ - v0.z_) * (v2.y_ - v0.y_) - (v2.z_ - v0.z_) * (v1.y_ - v0.y_)) * invArea;
+    triangle.dZdY_ = ((v2.z_ - v0.z_) * (v1.x_ - v0.x_) - (v1.z_ - v0.z_) * (v2.x_ - v0.x_)) * invArea;
+    triangle.z_ = v0.z_;
+    triangle.refX_ = v0.x_ - 1.0f;
+    triangle.refY_ = v0.y_ - 1.0f;
 
-        while (count--)
+    OcclusionThreadData& data = threadData_[threadIndex];
+    unsigned index = data.triangles_.Size();
+    bool binned = false;
+
+    for (int y = rect.top_ >> OCCLUSION_TILE_SHIFT; y <= rect.bottom_ >> OCCLUSION_TILE_SHIFT; ++y)
+    {
+        for (int x = rect.left_ >> OCCLUSION_TILE_SHIFT; x <= rect.right_ >> OCCLUSION_TILE_SHIFT; ++x)
         {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
+            unsigned tileIndex = (unsigned)(y * numTilesX_ + x);
+            const IntRect& tile = tiles_[tileIndex];
+            int left = Max(rect.left_, tile.left_);
+            int top = Max(rect.top_, tile.top_);
+            int right = Min(rect.right_, tile.right_ - 1);
+            int bottom = Min(rect.bottom_, tile.bottom_ - 1);
+
+            // Skip the tile if it is outside any edge, tested at the corner where the edge function is largest
+            bool outside = false;
+            for (unsigned i = 0; i < 3 && !outside; ++i)
+            {
+                float cornerX = (float)(triangle.edgeX_[i] > 0.0f ? right : left);
+                float cornerY = (float)(triangle.edgeY_[i] > 0.0f ? bottom : top);
+                outside = triangle.edgeX_[i] * cornerX + triangle.edgeY_[i] * cornerY + triangle.edgeConstant_[i] < 0.0f;
+            }
+
+            if (!outside)
+            {
+                data.bins_[tileIndex].Push(index);
+                binned = true;
+            }
+        }
+    }
+
+    if (binned)
+        data.triangles_.Push(triangle);
+}
+
+void OcclusionBuffer::DrawTileTriangle(const OcclusionTriangle& triangle, const IntRect& tile)
+{
+    int left = Max(triangle.rect_.left_, tile.left_);
+    int top = Max(triangle.rect_.top_, tile.top_);
+    int right = Min(triangle.rect_.right_, tile.right_ - 1);
+    int bottom = Min(triangle.rect_.bottom_, tile.bottom_ - 1);
+    int* row = data_ + top * width_;
+
+#ifdef URHO3D_SSE
+    // Walk the rectangle four pixels at a time, stepping the edge functions and depth incrementally. The tiles are
+    // aligned to four pixels and the width is a multiple of the tile size, so each group of four stays inside the tile
+    left &= ~3;
+    float fx = (float)left;
+    float fy = (float)top;
+    __m128 offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    __m128 zero = _mm_setzero_ps();
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 row0 = _mm_add_ps(_mm_set1_ps(triangle.edgeX_[0] * fx + triangle.edgeY_[0] * fy + triangle.edgeConstant_[0]),
+        _mm_mul_ps(_mm_set1_ps(triangle.edgeX_[0]), offsets));
+    __m128 row1 = _mm_add_ps(_mm_set1_ps(triangle.edgeX_[1] * fx + triangle.edgeY_[1] * fy + triangle.edgeConstant_[1]),
+        _mm_mul_ps(_mm_set1_ps(triangle.edgeX_[1]), offsets));
+    __m128 row2 = _mm_add_ps(_mm_set1_ps(triangle.edgeX_[2] * fx + triangle.edgeY_[2] * fy + triangle.edgeConstant_[2]),
+        _mm_mul_ps(_mm_set1_ps(triangle.edgeX_[2]), offsets));
+    __m128 rowZ = _mm_add_ps(_mm_set1_ps(triangle.z_ + triangle.dZdX_ * (fx - triangle.refX_) + triangle.dZdY_ * (fy - triangle.refY_)),
+        _mm_mul_ps(_mm_set1_ps(triangle.dZdX_), offsets));
+    __m128 step0 = _mm_set1_ps(triangle.edgeX_[0] * 4.0f);
+    __m128 step1 = _mm_set1_ps(triangle.edgeX_[1] * 4.0f);
+    __m128 step2 = _mm_set1_ps(triangle.edgeX_[2] * 4.0f);
+    __m128 stepZ = _mm_set1_ps(triangle.dZdX_ * 4.0f);
+    __m128 rowStep0 = _mm_set1_ps(triangle.edgeY_[0]);
+    __m128 rowStep1 = _mm_set1_ps(triangle.edgeY_[1]);
+    __m128 rowStep2 = _mm_set1_ps(triangle.edgeY_[2]);
+    __m128 rowStepZ = _mm_set1_ps(triangle.dZdY_);
+
+    for (int y = top; y <= bottom; ++y)
+    {
+        __m128 e0 = row0;
+        __m128 e1 = row1;
+        __m128 e2 = row2;
+        __m128 z = rowZ;
+        bool entered = false;
+
+        for (int x = left; x <= right; x += 4)
+        {
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+            if (!_mm_movemask_ps(inside))
+            {
+                // The triangle is convex, so the rest of the row is outside once it has been left
+                if (entered)
+                    break;
+            }
+            else
+            {
+                entered = true;
+                // Select the closer depth with masks, as there is no integer minimum before SSE4.1
+                __m128i depth = _mm_cvttps_epi32(_mm_add_ps(z, half));
+                __m128i* dest = reinterpret_cast<__m128i*>(row + x);
+                __m128i old = _mm_loadu_si128(dest);
+                __m128i write = _mm_and_si128(_mm_castps_si128(inside), _mm_cmplt_epi32(depth, old));
+                _mm_storeu_si128(dest, _mm_or_si128(_mm_and_si128(write, depth), _mm_andnot_si128(write, old)));
+            }
+
+            e0 = _mm_add_ps(e0, step0);
+            e1 = _mm_add_ps(e1, step1);
+            e2 = _mm_add_ps(e2, step2);
+            z = _mm_add_ps(z, stepZ);
+        }
+
+        row0 = _mm_add_ps(row0, rowStep0);
+        row1 = _mm_add_ps(row1, rowStep1);
+        row2 = _mm_add_ps(row2, rowStep2);
+        rowZ = _mm_add_ps(rowZ, rowStepZ);
+        row += width_;
+    }
+#else
+    float fx = (float)left;
+    float fy = (float)top;
+    float row0 = triangle.edgeX_[0] * fx + triangle.edgeY_[0] * fy + triangle.edgeConstant_[0];
+    float row1 = triangle.edgeX_[1] * fx + triangle.edgeY_[1] * fy + triangle.edgeConstant_[1];
+    float row2 = triangle.edgeX_[2] * fx + triangle.edgeY_[2] * fy + triangle.edgeConstant_[2];
+    float rowZ = triangle.z_ + triangle.dZdX_ * (fx - triangle.refX_) + triangle.dZdY_ * (fy - triangle.refY_);
+
+    for (int y = top; y <= bottom; ++y)
+    {
+        float e0 = row0;
+        float e1 = row1;
+        float e2 = row2;
+        float z = rowZ;
+        bool entered = false;
+
+        for (int x = left; x <= right; ++x)
+        {
+            if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f)
+            {
+                // The triangle is convex, so the rest of the row is outside once it has been left
+                if (entered)
+                    break;
+            }
+            else
+            {
+                entered = true;
+                int depth = (int)(z + 0.5f);
+                if (depth < row[x])
+                    row[x] = depth;
+            }
+
+            e0 += triangle.edgeX_[0];
+            e1 += triangle.edgeX_[1];
+            e2 += triangle.edgeX_[2];
+            z += triangle.dZdX_;
+        }
+
+        row0 += triangle.edgeY_[0];
+        row1 += triangle.edgeY_[1];
+        row2 += triangle.edgeY_[2];
+        rowZ += triangle.dZdY_;
+        row += width_;
+    }
+#endif
+}
+
+void OcclusionBuffer::BuildDepthHierarchy(const IntRect& rect, unsigned startLevel, unsigned endLevel)
+{
+    int prevWidth = width_;
+    int prevHeight = height_;
+
+    for (unsigned i = 0; i < endLevel; ++i)
+    {
+        int width = (prevWidth + 1) / 2;
+        int height = (prevHeight + 1) / 2;
+
+        if (i >= startLevel)
+        {
+            // Mip values covered by the rectangle, rounding outward
+            int shift = i + 1;
+            int left = rect.left_ >> shift;
+            int top = rect.top_ >> shift;
+            int right = ((rect.right_ - 1) >> shift) + 1;
+            int bottom = ((rect.bottom_ - 1) >> shift) + 1;
+
+            for (int y = top; y < bottom; ++y)
+            {
+                DepthValue* dest = mipBuffers_[i].Get() + y * width + left;
+                DepthValue* end = dest + (right - left);
+
+                if (!i)
+                {
+                    // Build the first mip level from the pixel-level data
+                    int* src = data_ + (y * 2) * prevWidth + left * 2;
+
+                    if (y * 2 + 1 < prevHeight)
+                    {
+                        int* src2 = src + prevWidth;
+                        while (dest < end)
+                        {
+                            int minUpper = Min(src[0], src[1]);
+                            int minLower = Min(src2[0], src2[1]);
+                            dest->min_ = Min(minUpper, minLower);
+                            int maxUpper = Max(src[0], src[1]);
+                            int maxLower = Max(src2[0], src2[1]);
+                            dest->max_ = Max(maxUpper, maxLower);
+
+                            src += 2;
+                            src2 += 2;
+                            ++dest;
+                        }
+                    }
+                    else
+                    {
+                        while (dest < end)
+                        {
+                            dest->min_ = Min(src[0], src[1]);
+                            dest->max_ = Max(src[0], src[1]);
+
+                            src += 2;
+                            ++dest;
+                        }
+                    }
+                }
+                else
+                {
+                    // Build the rest of the mip levels from the previous level
+                    DepthValue* src = mipBuffers_[i - 1].Get() + (y * 2) * prevWidth + left * 2;
+
+                    if (y * 2 + 1 < prevHeight)
+                    {
+                        DepthValue* src2 = src + prevWidth;
+                        while (dest < end)
+                        {
+                            int minUpper = Min(src[0].min_, src[1].min_);
+                            int minLower = Min(src2[0].min_, src2[1].min_);
+                            dest->min_ = Min(minUpper, minLower);
+                            int maxUpper = Max(src[0].max_, src[1].max_);
+                            int maxLower = Max(src2[0].max_, src2[1].max_);
+                            dest->max_ = Max(maxUpper, maxLower);
+
+                            src += 2;
+                            src2 += 2;
+                            ++dest;
+                        }
+                    }
+                    else
+                    {
+                        while (dest < end)
+                        {
+                            dest->min_ = Min(src[0].min_, src[1].min_);
+                            dest->max_ = Max(src[0].max_, src[1].max_);
+
+                            src += 2;
+                            ++dest;
+                        }
+                    }
+                }
+            }
         }
+
+        prevWidth = width;
+        prevHeight = height;
     }
 }
 
-void OcclusionBuffer::ClearBuffer(unsigned threadIndex)
+void OcclusionBuffer::ClearBuffer()
 {
-    if (threadIndex >= buffers_.Size())
+    if (!data_)
         return;
 
-    int* dest = buffers_[threadIndex].data_;
+    int* dest = data_;
     int count = width_ * height_;
     int fillValue = (int)OCCLUSION_Z_SCALE;
 
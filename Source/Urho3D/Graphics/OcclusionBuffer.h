@@ -27,6 +27,7 @@
 #include "../Container/ArrayPtr.h"
 #include "../Graphics/GraphicsDefs.h"
 #include "../Math/Frustum.h"
+#include "../Math/Rect.h"
 
 namespace Urho3D
 {
@@ -34,7 +35,6 @@ namespace Urho3D
 class BoundingBox;
 class Camera;
 class IndexBuffer;
-class IntRect;
 class VertexBuffer;
 struct Edge;
 struct Gradients;
@@ -48,15 +48,38 @@ struct DepthValue
     int max_;
 };
 
-/// Per-thread occlusion buffer data.
-struct OcclusionBufferData
+/// Screen-space triangle set up for tiled occlusion rendering.
+struct OcclusionTriangle
 {
-    /// Full buffer data with safety padding.
-    SharedArrayPtr<int> dataWithSafety_;
-    /// Buffer data.
-    int* data_;
-    /// Use flag.
-    bool used_;
+    /// Edge function X coefficients. Positive inside the triangle.
+    float edgeX_[3];
+    /// Edge function Y coefficients.
+    float edgeY_[3];
+    /// Edge function constants.
+    float edgeConstant_[3];
+    /// Depth at the reference point.
+    float z_;
+    /// Horizontal depth gradient.
+    float dZdX_;
+    /// Vertical depth gradient.
+    float dZdY_;
+    /// Reference point X coordinate.
+    float refX_;
+    /// Reference point Y coordinate.
+    float refY_;
+    /// Bounding rectangle in pixels, inclusive.
+    IntRect rect_;
+};
+
+/// Per-thread triangle setup results for tiled occlusion rendering.
+struct OcclusionThreadData
+{
+    /// Set up triangles.
+    PODVector<OcclusionTriangle> triangles_;
+    /// Triangle indices binned to each screen tile.
+    Vector<PODVector<unsigned> > bins_;
+    /// Number of rendered triangles.
+    unsigned numTriangles_;
 };
 
 /// Stored occlusion render job.
@@ -84,6 +107,8 @@ static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
 static const float OCCLUSION_X_SCALE = 65536.0f;
 static const float OCCLUSION_Z_SCALE = 16777216.0f;
+static const int OCCLUSION_TILE_SHIFT = 5;
+static const int OCCLUSION_TILE_SIZE = 1 << OCCLUSION_TILE_SHIFT;
 
 /// Software renderer for occlusion.
 class URHO3D_API OcclusionBuffer : public Object
@@ -96,7 +121,7 @@ public:
     /// Destruct.
     virtual ~OcclusionBuffer();
 
-    /// Set occlusion buffer size and whether to reserve multiple buffers for threading optimization.
+    /// Set occlusion buffer size and whether to render in screen tiles using worker threads. The width must be a power of two. Threading requires it to be a multiple of the tile size, otherwise the buffer is drawn in the main thread.
     bool SetSize(int width, int height, bool threaded);
     /// Set camera view to render from.
     void SetView(Camera* camera);
@@ -121,7 +146,7 @@ public:
     void ResetUseTimer();
 
     /// Return highest level depth values.
-    int* GetBuffer() const { return buffers_.Size() ? buffers_[0].data_ : (int*)0; }
+    int* GetBuffer() const { return data_; }
 
     /// Return view transform matrix.
     const Matrix3x4& GetView() const { return view_; }
@@ -145,15 +170,17 @@ public:
     CullMode GetCullMode() const { return cullMode_; }
 
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.Size() > 1; }
+    bool IsThreaded() const { return threaded_; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
     /// Return time since last use in milliseconds.
     unsigned GetUseTimer();
 
-    /// Draw a batch. Called internally.
+    /// Draw a batch, or set up and bin its triangles when threaded. Called internally.
     void DrawBatch(const OcclusionBatch& batch, unsigned threadIndex);
+    /// Draw the triangles binned to a screen tile and build the tile's depth hierarchy levels. Called internally.
+    void DrawTile(unsigned index);
 
 private:
     /// Apply modelview transform to vertex.
@@ -171,18 +198,30 @@ private:
     /// Clip vertices against a plane.
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
     /// Draw a clipped triangle.
-    void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
-    /// Clear a thread work buffer.
-    void ClearBuffer(unsigned threadIndex);
-    /// Merge thread work buffers into the first buffer.
-    void MergeBuffers();
-
-    /// Highest-level buffer data per thread.
-    Vector<OcclusionBufferData> buffers_;
+    void DrawTriangle2D(const Vector3* vertices, bool clockwise);
+    /// Set up a clipped triangle's edge functions and bin it to the screen tiles it overlaps.
+    void BinTriangle(const Vector3* vertices, unsigned threadIndex);
+    /// Draw the part of a set up triangle inside a screen tile.
+    void DrawTileTriangle(const OcclusionTriangle& triangle, const IntRect& tile);
+    /// Build mip levels in the given range for a pixel rectangle. Only the mip values covered by the rectangle are updated.
+    void BuildDepthHierarchy(const IntRect& rect, unsigned startLevel, unsigned endLevel);
+    /// Clear the buffer.
+    void ClearBuffer();
+
+    /// Full buffer data with safety padding.
+    SharedArrayPtr<int> dataWithSafety_;
+    /// Highest-level buffer data.
+    int* data_;
     /// Reduced size depth buffers.
     Vector<SharedArrayPtr<DepthValue> > mipBuffers_;
     /// Submitted render jobs.
     PODVector<OcclusionBatch> batches_;
+    /// Screen tiles for threaded rendering.
+    PODVector<IntRect> tiles_;
+    /// Triangle setup results per thread for threaded rendering.
+    Vector<OcclusionThreadData> threadData_;
+    /// Number of screen tiles horizontally.
+    int numTilesX_;
     /// Buffer width.
     int width_;
     /// Buffer height.
@@ -193,8 +232,12 @@ private:
     unsigned maxTriangles_;
     /// Culling mode.
     CullMode cullMode_;
+    /// First mip level that needs update when the depth hierarchy is dirty.
+    unsigned firstDirtyMipLevel_;
     /// Depth hierarchy needs update flag.
     bool depthHierarchyDirty_;
+    /// Threaded tile rendering flag.
+    bool threaded_;
     /// Culling reverse flag.
     bool reverseCulling_;
     /// View transform matrix.
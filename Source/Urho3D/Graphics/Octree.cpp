@@ -24,9 +24,9 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/ParallelFor.h"
 #include "../Core/Profiler.h"
 #include "../Core/Thread.h"
-#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Octree.h"
@@ -45,23 +45,88 @@ namespace Urho3D
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+static const unsigned DEFAULT_MIN_PACKED_DRAWABLES = 16;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
+static const char* spatialIndexNames[] =
 {
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    Drawable** start = reinterpret_cast<Drawable**>(item->start_);
-    Drawable** end = reinterpret_cast<Drawable**>(item->end_);
+    "Octree",
+    "AABB Tree",
+    0
+};
 
-    while (start != end)
+/// Parallel loop body for updating drawables.
+struct UpdateDrawablesLoop
+{
+    /// Construct.
+    UpdateDrawablesLoop(const FrameInfo& frame) :
+        frame_(frame)
     {
-        Drawable* drawable = *start;
-        if (drawable)
-            drawable->Update(frame);
-        ++start;
     }
-}
+
+    /// Update a range of drawables.
+    void operator ()(Drawable** start, Drawable** end, unsigned threadIndex)
+    {
+        while (start != end)
+        {
+            Drawable* drawable = *start;
+            if (drawable)
+                drawable->Update(frame_);
+            ++start;
+        }
+    }
+
+    /// Frame info.
+    const FrameInfo& frame_;
+};
+
+/// Parallel loop body for batched closest hit raycasts.
+struct RaycastPacketsLoop
+{
+    /// Construct.
+    RaycastPacketsLoop(const Octree* octree, const PODVector<Ray>& rays, PODVector<RayQueryResult>& results, RayQueryLevel level,
+        float maxDistance, unsigned char drawableFlags, unsigned viewMask) :
+        octree_(octree),
+        rays_(rays),
+        results_(results),
+        level_(level),
+        maxDistance_(maxDistance),
+        drawableFlags_(drawableFlags),
+        viewMask_(viewMask)
+    {
+    }
+
+    /// Raycast a range of rays in packets.
+    void operator ()(const Ray* start, const Ray* end, unsigned threadIndex)
+    {
+        RayPacketOctreeQuery query(level_, maxDistance_, drawableFlags_, viewMask_);
+
+        while (start < end)
+        {
+            unsigned numRays = Min((unsigned)(end - start), RAY_PACKET_SIZE);
+            query.SetRays(start, numRays, &results_[(unsigned)(start - rays_.Buffer())]);
+            octree_->GetDrawablesInternal(query);
+            octree_->aabbTree_.GetDrawables(query);
+            start += numRays;
+        }
+    }
+
+    /// Octree.
+    const Octree* octree_;
+    /// Rays.
+    const PODVector<Ray>& rays_;
+    /// Results.
+    PODVector<RayQueryResult>& results_;
+    /// Raycast detail level.
+    RayQueryLevel level_;
+    /// Maximum ray distance.
+    float maxDistance_;
+    /// Drawable flags to include.
+    unsigned char drawableFlags_;
+    /// Drawable layers to include.
+    unsigned viewMask_;
+};
 
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
@@ -73,12 +138,17 @@ Octant::Octant(const BoundingBox& box, unsigned level, Octant* parent, Octree* r
     numDrawables_(0),
     parent_(parent),
     root_(root),
-    index_(index)
+    index_(index),
+    boundsDirty_(true),
+    boundsChanged_(false)
 {
     Initialize(box);
 
     for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+    {
         children_[i] = 0;
+        childBoundsDirty_[i] = false;
+    }
 }
 
 Octant::~Octant()
@@ -92,6 +162,7 @@ Octant::~Octant()
             root_->drawables_.Push(*i);
             root_->QueueUpdate(*i);
         }
+        root_->MarkBoundsDirty();
         drawables_.Clear();
         numDrawables_ = 0;
     }
@@ -137,35 +208,48 @@ void Octant::DeleteChild(unsigned index)
 
 void Octant::InsertDrawable(Drawable* drawable)
 {
-    const BoundingBox& box = drawable->GetWorldBoundingBox();
-
-    // If root octant, insert all non-occludees here, so that octant occlusion does not hide the drawable.
-    // Also if drawable is outside the root octant bounds, insert to root
-    bool insertHere;
-    if (this == root_)
-        insertHere = !drawable->IsOccludee() || cullingBox_.IsInside(box) != INSIDE || CheckDrawableFit(box);
-    else
-        insertHere = CheckDrawableFit(box);
+    if (root_ && root_->spatialIndex_ == SPATIAL_AABBTREE)
+    {
+        root_->InsertTreeDrawable(drawable);
+        return;
+    }
 
-    if (insertHere)
+    Octant* octant = GetDrawableOctant(drawable->GetWorldBoundingBox(), drawable->IsOccludee(), true);
+    Octant* oldOctant = drawable->octant_;
+    if (oldOctant != octant)
     {
-        Octant* oldOctant = drawable->octant_;
-        if (oldOctant != this)
-        {
-            // Add first, then remove, because drawable count going to zero deletes the octree branch in question
-            AddDrawable(drawable);
-            if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
-        }
+        // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+        octant->AddDrawable(drawable);
+        if (oldOctant)
+            oldOctant->RemoveDrawable(drawable, false);
     }
-    else
+}
+
+Octant* Octant::GetDrawableOctant(const BoundingBox& box, bool occludee, bool create)
+{
+    Octant* octant = this;
+
+    for (;;)
     {
+        // If root octant, insert all non-occludees here, so that octant occlusion does not hide the drawable.
+        // Also if drawable is outside the root octant bounds, insert to root
+        bool insertHere;
+        if (octant == root_)
+            insertHere = !occludee || octant->cullingBox_.IsInside(box) != INSIDE || octant->CheckDrawableFit(box);
+        else
+            insertHere = octant->CheckDrawableFit(box);
+
+        if (insertHere)
+            return octant;
+
         Vector3 boxCenter = box.Center();
-        unsigned x = boxCenter.x_ < center_.x_ ? 0 : 1;
-        unsigned y = boxCenter.y_ < center_.y_ ? 0 : 2;
-        unsigned z = boxCenter.z_ < center_.z_ ? 0 : 4;
+        unsigned x = boxCenter.x_ < octant->center_.x_ ? 0 : 1;
+        unsigned y = boxCenter.y_ < octant->center_.y_ ? 0 : 2;
+        unsigned z = boxCenter.z_ < octant->center_.z_ ? 0 : 4;
 
-        GetOrCreateChild(x + y + z)->InsertDrawable(drawable);
+        octant = create ? octant->GetOrCreateChild(x + y + z) : octant->children_[x + y + z];
+        if (!octant)
+            return 0;
     }
 }
 
@@ -193,6 +277,16 @@ bool Octant::CheckDrawableFit(const BoundingBox& box) const
     return false;
 }
 
+bool Octant::RemoveTreeDrawable(Drawable* drawable)
+{
+    if (this != root_ || !root_)
+        return false;
+
+    root_->aabbTree_.RemoveLeaf(drawable->treeLeaf_);
+    drawable->treeLeaf_ = M_MAX_UNSIGNED;
+    return true;
+}
+
 void Octant::ResetRoot()
 {
     root_ = 0;
@@ -222,6 +316,107 @@ void Octant::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     }
 }
 
+void Octant::MarkBoundsDirty()
+{
+    boundsDirty_ = true;
+    boundsChanged_ = true;
+
+    // Octants with too few drawables to pack do not need to be visited in the update, unless they have packed bounds to free
+    if (!root_ || (drawables_.Size() < root_->minPackedDrawables_ && packedBounds_.Empty()))
+        return;
+
+    // Mark the path from the root so that the update visits only dirty branches. Stop at an octant marked already, as its
+    // parents are marked too. Each octant is marked with a separate flag in its parent, so that marking from several threads
+    // does not lose flags
+    for (Octant* octant = this; octant->parent_ && !octant->parent_->childBoundsDirty_[octant->index_]; octant = octant->parent_)
+        octant->parent_->childBoundsDirty_[octant->index_] = true;
+}
+
+bool Octant::UpdatePackedBounds()
+{
+    bool pending = false;
+
+    if (boundsChanged_)
+    {
+        // Octants with moving or animated drawables would be repacked every frame for little gain, so wait until the drawables
+        // have stayed unchanged for one update. Until then queries test the drawables' own bounding boxes
+        boundsChanged_ = false;
+        pending = true;
+    }
+    else if (boundsDirty_)
+    {
+        // Octants with only a few drawables are faster to test directly
+        unsigned numGroups = drawables_.Size() >= root_->minPackedDrawables_ ?
+            (drawables_.Size() + PACKED_BOX_GROUP_SIZE - 1) / PACKED_BOX_GROUP_SIZE : 0;
+        unsigned numPacked = numGroups * PACKED_BOX_GROUP_SIZE;
+        packedBounds_.Resize(numGroups * PACKED_BOX_GROUP_FLOATS);
+        packedViewMasks_.Resize(numPacked);
+        packedDrawableFlags_.Resize(numPacked);
+
+        for (unsigned i = 0; i < numPacked; ++i)
+        {
+            float* group = &packedBounds_[i / PACKED_BOX_GROUP_SIZE * PACKED_BOX_GROUP_FLOATS];
+            unsigned j = i % PACKED_BOX_GROUP_SIZE;
+
+            if (i < drawables_.Size())
+            {
+                Drawable* drawable = drawables_[i];
+                const BoundingBox& box = drawable->GetWorldBoundingBox();
+                // Calculate the center and half size the same way as Frustum::IsInsideFast() for a single box
+                Vector3 center = box.Center();
+                Vector3 edge = center - box.min_;
+                group[j] = center.x_;
+                group[PACKED_BOX_GROUP_SIZE + j] = center.y_;
+                group[PACKED_BOX_GROUP_SIZE * 2 + j] = center.z_;
+                group[PACKED_BOX_GROUP_SIZE * 3 + j] = edge.x_;
+                group[PACKED_BOX_GROUP_SIZE * 4 + j] = edge.y_;
+                group[PACKED_BOX_GROUP_SIZE * 5 + j] = edge.z_;
+                packedViewMasks_[i] = drawable->GetViewMask();
+                packedDrawableFlags_[i] = drawable->GetDrawableFlags();
+            }
+            else
+            {
+                for (unsigned k = 0; k < 6; ++k)
+                    group[PACKED_BOX_GROUP_SIZE * k + j] = 0.0f;
+                packedViewMasks_[i] = 0;
+                packedDrawableFlags_[i] = 0;
+            }
+        }
+
+        boundsDirty_ = false;
+    }
+
+    for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+    {
+        if (childBoundsDirty_[i])
+        {
+            childBoundsDirty_[i] = children_[i] && children_[i]->UpdatePackedBounds();
+            pending |= childBoundsDirty_[i];
+        }
+    }
+
+    return pending;
+}
+
+void Octant::ResetPackedBounds()
+{
+    packedBounds_.Clear();
+    packedBounds_.Compact();
+    packedViewMasks_.Clear();
+    packedViewMasks_.Compact();
+    packedDrawableFlags_.Clear();
+    packedDrawableFlags_.Compact();
+    boundsDirty_ = true;
+    boundsChanged_ = false;
+
+    for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+    {
+        childBoundsDirty_[i] = children_[i] != 0;
+        if (children_[i])
+            children_[i]->ResetPackedBounds();
+    }
+}
+
 void Octant::Initialize(const BoundingBox& box)
 {
     worldBoundingBox_ = box;
@@ -248,7 +443,10 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     {
         Drawable** start = const_cast<Drawable**>(&drawables_[0]);
         Drawable** end = start + drawables_.Size();
-        query.TestDrawables(start, end, inside);
+        if (boundsDirty_ || packedBounds_.Empty())
+            query.TestDrawables(start, end, inside);
+        else
+            query.TestPackedDrawables(start, end, &packedBounds_[0], &packedViewMasks_[0], &packedDrawableFlags_[0], inside);
     }
 
     for (unsigned i = 0; i < NUM_OCTANTS; ++i)
@@ -312,10 +510,32 @@ void Octant::GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*
     }
 }
 
+void Octant::GetDrawablesInternal(RayPacketOctreeQuery& query) const
+{
+    if (!query.TestBox(cullingBox_))
+        return;
+
+    if (drawables_.Size())
+    {
+        Drawable** start = const_cast<Drawable**>(&drawables_[0]);
+        query.TestDrawables(start, start + drawables_.Size());
+    }
+
+    // Visit the children nearer to the ray origins first, so that the closest hits found early cull the rest
+    for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+    {
+        Octant* child = children_[i ^ query.octantOrder_];
+        if (child)
+            child->GetDrawablesInternal(query);
+    }
+}
+
 Octree::Octree(Context* context) :
     Component(context),
     Octant(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), 0, 0, this),
-    numLevels_(DEFAULT_OCTREE_LEVELS)
+    numLevels_(DEFAULT_OCTREE_LEVELS),
+    spatialIndex_(SPATIAL_OCTREE),
+    minPackedDrawables_(DEFAULT_MIN_PACKED_DRAWABLES)
 {
     // If the engine is running headless, subscribe to RenderUpdate events for manually updating the octree
     // to allow raycasts and animation update
@@ -328,6 +548,15 @@ Octree::~Octree()
     // Reset root pointer from all child octants now so that they do not move their drawables to root
     drawableUpdates_.Clear();
     ResetRoot();
+
+    // Detach the drawables of the AABB tree
+    PODVector<Drawable*> treeDrawables;
+    aabbTree_.GetAllDrawables(treeDrawables);
+    for (PODVector<Drawable*>::Iterator i = treeDrawables.Begin(); i != treeDrawables.End(); ++i)
+    {
+        (*i)->treeLeaf_ = M_MAX_UNSIGNED;
+        (*i)->SetOctant(0);
+    }
 }
 
 void Octree::RegisterObject(Context* context)
@@ -340,6 +569,8 @@ void Octree::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Bounding Box Min", Vector3, worldBoundingBox_.min_, defaultBoundsMin, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Bounding Box Max", Vector3, worldBoundingBox_.max_, defaultBoundsMax, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Number of Levels", int, numLevels_, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Spatial Index", GetSpatialIndex, SetSpatialIndex, SpatialIndex, spatialIndexNames,
+        SPATIAL_OCTREE, AM_DEFAULT);
 }
 
 void Octree::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
@@ -356,6 +587,7 @@ void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
         URHO3D_PROFILE(OctreeDrawDebug);
 
         Octant::DrawDebugGeometry(debug, depthTest);
+        aabbTree_.DrawDebugGeometry(debug, depthTest);
     }
 }
 
@@ -368,10 +600,66 @@ void Octree::SetSize(const BoundingBox& box, unsigned numLevels)
         DeleteChild(i);
 
     Initialize(box);
-    numDrawables_ = drawables_.Size();
+    numDrawables_ = drawables_.Size() + aabbTree_.GetNumLeaves();
     numLevels_ = Max(numLevels, 1U);
 }
 
+void Octree::SetSpatialIndex(SpatialIndex index)
+{
+    if (index == spatialIndex_)
+        return;
+
+    URHO3D_PROFILE(ChangeSpatialIndex);
+
+    // Move all drawables to the root first
+    for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+        DeleteChild(i);
+
+    if (index == SPATIAL_AABBTREE)
+    {
+        // Move the occludees to the tree
+        PODVector<Drawable*> drawables = drawables_;
+        drawables_.Clear();
+        for (PODVector<Drawable*>::Iterator i = drawables.Begin(); i != drawables.End(); ++i)
+        {
+            Drawable* drawable = *i;
+            if (drawable->IsOccludee())
+                drawable->treeLeaf_ = aabbTree_.InsertLeaf(drawable, drawable->GetWorldBoundingBox());
+            else
+                drawables_.Push(drawable);
+        }
+    }
+    else
+    {
+        // Move the tree drawables to the root and queue them for reinsertion to the octants
+        PODVector<Drawable*> drawables;
+        aabbTree_.GetAllDrawables(drawables);
+        aabbTree_.Clear();
+        for (PODVector<Drawable*>::Iterator i = drawables.Begin(); i != drawables.End(); ++i)
+        {
+            Drawable* drawable = *i;
+            drawable->treeLeaf_ = M_MAX_UNSIGNED;
+            drawables_.Push(drawable);
+            if (!drawable->updateQueued_)
+                QueueUpdate(drawable);
+        }
+    }
+
+    spatialIndex_ = index;
+    numDrawables_ = drawables_.Size() + aabbTree_.GetNumLeaves();
+    MarkBoundsDirty();
+}
+
+void Octree::SetMinPackedDrawables(unsigned num)
+{
+    if (num == minPackedDrawables_)
+        return;
+
+    // Rebuild the packed bounds of all octants on the next update, or free them if disabled
+    minPackedDrawables_ = num;
+    ResetPackedBounds();
+}
+
 void Octree::Update(const FrameInfo& frame)
 {
     if (!Thread::IsMainThread())
@@ -391,30 +679,9 @@ void Octree::Update(const FrameInfo& frame)
         WorkQueue* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.Size() / numWorkItems), 1);
-
-        PODVector<Drawable*>::Iterator start = drawableUpdates_.Begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            PODVector<Drawable*>::Iterator end = drawableUpdates_.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
+        UpdateDrawablesLoop loop(frame);
+        ParallelFor(queue, drawableUpdates_.Buffer(), drawableUpdates_.Buffer() + drawableUpdates_.Size(), loop);
 
-        queue->Complete(M_MAX_UNSIGNED);
         scene->EndThreadedUpdate();
     }
 
@@ -464,6 +731,16 @@ void Octree::Update(const FrameInfo& frame)
             // Skip if no octant or does not belong to this octree anymore
             if (!octant || octant->GetRoot() != this)
                 continue;
+
+            // With the AABB tree all drawables are held by the root. Update the tree leaf if it no longer fits
+            if (spatialIndex_ == SPATIAL_AABBTREE)
+            {
+                bool inTree = drawable->treeLeaf_ != M_MAX_UNSIGNED;
+                if (inTree != drawable->IsOccludee() || (inTree && !aabbTree_.CheckLeafFit(drawable->treeLeaf_, box)))
+                    InsertTreeDrawable(drawable);
+                continue;
+            }
+
             // Skip if still fits the current octant
             if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
                 continue;
@@ -483,6 +760,14 @@ void Octree::Update(const FrameInfo& frame)
     }
 
     drawableUpdates_.Clear();
+
+    // Refresh the packed bounds of octants whose drawables were added, removed, moved or resized. When disabled, the octants
+    // stay dirty and queries test the drawables' own bounding boxes
+    if (minPackedDrawables_ != M_MAX_UNSIGNED)
+    {
+        URHO3D_PROFILE(UpdatePackedBounds);
+        UpdatePackedBounds();
+    }
 }
 
 void Octree::AddManualDrawable(Drawable* drawable)
@@ -490,7 +775,10 @@ void Octree::AddManualDrawable(Drawable* drawable)
     if (!drawable || drawable->GetOctant())
         return;
 
-    AddDrawable(drawable);
+    if (spatialIndex_ == SPATIAL_AABBTREE)
+        InsertTreeDrawable(drawable);
+    else
+        AddDrawable(drawable);
 }
 
 void Octree::RemoveManualDrawable(Drawable* drawable)
@@ -507,6 +795,7 @@ void Octree::GetDrawables(OctreeQuery& query) const
 {
     query.result_.Clear();
     GetDrawablesInternal(query, false);
+    aabbTree_.GetDrawables(query);
 }
 
 void Octree::Raycast(RayOctreeQuery& query) const
@@ -515,6 +804,7 @@ void Octree::Raycast(RayOctreeQuery& query) const
 
     query.result_.Clear();
     GetDrawablesInternal(query);
+    aabbTree_.GetDrawables(query);
     Sort(query.result_.Begin(), query.result_.End(), CompareRayQueryResults);
 }
 
@@ -525,6 +815,7 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
     query.result_.Clear();
     rayQueryDrawables_.Clear();
     GetDrawablesOnlyInternal(query, rayQueryDrawables_);
+    aabbTree_.GetDrawablesOnly(query, rayQueryDrawables_);
 
     // Sort by increasing hit distance to AABB
     for (PODVector<Drawable*>::Iterator i = rayQueryDrawables_.Begin(); i != rayQueryDrawables_.End(); ++i)
@@ -558,6 +849,47 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
     }
 }
 
+void Octree::RaycastSingle(const PODVector<Ray>& rays, PODVector<RayQueryResult>& results, RayQueryLevel level, float maxDistance,
+    unsigned char drawableFlags, unsigned viewMask) const
+{
+    URHO3D_PROFILE(RaycastBatch);
+
+    results.Resize(rays.Size());
+    if (rays.Empty())
+        return;
+
+    RaycastPacketsLoop loop(this, rays, results, level, maxDistance, drawableFlags, viewMask);
+    ParallelFor(GetSubsystem<WorkQueue>(), rays.Buffer(), rays.Buffer() + rays.Size(), loop, RAY_PACKET_SIZE);
+}
+
+void Octree::InsertTreeDrawable(Drawable* drawable)
+{
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    // Hold non-occludees in the root, so that occlusion of the tree nodes does not hide them
+    bool toTree = drawable->IsOccludee();
+    Octant* oldOctant = drawable->octant_;
+
+    if (oldOctant == this && (drawable->treeLeaf_ != M_MAX_UNSIGNED) == toTree)
+    {
+        if (toTree)
+            aabbTree_.MoveLeaf(drawable->treeLeaf_, box);
+        return;
+    }
+
+    // The root is never deleted, and an octant of another octree is unaffected, so can remove first
+    if (oldOctant)
+        oldOctant->RemoveDrawable(drawable, false);
+
+    if (toTree)
+    {
+        drawable->SetOctant(this);
+        drawable->treeLeaf_ = aabbTree_.InsertLeaf(drawable, box);
+        IncDrawableCount();
+    }
+    else
+        AddDrawable(drawable);
+}
+
 void Octree::QueueUpdate(Drawable* drawable)
 {
     Scene* scene = GetScene();
@@ -24,6 +24,7 @@
 
 #include "../Container/List.h"
 #include "../Core/Mutex.h"
+#include "../Graphics/AABBTree.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/OctreeQuery.h"
 
@@ -35,6 +36,13 @@ class Octree;
 static const int NUM_OCTANTS = 8;
 static const unsigned ROOT_INDEX = M_MAX_UNSIGNED;
 
+/// Spatial index used by the octree component for occludee drawables.
+enum SpatialIndex
+{
+    SPATIAL_OCTREE = 0,
+    SPATIAL_AABBTREE
+};
+
 /// %Octree octant
 class URHO3D_API Octant
 {
@@ -50,6 +58,8 @@ public:
     void DeleteChild(unsigned index);
     /// Insert a drawable object by checking for fit recursively.
     void InsertDrawable(Drawable* drawable);
+    /// Return the octant for a drawable bounding box by checking for fit recursively, optionally creating child octants. Without creating, returns null if the octant does not exist yet, and does not modify the octree.
+    Octant* GetDrawableOctant(const BoundingBox& box, bool occludee, bool create);
     /// Check if a drawable object fits.
     bool CheckDrawableFit(const BoundingBox& box) const;
 
@@ -58,20 +68,25 @@ public:
     {
         drawable->SetOctant(this);
         drawables_.Push(drawable);
+        MarkBoundsDirty();
         IncDrawableCount();
     }
 
     /// Remove a drawable object from this octant.
     void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
     {
-        if (drawables_.Remove(drawable))
+        if (drawable->treeLeaf_ != M_MAX_UNSIGNED ? RemoveTreeDrawable(drawable) : drawables_.Remove(drawable))
         {
+            MarkBoundsDirty();
             if (resetOctant)
                 drawable->SetOctant(0);
             DecDrawableCount();
         }
     }
 
+    /// Mark the packed drawable bounds to be rebuilt on the next octree update. Until then queries test the drawables' own bounding boxes. May be called from worker threads.
+    void MarkBoundsDirty();
+
     /// Return world-space bounding box.
     const BoundingBox& GetWorldBoundingBox() const { return worldBoundingBox_; }
 
@@ -107,6 +122,14 @@ protected:
     void GetDrawablesInternal(RayOctreeQuery& query) const;
     /// Return drawable objects only for a threaded ray query, called internally.
     void GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const;
+    /// Return drawable objects by a ray packet query, called internally.
+    void GetDrawablesInternal(RayPacketOctreeQuery& query) const;
+    /// Rebuild dirty packed drawable bounds in the marked branches, once the drawables have stayed unchanged for one update. Return true if some are left dirty.
+    bool UpdatePackedBounds();
+    /// Free the packed drawable bounds and mark them dirty recursively.
+    void ResetPackedBounds();
+    /// Remove a drawable object from the octree's AABB tree. Return true if was removed.
+    bool RemoveTreeDrawable(Drawable* drawable);
 
     /// Increase drawable object count recursively.
     void IncDrawableCount()
@@ -138,6 +161,12 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     PODVector<Drawable*> drawables_;
+    /// Drawable bounding boxes packed in groups for SIMD frustum tests, see Frustum::IsInsideFast(). Valid when bounds are not dirty.
+    PODVector<float> packedBounds_;
+    /// Drawable view masks in the same order, padded to whole groups with zero masks.
+    PODVector<unsigned> packedViewMasks_;
+    /// Drawable flags in the same order, padded to whole groups with zero flags.
+    PODVector<unsigned char> packedDrawableFlags_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS];
     /// World bounding box center.
@@ -154,12 +183,20 @@ protected:
     Octree* root_;
     /// Octant index relative to its siblings or ROOT_INDEX for root octant
     unsigned index_;
+    /// Packed drawable bounds need to be rebuilt flag.
+    bool boundsDirty_;
+    /// Drawables added, removed or changed since the previous octree update flag.
+    bool boundsChanged_;
+    /// Packed drawable bounds need to be rebuilt in child octant branches flags.
+    bool childBoundsDirty_[NUM_OCTANTS];
 };
 
 /// %Octree component. Should be added only to the root scene node
 class URHO3D_API Octree : public Component, public Octant
 {
     friend void RaycastDrawablesWork(const WorkItem* item, unsigned threadIndex);
+    friend struct RaycastPacketsLoop;
+    friend class Octant;
 
     URHO3D_OBJECT(Octree, Component);
 
@@ -178,6 +215,10 @@ public:
 
     /// Set size and maximum subdivision levels. If octree is not empty, drawable objects will be temporarily moved to the root.
     void SetSize(const BoundingBox& box, unsigned numLevels);
+    /// Set spatial index for occludee drawables. With the AABB tree, drawables are not limited by the octree size and objects straddling octant boundaries are not held high in the hierarchy. Non-occludees are held in the root in both cases.
+    void SetSpatialIndex(SpatialIndex index);
+    /// Set minimum number of drawables in an octant for keeping their bounds packed for SIMD frustum culling. Octants with fewer drawables test the drawables' own bounding boxes. M_MAX_UNSIGNED disables the packed bounds.
+    void SetMinPackedDrawables(unsigned num);
     /// Update and reinsert drawable objects.
     void Update(const FrameInfo& frame);
     /// Add a drawable manually.
@@ -191,9 +232,18 @@ public:
     void Raycast(RayOctreeQuery& query) const;
     /// Return the closest drawable object by a ray query.
     void RaycastSingle(RayOctreeQuery& query) const;
+    /// Return the closest drawable object for each ray of a batch. The rays are processed in packets in the worker threads. The results are in the same order as the rays, with a null drawable and infinite distance for no hit. Must be called from the main thread.
+    void RaycastSingle(const PODVector<Ray>& rays, PODVector<RayQueryResult>& results, RayQueryLevel level = RAY_TRIANGLE,
+        float maxDistance = M_INFINITY, unsigned char drawableFlags = DRAWABLE_ANY, unsigned viewMask = DEFAULT_VIEWMASK) const;
 
     /// Return subdivision levels.
     unsigned GetNumLevels() const { return numLevels_; }
+    /// Return spatial index for occludee drawables.
+    SpatialIndex GetSpatialIndex() const { return spatialIndex_; }
+    /// Return minimum number of drawables in an octant for keeping their bounds packed.
+    unsigned GetMinPackedDrawables() const { return minPackedDrawables_; }
+    /// Return the AABB tree. Empty unless the AABB tree spatial index is used.
+    const AABBTree& GetAABBTree() const { return aabbTree_; }
 
     /// Mark drawable object as requiring an update and a reinsertion.
     void QueueUpdate(Drawable* drawable);
@@ -205,6 +255,8 @@ public:
 private:
     /// Handle render update in case of headless execution.
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
+    /// Insert a drawable object to the root or the AABB tree, or update its AABB tree leaf.
+    void InsertTreeDrawable(Drawable* drawable);
 
     /// Drawable objects that require update.
     PODVector<Drawable*> drawableUpdates_;
@@ -214,8 +266,14 @@ private:
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
     mutable PODVector<Drawable*> rayQueryDrawables_;
+    /// AABB tree of occludee drawables when used as the spatial index.
+    AABBTree aabbTree_;
     /// Subdivision level.
     unsigned numLevels_;
+    /// Spatial index for occludee drawables.
+    SpatialIndex spatialIndex_;
+    /// Minimum number of drawables in an octant for keeping their bounds packed.
+    unsigned minPackedDrawables_;
 };
 
 }
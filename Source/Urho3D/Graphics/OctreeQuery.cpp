@@ -24,6 +24,10 @@
 
 #include "../Graphics/OctreeQuery.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -117,6 +121,193 @@ void FrustumOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool in
     }
 }
 
+void FrustumOctreeQuery::TestPackedDrawables(Drawable** start, Drawable** end, const float* packedBoxes, const unsigned* viewMasks,
+    const unsigned char* drawableFlags, bool inside)
+{
+    // If the octant is fully inside, there are no boxes to test
+    if (inside)
+    {
+        TestDrawables(start, end, inside);
+        return;
+    }
+
+    static const unsigned MAX_BATCH_GROUPS = 64;
+    static const unsigned MAX_BATCH_DRAWABLES = MAX_BATCH_GROUPS * PACKED_BOX_GROUP_SIZE;
+    unsigned char insideMasks[MAX_BATCH_GROUPS];
+    Drawable* visible[MAX_BATCH_DRAWABLES];
+    unsigned numDrawables = (unsigned)(end - start);
+
+    for (unsigned first = 0; first < numDrawables; first += MAX_BATCH_DRAWABLES)
+    {
+        unsigned count = Min(numDrawables - first, MAX_BATCH_DRAWABLES);
+        unsigned numGroups = (count + PACKED_BOX_GROUP_SIZE - 1) / PACKED_BOX_GROUP_SIZE;
+        frustum_.IsInsideFast(packedBoxes + first / PACKED_BOX_GROUP_SIZE * PACKED_BOX_GROUP_FLOATS, numGroups, insideMasks);
+
+        unsigned numVisible = 0;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            unsigned index = first + i;
+            if ((insideMasks[i / PACKED_BOX_GROUP_SIZE] & (1 << (i % PACKED_BOX_GROUP_SIZE))) && (viewMasks[index] & viewMask_) &&
+                (drawableFlags[index] & drawableFlags_))
+                visible[numVisible++] = start[index];
+        }
+
+        if (numVisible)
+            TestDrawables(visible, visible + numVisible, true);
+    }
+}
+
+/// Smallest ray direction component magnitude used for the inverse direction, to avoid infinity times zero in the box test.
+static const float MIN_RAY_DIRECTION = 1.0e-20f;
+
+static inline float GetInverseDirection(float direction)
+{
+    if (Abs(direction) < MIN_RAY_DIRECTION)
+        direction = direction < 0.0f ? -MIN_RAY_DIRECTION : MIN_RAY_DIRECTION;
+    return 1.0f / direction;
+}
+
+RayPacketOctreeQuery::RayPacketOctreeQuery(RayQueryLevel level, float maxDistance, unsigned char drawableFlags, unsigned viewMask) :
+    result_(0),
+    numRays_(0),
+    octantOrder_(0),
+    drawableFlags_(drawableFlags),
+    viewMask_(viewMask),
+    maxDistance_(maxDistance),
+    level_(level)
+{
+    for (unsigned i = 0; i < RAY_PACKET_SIZE; ++i)
+    {
+        hitDistances_[i] = -1.0f;
+        originX_[i] = originY_[i] = originZ_[i] = 0.0f;
+        invDirX_[i] = invDirY_[i] = invDirZ_[i] = 0.0f;
+    }
+}
+
+void RayPacketOctreeQuery::SetRays(const Ray* rays, unsigned numRays, RayQueryResult* result)
+{
+    numRays_ = Min(numRays, RAY_PACKET_SIZE);
+    result_ = result;
+
+    for (unsigned i = 0; i < RAY_PACKET_SIZE; ++i)
+    {
+        if (i < numRays_)
+        {
+            const Ray& ray = rays[i];
+            rays_[i] = ray;
+            hitDistances_[i] = maxDistance_;
+            originX_[i] = ray.origin_.x_;
+            originY_[i] = ray.origin_.y_;
+            originZ_[i] = ray.origin_.z_;
+            invDirX_[i] = GetInverseDirection(ray.direction_.x_);
+            invDirY_[i] = GetInverseDirection(ray.direction_.y_);
+            invDirZ_[i] = GetInverseDirection(ray.direction_.z_);
+
+            RayQueryResult& hit = result[i];
+            hit.position_ = Vector3::ZERO;
+            hit.normal_ = Vector3::ZERO;
+            hit.textureUV_ = Vector2::ZERO;
+            hit.distance_ = M_INFINITY;
+            hit.drawable_ = 0;
+            hit.node_ = 0;
+            hit.subObject_ = 0;
+        }
+        else
+            hitDistances_[i] = -1.0f;
+    }
+
+    // Visit the child octants on the side of the ray origin first
+    octantOrder_ = 0;
+    if (numRays_)
+    {
+        const Vector3& direction = rays_[0].direction_;
+        octantOrder_ = (direction.x_ < 0.0f ? 1 : 0) | (direction.y_ < 0.0f ? 2 : 0) | (direction.z_ < 0.0f ? 4 : 0);
+    }
+}
+
+unsigned RayPacketOctreeQuery::TestBox(const BoundingBox& box) const
+{
+    if (!box.Defined())
+        return 0;
+
+#ifdef URHO3D_SSE
+    // Slab test for all rays at once: the entry distance is the largest of the per-axis near distances, and the exit
+    // distance the smallest of the far distances
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min_.x_), _mm_loadu_ps(originX_)), _mm_loadu_ps(invDirX_));
+    __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max_.x_), _mm_loadu_ps(originX_)), _mm_loadu_ps(invDirX_));
+    __m128 enter = _mm_min_ps(t1, t2);
+    __m128 exit = _mm_max_ps(t1, t2);
+    t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min_.y_), _mm_loadu_ps(originY_)), _mm_loadu_ps(invDirY_));
+    t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max_.y_), _mm_loadu_ps(originY_)), _mm_loadu_ps(invDirY_));
+    enter = _mm_max_ps(enter, _mm_min_ps(t1, t2));
+    exit = _mm_min_ps(exit, _mm_max_ps(t1, t2));
+    t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min_.z_), _mm_loadu_ps(originZ_)), _mm_loadu_ps(invDirZ_));
+    t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max_.z_), _mm_loadu_ps(originZ_)), _mm_loadu_ps(invDirZ_));
+    enter = _mm_max_ps(enter, _mm_min_ps(t1, t2));
+    exit = _mm_min_ps(exit, _mm_max_ps(t1, t2));
+    // Rays starting inside the box hit at zero distance
+    enter = _mm_max_ps(enter, _mm_setzero_ps());
+
+    __m128 hit = _mm_and_ps(_mm_cmple_ps(enter, exit), _mm_cmplt_ps(enter, _mm_loadu_ps(hitDistances_)));
+    return (unsigned)_mm_movemask_ps(hit);
+#else
+    unsigned mask = 0;
+
+    for (unsigned i = 0; i < RAY_PACKET_SIZE; ++i)
+    {
+        float t1 = (box.min_.x_ - originX_[i]) * invDirX_[i];
+        float t2 = (box.max_.x_ - originX_[i]) * invDirX_[i];
+        float enter = Min(t1, t2);
+        float exit = Max(t1, t2);
+        t1 = (box.min_.y_ - originY_[i]) * invDirY_[i];
+        t2 = (box.max_.y_ - originY_[i]) * invDirY_[i];
+        enter = Max(enter, Min(t1, t2));
+        exit = Min(exit, Max(t1, t2));
+        t1 = (box.min_.z_ - originZ_[i]) * invDirZ_[i];
+        t2 = (box.max_.z_ - originZ_[i]) * invDirZ_[i];
+        enter = Max(enter, Min(t1, t2));
+        exit = Min(exit, Max(t1, t2));
+        enter = Max(enter, 0.0f);
+
+        if (enter <= exit && enter < hitDistances_[i])
+            mask |= 1 << i;
+    }
+
+    return mask;
+#endif
+}
+
+void RayPacketOctreeQuery::TestDrawables(Drawable** start, Drawable** end)
+{
+    while (start != end)
+    {
+        Drawable* drawable = *start++;
+
+        if (!(drawable->GetDrawableFlags() & drawableFlags_) || !(drawable->GetViewMask() & viewMask_))
+            continue;
+
+        unsigned mask = TestBox(drawable->GetWorldBoundingBox());
+        for (unsigned i = 0; mask; ++i, mask >>= 1)
+        {
+            if (!(mask & 1))
+                continue;
+
+            // Query the drawable with the closest hit so far as the maximum distance, so that only closer hits are returned
+            drawableResult_.Clear();
+            RayOctreeQuery query(drawableResult_, rays_[i], level_, hitDistances_[i], drawableFlags_, viewMask_);
+            drawable->ProcessRayQuery(query, drawableResult_);
+
+            for (PODVector<RayQueryResult>::ConstIterator j = drawableResult_.Begin(); j != drawableResult_.End(); ++j)
+            {
+                if (j->distance_ < hitDistances_[i])
+                {
+                    result_[i] = *j;
+                    hitDistances_[i] = j->distance_;
+                }
+            }
+        }
+    }
+}
 
 Intersection AllContentOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
@@ -55,6 +55,12 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Intersection test for drawables of an octant with packed bounding boxes, view masks and drawable flags, see Frustum::IsInsideFast(). Default implementation ignores the packed data.
+    virtual void TestPackedDrawables(Drawable** start, Drawable** end, const float* packedBoxes, const unsigned* viewMasks,
+        const unsigned char* drawableFlags, bool inside)
+    {
+        TestDrawables(start, end, inside);
+    }
 
     /// Result vector reference.
     PODVector<Drawable*>& result_;
@@ -149,6 +155,9 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside);
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside);
+    /// Intersection test for drawables with packed bounding boxes. Tests the boxes, view masks and drawable flags without accessing the drawables, then passes those that pass to TestDrawables() as inside.
+    virtual void TestPackedDrawables(Drawable** start, Drawable** end, const float* packedBoxes, const unsigned* viewMasks,
+        const unsigned char* drawableFlags, bool inside);
 
     /// Frustum.
     Frustum frustum_;
@@ -256,6 +265,65 @@ private:
     RayOctreeQuery& operator =(const RayOctreeQuery& rhs);
 };
 
+/// Number of rays in a ray packet.
+static const unsigned RAY_PACKET_SIZE = 4;
+
+/// Closest hit raycast octree query for a packet of rays. The rays are tested against bounding boxes together.
+class URHO3D_API RayPacketOctreeQuery
+{
+public:
+    /// Construct with query parameters. Set the rays before use.
+    RayPacketOctreeQuery(RayQueryLevel level = RAY_TRIANGLE, float maxDistance = M_INFINITY,
+        unsigned char drawableFlags = DRAWABLE_ANY, unsigned viewMask = DEFAULT_VIEWMASK);
+
+    /// Set up to RAY_PACKET_SIZE rays and the destination for their closest hits, which is reset to no hit.
+    void SetRays(const Ray* rays, unsigned numRays, RayQueryResult* result);
+    /// Return a bitmask of the rays that hit a bounding box closer than their closest hit so far.
+    unsigned TestBox(const BoundingBox& box) const;
+    /// Intersection test for drawables. Update the closest hits.
+    void TestDrawables(Drawable** start, Drawable** end);
+
+    /// Result array for the closest hits, one per ray.
+    RayQueryResult* result_;
+    /// Rays.
+    Ray rays_[RAY_PACKET_SIZE];
+    /// Distances of the closest hits so far, initially the maximum distance. Negative for unused rays.
+    float hitDistances_[RAY_PACKET_SIZE];
+    /// Ray origin X coordinates.
+    float originX_[RAY_PACKET_SIZE];
+    /// Ray origin Y coordinates.
+    float originY_[RAY_PACKET_SIZE];
+    /// Ray origin Z coordinates.
+    float originZ_[RAY_PACKET_SIZE];
+    /// Inverse ray direction X components.
+    float invDirX_[RAY_PACKET_SIZE];
+    /// Inverse ray direction Y components.
+    float invDirY_[RAY_PACKET_SIZE];
+    /// Inverse ray direction Z components.
+    float invDirZ_[RAY_PACKET_SIZE];
+    /// Number of rays.
+    unsigned numRays_;
+    /// Child octant traversal order mask for front-to-back order, from the first ray's direction.
+    unsigned octantOrder_;
+    /// Drawable flags to include.
+    unsigned char drawableFlags_;
+    /// Drawable layers to include.
+    unsigned viewMask_;
+    /// Maximum ray distance.
+    float maxDistance_;
+    /// Raycast detail level.
+    RayQueryLevel level_;
+
+private:
+    /// Prevent copy construction.
+    RayPacketOctreeQuery(const RayPacketOctreeQuery& rhs);
+    /// Prevent assignment.
+    RayPacketOctreeQuery& operator =(const RayPacketOctreeQuery& rhs);
+
+    /// Results of a drawable's ray query.
+    PODVector<RayQueryResult> drawableResult_;
+};
+
 class URHO3D_API AllContentOctreeQuery : public OctreeQuery
 {
 public:
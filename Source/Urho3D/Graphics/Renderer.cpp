@@ -1477,7 +1477,7 @@ const Rect& Renderer::GetLightScissor(Light* light, Camera* camera)
 {
     Pair<Light*, Camera*> combination(light, camera);
 
-    HashMap<Pair<Light*, Camera*>, Rect>::Iterator i = lightScissorCache_.Find(combination);
+    FlatHashMap<Pair<Light*, Camera*>, Rect>::Iterator i = lightScissorCache_.Find(combination);
     if (i != lightScissorCache_.End())
         return i->second_;
 
@@ -516,7 +516,7 @@ private:
     /// Saved status of screen buffer allocations for restoring.
     HashMap<long long, unsigned> savedScreenBufferAllocations_;
     /// Cache for light scissor queries.
-    HashMap<Pair<Light*, Camera*>, Rect> lightScissorCache_;
+    FlatHashMap<Pair<Light*, Camera*>, Rect> lightScissorCache_;
     /// Backbuffer viewports.
     Vector<SharedPtr<Viewport> > viewports_;
     /// Render surface viewports queued for update.
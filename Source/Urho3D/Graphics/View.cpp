@@ -22,8 +22,8 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/ParallelFor.h"
 #include "../Core/Profiler.h"
-#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Geometry.h"
@@ -167,74 +167,97 @@ public:
     OcclusionBuffer* buffer_;
 };
 
-void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
+/// Parallel loop body for checking drawable visibility and collecting geometries, lights and scene Z range.
+struct CheckVisibilityLoop
 {
-    View* view = reinterpret_cast<View*>(item->aux_);
-    Drawable** start = reinterpret_cast<Drawable**>(item->start_);
-    Drawable** end = reinterpret_cast<Drawable**>(item->end_);
-    OcclusionBuffer* buffer = view->occlusionBuffer_;
-    const Matrix3x4& viewMatrix = view->cullCamera_->GetView();
-    Vector3 viewZ = Vector3(viewMatrix.m20_, viewMatrix.m21_, viewMatrix.m22_);
-    Vector3 absViewZ = viewZ.Abs();
-    unsigned cameraViewMask = view->cullCamera_->GetViewMask();
-    bool cameraZoneOverride = view->cameraZoneOverride_;
-    PerThreadSceneResult& result = view->sceneResults_[threadIndex];
-
-    while (start != end)
-    {
-        Drawable* drawable = *start++;
-
-        if (!buffer || !drawable->IsOccludee() || buffer->IsVisible(drawable->GetWorldBoundingBox()))
-        {
-            drawable->UpdateBatches(view->frame_);
-            // If draw distance non-zero, update and check it
-            float maxDistance = drawable->GetDrawDistance();
-            if (maxDistance > 0.0f)
-            {
-                if (drawable->GetDistance() > maxDistance)
-                    continue;
-            }
+    /// Construct.
+    CheckVisibilityLoop(View* view) :
+        view_(view)
+    {
+    }
 
-            drawable->MarkInView(view->frame_);
+    /// Check a range of drawables.
+    void operator ()(Drawable** start, Drawable** end, PerThreadSceneResult& result)
+    {
+        OcclusionBuffer* buffer = view_->occlusionBuffer_;
+        const Matrix3x4& viewMatrix = view_->cullCamera_->GetView();
+        Vector3 viewZ = Vector3(viewMatrix.m20_, viewMatrix.m21_, viewMatrix.m22_);
+        Vector3 absViewZ = viewZ.Abs();
+        unsigned cameraViewMask = view_->cullCamera_->GetViewMask();
+        bool cameraZoneOverride = view_->cameraZoneOverride_;
 
-            // For geometries, find zone, clear lights and calculate view space Z range
-            if (drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY)
+        while (start != end)
+        {
+            Drawable* drawable = *start++;
+
+            if (!buffer || !drawable->IsOccludee() || buffer->IsVisible(drawable->GetWorldBoundingBox()))
             {
-                Zone* drawableZone = drawable->GetZone();
-                if (!cameraZoneOverride &&
-                    (drawable->IsZoneDirty() || !drawableZone || (drawableZone->GetViewMask() & cameraViewMask) == 0))
-                    view->FindZone(drawable);
+                drawable->UpdateBatches(view_->frame_);
+                // If draw distance non-zero, update and check it
+                float maxDistance = drawable->GetDrawDistance();
+                if (maxDistance > 0.0f)
+                {
+                    if (drawable->GetDistance() > maxDistance)
+                        continue;
+                }
 
-                const BoundingBox& geomBox = drawable->GetWorldBoundingBox();
-                Vector3 center = geomBox.Center();
-                Vector3 edge = geomBox.Size() * 0.5f;
+                drawable->MarkInView(view_->frame_);
 
-                // Do not add "infinite" objects like skybox to prevent shadow map focusing behaving erroneously
-                if (edge.LengthSquared() < M_LARGE_VALUE * M_LARGE_VALUE)
+                // For geometries, find zone, clear lights and calculate view space Z range
+                if (drawable->GetDrawableFlags() & DRAWABLE_GEOMETRY)
                 {
-                    float viewCenterZ = viewZ.DotProduct(center) + viewMatrix.m23_;
-                    float viewEdgeZ = absViewZ.DotProduct(edge);
-                    float minZ = viewCenterZ - viewEdgeZ;
-                    float maxZ = viewCenterZ + viewEdgeZ;
-                    drawable->SetMinMaxZ(viewCenterZ - viewEdgeZ, viewCenterZ + viewEdgeZ);
-                    result.minZ_ = Min(result.minZ_, minZ);
-                    result.maxZ_ = Max(result.maxZ_, maxZ);
-                }
-                else
-                    drawable->SetMinMaxZ(M_LARGE_VALUE, M_LARGE_VALUE);
+                    Zone* drawableZone = drawable->GetZone();
+                    if (!cameraZoneOverride &&
+                        (drawable->IsZoneDirty() || !drawableZone || (drawableZone->GetViewMask() & cameraViewMask) == 0))
+                        view_->FindZone(drawable);
 
-                result.geometries_.Push(drawable);
-            }
-            else if (drawable->GetDrawableFlags() & DRAWABLE_LIGHT)
-            {
-                Light* light = static_cast<Light*>(drawable);
-                // Skip lights with zero brightness or black color
-                if (!light->GetEffectiveColor().Equals(Color::BLACK))
-                    result.lights_.Push(light);
+                    const BoundingBox& geomBox = drawable->GetWorldBoundingBox();
+                    Vector3 center = geomBox.Center();
+                    Vector3 edge = geomBox.Size() * 0.5f;
+
+                    // Do not add "infinite" objects like skybox to prevent shadow map focusing behaving erroneously
+                    if (edge.LengthSquared() < M_LARGE_VALUE * M_LARGE_VALUE)
+                    {
+                        float viewCenterZ = viewZ.DotProduct(center) + viewMatrix.m23_;
+                        float viewEdgeZ = absViewZ.DotProduct(edge);
+                        float minZ = viewCenterZ - viewEdgeZ;
+                        float maxZ = viewCenterZ + viewEdgeZ;
+                        drawable->SetMinMaxZ(viewCenterZ - viewEdgeZ, viewCenterZ + viewEdgeZ);
+                        result.minZ_ = Min(result.minZ_, minZ);
+                        result.maxZ_ = Max(result.maxZ_, maxZ);
+                    }
+                    else
+                        drawable->SetMinMaxZ(M_LARGE_VALUE, M_LARGE_VALUE);
+
+                    result.geometries_.Push(drawable);
+                }
+                else if (drawable->GetDrawableFlags() & DRAWABLE_LIGHT)
+                {
+                    Light* light = static_cast<Light*>(drawable);
+                    // Skip lights with zero brightness or black color
+                    if (!light->GetEffectiveColor().Equals(Color::BLACK))
+                        result.lights_.Push(light);
+                }
             }
         }
     }
-}
+
+    /// View.
+    View* view_;
+};
+
+/// Combine function for per-thread scene results.
+struct CombineSceneResults
+{
+    /// Append a partial result to the total.
+    void operator ()(PerThreadSceneResult& total, PerThreadSceneResult& partial)
+    {
+        total.geometries_.Push(partial.geometries_);
+        total.lights_.Push(partial.lights_);
+        total.minZ_ = Min(total.minZ_, partial.minZ_);
+        total.maxZ_ = Max(total.maxZ_, partial.maxZ_);
+    }
+};
 
 void ProcessLightWork(const WorkItem* item, unsigned threadIndex)
 {
@@ -244,47 +267,93 @@ void ProcessLightWork(const WorkItem* item, unsigned threadIndex)
     view->ProcessLight(*query, threadIndex);
 }
 
-void UpdateDrawableGeometriesWork(const WorkItem* item, unsigned threadIndex)
+void ProcessShadowSplitWork(const WorkItem* item, unsigned threadIndex)
+{
+    View* view = reinterpret_cast<View*>(item->aux_);
+    LightQueryResult* query = reinterpret_cast<LightQueryResult*>(item->start_);
+    PODVector<Drawable*>* shadowCasters = reinterpret_cast<PODVector<Drawable*>*>(item->end_);
+
+    view->ProcessShadowSplit(*query, (unsigned)(shadowCasters - query->shadowCasters_), threadIndex);
+}
+
+/// Parallel loop body for updating drawable geometries.
+struct UpdateDrawableGeometriesLoop
 {
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    Drawable** start = reinterpret_cast<Drawable**>(item->start_);
-    Drawable** end = reinterpret_cast<Drawable**>(item->end_);
+    /// Construct.
+    UpdateDrawableGeometriesLoop(const FrameInfo& frame) :
+        frame_(frame)
+    {
+    }
 
-    while (start != end)
+    /// Update a range of drawables.
+    void operator ()(Drawable** start, Drawable** end, unsigned threadIndex)
     {
-        Drawable* drawable = *start++;
-        // We may leave null pointer holes in the queue if a drawable is found out to require a main thread update
-        if (drawable)
-            drawable->UpdateGeometry(frame);
+        while (start != end)
+        {
+            Drawable* drawable = *start++;
+            // We may leave null pointer holes in the queue if a drawable is found out to require a main thread update
+            if (drawable)
+                drawable->UpdateGeometry(frame_);
+        }
+    }
+
+    /// Frame info.
+    const FrameInfo& frame_;
+};
+
+/// Parallel loop body for copying instance data of batch groups to the instancing buffer.
+struct SetInstancingDataLoop
+{
+    /// Construct.
+    SetInstancingDataLoop(void* lockedData, unsigned stride) :
+        lockedData_(lockedData),
+        stride_(stride)
+    {
+    }
+
+    /// Copy the instance data of a range of batch groups.
+    void operator ()(BatchGroup** start, BatchGroup** end, unsigned threadIndex)
+    {
+        while (start != end)
+            (*start++)->WriteInstancingData(lockedData_, stride_);
     }
-}
+
+    /// Locked instancing buffer data.
+    void* lockedData_;
+    /// Instancing buffer vertex size.
+    unsigned stride_;
+};
 
 void SortBatchQueueFrontToBackWork(const WorkItem* item, unsigned threadIndex)
 {
     BatchQueue* queue = reinterpret_cast<BatchQueue*>(item->start_);
+    WorkQueue* workQueue = reinterpret_cast<WorkQueue*>(item->aux_);
 
-    queue->SortFrontToBack();
+    queue->SortFrontToBack(workQueue->GetFrameAllocator(threadIndex));
 }
 
 void SortBatchQueueBackToFrontWork(const WorkItem* item, unsigned threadIndex)
 {
     BatchQueue* queue = reinterpret_cast<BatchQueue*>(item->start_);
+    WorkQueue* workQueue = reinterpret_cast<WorkQueue*>(item->aux_);
 
-    queue->SortBackToFront();
+    queue->SortBackToFront(workQueue->GetFrameAllocator(threadIndex));
 }
 
 void SortLightQueueWork(const WorkItem* item, unsigned threadIndex)
 {
     LightBatchQueue* start = reinterpret_cast<LightBatchQueue*>(item->start_);
-    start->litBaseBatches_.SortFrontToBack();
-    start->litBatches_.SortFrontToBack();
+    FrameAllocator* allocator = reinterpret_cast<WorkQueue*>(item->aux_)->GetFrameAllocator(threadIndex);
+    start->litBaseBatches_.SortFrontToBack(allocator);
+    start->litBatches_.SortFrontToBack(allocator);
 }
 
 void SortShadowQueueWork(const WorkItem* item, unsigned threadIndex)
 {
     LightBatchQueue* start = reinterpret_cast<LightBatchQueue*>(item->start_);
+    FrameAllocator* allocator = reinterpret_cast<WorkQueue*>(item->aux_)->GetFrameAllocator(threadIndex);
     for (unsigned i = 0; i < start->shadowSplits_.Size(); ++i)
-        start->shadowSplits_[i].shadowBatches_.SortFrontToBack();
+        start->shadowSplits_[i].shadowBatches_.SortFrontToBack(allocator);
 }
 
 StringHash ParseTextureTypeXml(ResourceCache* cache, String filename);
@@ -304,10 +373,16 @@ View::View(Context* context) :
     substituteRenderTarget_(0),
     passCommand_(0)
 {
-    // Create octree query and scene results vector for each thread
-    unsigned numThreads = GetSubsystem<WorkQueue>()->GetNumThreads() + 1; // Worker threads + main thread
+    // Create octree query and scene results vector for each thread. The scene results use the thread's frame allocator
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    unsigned numThreads = queue->GetNumThreads() + 1; // Worker threads + main thread
     tempDrawables_.Resize(numThreads);
     sceneResults_.Resize(numThreads);
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        sceneResults_[i].geometries_.SetAllocator(queue->GetFrameAllocator(i));
+        sceneResults_[i].lights_.SetAllocator(queue->GetFrameAllocator(i));
+    }
     frame_.camera_ = 0;
 }
 
@@ -556,6 +631,7 @@ void View::Update(const FrameInfo& frame)
     SendViewEvent(E_BEGINVIEWUPDATE);
 
     int maxSortedInstances = renderer_->GetMaxSortedInstances();
+    FrameAllocator* frameAllocator = GetSubsystem<WorkQueue>()->GetFrameAllocator(0);
 
     // Clear buffers, geometry, light, occluder & batch list
     renderTargets_.Clear();
@@ -566,7 +642,7 @@ void View::Update(const FrameInfo& frame)
     activeOccluders_ = 0;
     vertexLightQueues_.Clear();
     for (HashMap<unsigned, BatchQueue>::Iterator i = batchQueues_.Begin(); i != batchQueues_.End(); ++i)
-        i->second_.Clear(maxSortedInstances);
+        i->second_.Clear(maxSortedInstances, frameAllocator);
 
     if (hasScenePasses_ && (!cullCamera_ || !octree_))
     {
@@ -897,67 +973,16 @@ void View::GetDrawables()
 
     // Check drawable occlusion, find zones for moved drawables and collect geometries & lights in worker threads
     {
-        for (unsigned i = 0; i < sceneResults_.Size(); ++i)
-        {
-            PerThreadSceneResult& result = sceneResults_[i];
-
-            result.geometries_.Clear();
-            result.lights_.Clear();
-            result.minZ_ = M_INFINITY;
-            result.maxZ_ = 0.0f;
-        }
-
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = tempDrawables.Size() / numWorkItems;
-
-        PODVector<Drawable*>::Iterator start = tempDrawables.Begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = CheckVisibilityWork;
-            item->aux_ = this;
-
-            PODVector<Drawable*>::Iterator end = tempDrawables.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
+        CheckVisibilityLoop loop(this);
+        CombineSceneResults combine;
+        PerThreadSceneResult& result = ParallelReduce(queue, tempDrawables.Buffer(), tempDrawables.Buffer() + tempDrawables.Size(),
+            loop, combine, PerThreadSceneResult(), sceneResults_);
 
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
-
-        queue->Complete(M_MAX_UNSIGNED);
-    }
-
-    // Combine lights, geometries & scene Z range from the threads
-    geometries_.Clear();
-    lights_.Clear();
-    minZ_ = M_INFINITY;
-    maxZ_ = 0.0f;
-
-    if (sceneResults_.Size() > 1)
-    {
-        for (unsigned i = 0; i < sceneResults_.Size(); ++i)
-        {
-            PerThreadSceneResult& result = sceneResults_[i];
-            geometries_.Push(result.geometries_);
-            lights_.Push(result.lights_);
-            minZ_ = Min(minZ_, result.minZ_);
-            maxZ_ = Max(maxZ_, result.maxZ_);
-        }
-    }
-    else
-    {
-        // If just 1 thread, copy the results directly
-        PerThreadSceneResult& result = sceneResults_[0];
+        // Take the combined lights, geometries & scene Z range
         minZ_ = result.minZ_;
         maxZ_ = result.maxZ_;
-        Swap(geometries_, result.geometries_);
-        Swap(lights_, result.lights_);
+        geometries_.Insert(geometries_.End(), result.geometries_.Begin(), result.geometries_.End());
+        lights_.Insert(lights_.End(), result.lights_.Begin(), result.lights_.End());
     }
 
     if (minZ_ == M_INFINITY)
@@ -989,7 +1014,8 @@ void View::GetBatches()
 
 void View::ProcessLights()
 {
-    // Process lit geometries and shadow casters for each light
+    // Process lit geometries and shadow casters for each light. The shadow splits are processed as continuations of the
+    // light's work item, so that the splits of one light, and the lights themselves, can proceed in parallel
     URHO3D_PROFILE(ProcessLights);
 
     WorkQueue* queue = GetSubsystem<WorkQueue>();
@@ -997,16 +1023,50 @@ void View::ProcessLights()
 
     for (unsigned i = 0; i < lightQueryResults_.Size(); ++i)
     {
-        SharedPtr<WorkItem> item = queue->GetFreeItem();
-        item->priority_ = M_MAX_UNSIGNED;
-        item->workFunction_ = ProcessLightWork;
-        item->aux_ = this;
-
         LightQueryResult& query = lightQueryResults_[i];
-        query.light_ = lights_[i];
+        Light* light = lights_[i];
+        query.light_ = light;
 
-        item->start_ = &query;
-        queue->AddWorkItem(item);
+        SharedPtr<WorkItem> lightItem = queue->GetFreeItem();
+        lightItem->priority_ = M_MAX_UNSIGNED;
+        lightItem->workFunction_ = ProcessLightWork;
+        lightItem->aux_ = this;
+        lightItem->start_ = &query;
+
+        // The actual split count is only known after the light has been processed, so queue the maximum. Unneeded splits
+        // will return early
+        unsigned maxSplits = 0;
+        if (drawShadows_ && light->GetCastShadows() && !light->GetPerVertex())
+        {
+            switch (light->GetLightType())
+            {
+            case LIGHT_DIRECTIONAL:
+                maxSplits = (unsigned)light->GetNumShadowSplits();
+                break;
+
+            case LIGHT_SPOT:
+                maxSplits = 1;
+                break;
+
+            case LIGHT_POINT:
+                maxSplits = MAX_CUBEMAP_FACES;
+                break;
+            }
+        }
+
+        for (unsigned j = 0; j < maxSplits; ++j)
+        {
+            SharedPtr<WorkItem> splitItem = queue->GetFreeItem();
+            splitItem->priority_ = M_MAX_UNSIGNED;
+            splitItem->workFunction_ = ProcessShadowSplitWork;
+            splitItem->aux_ = this;
+            splitItem->start_ = &query;
+            splitItem->end_ = &query.shadowCasters_[j];
+            queue->AddDependency(splitItem, lightItem);
+            queue->AddWorkItem(splitItem);
+        }
+
+        queue->AddWorkItem(lightItem);
     }
 
     // Ensure all lights have been processed before proceeding
@@ -1033,6 +1093,7 @@ void View::GetLightBatches()
         lightQueues_.Resize(numLightQueues);
         maxLightsDrawables_.Clear();
         unsigned maxSortedInstances = (unsigned)renderer_->GetMaxSortedInstances();
+        FrameAllocator* frameAllocator = GetSubsystem<WorkQueue>()->GetFrameAllocator(0);
 
         for (Vector<LightQueryResult>::Iterator i = lightQueryResults_.Begin(); i != lightQueryResults_.End(); ++i)
         {
@@ -1049,14 +1110,22 @@ void View::GetLightBatches()
             {
                 unsigned shadowSplits = query.numSplits_;
 
+                // If no shadow casters, the light can be rendered unshadowed. At this point we have not allocated a shadow
+                // map yet, so the only cost has been the shadow camera setup & queries
+                bool hasShadowCasters = false;
+                for (unsigned j = 0; j < shadowSplits && !hasShadowCasters; ++j)
+                    hasShadowCasters = !query.shadowCasters_[j].Empty();
+                if (!hasShadowCasters)
+                    shadowSplits = 0;
+
                 // Initialize light queue and store it to the light so that it can be found later
                 LightBatchQueue& lightQueue = lightQueues_[usedLightQueues++];
                 light->SetLightQueue(&lightQueue);
                 lightQueue.light_ = light;
                 lightQueue.negative_ = light->IsNegative();
                 lightQueue.shadowMap_ = 0;
-                lightQueue.litBaseBatches_.Clear(maxSortedInstances);
-                lightQueue.litBatches_.Clear(maxSortedInstances);
+                lightQueue.litBaseBatches_.Clear(maxSortedInstances, frameAllocator);
+                lightQueue.litBatches_.Clear(maxSortedInstances, frameAllocator);
                 if (forwardLightsCommand_)
                 {
                     SetQueueShaderDefines(lightQueue.litBaseBatches_, *forwardLightsCommand_);
@@ -1087,15 +1156,15 @@ void View::GetLightBatches()
                     shadowQueue.shadowCamera_ = shadowCamera;
                     shadowQueue.nearSplit_ = query.shadowNearSplits_[j];
                     shadowQueue.farSplit_ = query.shadowFarSplits_[j];
-                    shadowQueue.shadowBatches_.Clear(maxSortedInstances);
+                    shadowQueue.shadowBatches_.Clear(maxSortedInstances, frameAllocator);
 
                     // Setup the shadow split viewport and finalize shadow camera parameters
                     shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, lightQueue.shadowMap_);
                     FinalizeShadowCamera(shadowCamera, light, shadowQueue.shadowViewport_, query.shadowCasterBox_[j]);
 
                     // Loop through shadow casters
-                    for (PODVector<Drawable*>::ConstIterator k = query.shadowCasters_.Begin() + query.shadowCasterBegin_[j];
-                         k < query.shadowCasters_.Begin() + query.shadowCasterEnd_[j]; ++k)
+                    for (PODVector<Drawable*>::ConstIterator k = query.shadowCasters_[j].Begin(); k != query.shadowCasters_[j].End();
+                         ++k)
                     {
                         Drawable* drawable = *k;
                         // If drawable is not in actual view frustum, mark it in view here and check its geometry update type
@@ -1318,6 +1387,7 @@ void View::UpdateGeometries()
                 item->workFunction_ =
                     command.sortMode_ == SORT_FRONTTOBACK ? SortBatchQueueFrontToBackWork : SortBatchQueueBackToFrontWork;
                 item->start_ = &batchQueues_[command.passIndex_];
+                item->aux_ = queue;
                 queue->AddWorkItem(item);
             }
         }
@@ -1328,6 +1398,7 @@ void View::UpdateGeometries()
             lightItem->priority_ = M_MAX_UNSIGNED;
             lightItem->workFunction_ = SortLightQueueWork;
             lightItem->start_ = &(*i);
+            lightItem->aux_ = queue;
             queue->AddWorkItem(lightItem);
 
             if (i->shadowSplits_.Size())
@@ -1336,6 +1407,7 @@ void View::UpdateGeometries()
                 shadowItem->priority_ = M_MAX_UNSIGNED;
                 shadowItem->workFunction_ = SortShadowQueueWork;
                 shadowItem->start_ = &(*i);
+                shadowItem->aux_ = queue;
                 queue->AddWorkItem(shadowItem);
             }
         }
@@ -1356,36 +1428,20 @@ void View::UpdateGeometries()
                     *i = 0;
                 }
             }
-
-            int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-            int drawablesPerItem = threadedGeometries_.Size() / numWorkItems;
-
-            PODVector<Drawable*>::Iterator start = threadedGeometries_.Begin();
-            for (int i = 0; i < numWorkItems; ++i)
-            {
-                PODVector<Drawable*>::Iterator end = threadedGeometries_.End();
-                if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                    end = start + drawablesPerItem;
-
-                SharedPtr<WorkItem> item = queue->GetFreeItem();
-                item->priority_ = M_MAX_UNSIGNED;
-                item->workFunction_ = UpdateDrawableGeometriesWork;
-                item->aux_ = const_cast<FrameInfo*>(&frame_);
-                item->start_ = &(*start);
-                item->end_ = &(*end);
-                queue->AddWorkItem(item);
-
-                start = end;
-            }
         }
 
-        // While the work queue is processed, update non-threaded geometries
+        // Queue the threaded updates without waiting
+        UpdateDrawableGeometriesLoop loop(frame_);
+        ParallelForAsync(queue, threadedGeometries_.Buffer(), threadedGeometries_.Buffer() + threadedGeometries_.Size(), loop);
+
+        // While the work queue sorts the batches and updates threaded geometries, update non-threaded geometries
         for (PODVector<Drawable*>::ConstIterator i = nonThreadedGeometries_.Begin(); i != nonThreadedGeometries_.End(); ++i)
             (*i)->UpdateGeometry(frame_);
+
+        // Finally ensure all threaded work has completed
+        queue->Complete(M_MAX_UNSIGNED);
     }
 
-    // Finally ensure all threaded work has completed
-    queue->Complete(M_MAX_UNSIGNED);
     geometriesUpdated_ = true;
 }
 
@@ -2291,7 +2347,6 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
     Light* light = query.light_;
     LightType type = light->GetLightType();
     unsigned lightMask = light->GetLightMask();
-    const Frustum& frustum = cullCamera_->GetFrustum();
 
     // Check if light should be shadowed
     bool isShadowed = drawShadows_ && light->GetCastShadows() && !light->GetPerVertex() && light->GetShadowIntensity() < 1.0f;
@@ -2304,8 +2359,9 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
         isShadowed = false;
 #endif
     // Get lit geometries. They must match the light mask and be inside the main camera frustum to be considered
-    PODVector<Drawable*>& tempDrawables = tempDrawables_[threadIndex];
+    PODVector<Drawable*>& volumeGeometries = query.volumeGeometries_;
     query.litGeometries_.Clear();
+    volumeGeometries.Clear();
 
     switch (type)
     {
@@ -2319,26 +2375,26 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
 
     case LIGHT_SPOT:
         {
-            FrustumOctreeQuery octreeQuery(tempDrawables, light->GetFrustum(), DRAWABLE_GEOMETRY,
+            FrustumOctreeQuery octreeQuery(volumeGeometries, light->GetFrustum(), DRAWABLE_GEOMETRY,
                 cullCamera_->GetViewMask());
             octree_->GetDrawables(octreeQuery);
-            for (unsigned i = 0; i < tempDrawables.Size(); ++i)
+            for (unsigned i = 0; i < volumeGeometries.Size(); ++i)
             {
-                if (tempDrawables[i]->IsInView(frame_) && (GetLightMask(tempDrawables[i]) & lightMask))
-                    query.litGeometries_.Push(tempDrawables[i]);
+                if (volumeGeometries[i]->IsInView(frame_) && (GetLightMask(volumeGeometries[i]) & lightMask))
+                    query.litGeometries_.Push(volumeGeometries[i]);
             }
         }
         break;
 
     case LIGHT_POINT:
         {
-            SphereOctreeQuery octreeQuery(tempDrawables, Sphere(light->GetNode()->GetWorldPosition(), light->GetRange()),
+            SphereOctreeQuery octreeQuery(volumeGeometries, Sphere(light->GetNode()->GetWorldPosition(), light->GetRange()),
                 DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
             octree_->GetDrawables(octreeQuery);
-            for (unsigned i = 0; i < tempDrawables.Size(); ++i)
+            for (unsigned i = 0; i < volumeGeometries.Size(); ++i)
             {
-                if (tempDrawables[i]->IsInView(frame_) && (GetLightMask(tempDrawables[i]) & lightMask))
-                    query.litGeometries_.Push(tempDrawables[i]);
+                if (volumeGeometries[i]->IsInView(frame_) && (GetLightMask(volumeGeometries[i]) & lightMask))
+                    query.litGeometries_.Push(volumeGeometries[i]);
             }
         }
         break;
@@ -2351,42 +2407,44 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
         return;
     }
 
-    // Determine number of shadow cameras and setup their initial positions
+    // Determine number of shadow cameras and setup their initial positions. The splits will be processed for shadow casters
+    // by the continuation work items
     SetupShadowCameras(query);
+}
 
-    // Process each split for shadow casters
-    query.shadowCasters_.Clear();
-    for (unsigned i = 0; i < query.numSplits_; ++i)
-    {
-        Camera* shadowCamera = query.shadowCameras_[i];
-        const Frustum& shadowCameraFrustum = shadowCamera->GetFrustum();
-        query.shadowCasterBegin_[i] = query.shadowCasterEnd_[i] = query.shadowCasters_.Size();
+void View::ProcessShadowSplit(LightQueryResult& query, unsigned splitIndex, unsigned threadIndex)
+{
+    query.shadowCasters_[splitIndex].Clear();
+    if (splitIndex >= query.numSplits_)
+        return;
 
-        // For point light check that the face is visible: if not, can skip the split
-        if (type == LIGHT_POINT && frustum.IsInsideFast(BoundingBox(shadowCameraFrustum)) == OUTSIDE)
-            continue;
+    LightType type = query.light_->GetLightType();
+    const Frustum& frustum = cullCamera_->GetFrustum();
+    Camera* shadowCamera = query.shadowCameras_[splitIndex];
+    const Frustum& shadowCameraFrustum = shadowCamera->GetFrustum();
 
-        // For directional light check that the split is inside the visible scene: if not, can skip the split
-        if (type == LIGHT_DIRECTIONAL)
-        {
-            if (minZ_ > query.shadowFarSplits_[i])
-                continue;
-            if (maxZ_ < query.shadowNearSplits_[i])
-                continue;
+    // For point light check that the face is visible: if not, can skip the split
+    if (type == LIGHT_POINT && frustum.IsInsideFast(BoundingBox(shadowCameraFrustum)) == OUTSIDE)
+        return;
 
-            // Reuse lit geometry query for all except directional lights
-            ShadowCasterOctreeQuery query(tempDrawables, shadowCameraFrustum, DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
-            octree_->GetDrawables(query);
-        }
+    // For directional light check that the split is inside the visible scene: if not, can skip the split
+    if (type == LIGHT_DIRECTIONAL)
+    {
+        if (minZ_ > query.shadowFarSplits_[splitIndex])
+            return;
+        if (maxZ_ < query.shadowNearSplits_[splitIndex])
+            return;
+
+        // Reuse lit geometry query for all except directional lights
+        PODVector<Drawable*>& tempDrawables = tempDrawables_[threadIndex];
+        ShadowCasterOctreeQuery octreeQuery(tempDrawables, shadowCameraFrustum, DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
+        octree_->GetDrawables(octreeQuery);
 
         // Check which shadow casters actually contribute to the shadowing
-        ProcessShadowCasters(query, tempDrawables, i);
+        ProcessShadowCasters(query, tempDrawables, splitIndex);
     }
-
-    // If no shadow casters, the light can be rendered unshadowed. At this point we have not allocated a shadow map yet, so the
-    // only cost has been the shadow camera setup & queries
-    if (query.shadowCasters_.Empty())
-        query.numSplits_ = 0;
+    else
+        ProcessShadowCasters(query, query.volumeGeometries_, splitIndex);
 }
 
 void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawable*>& drawables, unsigned splitIndex)
@@ -2458,11 +2516,9 @@ void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawabl
                 lightProjBox = lightViewBox.Projected(lightProj);
                 query.shadowCasterBox_[splitIndex].Merge(lightProjBox);
             }
-            query.shadowCasters_.Push(drawable);
+            query.shadowCasters_[splitIndex].Push(drawable);
         }
     }
-
-    query.shadowCasterEnd_[splitIndex] = query.shadowCasters_.Size();
 }
 
 bool View::IsShadowCasterVisible(Drawable* drawable, BoundingBox lightViewBox, Camera* shadowCamera, const Matrix3x4& lightView,
@@ -2910,26 +2966,29 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     {
         BatchGroupKey key(batch);
 
-        HashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
+        FlatHashMap<BatchGroupKey, BatchGroup*>::Iterator i = queue.batchGroups_.Find(key);
         if (i == queue.batchGroups_.End())
         {
-            // Create a new group based on the batch
+            // Create a new group based on the batch. It lives in frame allocator memory and is never destructed
             // In case the group remains below the instancing limit, do not enable instancing shaders yet
-            BatchGroup newGroup(batch);
-            newGroup.geometryType_ = GEOM_STATIC;
-            renderer_->SetBatchShaders(newGroup, tech, allowShadows, queue);
-            newGroup.CalculateSortKey();
+            FrameAllocator* allocator = GetSubsystem<WorkQueue>()->GetFrameAllocator(0);
+            BatchGroup* newGroup = new(allocator->Allocate(sizeof(BatchGroup))) BatchGroup(batch);
+            newGroup->instances_.SetAllocator(allocator);
+            newGroup->geometryType_ = GEOM_STATIC;
+            renderer_->SetBatchShaders(*newGroup, tech, allowShadows, queue);
+            newGroup->CalculateSortKey();
             i = queue.batchGroups_.Insert(MakePair(key, newGroup));
         }
 
-        int oldSize = i->second_.instances_.Size();
-        i->second_.AddTransforms(batch);
+        BatchGroup* group = i->second_;
+        int oldSize = group->instances_.Size();
+        group->AddTransforms(batch);
         // Convert to using instancing shaders when the instancing limit is reached
-        if (oldSize < minInstances_ && (int)i->second_.instances_.Size() >= minInstances_)
+        if (oldSize < minInstances_ && (int)group->instances_.Size() >= minInstances_)
         {
-            i->second_.geometryType_ = GEOM_INSTANCED;
-            renderer_->SetBatchShaders(i->second_, tech, allowShadows, queue);
-            i->second_.CalculateSortKey();
+            group->geometryType_ = GEOM_INSTANCED;
+            renderer_->SetBatchShaders(*group, tech, allowShadows, queue);
+            group->CalculateSortKey();
         }
     }
     else
@@ -2988,18 +3047,22 @@ void View::PrepareInstancingBuffer()
     if (!dest)
         return;
 
-    const unsigned stride = instancingBuffer->GetVertexSize();
+    // Assign the buffer ranges in the main thread, then copy the instance data in parallel
+    instancingGroups_.Clear();
     for (HashMap<unsigned, BatchQueue>::Iterator i = batchQueues_.Begin(); i != batchQueues_.End(); ++i)
-        i->second_.SetInstancingData(dest, stride, freeIndex);
+        i->second_.ReserveInstancingData(freeIndex, instancingGroups_);
 
     for (Vector<LightBatchQueue>::Iterator i = lightQueues_.Begin(); i != lightQueues_.End(); ++i)
     {
         for (unsigned j = 0; j < i->shadowSplits_.Size(); ++j)
-            i->shadowSplits_[j].shadowBatches_.SetInstancingData(dest, stride, freeIndex);
-        i->litBaseBatches_.SetInstancingData(dest, stride, freeIndex);
-        i->litBatches_.SetInstancingData(dest, stride, freeIndex);
+            i->shadowSplits_[j].shadowBatches_.ReserveInstancingData(freeIndex, instancingGroups_);
+        i->litBaseBatches_.ReserveInstancingData(freeIndex, instancingGroups_);
+        i->litBatches_.ReserveInstancingData(freeIndex, instancingGroups_);
     }
 
+    SetInstancingDataLoop loop(dest, instancingBuffer->GetVertexSize());
+    ParallelFor(GetSubsystem<WorkQueue>(), instancingGroups_.Buffer(), instancingGroups_.Buffer() + instancingGroups_.Size(), loop);
+
     instancingBuffer->Unlock();
 }
 
@@ -58,14 +58,12 @@ struct LightQueryResult
     Light* light_;
     /// Lit geometries.
     PODVector<Drawable*> litGeometries_;
-    /// Shadow casters.
-    PODVector<Drawable*> shadowCasters_;
+    /// Geometries inside the light volume, reused as shadow caster candidates (spot and point lights only.)
+    PODVector<Drawable*> volumeGeometries_;
+    /// Shadow casters per split.
+    PODVector<Drawable*> shadowCasters_[MAX_LIGHT_SPLITS];
     /// Shadow cameras.
     Camera* shadowCameras_[MAX_LIGHT_SPLITS];
-    /// Shadow caster start indices.
-    unsigned shadowCasterBegin_[MAX_LIGHT_SPLITS];
-    /// Shadow caster end indices.
-    unsigned shadowCasterEnd_[MAX_LIGHT_SPLITS];
     /// Combined bounding box of shadow casters in light projection space. Only used for focused spot lights.
     BoundingBox shadowCasterBox_[MAX_LIGHT_SPLITS];
     /// Shadow camera near splits (directional lights only.)
@@ -91,13 +89,20 @@ struct ScenePassInfo
     BatchQueue* batchQueue_;
 };
 
-/// Per-thread geometry, light and scene range collection structure.
+/// Per-thread geometry, light and scene range collection structure. The vectors use the thread's frame allocator.
 struct PerThreadSceneResult
 {
+    /// Construct.
+    PerThreadSceneResult() :
+        minZ_(M_INFINITY),
+        maxZ_(0.0f)
+    {
+    }
+
     /// Geometry objects.
-    PODVector<Drawable*> geometries_;
+    FrameVector<Drawable*> geometries_;
     /// Lights.
-    PODVector<Light*> lights_;
+    FrameVector<Light*> lights_;
     /// Scene minimum Z value.
     float minZ_;
     /// Scene maximum Z value.
@@ -109,8 +114,9 @@ static const unsigned MAX_VIEWPORT_TEXTURES = 2;
 /// Internal structure for 3D rendering work. Created for each backbuffer and texture viewport, but not for shadow cameras.
 class URHO3D_API View : public Object
 {
-    friend void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex);
+    friend struct CheckVisibilityLoop;
     friend void ProcessLightWork(const WorkItem* item, unsigned threadIndex);
+    friend void ProcessShadowSplitWork(const WorkItem* item, unsigned threadIndex);
 
     URHO3D_OBJECT(View, Object);
 
@@ -234,8 +240,10 @@ private:
     void UpdateOccluders(PODVector<Drawable*>& occluders, Camera* camera);
     /// Draw occluders to occlusion buffer.
     void DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders);
-    /// Query for lit geometries and shadow casters for a light.
+    /// Query for lit geometries for a light and set up its shadow cameras.
     void ProcessLight(LightQueryResult& query, unsigned threadIndex);
+    /// Query for shadow casters of a light's shadow split. Called after the light has been processed.
+    void ProcessShadowSplit(LightQueryResult& query, unsigned splitIndex, unsigned threadIndex);
     /// Process shadow casters' visibilities and build their combined view- or projection-space bounding box.
     void ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawable*>& drawables, unsigned splitIndex);
     /// Set up initial shadow camera view(s).
@@ -394,6 +402,8 @@ private:
     PODVector<Drawable*> nonThreadedGeometries_;
     /// Geometry objects that will be updated in worker threads.
     PODVector<Drawable*> threadedGeometries_;
+    /// Batch groups whose instance data will be written in worker threads.
+    PODVector<BatchGroup*> instancingGroups_;
     /// Occluder objects.
     PODVector<Drawable*> occluders_;
     /// Lights.
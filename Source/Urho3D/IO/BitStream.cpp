@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Attribute.h"
+#include "../IO/BitStream.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Largest absolute value of the three smallest components of a normalized quaternion.
+static const float QUATERNION_COMPONENT_RANGE = 0.707107f;
+
+BitWriter::BitWriter(Serializer& dest) :
+    dest_(dest),
+    pending_(0),
+    numPendingBits_(0),
+    numBits_(0),
+    failed_(false)
+{
+}
+
+BitWriter::~BitWriter()
+{
+    Flush();
+}
+
+void BitWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    if (!numBits)
+        return;
+    if (numBits > 32)
+        numBits = 32;
+
+    pending_ |= ((unsigned long long)value & ((1ULL << numBits) - 1)) << numPendingBits_;
+    numPendingBits_ += numBits;
+    numBits_ += numBits;
+
+    while (numPendingBits_ >= 8)
+    {
+        if (!dest_.WriteUByte((unsigned char)(pending_ & 0xff)))
+            failed_ = true;
+        pending_ >>= 8;
+        numPendingBits_ -= 8;
+    }
+}
+
+void BitWriter::WriteBool(bool value)
+{
+    WriteBits(value ? 1 : 0, 1);
+}
+
+void BitWriter::WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits)
+{
+    if (!numBits || maxValue <= minValue)
+        return;
+    if (numBits > MAX_QUANTIZATION_BITS)
+        numBits = MAX_QUANTIZATION_BITS;
+
+    float maxSteps = (float)((1U << numBits) - 1);
+    float t = (Clamp(value, minValue, maxValue) - minValue) / (maxValue - minValue);
+    WriteBits((unsigned)(t * maxSteps + 0.5f), numBits);
+}
+
+void BitWriter::WriteQuantizedQuaternion(const Quaternion& value, unsigned numBits)
+{
+    Quaternion norm = value.Normalized();
+    const float* data = norm.Data();
+
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(data[i]) > Abs(data[largest]))
+            largest = i;
+    }
+
+    // The quaternion and its negation represent the same rotation, so flip the sign to make the omitted component positive
+    float sign = data[largest] < 0.0f ? -1.0f : 1.0f;
+
+    WriteBits(largest, 2);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+            WriteQuantizedFloat(data[i] * sign, -QUATERNION_COMPONENT_RANGE, QUATERNION_COMPONENT_RANGE, numBits);
+    }
+}
+
+bool BitWriter::Flush()
+{
+    if (numPendingBits_)
+    {
+        if (!dest_.WriteUByte((unsigned char)(pending_ & 0xff)))
+            failed_ = true;
+        pending_ = 0;
+        numPendingBits_ = 0;
+    }
+
+    return !failed_;
+}
+
+BitReader::BitReader(Deserializer& source) :
+    source_(source),
+    pending_(0),
+    numPendingBits_(0)
+{
+}
+
+unsigned BitReader::ReadBits(unsigned numBits)
+{
+    if (!numBits)
+        return 0;
+    if (numBits > 32)
+        numBits = 32;
+
+    while (numPendingBits_ < numBits && !source_.IsEof())
+    {
+        pending_ |= (unsigned long long)source_.ReadUByte() << numPendingBits_;
+        numPendingBits_ += 8;
+    }
+
+    unsigned ret = (unsigned)(pending_ & ((1ULL << numBits) - 1));
+    pending_ >>= numBits;
+    numPendingBits_ -= Min(numBits, numPendingBits_);
+    return ret;
+}
+
+bool BitReader::ReadBool()
+{
+    return ReadBits(1) != 0;
+}
+
+float BitReader::ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits)
+{
+    if (!numBits || maxValue <= minValue)
+        return minValue;
+    if (numBits > MAX_QUANTIZATION_BITS)
+        numBits = MAX_QUANTIZATION_BITS;
+
+    float maxSteps = (float)((1U << numBits) - 1);
+    return minValue + (maxValue - minValue) * ((float)ReadBits(numBits) / maxSteps);
+}
+
+Quaternion BitReader::ReadQuantizedQuaternion(unsigned numBits)
+{
+    unsigned largest = ReadBits(2);
+    float data[4];
+    float sumSquares = 0.0f;
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+        {
+            data[i] = ReadQuantizedFloat(-QUATERNION_COMPONENT_RANGE, QUATERNION_COMPONENT_RANGE, numBits);
+            sumSquares += data[i] * data[i];
+        }
+    }
+
+    data[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+    Quaternion ret(data);
+    ret.Normalize();
+    return ret;
+}
+
+}
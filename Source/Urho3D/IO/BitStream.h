@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+
+namespace Urho3D
+{
+
+/// Bit-level writer on top of a byte stream such as a VectorBuffer. Bits are written least significant first; the last partial
+/// byte is padded with zeros when flushed.
+class URHO3D_API BitWriter
+{
+public:
+    /// Construct with destination stream.
+    BitWriter(Serializer& dest);
+    /// Destruct. Flush any pending bits.
+    ~BitWriter();
+
+    /// Write up to 32 bits of an unsigned value.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write a bool as one bit.
+    void WriteBool(bool value);
+    /// Write a float quantized to the given range and bits.
+    void WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits);
+    /// Write a normalized quaternion as the smallest three components with the given bits each, plus 2 bits for the index of the omitted component.
+    void WriteQuantizedQuaternion(const Quaternion& value, unsigned numBits);
+    /// Write pending bits padded to a whole byte. Return true if successful.
+    bool Flush();
+
+    /// Return number of bits written, including flushed ones.
+    unsigned GetNumBits() const { return numBits_; }
+
+private:
+    /// Prevent copy construction.
+    BitWriter(const BitWriter& rhs);
+    /// Prevent assignment.
+    BitWriter& operator =(const BitWriter& rhs);
+
+    /// Destination stream.
+    Serializer& dest_;
+    /// Bits not yet written to the stream.
+    unsigned long long pending_;
+    /// Number of bits not yet written to the stream.
+    unsigned numPendingBits_;
+    /// Total number of bits written.
+    unsigned numBits_;
+    /// Write failure flag.
+    bool failed_;
+};
+
+/// Bit-level reader on top of a byte stream such as a MemoryBuffer. Bytes are read from the stream only when their bits are needed.
+class URHO3D_API BitReader
+{
+public:
+    /// Construct with source stream.
+    BitReader(Deserializer& source);
+
+    /// Read up to 32 bits of an unsigned value. Missing bits past the end of the stream read as zero.
+    unsigned ReadBits(unsigned numBits);
+    /// Read a bool from one bit.
+    bool ReadBool();
+    /// Read a float quantized to the given range and bits.
+    float ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits);
+    /// Read a quaternion written as the smallest three components with the given bits each.
+    Quaternion ReadQuantizedQuaternion(unsigned numBits);
+
+    /// Return whether all bits have been read.
+    bool IsEof() const { return !numPendingBits_ && source_.IsEof(); }
+
+private:
+    /// Prevent copy construction.
+    BitReader(const BitReader& rhs);
+    /// Prevent assignment.
+    BitReader& operator =(const BitReader& rhs);
+
+    /// Source stream.
+    Deserializer& source_;
+    /// Bits read from the stream but not yet consumed.
+    unsigned long long pending_;
+    /// Number of bits read from the stream but not yet consumed.
+    unsigned numPendingBits_;
+};
+
+}
@@ -72,8 +72,11 @@ File::File(Context* context) :
 #ifdef __ANDROID__
     assetHandle_(0),
 #endif
+    mappedData_(0),
+    mappedPosition_(0),
     readBufferOffset_(0),
     readBufferSize_(0),
+    readBufferCapacity_(0),
     offset_(0),
     checksum_(0),
     compressed_(false),
@@ -89,8 +92,11 @@ File::File(Context* context, const String& fileName, FileMode mode) :
 #ifdef __ANDROID__
     assetHandle_(0),
 #endif
+    mappedData_(0),
+    mappedPosition_(0),
     readBufferOffset_(0),
     readBufferSize_(0),
+    readBufferCapacity_(0),
     offset_(0),
     checksum_(0),
     compressed_(false),
@@ -107,8 +113,11 @@ File::File(Context* context, PackageFile* package, const String& fileName) :
 #ifdef __ANDROID__
     assetHandle_(0),
 #endif
+    mappedData_(0),
+    mappedPosition_(0),
     readBufferOffset_(0),
     readBufferSize_(0),
+    readBufferCapacity_(0),
     offset_(0),
     checksum_(0),
     compressed_(false),
@@ -137,7 +146,7 @@ bool File::Open(PackageFile* package, const String& fileName)
     if (!entry)
         return false;
 
-    bool success = OpenInternal(package->GetName(), FILE_READ, true);
+    bool success = OpenInternal(package->GetName(), FILE_READ, package);
     if (!success)
     {
         URHO3D_LOGERROR("Could not open package file " + fileName);
@@ -219,7 +228,7 @@ unsigned File::Read(void* dest, unsigned size)
             if (!readBuffer_ || readBufferOffset_ >= readBufferSize_)
             {
                 unsigned char blockHeaderBytes[4];
-                ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes);
+                bool headerRead = ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes);
 
                 MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
                 unsigned unpackedSize = blockHeader.ReadUShort();
@@ -228,12 +237,33 @@ unsigned File::Read(void* dest, unsigned size)
                 if (!readBuffer_)
                 {
                     readBuffer_ = new unsigned char[unpackedSize];
-                    inputBuffer_ = new unsigned char[LZ4_compressBound(unpackedSize)];
+                    readBufferCapacity_ = unpackedSize;
+                    if (!mappedData_)
+                        inputBuffer_ = new unsigned char[LZ4_compressBound(unpackedSize)];
                 }
 
                 /// \todo Handle errors
-                ReadInternal(inputBuffer_.Get(), packedSize);
-                LZ4_decompress_fast((const char*)inputBuffer_.Get(), (char*)readBuffer_.Get(), unpackedSize);
+                if (mappedData_)
+                {
+                    // Decompress straight from the memory mapping without copying the packed block first. The block sizes
+                    // come from the package, so check that the packed block stays inside the mapping and the unpacked
+                    // block inside the read buffer, so that a truncated or corrupt package can not read past them
+                    unsigned totalSize = mappedPackage_->GetTotalSize();
+                    unsigned mappedSizeLeft = mappedPosition_ < totalSize ? totalSize - mappedPosition_ : 0;
+                    if (!headerRead || packedSize > mappedSizeLeft || unpackedSize > readBufferCapacity_ ||
+                        LZ4_decompress_safe((const char*)mappedData_ + mappedPosition_, (char*)readBuffer_.Get(), packedSize,
+                            unpackedSize) != (int)unpackedSize)
+                    {
+                        URHO3D_LOGERROR("Corrupt compressed data in package file " + GetName());
+                        return size - sizeLeft;
+                    }
+                    mappedPosition_ += packedSize;
+                }
+                else
+                {
+                    ReadInternal(inputBuffer_.Get(), packedSize);
+                    LZ4_decompress_fast((const char*)inputBuffer_.Get(), (char*)readBuffer_.Get(), unpackedSize);
+                }
 
                 readBufferSize_ = unpackedSize;
                 readBufferOffset_ = 0;
@@ -392,8 +422,20 @@ void File::Close()
 #endif
 
     readBuffer_.Reset();
+    readBufferCapacity_ = 0;
     inputBuffer_.Reset();
 
+    if (mappedData_)
+    {
+        mappedPackage_.Reset();
+        mappedData_ = 0;
+        mappedPosition_ = 0;
+        position_ = 0;
+        size_ = 0;
+        offset_ = 0;
+        checksum_ = 0;
+    }
+
     if (handle_)
     {
         fclose((FILE*)handle_);
@@ -419,13 +461,13 @@ void File::SetName(const String& name)
 bool File::IsOpen() const
 {
 #ifdef __ANDROID__
-    return handle_ != 0 || assetHandle_ != 0;
+    return handle_ != 0 || assetHandle_ != 0 || mappedData_ != 0;
 #else
-    return handle_ != 0;
+    return handle_ != 0 || mappedData_ != 0;
 #endif
 }
 
-bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
+bool File::OpenInternal(const String& fileName, FileMode mode, PackageFile* package)
 {
     Close();
 
@@ -446,6 +488,19 @@ bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
         return false;
     }
 
+    if (package && package->IsMemoryMapped())
+    {
+        // Read from the package file's memory mapping, no file handle is needed
+        mappedPackage_ = package;
+        mappedData_ = package->GetMappedData();
+        mappedPosition_ = 0;
+        fileName_ = fileName;
+        mode_ = mode;
+        position_ = 0;
+        checksum_ = 0;
+        return true;
+    }
+
 #ifdef __ANDROID__
     if (URHO3D_IS_ASSET(fileName))
     {
@@ -466,7 +521,7 @@ bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
             fileName_ = fileName;
             mode_ = mode;
             position_ = 0;
-            if (!fromPackage)
+            if (!package)
             {
                 size_ = SDL_RWsize(assetHandle_);
                 offset_ = 0;
@@ -499,7 +554,7 @@ bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
         return false;
     }
 
-    if (!fromPackage)
+    if (!package)
     {
         fseek((FILE*)handle_, 0, SEEK_END);
         long size = ftell((FILE*)handle_);
@@ -525,6 +580,16 @@ bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
 
 bool File::ReadInternal(void* dest, unsigned size)
 {
+    if (mappedData_)
+    {
+        unsigned totalSize = mappedPackage_->GetTotalSize();
+        if (mappedPosition_ > totalSize || size > totalSize - mappedPosition_)
+            return false;
+        memcpy(dest, mappedData_ + mappedPosition_, size);
+        mappedPosition_ += size;
+        return true;
+    }
+
 #ifdef __ANDROID__
     if (assetHandle_)
     {
@@ -537,6 +602,12 @@ bool File::ReadInternal(void* dest, unsigned size)
 
 void File::SeekInternal(unsigned newPosition)
 {
+    if (mappedData_)
+    {
+        mappedPosition_ = newPosition;
+        return;
+    }
+
 #ifdef __ANDROID__
     if (assetHandle_)
     {
@@ -109,11 +109,11 @@ public:
     bool IsPackaged() const { return offset_ != 0; }
 
 private:
-    /// Open file internally using either C standard IO functions or SDL RWops for Android asset files. Return true if successful.
-    bool OpenInternal(const String& fileName, FileMode mode, bool fromPackage = false);
-    /// Perform the file read internally using either C standard IO functions or SDL RWops for Android asset files. Return true if successful. This does not handle compressed package file reading.
+    /// Open file internally using either C standard IO functions, SDL RWops for Android asset files or a memory-mapped package file. Return true if successful.
+    bool OpenInternal(const String& fileName, FileMode mode, PackageFile* package = 0);
+    /// Perform the file read internally using either C standard IO functions, SDL RWops for Android asset files or a memory-mapped package file. Return true if successful. This does not handle compressed package file reading.
     bool ReadInternal(void* dest, unsigned size);
-    /// Seek in file internally using either C standard IO functions or SDL RWops for Android asset files.
+    /// Seek in file internally using either C standard IO functions, SDL RWops for Android asset files or a memory-mapped package file.
     void SeekInternal(unsigned newPosition);
 
     /// File name.
@@ -126,6 +126,12 @@ private:
     /// SDL RWops context for Android asset loading.
     SDL_RWops* assetHandle_;
 #endif
+    /// Memory-mapped package file, kept alive while the file is open.
+    SharedPtr<PackageFile> mappedPackage_;
+    /// Memory-mapped package file contents.
+    const unsigned char* mappedData_;
+    /// Read position within the memory-mapped package file.
+    unsigned mappedPosition_;
     /// Read buffer for Android asset or compressed file loading.
     SharedArrayPtr<unsigned char> readBuffer_;
     /// Decompression input buffer for compressed file loading.
@@ -134,6 +140,8 @@ private:
     unsigned readBufferOffset_;
     /// Bytes in the current read buffer.
     unsigned readBufferSize_;
+    /// Allocated size of the read buffer for compressed file loading.
+    unsigned readBufferCapacity_;
     /// Start position within a package file, 0 for regular files.
     unsigned offset_;
     /// Content checksum.
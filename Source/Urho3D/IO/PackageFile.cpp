@@ -23,9 +23,17 @@
 #include "../Precompiled.h"
 
 #include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
 
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define URHO3D_PACKAGE_MMAP
+#endif
+
 namespace Urho3D
 {
 
@@ -34,7 +42,9 @@ PackageFile::PackageFile(Context* context) :
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
-    compressed_(false)
+    compressed_(false),
+    mappedData_(0),
+    mappedSize_(0)
 {
 }
 
@@ -43,17 +53,22 @@ PackageFile::PackageFile(Context* context, const String& fileName, unsigned star
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
-    compressed_(false)
+    compressed_(false),
+    mappedData_(0),
+    mappedSize_(0)
 {
     Open(fileName, startOffset);
 }
 
 PackageFile::~PackageFile()
 {
+    Unmap();
 }
 
 bool PackageFile::Open(const String& fileName, unsigned startOffset)
 {
+    Unmap();
+
     SharedPtr<File> file(new File(context_, fileName));
     if (!file->IsOpen())
         return false;
@@ -109,6 +124,25 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
             entries_[entryName] = newEntry;
     }
 
+#ifdef URHO3D_PACKAGE_MMAP
+    // Map the whole package file read-only. The mapping shares the page cache between all processes reading the
+    // same package, and files opened from the package can read from it without seeking or copying into stdio buffers.
+    // If mapping fails, files are read through normal file I/O instead
+    int fd = open(GetNativePath(fileName).CString(), O_RDONLY);
+    if (fd >= 0)
+    {
+        void* data = mmap(0, totalSize_, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data != MAP_FAILED)
+        {
+            mappedData_ = (unsigned char*)data;
+            mappedSize_ = totalSize_;
+        }
+        else
+            URHO3D_LOGWARNING("Could not memory-map package file " + fileName);
+    }
+#endif
+
     return true;
 }
 
@@ -155,4 +189,26 @@ const PackageEntry* PackageFile::GetEntry(const String& fileName) const
     return 0;
 }
 
+const unsigned char* PackageFile::GetEntryData(const PackageEntry* entry) const
+{
+    if (!mappedData_ || compressed_ || !entry)
+        return 0;
+    // The entry comes from the package directory, which may be corrupt
+    if (entry->offset_ > mappedSize_ || entry->size_ > mappedSize_ - entry->offset_)
+        return 0;
+
+    return mappedData_ + entry->offset_;
+}
+
+void PackageFile::Unmap()
+{
+#ifdef URHO3D_PACKAGE_MMAP
+    if (mappedData_)
+        munmap(mappedData_, mappedSize_);
+#endif
+
+    mappedData_ = 0;
+    mappedSize_ = 0;
+}
+
 }
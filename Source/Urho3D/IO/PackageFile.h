@@ -51,7 +51,7 @@ public:
     /// Destruct.
     virtual ~PackageFile();
 
-    /// Open the package file. Return true if successful.
+    /// Open the package file. On Linux the package file is also memory-mapped if possible. Return true if successful.
     bool Open(const String& fileName, unsigned startOffset = 0);
     /// Check if a file exists within the package file. This will be case-insensitive on Windows and case-sensitive on other platforms.
     bool Exists(const String& fileName) const;
@@ -85,7 +85,19 @@ public:
     /// Return list of file names in the package.
     const Vector<String> GetEntryNames() const { return entries_.Keys(); }
 
+    /// Return whether the package file is memory-mapped. Files opened from the package then read from the mapping instead of through file I/O.
+    bool IsMemoryMapped() const { return mappedData_ != 0; }
+
+    /// Return the memory-mapped package file contents, or null if not mapped.
+    const unsigned char* GetMappedData() const { return mappedData_; }
+
+    /// Return an entry's data within the memory mapping for zero-copy access, for example through a MemoryBuffer. Return null if not mapped, if the files are compressed or if the entry does not fit inside the mapping. Valid as long as the package file is not reopened or destroyed.
+    const unsigned char* GetEntryData(const PackageEntry* entry) const;
+
 private:
+    /// Release the memory mapping if any.
+    void Unmap();
+
     /// File entries.
     HashMap<String, PackageEntry> entries_;
     /// File name.
@@ -100,6 +112,10 @@ private:
     unsigned checksum_;
     /// Compressed flag.
     bool compressed_;
+    /// Memory-mapped package file contents.
+    unsigned char* mappedData_;
+    /// Size of the memory mapping.
+    unsigned mappedSize_;
 };
 
 }
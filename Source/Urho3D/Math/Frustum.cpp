@@ -24,6 +24,10 @@
 
 #include "../Math/Frustum.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -226,6 +230,89 @@ Rect Frustum::Projected(const Matrix4& projection) const
     return rect;
 }
 
+void Frustum::IsInsideFast(const float* packedBoxes, unsigned numGroups, unsigned char* insideMasks) const
+{
+#ifdef URHO3D_SSE
+    __m128 normalX[NUM_FRUSTUM_PLANES];
+    __m128 normalY[NUM_FRUSTUM_PLANES];
+    __m128 normalZ[NUM_FRUSTUM_PLANES];
+    __m128 absNormalX[NUM_FRUSTUM_PLANES];
+    __m128 absNormalY[NUM_FRUSTUM_PLANES];
+    __m128 absNormalZ[NUM_FRUSTUM_PLANES];
+    __m128 d[NUM_FRUSTUM_PLANES];
+    for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    {
+        const Plane& plane = planes_[i];
+        normalX[i] = _mm_set1_ps(plane.normal_.x_);
+        normalY[i] = _mm_set1_ps(plane.normal_.y_);
+        normalZ[i] = _mm_set1_ps(plane.normal_.z_);
+        absNormalX[i] = _mm_set1_ps(plane.absNormal_.x_);
+        absNormalY[i] = _mm_set1_ps(plane.absNormal_.y_);
+        absNormalZ[i] = _mm_set1_ps(plane.absNormal_.z_);
+        d[i] = _mm_set1_ps(plane.d_);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+
+    for (unsigned i = 0; i < numGroups; ++i)
+    {
+        const float* group = packedBoxes + i * PACKED_BOX_GROUP_FLOATS;
+        __m128 centerX = _mm_loadu_ps(group);
+        __m128 centerY = _mm_loadu_ps(group + 4);
+        __m128 centerZ = _mm_loadu_ps(group + 8);
+        __m128 edgeX = _mm_loadu_ps(group + 12);
+        __m128 edgeY = _mm_loadu_ps(group + 16);
+        __m128 edgeZ = _mm_loadu_ps(group + 20);
+        __m128 outside = zero;
+
+        // Same test as for a single box: outside if the center is further behind any plane than the projected half size
+        for (unsigned j = 0; j < NUM_FRUSTUM_PLANES; ++j)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX[j], centerX), _mm_mul_ps(normalY[j], centerY)),
+                _mm_mul_ps(normalZ[j], centerZ)), d[j]);
+            __m128 absDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absNormalX[j], edgeX), _mm_mul_ps(absNormalY[j], edgeY)),
+                _mm_mul_ps(absNormalZ[j], edgeZ));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(zero, absDist)));
+            if (_mm_movemask_ps(outside) == 0xf)
+                break;
+        }
+
+        insideMasks[i] = (unsigned char)(~_mm_movemask_ps(outside) & 0xf);
+    }
+#else
+    for (unsigned i = 0; i < numGroups; ++i)
+    {
+        const float* group = packedBoxes + i * PACKED_BOX_GROUP_FLOATS;
+        unsigned char mask = 0;
+
+        for (unsigned j = 0; j < PACKED_BOX_GROUP_SIZE; ++j)
+        {
+            Vector3 center(group[j], group[4 + j], group[8 + j]);
+            Vector3 edge(group[12 + j], group[16 + j], group[20 + j]);
+            bool inside = true;
+
+            for (unsigned k = 0; k < NUM_FRUSTUM_PLANES; ++k)
+            {
+                const Plane& plane = planes_[k];
+                float dist = plane.normal_.DotProduct(center) + plane.d_;
+                float absDist = plane.absNormal_.DotProduct(edge);
+
+                if (dist < -absDist)
+                {
+                    inside = false;
+                    break;
+                }
+            }
+
+            if (inside)
+                mask |= 1 << j;
+        }
+
+        insideMasks[i] = mask;
+    }
+#endif
+}
+
 void Frustum::UpdatePlanes()
 {
     planes_[PLANE_NEAR].Define(vertices_[2], vertices_[1], vertices_[0]);
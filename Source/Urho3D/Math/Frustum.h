@@ -44,6 +44,10 @@ enum FrustumPlane
 
 static const unsigned NUM_FRUSTUM_PLANES = 6;
 static const unsigned NUM_FRUSTUM_VERTICES = 8;
+/// Number of bounding boxes in a packed group for frustum tests.
+static const unsigned PACKED_BOX_GROUP_SIZE = 4;
+/// Number of floats in a packed group: the center X, Y and Z of each box, followed by the half size X, Y and Z of each box.
+static const unsigned PACKED_BOX_GROUP_FLOATS = PACKED_BOX_GROUP_SIZE * 6;
 
 /// Convex constructed of 6 planes.
 class URHO3D_API Frustum
@@ -157,6 +161,9 @@ public:
         return INSIDE;
     }
 
+    /// Test groups of packed bounding boxes for being (partially) inside. Writes a bit mask of the boxes inside for each group. Uses SSE when available to test a whole group at once.
+    void IsInsideFast(const float* packedBoxes, unsigned numGroups, unsigned char* insideMasks) const;
+
     /// Return distance of a point to the frustum, or 0 if inside.
     float Distance(const Vector3& point) const
     {
@@ -26,11 +26,163 @@
 #include "../Math/Frustum.h"
 #include "../Math/Ray.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+#ifdef URHO3D_SSE
+/// Load a vertex position as (x, y, z, 0) without reading past its end.
+static inline __m128 LoadVertex(const Vector3* vertex)
+{
+    return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&vertex->x_), _mm_load_ss(&vertex->z_));
+}
+
+/// Load the same corner of four triangles as separate X, Y and Z vectors.
+static inline void LoadCorners(const Vector3* const* vertices, __m128& x, __m128& y, __m128& z)
+{
+    __m128 a = LoadVertex(vertices[0]);
+    __m128 b = LoadVertex(vertices[3]);
+    __m128 c = LoadVertex(vertices[6]);
+    __m128 d = LoadVertex(vertices[9]);
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    x = a;
+    y = b;
+    z = c;
+}
+
+/// Return hit distances of a ray to four triangles, or infinity where no hit. Calculated the same way as for a single triangle. The vertices are given as three consecutive pointers per triangle.
+static inline __m128 HitDistances(const Ray& ray, const Vector3* const* vertices)
+{
+    __m128 v0x, v0y, v0z, e1x, e1y, e1z, e2x, e2y, e2z;
+    LoadCorners(vertices, v0x, v0y, v0z);
+    LoadCorners(vertices + 1, e1x, e1y, e1z);
+    LoadCorners(vertices + 2, e2x, e2y, e2z);
+    e1x = _mm_sub_ps(e1x, v0x);
+    e1y = _mm_sub_ps(e1y, v0y);
+    e1z = _mm_sub_ps(e1z, v0z);
+    e2x = _mm_sub_ps(e2x, v0x);
+    e2y = _mm_sub_ps(e2y, v0y);
+    e2z = _mm_sub_ps(e2z, v0z);
+    __m128 dx = _mm_set1_ps(ray.direction_.x_);
+    __m128 dy = _mm_set1_ps(ray.direction_.y_);
+    __m128 dz = _mm_set1_ps(ray.direction_.z_);
+
+    // Determinant
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+    // U & V parameters
+    __m128 tx = _mm_sub_ps(_mm_set1_ps(ray.origin_.x_), v0x);
+    __m128 ty = _mm_sub_ps(_mm_set1_ps(ray.origin_.y_), v0y);
+    __m128 tz = _mm_sub_ps(_mm_set1_ps(ray.origin_.z_), v0z);
+    __m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz));
+    __m128 zero = _mm_setzero_ps();
+    __m128 infinity = _mm_set1_ps(M_INFINITY);
+    __m128 hit = _mm_and_ps(_mm_cmpge_ps(det, _mm_set1_ps(M_EPSILON)), _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, det)));
+    // Most triangles are backfacing or miss already on the U parameter
+    if (!_mm_movemask_ps(hit))
+        return infinity;
+
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+    __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz));
+    __m128 distance = _mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), det);
+
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), det));
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(distance, zero));
+    return _mm_or_ps(_mm_and_ps(hit, distance), _mm_andnot_ps(hit, infinity));
+}
+#endif
+
+/// Return the nearest hit distance of a ray to triangles defined by vertex pointers, three per triangle, and the index of the nearest triangle's first vertex pointer.
+static float NearestHitDistance(const Ray& ray, const Vector3* const* vertices, unsigned numVertices, unsigned& nearestIndex)
+{
+    float nearest = M_INFINITY;
+    unsigned index = 0;
+
+#ifdef URHO3D_SSE
+    // Test four triangles at a time. Ties are resolved to the first triangle as in the scalar loop
+    while (index + 12 <= numVertices)
+    {
+        float distances[4];
+        _mm_storeu_ps(distances, HitDistances(ray, vertices + index));
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            if (distances[i] < nearest)
+            {
+                nearestIndex = index + i * 3;
+                nearest = distances[i];
+            }
+        }
+        index += 12;
+    }
+#endif
+
+    while (index + 2 < numVertices)
+    {
+        float distance = ray.HitDistance(*vertices[index], *vertices[index + 1], *vertices[index + 2]);
+        if (distance < nearest)
+        {
+            nearestIndex = index;
+            nearest = distance;
+        }
+        index += 3;
+    }
+
+    return nearest;
+}
+
+/// Return the nearest hit distance of a ray to indexed or non-indexed triangles. Optionally return the hit normal and barycentric coordinate of the nearest triangle, and its first index.
+template <class T> static float NearestHitDistance(const Ray& ray, const unsigned char* vertices, unsigned vertexStride,
+    const T* indices, unsigned count, Vector3* outNormal, Vector3* outBary, unsigned& nearestIndex)
+{
+    // Gather vertex pointers in batches to share the triangle tests between indexed and non-indexed data
+    static const unsigned BATCH_VERTICES = 96;
+    const Vector3* batch[BATCH_VERTICES];
+    float nearest = M_INFINITY;
+    nearestIndex = M_MAX_UNSIGNED;
+    count -= count % 3;
+
+    for (unsigned start = 0; start < count; start += BATCH_VERTICES)
+    {
+        unsigned batchCount = Min(count - start, BATCH_VERTICES);
+        for (unsigned i = 0; i < batchCount; ++i)
+        {
+            unsigned vertexIndex = indices ? (unsigned)indices[start + i] : start + i;
+            batch[i] = (const Vector3*)(&vertices[vertexIndex * vertexStride]);
+        }
+
+        unsigned batchNearestIndex = M_MAX_UNSIGNED;
+        float distance = NearestHitDistance(ray, batch, batchCount, batchNearestIndex);
+        if (distance < nearest)
+        {
+            nearestIndex = start + batchNearestIndex;
+            nearest = distance;
+        }
+    }
+
+    // Calculate normal and barycentric coordinate only for the nearest triangle
+    if (nearestIndex != M_MAX_UNSIGNED && (outNormal || outBary))
+    {
+        unsigned i0 = indices ? (unsigned)indices[nearestIndex] : nearestIndex;
+        unsigned i1 = indices ? (unsigned)indices[nearestIndex + 1] : nearestIndex + 1;
+        unsigned i2 = indices ? (unsigned)indices[nearestIndex + 2] : nearestIndex + 2;
+        ray.HitDistance(*((const Vector3*)(&vertices[i0 * vertexStride])), *((const Vector3*)(&vertices[i1 * vertexStride])),
+            *((const Vector3*)(&vertices[i2 * vertexStride])), outNormal, outBary);
+    }
+
+    return nearest;
+}
+
 Vector3 Ray::ClosestPoint(const Ray& ray) const
 {
     // Algorithm based on http://paulbourke.net/geometry/lineline3d/
@@ -247,25 +399,12 @@ float Ray::HitDistance(const Vector3& v0, const Vector3& v1, const Vector3& v2,
 float Ray::HitDistance(const void* vertexData, unsigned vertexStride, unsigned vertexStart, unsigned vertexCount,
     Vector3* outNormal, Vector2* outUV, unsigned uvOffset) const
 {
-    float nearest = M_INFINITY;
     const unsigned char* vertices = ((const unsigned char*)vertexData) + vertexStart * vertexStride;
-    unsigned index = 0, nearestIdx = M_MAX_UNSIGNED;
+    unsigned nearestIdx;
     Vector3 barycentric;
     Vector3* outBary = outUV ? &barycentric : 0;
 
-    while (index + 2 < vertexCount)
-    {
-        const Vector3& v0 = *((const Vector3*)(&vertices[index * vertexStride]));
-        const Vector3& v1 = *((const Vector3*)(&vertices[(index + 1) * vertexStride]));
-        const Vector3& v2 = *((const Vector3*)(&vertices[(index + 2) * vertexStride]));
-        float distance = HitDistance(v0, v1, v2, outNormal, outBary);
-        if (distance < nearest)
-        {
-            nearestIdx = index;
-            nearest = distance;
-        }
-        index += 3;
-    }
+    float nearest = NearestHitDistance(*this, vertices, vertexStride, (const unsigned*)0, vertexCount, outNormal, outBary, nearestIdx);
 
     if (outUV)
     {
@@ -288,8 +427,10 @@ float Ray::HitDistance(const void* vertexData, unsigned vertexStride, unsigned v
 float Ray::HitDistance(const void* vertexData, unsigned vertexStride, const void* indexData, unsigned indexSize,
     unsigned indexStart, unsigned indexCount, Vector3* outNormal, Vector2* outUV, unsigned uvOffset) const
 {
-    float nearest = M_INFINITY;
+    float nearest;
     const unsigned char* vertices = (const unsigned char*)vertexData;
+    unsigned nearestIdx;
+    unsigned i0 = 0, i1 = 0, i2 = 0;
     Vector3 barycentric;
     Vector3* outBary = outUV ? &barycentric : 0;
 
@@ -297,72 +438,39 @@ float Ray::HitDistance(const void* vertexData, unsigned vertexStride, const void
     if (indexSize == sizeof(unsigned short))
     {
         const unsigned short* indices = ((const unsigned short*)indexData) + indexStart;
-        const unsigned short* indicesEnd = indices + indexCount;
-        const unsigned short* nearestIndices = 0;
-
-        while (indices < indicesEnd)
-        {
-            const Vector3& v0 = *((const Vector3*)(&vertices[indices[0] * vertexStride]));
-            const Vector3& v1 = *((const Vector3*)(&vertices[indices[1] * vertexStride]));
-            const Vector3& v2 = *((const Vector3*)(&vertices[indices[2] * vertexStride]));
-            float distance = HitDistance(v0, v1, v2, outNormal, outBary);
-            if (distance < nearest)
-            {
-                nearestIndices = indices;
-                nearest = distance;
-            }
-            indices += 3;
-        }
-
-        if (outUV)
+        nearest = NearestHitDistance(*this, vertices, vertexStride, indices, indexCount, outNormal, outBary, nearestIdx);
+        if (nearestIdx != M_MAX_UNSIGNED)
         {
-            if (nearestIndices == 0)
-                *outUV = Vector2::ZERO;
-            else
-            {
-                // Interpolate the UV coordinate using barycentric coordinate
-                const Vector2& uv0 = *((const Vector2*)(&vertices[uvOffset + nearestIndices[0] * vertexStride]));
-                const Vector2& uv1 = *((const Vector2*)(&vertices[uvOffset + nearestIndices[1] * vertexStride]));
-                const Vector2& uv2 = *((const Vector2*)(&vertices[uvOffset + nearestIndices[2] * vertexStride]));
-                *outUV = Vector2(uv0.x_ * barycentric.x_ + uv1.x_ * barycentric.y_ + uv2.x_ * barycentric.z_,
-                    uv0.y_ * barycentric.x_ + uv1.y_ * barycentric.y_ + uv2.y_ * barycentric.z_);
-            }
+            i0 = indices[nearestIdx];
+            i1 = indices[nearestIdx + 1];
+            i2 = indices[nearestIdx + 2];
         }
     }
     // 32-bit indices
     else
     {
         const unsigned* indices = ((const unsigned*)indexData) + indexStart;
-        const unsigned* indicesEnd = indices + indexCount;
-        const unsigned* nearestIndices = 0;
-
-        while (indices < indicesEnd)
+        nearest = NearestHitDistance(*this, vertices, vertexStride, indices, indexCount, outNormal, outBary, nearestIdx);
+        if (nearestIdx != M_MAX_UNSIGNED)
         {
-            const Vector3& v0 = *((const Vector3*)(&vertices[indices[0] * vertexStride]));
-            const Vector3& v1 = *((const Vector3*)(&vertices[indices[1] * vertexStride]));
-            const Vector3& v2 = *((const Vector3*)(&vertices[indices[2] * vertexStride]));
-            float distance = HitDistance(v0, v1, v2, outNormal, outBary);
-            if (distance < nearest)
-            {
-                nearestIndices = indices;
-                nearest = distance;
-            }
-            indices += 3;
+            i0 = indices[nearestIdx];
+            i1 = indices[nearestIdx + 1];
+            i2 = indices[nearestIdx + 2];
         }
+    }
 
-        if (outUV)
+    if (outUV)
+    {
+        if (nearestIdx == M_MAX_UNSIGNED)
+            *outUV = Vector2::ZERO;
+        else
         {
-            if (nearestIndices == 0)
-                *outUV = Vector2::ZERO;
-            else
-            {
-                // Interpolate the UV coordinate using barycentric coordinate
-                const Vector2& uv0 = *((const Vector2*)(&vertices[uvOffset + nearestIndices[0] * vertexStride]));
-                const Vector2& uv1 = *((const Vector2*)(&vertices[uvOffset + nearestIndices[1] * vertexStride]));
-                const Vector2& uv2 = *((const Vector2*)(&vertices[uvOffset + nearestIndices[2] * vertexStride]));
-                *outUV = Vector2(uv0.x_ * barycentric.x_ + uv1.x_ * barycentric.y_ + uv2.x_ * barycentric.z_,
-                    uv0.y_ * barycentric.x_ + uv1.y_ * barycentric.y_ + uv2.y_ * barycentric.z_);
-            }
+            // Interpolate the UV coordinate using barycentric coordinate
+            const Vector2& uv0 = *((const Vector2*)(&vertices[uvOffset + i0 * vertexStride]));
+            const Vector2& uv1 = *((const Vector2*)(&vertices[uvOffset + i1 * vertexStride]));
+            const Vector2& uv2 = *((const Vector2*)(&vertices[uvOffset + i2 * vertexStride]));
+            *outUV = Vector2(uv0.x_ * barycentric.x_ + uv1.x_ * barycentric.y_ + uv2.x_ * barycentric.z_,
+                uv0.y_ * barycentric.x_ + uv1.y_ * barycentric.y_ + uv2.y_ * barycentric.z_);
         }
     }
 
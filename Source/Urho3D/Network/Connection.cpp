@@ -33,6 +33,7 @@
 #include "../Network/NetworkEvents.h"
 #include "../Network/NetworkPriority.h"
 #include "../Network/Protocol.h"
+#include "../Network/RelevanceFilter.h"
 #include "../Resource/ResourceCache.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
@@ -46,6 +47,74 @@ namespace Urho3D
 {
 
 static const int STATS_INTERVAL_MSEC = 2000;
+/// Maximum number of unacknowledged snapshot deltas per node or component. Older ones are merged.
+static const unsigned MAX_SNAPSHOT_DELTAS = 32;
+
+/// Return whether a snapshot sequence number is newer than another, taking wraparound into account.
+static bool IsSnapshotNewer(unsigned short sequence, unsigned short other)
+{
+    return (short)(sequence - other) > 0;
+}
+
+static void AddSnapshotDelta(PODVector<SnapshotDelta>& snapshotDeltas, unsigned short sequence, const DirtyBits& attributes)
+{
+    // If the client has not acknowledged for a long time, merge the oldest changes to the next snapshot delta. They were
+    // resent in it, so acknowledging it covers both
+    if (snapshotDeltas.Size() >= MAX_SNAPSHOT_DELTAS)
+    {
+        snapshotDeltas[1].attributes_.Merge(snapshotDeltas[0].attributes_);
+        snapshotDeltas.Erase(0);
+    }
+
+    SnapshotDelta delta;
+    delta.sequence_ = sequence;
+    delta.attributes_ = attributes;
+    snapshotDeltas.Push(delta);
+}
+
+static void AcknowledgeSnapshot(PODVector<SnapshotDelta>& snapshotDeltas, unsigned short sequence)
+{
+    // The delta sent in the acknowledged snapshot contained all earlier unacknowledged changes, so they are confirmed too
+    for (unsigned i = 0; i < snapshotDeltas.Size(); ++i)
+    {
+        if (snapshotDeltas[i].sequence_ == sequence)
+        {
+            snapshotDeltas.Erase(0, i + 1);
+            return;
+        }
+    }
+}
+
+static void ResendSnapshotDeltas(PODVector<SnapshotDelta>& snapshotDeltas, DirtyBits& dirtyAttributes)
+{
+    for (unsigned i = 0; i < snapshotDeltas.Size(); ++i)
+        dirtyAttributes.Merge(snapshotDeltas[i].attributes_);
+    snapshotDeltas.Clear();
+}
+
+/// Scoped lock of the mutex shared between connections during a threaded server update. Does nothing if there is none.
+class SharedMutexLock
+{
+public:
+    /// Construct and acquire the mutex if not null.
+    SharedMutexLock(Mutex* mutex) :
+        mutex_(mutex)
+    {
+        if (mutex_)
+            mutex_->Acquire();
+    }
+
+    /// Destruct and release the mutex.
+    ~SharedMutexLock()
+    {
+        if (mutex_)
+            mutex_->Release();
+    }
+
+private:
+    /// Mutex, or null.
+    Mutex* mutex_;
+};
 
 PackageDownload::PackageDownload() :
     totalFragments_(0),
@@ -64,14 +133,28 @@ Connection::Connection(Context* context, bool isClient, kNet::SharedPtr<kNet::Me
     Object(context),
     timeStamp_(0),
     connection_(connection),
+    sharedMutex_(0),
     sendMode_(OPSM_NONE),
     isClient_(isClient),
     connectPending_(false),
     sceneLoaded_(false),
-    logStatistics_(false)
+    logStatistics_(false),
+    queueMessages_(false),
+    numSnapshotMessages_(0),
+    snapshotSequence_(0),
+    latestSnapshotSequence_(0),
+    snapshotDeltas_(false),
+    snapshotAckPending_(false)
 {
     sceneState_.connection_ = this;
 
+    for (unsigned i = 0; i < NUM_SNAPSHOT_RECEIPTS; ++i)
+    {
+        snapshotReceipts_[i].sequence_ = 0;
+        snapshotReceipts_[i].numReceived_ = 0;
+        snapshotReceipts_[i].numExpected_ = M_MAX_UNSIGNED;
+    }
+
     // Store address and port now for accurate logging (kNet may already have destroyed the socket on disconnection,
     // in which case we would log a zero address:port on disconnect)
     kNet::EndPoint endPoint = connection_->RemoteEndPoint();
@@ -107,6 +190,25 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
         return;
     }
 
+    if (queueMessages_)
+    {
+        QueuedMessage queued;
+        queued.msgID_ = msgID;
+        queued.contentID_ = contentID;
+        queued.offset_ = queuedMessageData_.Size();
+        queued.size_ = numBytes;
+        queued.reliable_ = reliable;
+        queued.inOrder_ = inOrder;
+        queuedMessages_.Push(queued);
+
+        if (numBytes)
+        {
+            queuedMessageData_.Resize(queued.offset_ + numBytes);
+            memcpy(&queuedMessageData_[queued.offset_], data, numBytes);
+        }
+        return;
+    }
+
     kNet::NetworkMessage* msg = connection_->StartNewMessage((unsigned long)msgID, numBytes);
     if (!msg)
     {
@@ -178,6 +280,7 @@ void Connection::SetScene(Scene* newScene)
     if (isClient_)
     {
         sceneState_.Clear();
+        snapshotNodes_.Clear();
 
         // When scene is assigned on the server, instruct the client to load it. This may require downloading packages
         const Vector<SharedPtr<PackageFile> >& packages = scene_->GetRequiredPackageFiles();
@@ -236,6 +339,55 @@ void Connection::SetLogStatistics(bool enable)
     logStatistics_ = enable;
 }
 
+void Connection::SetRelevanceFilter(RelevanceFilter* filter)
+{
+    // When interest management is turned off, the nodes that were filtered out need to be created on the client
+    if (!filter && relevanceFilter_ && scene_)
+    {
+        PODVector<Node*> nodes;
+        scene_->GetChildren(nodes, true);
+        for (PODVector<Node*>::ConstIterator i = nodes.Begin(); i != nodes.End(); ++i)
+        {
+            unsigned nodeID = (*i)->GetID();
+            if (nodeID < FIRST_LOCAL_ID && !sceneState_.nodeStates_.Contains(nodeID))
+                sceneState_.dirtyNodes_.Insert(nodeID);
+        }
+    }
+
+    relevanceFilter_ = filter;
+    relevantNodes_.Clear();
+}
+
+void Connection::SetSnapshotDeltas(bool enable)
+{
+    if (enable == snapshotDeltas_)
+        return;
+
+    // When turned off, send the unacknowledged changes again as reliable delta updates
+    if (!enable)
+    {
+        for (HashSet<unsigned>::ConstIterator i = snapshotNodes_.Begin(); i != snapshotNodes_.End(); ++i)
+        {
+            HashMap<unsigned, NodeReplicationState>::Iterator j = sceneState_.nodeStates_.Find(*i);
+            if (j == sceneState_.nodeStates_.End())
+                continue;
+
+            NodeReplicationState& nodeState = j->second_;
+            ResendSnapshotDeltas(nodeState.snapshotDeltas_, nodeState.dirtyAttributes_);
+            for (HashMap<unsigned, ComponentReplicationState>::Iterator k = nodeState.componentStates_.Begin();
+                 k != nodeState.componentStates_.End(); ++k)
+                ResendSnapshotDeltas(k->second_.snapshotDeltas_, k->second_.dirtyAttributes_);
+
+            nodeState.markedDirty_ = true;
+            sceneState_.dirtyNodes_.Insert(*i);
+        }
+
+        snapshotNodes_.Clear();
+    }
+
+    snapshotDeltas_ = enable;
+}
+
 void Connection::Disconnect(int waitMSec)
 {
     connection_->Disconnect(waitMSec);
@@ -252,8 +404,13 @@ void Connection::SendServerUpdate()
     nodesToProcess_.Insert(sceneID);
     ProcessNode(sceneID);
 
-    // Then go through all dirtied nodes
+    // With interest management, only the nodes relevant to the client are replicated
+    if (relevanceFilter_)
+        UpdateRelevantNodes();
+
+    // Then go through all dirtied nodes, and in snapshot delta mode the nodes with changes not yet acknowledged by the client
     nodesToProcess_.Insert(sceneState_.dirtyNodes_);
+    nodesToProcess_.Insert(snapshotNodes_);
     nodesToProcess_.Erase(sceneID); // Do not process the root node twice
 
     while (nodesToProcess_.Size())
@@ -261,6 +418,18 @@ void Connection::SendServerUpdate()
         unsigned nodeID = nodesToProcess_.Front();
         ProcessNode(nodeID);
     }
+
+    // Finish the snapshot by telling how many delta messages the client should have received for it
+    if (numSnapshotMessages_)
+    {
+        msg_.Clear();
+        msg_.WriteUShort(snapshotSequence_);
+        msg_.WriteVLE(numSnapshotMessages_);
+        SendMessage(MSG_SNAPSHOTEND, false, false, msg_);
+
+        ++snapshotSequence_;
+        numSnapshotMessages_ = 0;
+    }
 }
 
 void Connection::SendClientUpdate()
@@ -281,6 +450,14 @@ void Connection::SendClientUpdate()
     SendMessage(MSG_CONTROLS, false, false, msg_, CONTROLS_CONTENT_ID);
 
     ++timeStamp_;
+
+    if (snapshotAckPending_)
+    {
+        msg_.Clear();
+        msg_.WriteUShort(snapshotSequence_);
+        SendMessage(MSG_SNAPSHOTACK, false, false, msg_, SNAPSHOTACK_CONTENT_ID);
+        snapshotAckPending_ = false;
+    }
 }
 
 void Connection::SendRemoteEvents()
@@ -350,6 +527,24 @@ void Connection::SendPackages()
     }
 }
 
+void Connection::SetQueueMessages(bool enable, Mutex* sharedMutex)
+{
+    queueMessages_ = enable;
+    sharedMutex_ = enable ? sharedMutex : 0;
+
+    if (!enable && queuedMessages_.Size())
+    {
+        for (PODVector<QueuedMessage>::ConstIterator i = queuedMessages_.Begin(); i != queuedMessages_.End(); ++i)
+        {
+            SendMessage(i->msgID_, i->reliable_, i->inOrder_, i->size_ ? &queuedMessageData_[i->offset_] : 0, i->size_,
+                i->contentID_);
+        }
+
+        queuedMessages_.Clear();
+        queuedMessageData_.Clear();
+    }
+}
+
 void Connection::ProcessPendingLatestData()
 {
     if (!scene_ || !sceneLoaded_)
@@ -438,6 +633,16 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
         ProcessPackageInfo(msgID, msg);
         break;
 
+    case MSG_NODESNAPSHOTDELTA:
+    case MSG_COMPONENTSNAPSHOTDELTA:
+    case MSG_SNAPSHOTEND:
+        ProcessSnapshot(msgID, msg);
+        break;
+
+    case MSG_SNAPSHOTACK:
+        ProcessSnapshotAck(msgID, msg);
+        break;
+
     default:
         processed = false;
         break;
@@ -463,9 +668,18 @@ void Connection::ProcessLoadScene(int msgID, MemoryBuffer& msg)
     // Store the scene file name we need to eventually load
     sceneFileName_ = msg.ReadString();
 
-    // Clear previous pending latest data and package downloads if any
+    // Clear previous pending latest data, snapshot state and package downloads if any
     nodeLatestData_.Clear();
     componentLatestData_.Clear();
+    nodeSnapshotSequences_.Clear();
+    componentSnapshotSequences_.Clear();
+    for (unsigned i = 0; i < NUM_SNAPSHOT_RECEIPTS; ++i)
+    {
+        snapshotReceipts_[i].numReceived_ = 0;
+        snapshotReceipts_[i].numExpected_ = M_MAX_UNSIGNED;
+    }
+    snapshotAckPending_ = false;
+    latestSnapshotSequence_ = 0;
     downloads_.Clear();
 
     // In case we have joined other scenes in this session, remove first all downloaded package files from the resource system
@@ -630,6 +844,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             if (node)
                 node->Remove();
             nodeLatestData_.Erase(nodeID);
+            nodeSnapshotSequences_.Erase(nodeID);
         }
         break;
 
@@ -707,6 +922,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             if (component)
                 component->Remove();
             componentLatestData_.Erase(componentID);
+            componentSnapshotSequences_.Erase(componentID);
         }
         break;
 
@@ -981,11 +1197,173 @@ void Connection::ProcessRemoteEvent(int msgID, MemoryBuffer& msg)
     }
 }
 
+void Connection::ProcessSnapshot(int msgID, MemoryBuffer& msg)
+{
+    if (IsClient())
+    {
+        URHO3D_LOGWARNING("Received unexpected Snapshot message from client " + ToString());
+        return;
+    }
+
+    if (!scene_)
+        return;
+
+    switch (msgID)
+    {
+    case MSG_NODESNAPSHOTDELTA:
+        {
+            unsigned nodeID = msg.ReadNetID();
+            unsigned short sequence = msg.ReadUShort();
+            unsigned extendedSequence = ExtendSnapshotSequence(sequence);
+            Node* node = scene_->GetNode(nodeID);
+            // If the node has not been created yet, leave the snapshot incomplete. The server resends the changes until
+            // a later snapshot is acknowledged
+            if (!node)
+                break;
+
+            // Snapshot deltas are unordered, so do not apply older changes over newer ones. An older delta still counts as
+            // received, as the newer one resent its changes. A duplicate of the applied delta does not count again
+            HashMap<unsigned, unsigned>::Iterator i = nodeSnapshotSequences_.Find(nodeID);
+            if (i == nodeSnapshotSequences_.End() || extendedSequence > i->second_)
+            {
+                node->ReadDeltaUpdate(msg);
+                // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
+                // Furthermore it would propagate to components and child nodes, which is not desired in this case
+                nodeSnapshotSequences_[nodeID] = extendedSequence;
+            }
+            else if (extendedSequence == i->second_)
+                break;
+
+            UpdateSnapshotReceipt(sequence, false, 1);
+        }
+        break;
+
+    case MSG_COMPONENTSNAPSHOTDELTA:
+        {
+            unsigned componentID = msg.ReadNetID();
+            unsigned short sequence = msg.ReadUShort();
+            unsigned extendedSequence = ExtendSnapshotSequence(sequence);
+            Component* component = scene_->GetComponent(componentID);
+            if (!component)
+                break;
+
+            HashMap<unsigned, unsigned>::Iterator i = componentSnapshotSequences_.Find(componentID);
+            if (i == componentSnapshotSequences_.End() || extendedSequence > i->second_)
+            {
+                if (component->ReadDeltaUpdate(msg))
+                    component->ApplyAttributes();
+                componentSnapshotSequences_[componentID] = extendedSequence;
+            }
+            else if (extendedSequence == i->second_)
+                break;
+
+            UpdateSnapshotReceipt(sequence, false, 1);
+        }
+        break;
+
+    case MSG_SNAPSHOTEND:
+        {
+            unsigned short sequence = msg.ReadUShort();
+            ExtendSnapshotSequence(sequence);
+            UpdateSnapshotReceipt(sequence, true, msg.ReadVLE());
+        }
+        break;
+
+    default: break;
+    }
+}
+
+void Connection::ProcessSnapshotAck(int msgID, MemoryBuffer& msg)
+{
+    if (!IsClient())
+    {
+        URHO3D_LOGWARNING("Received unexpected SnapshotAck message from server");
+        return;
+    }
+
+    unsigned short sequence = msg.ReadUShort();
+    // Ignore acknowledgements of snapshots that have not been sent
+    if (!IsSnapshotNewer(snapshotSequence_, sequence))
+        return;
+
+    for (HashSet<unsigned>::Iterator i = snapshotNodes_.Begin(); i != snapshotNodes_.End();)
+    {
+        HashSet<unsigned>::Iterator current = i++;
+        bool pending = false;
+
+        HashMap<unsigned, NodeReplicationState>::Iterator j = sceneState_.nodeStates_.Find(*current);
+        if (j != sceneState_.nodeStates_.End())
+        {
+            NodeReplicationState& nodeState = j->second_;
+            AcknowledgeSnapshot(nodeState.snapshotDeltas_, sequence);
+            pending = !nodeState.snapshotDeltas_.Empty();
+
+            for (HashMap<unsigned, ComponentReplicationState>::Iterator k = nodeState.componentStates_.Begin();
+                 k != nodeState.componentStates_.End(); ++k)
+            {
+                AcknowledgeSnapshot(k->second_.snapshotDeltas_, sequence);
+                if (!k->second_.snapshotDeltas_.Empty())
+                    pending = true;
+            }
+        }
+
+        if (!pending)
+            snapshotNodes_.Erase(current);
+    }
+}
+
+void Connection::UpdateSnapshotReceipt(unsigned short sequence, bool end, unsigned numMessages)
+{
+    SnapshotReceipt& receipt = snapshotReceipts_[sequence % NUM_SNAPSHOT_RECEIPTS];
+    if (receipt.sequence_ != sequence)
+    {
+        // Reuse the slot of an older or unused snapshot. Messages of snapshots too old to be tracked are ignored
+        bool unused = !receipt.numReceived_ && receipt.numExpected_ == M_MAX_UNSIGNED;
+        if (!unused && !IsSnapshotNewer(sequence, receipt.sequence_))
+            return;
+
+        receipt.sequence_ = sequence;
+        receipt.numReceived_ = 0;
+        receipt.numExpected_ = M_MAX_UNSIGNED;
+    }
+
+    if (end)
+        receipt.numExpected_ = numMessages;
+    else
+        receipt.numReceived_ += numMessages;
+
+    // Acknowledge the newest complete snapshot on the next client update
+    if (receipt.numReceived_ == receipt.numExpected_ && (!snapshotAckPending_ || IsSnapshotNewer(sequence, snapshotSequence_)))
+    {
+        snapshotSequence_ = sequence;
+        snapshotAckPending_ = true;
+    }
+}
+
+unsigned Connection::ExtendSnapshotSequence(unsigned short sequence)
+{
+    // Start from the first sequence number received for the scene, leaving room below it for older messages arriving late.
+    // The 32-bit sequence does not wrap around in practice
+    if (!latestSnapshotSequence_)
+        latestSnapshotSequence_ = 0x10000 | sequence;
+
+    // Messages arrive at most a few snapshots out of order, so the nearest 32-bit value is the right one
+    unsigned extended = latestSnapshotSequence_ + (short)(sequence - (unsigned short)latestSnapshotSequence_);
+    if (extended > latestSnapshotSequence_)
+        latestSnapshotSequence_ = extended;
+    return extended;
+}
+
 kNet::MessageConnection* Connection::GetMessageConnection() const
 {
     return const_cast<kNet::MessageConnection*>(connection_.ptr());
 }
 
+RelevanceFilter* Connection::GetRelevanceFilter() const
+{
+    return relevanceFilter_;
+}
+
 Scene* Connection::GetScene() const
 {
     return scene_;
@@ -1123,6 +1501,7 @@ void Connection::ProcessNode(unsigned nodeID)
             // information at the time of receiving this message
             SendMessage(MSG_REMOVENODE, true, true, msg_);
             sceneState_.nodeStates_.Erase(nodeID);
+            snapshotNodes_.Erase(nodeID);
         }
         else
             ProcessExistingNode(node, i->second_);
@@ -1131,16 +1510,125 @@ void Connection::ProcessNode(unsigned nodeID)
     {
         // Replication state not found: this is a new node
         Node* node = scene_->GetNode(nodeID);
-        if (node)
+        if (node && (!relevanceFilter_ || relevantNodes_.Contains(nodeID)))
             ProcessNewNode(node);
         else
         {
-            // Did not find the new node (may have been created, then removed immediately): erase from dirty set.
+            // Did not find the new node (may have been created, then removed immediately), or it is not relevant to
+            // the client: erase from dirty set. A node that becomes relevant later is queued again
             sceneState_.dirtyNodes_.Erase(nodeID);
         }
     }
 }
 
+void Connection::UpdateRelevantNodes()
+{
+    unsigned sceneID = scene_->GetID();
+
+    relevantNodes_.Clear();
+    {
+        // The filter may use shared state such as the octree, so do not query it concurrently
+        SharedMutexLock lock(sharedMutex_);
+        relevanceFilter_->GetRelevantNodes(this, scene_, relevantNodes_);
+    }
+
+    // Depended upon nodes, such as the parents, must also exist on the client
+    for (HashSet<unsigned>::ConstIterator i = relevantNodes_.Begin(); i != relevantNodes_.End(); ++i)
+    {
+        Node* node = scene_->GetNode(*i);
+        if (node)
+            relevanceStack_.Push(node);
+    }
+    while (relevanceStack_.Size())
+    {
+        Node* node = relevanceStack_.Back();
+        relevanceStack_.Pop();
+
+        const PODVector<Node*>& dependencyNodes = node->GetDependencyNodes();
+        for (PODVector<Node*>::ConstIterator i = dependencyNodes.Begin(); i != dependencyNodes.End(); ++i)
+        {
+            unsigned nodeID = (*i)->GetID();
+            if (nodeID != sceneID && !relevantNodes_.Contains(nodeID))
+            {
+                relevantNodes_.Insert(nodeID);
+                relevanceStack_.Push(*i);
+            }
+        }
+    }
+
+    // Remove nodes that are no longer relevant from the client. Nodes removed from the scene are handled normally
+    for (HashMap<unsigned, NodeReplicationState>::Iterator i = sceneState_.nodeStates_.Begin(); i != sceneState_.nodeStates_.End();)
+    {
+        HashMap<unsigned, NodeReplicationState>::Iterator current = i++;
+        if (current->first_ != sceneID && current->second_.node_ && !relevantNodes_.Contains(current->first_))
+        {
+            RemoveReplicatedNode(current->first_, current->second_);
+            sceneState_.nodeStates_.Erase(current);
+        }
+    }
+
+    // Queue nodes that became relevant for creation
+    for (HashSet<unsigned>::ConstIterator i = relevantNodes_.Begin(); i != relevantNodes_.End(); ++i)
+    {
+        if (!sceneState_.nodeStates_.Contains(*i))
+            sceneState_.dirtyNodes_.Insert(*i);
+    }
+}
+
+void Connection::RemoveReplicatedNode(unsigned nodeID, NodeReplicationState& nodeState)
+{
+    msg_.Clear();
+    msg_.WriteNetID(nodeID);
+    SendMessage(MSG_REMOVENODE, true, true, msg_);
+
+    // Stop the node and its components from tracking the replication states that are about to be destroyed
+    {
+        SharedMutexLock lock(sharedMutex_);
+
+        NetworkState* networkState = nodeState.node_->GetNetworkState();
+        if (networkState)
+            networkState->replicationStates_.Remove(&nodeState);
+
+        for (HashMap<unsigned, ComponentReplicationState>::Iterator i = nodeState.componentStates_.Begin();
+             i != nodeState.componentStates_.End(); ++i)
+        {
+            Component* component = i->second_.component_;
+            NetworkState* componentNetworkState = component ? component->GetNetworkState() : 0;
+            if (componentNetworkState)
+                componentNetworkState->replicationStates_.Remove(&i->second_);
+        }
+    }
+
+    sceneState_.dirtyNodes_.Erase(nodeID);
+    nodesToProcess_.Erase(nodeID);
+    snapshotNodes_.Erase(nodeID);
+}
+
+bool Connection::SendSnapshotDelta(int msgID, Serializable* serializable, unsigned id, PODVector<SnapshotDelta>& snapshotDeltas,
+    DirtyBits& dirtyAttributes)
+{
+    // The delta is against the last acknowledged snapshot, so include the changes of all unacknowledged ones
+    DirtyBits attributeBits(dirtyAttributes);
+    for (unsigned i = 0; i < snapshotDeltas.Size(); ++i)
+        attributeBits.Merge(snapshotDeltas[i].attributes_);
+
+    if (!attributeBits.Count())
+        return false;
+
+    msg_.Clear();
+    msg_.WriteNetID(id);
+    msg_.WriteUShort(snapshotSequence_);
+    serializable->WriteDeltaUpdate(msg_, attributeBits, timeStamp_);
+
+    // A newer snapshot delta of the same object supersedes an older one still waiting to be sent
+    SendMessage(msgID, false, false, msg_, id);
+    ++numSnapshotMessages_;
+
+    AddSnapshotDelta(snapshotDeltas, snapshotSequence_, dirtyAttributes);
+    dirtyAttributes.ClearAll();
+    return true;
+}
+
 void Connection::ProcessNewNode(Node* node)
 {
     // Process depended upon nodes first, if they are dirty
@@ -1159,7 +1647,10 @@ void Connection::ProcessNewNode(Node* node)
     nodeState.connection_ = this;
     nodeState.sceneState_ = &sceneState_;
     nodeState.node_ = node;
-    node->AddReplicationState(&nodeState);
+    {
+        SharedMutexLock lock(sharedMutex_);
+        node->AddReplicationState(&nodeState);
+    }
 
     // Write node's attributes
     node->WriteInitialDeltaUpdate(msg_, timeStamp_);
@@ -1187,7 +1678,10 @@ void Connection::ProcessNewNode(Node* node)
         componentState.connection_ = this;
         componentState.nodeState_ = &nodeState;
         componentState.component_ = component;
-        component->AddReplicationState(&componentState);
+        {
+            SharedMutexLock lock(sharedMutex_);
+            component->AddReplicationState(&componentState);
+        }
 
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
@@ -1216,13 +1710,19 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     NetworkPriority* priority = node->GetComponent<NetworkPriority>();
     if (priority && (!priority->GetAlwaysUpdateOwner() || node->GetOwner() != this))
     {
-        float distance = (node->GetWorldPosition() - position_).Length();
+        // Getting the world position may update the cached world transform, which is shared with other connections
+        Vector3 worldPosition;
+        {
+            SharedMutexLock lock(sharedMutex_);
+            worldPosition = node->GetWorldPosition();
+        }
+        float distance = (worldPosition - position_).Length();
         if (!priority->CheckUpdate(distance, nodeState.priorityAcc_))
             return;
     }
 
-    // Check if attributes have changed
-    if (nodeState.dirtyAttributes_.Count() || nodeState.dirtyVars_.Size())
+    // Check if attributes have changed, or unacknowledged snapshot deltas need to be resent
+    if (nodeState.dirtyAttributes_.Count() || nodeState.dirtyVars_.Size() || nodeState.snapshotDeltas_.Size())
     {
         const Vector<AttributeInfo>* attributes = node->GetNetworkAttributes();
         unsigned numAttributes = attributes->Size();
@@ -1247,6 +1747,11 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
         }
 
+        // In snapshot delta mode send the remaining dirty bits unreliably. Changed vars still go in a reliable deltaupdate
+        if (snapshotDeltas_ && SendSnapshotDelta(MSG_NODESNAPSHOTDELTA, node, node->GetID(), nodeState.snapshotDeltas_,
+            nodeState.dirtyAttributes_))
+            snapshotNodes_.Insert(node->GetID());
+
         // Send deltaupdate if remaining dirty bits, or vars have changed
         if (nodeState.dirtyAttributes_.Count() || nodeState.dirtyVars_.Size())
         {
@@ -1299,8 +1804,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
         }
         else
         {
-            // Existing component. Check if attributes have changed
-            if (componentState.dirtyAttributes_.Count())
+            // Existing component. Check if attributes have changed, or unacknowledged snapshot deltas need to be resent
+            if (componentState.dirtyAttributes_.Count() || componentState.snapshotDeltas_.Size())
             {
                 const Vector<AttributeInfo>* attributes = component->GetNetworkAttributes();
                 unsigned numAttributes = attributes->Size();
@@ -1325,6 +1830,10 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                     SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
                 }
 
+                if (snapshotDeltas_ && SendSnapshotDelta(MSG_COMPONENTSNAPSHOTDELTA, component, component->GetID(),
+                    componentState.snapshotDeltas_, componentState.dirtyAttributes_))
+                    snapshotNodes_.Insert(node->GetID());
+
                 // Send deltaupdate if remaining dirty bits
                 if (componentState.dirtyAttributes_.Count())
                 {
@@ -1359,7 +1868,10 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 componentState.connection_ = this;
                 componentState.nodeState_ = &nodeState;
                 componentState.component_ = component;
-                component->AddReplicationState(&componentState);
+                {
+                    SharedMutexLock lock(sharedMutex_);
+                    component->AddReplicationState(&componentState);
+                }
 
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/HashSet.h"
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Core/Timer.h"
 #include "../Input/Controls.h"
@@ -45,6 +46,7 @@ class Node;
 class Scene;
 class Serializable;
 class PackageFile;
+class RelevanceFilter;
 
 /// Queued remote event.
 struct RemoteEvent
@@ -59,6 +61,37 @@ struct RemoteEvent
     bool inOrder_;
 };
 
+/// Outgoing message queued while building a server update in a worker thread.
+struct QueuedMessage
+{
+    /// Message ID.
+    int msgID_;
+    /// Content ID.
+    unsigned contentID_;
+    /// Offset of the message data in the queued data buffer.
+    unsigned offset_;
+    /// Message data size.
+    unsigned size_;
+    /// Reliable flag.
+    bool reliable_;
+    /// In order flag.
+    bool inOrder_;
+};
+
+/// Reception state of a snapshot on the client.
+struct SnapshotReceipt
+{
+    /// Snapshot sequence number.
+    unsigned short sequence_;
+    /// Number of snapshot delta messages received.
+    unsigned numReceived_;
+    /// Number of snapshot delta messages in the snapshot, or M_MAX_UNSIGNED until the end of the snapshot is received.
+    unsigned numExpected_;
+};
+
+/// Number of most recent snapshots tracked for acknowledgement on the client.
+static const unsigned NUM_SNAPSHOT_RECEIPTS = 16;
+
 /// Package file receive transfer.
 struct PackageDownload
 {
@@ -134,6 +167,10 @@ public:
     void SetConnectPending(bool connectPending);
     /// Set whether to log data in/out statistics.
     void SetLogStatistics(bool enable);
+    /// Set the relevance filter for interest management. Nodes not reported relevant by the filter are not replicated to the client, and are removed from the client when they stop being relevant. Null (default) replicates all nodes.
+    void SetRelevanceFilter(RelevanceFilter* filter);
+    /// Set whether to send the attribute changes of existing nodes and components unreliably as deltas against the last snapshot acknowledged by the client, instead of reliable in-order delta updates. Avoids stalls on packet loss. Node and component creation, removal and user variables are still sent reliably. Used on the server.
+    void SetSnapshotDeltas(bool enable);
     /// Disconnect. If wait time is non-zero, will block while waiting for disconnect to finish.
     void Disconnect(int waitMSec = 0);
     /// Send scene update messages. Called by Network.
@@ -144,6 +181,8 @@ public:
     void SendRemoteEvents();
     /// Send package files to client. Called by network.
     void SendPackages();
+    /// Set whether to queue outgoing messages instead of passing them to kNet immediately, which allows SendServerUpdate() and SendRemoteEvents() of different connections to run in worker threads at the same time. The mutex guards scene objects shared between the connections. Disabling sends the queued messages in order. Called by Network.
+    void SetQueueMessages(bool enable, Mutex* sharedMutex = 0);
     /// Process pending latest data for nodes and components.
     void ProcessPendingLatestData();
     /// Process a message from the server or client. Called by Network.
@@ -185,6 +224,12 @@ public:
     /// Return whether to log data in/out statistics.
     bool GetLogStatistics() const { return logStatistics_; }
 
+    /// Return the relevance filter for interest management.
+    RelevanceFilter* GetRelevanceFilter() const;
+
+    /// Return whether attribute changes are sent as snapshot deltas.
+    bool GetSnapshotDeltas() const { return snapshotDeltas_; }
+
     /// Return remote address.
     String GetAddress() const { return address_; }
 
@@ -249,6 +294,21 @@ private:
     void ProcessSceneLoaded(int msgID, MemoryBuffer& msg);
     /// Process a remote event message from the client or server. Called by Network.
     void ProcessRemoteEvent(int msgID, MemoryBuffer& msg);
+    /// Process a snapshot delta or snapshot end message from the server. Called by Network.
+    void ProcessSnapshot(int msgID, MemoryBuffer& msg);
+    /// Process a snapshot acknowledgement message from the client. Called by Network.
+    void ProcessSnapshotAck(int msgID, MemoryBuffer& msg);
+    /// Count a received snapshot delta message, or the end of a snapshot with the number of delta messages in it, and queue an acknowledgement once the snapshot is complete.
+    void UpdateSnapshotReceipt(unsigned short sequence, bool end, unsigned numMessages);
+    /// Extend a received 16-bit snapshot sequence number to 32 bits relative to the latest received one, so that per-object sequences can be compared however long ago they were stored. Used on the client.
+    unsigned ExtendSnapshotSequence(unsigned short sequence);
+    /// Send the dirty attributes and all unacknowledged snapshot deltas of a node or component in the current snapshot. Return true if sent.
+    bool SendSnapshotDelta(int msgID, Serializable* serializable, unsigned id, PODVector<SnapshotDelta>& snapshotDeltas,
+        DirtyBits& dirtyAttributes);
+    /// Query the relevance filter, remove nodes that are no longer relevant from the client and queue nodes that became relevant for creation.
+    void UpdateRelevantNodes();
+    /// Remove a node from the client and stop tracking it, while it still exists on the server.
+    void RemoveReplicatedNode(unsigned nodeID, NodeReplicationState& nodeState);
     /// Process a node for sending a network update. Recurses to process depended on node(s) first.
     void ProcessNode(unsigned nodeID);
     /// Process a node that the client has not yet received.
@@ -286,8 +346,28 @@ private:
     HashMap<unsigned, PODVector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     HashSet<unsigned> nodesToProcess_;
+    /// Relevance filter for interest management.
+    SharedPtr<RelevanceFilter> relevanceFilter_;
+    /// Node ID's relevant to the client during a replication update. Used only with a relevance filter.
+    HashSet<unsigned> relevantNodes_;
+    /// Nodes whose dependencies are checked for relevance.
+    PODVector<Node*> relevanceStack_;
+    /// Node ID's with unacknowledged snapshot deltas of the node or its components.
+    HashSet<unsigned> snapshotNodes_;
+    /// Extended sequence number of the latest applied snapshot delta per node. Used on the client.
+    HashMap<unsigned, unsigned> nodeSnapshotSequences_;
+    /// Extended sequence number of the latest applied snapshot delta per component. Used on the client.
+    HashMap<unsigned, unsigned> componentSnapshotSequences_;
+    /// Reception states of the most recent snapshots. Used on the client.
+    SnapshotReceipt snapshotReceipts_[NUM_SNAPSHOT_RECEIPTS];
     /// Reusable message buffer.
     VectorBuffer msg_;
+    /// Outgoing messages queued during a threaded server update.
+    PODVector<QueuedMessage> queuedMessages_;
+    /// Data of the queued outgoing messages.
+    PODVector<unsigned char> queuedMessageData_;
+    /// Mutex for scene objects shared between connections during a threaded server update.
+    Mutex* sharedMutex_;
     /// Queued remote events.
     Vector<RemoteEvent> remoteEvents_;
     /// Scene file to load once all packages (if any) have been downloaded.
@@ -312,6 +392,18 @@ private:
     bool sceneLoaded_;
     /// Show statistics flag.
     bool logStatistics_;
+    /// Queue outgoing messages flag.
+    bool queueMessages_;
+    /// Number of snapshot delta messages sent in the current snapshot.
+    unsigned numSnapshotMessages_;
+    /// Sequence number of the snapshot being sent on the server, or of the latest completely received snapshot on the client.
+    unsigned short snapshotSequence_;
+    /// Extended sequence number of the latest received snapshot message, or zero if none received for the current scene. Used on the client.
+    unsigned latestSnapshotSequence_;
+    /// Snapshot delta mode flag.
+    bool snapshotDeltas_;
+    /// Snapshot acknowledgement pending flag. Used on the client.
+    bool snapshotAckPending_;
 };
 
 }
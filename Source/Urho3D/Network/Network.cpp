@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/ParallelFor.h"
 #include "../Core/Profiler.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
@@ -47,6 +48,22 @@ namespace Urho3D
 
 static const int DEFAULT_UPDATE_FPS = 30;
 
+/// Parallel loop body for building client connection server updates.
+struct ServerUpdateLoop
+{
+    /// Build the scene update and remote event messages of a range of connections.
+    void operator ()(Connection** start, Connection** end, unsigned threadIndex)
+    {
+        while (start != end)
+        {
+            Connection* connection = *start;
+            connection->SendServerUpdate();
+            connection->SendRemoteEvents();
+            ++start;
+        }
+    }
+};
+
 Network::Network(Context* context) :
     Object(context),
     updateFps_(DEFAULT_UPDATE_FPS),
@@ -148,8 +165,13 @@ u32 Network::ComputeContentID(kNet::message_id_t msgId, const char* data, size_t
         // Return fixed content ID for controls
         return CONTROLS_CONTENT_ID;
 
+    case MSG_SNAPSHOTACK:
+        return SNAPSHOTACK_CONTENT_ID;
+
     case MSG_NODELATESTDATA:
     case MSG_COMPONENTLATESTDATA:
+    case MSG_NODESNAPSHOTDELTA:
+    case MSG_COMPONENTSNAPSHOTDELTA:
         {
             // Return the node or component ID, which is first in the message
             MemoryBuffer msg(data, (unsigned)numBytes);
@@ -515,12 +537,38 @@ void Network::PostUpdate(float timeStep)
                 URHO3D_PROFILE(SendServerUpdate);
 
                 // Then send server updates for each client connection
-                for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
-                     i != clientConnections_.End(); ++i)
+                WorkQueue* queue = GetSubsystem<WorkQueue>();
+                if (queue && queue->GetNumThreads() && clientConnections_.Size() > 1)
+                {
+                    // Build the updates in worker threads with the messages queued per connection, then hand them over
+                    // to kNet in the main thread. Package uploads are throttled by kNet's outbound queue, so they are
+                    // sent afterward
+                    updateConnections_.Clear();
+                    for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                         i != clientConnections_.End(); ++i)
+                    {
+                        i->second_->SetQueueMessages(true, &updateMutex_);
+                        updateConnections_.Push(i->second_);
+                    }
+
+                    ServerUpdateLoop loop;
+                    ParallelFor(queue, updateConnections_.Buffer(), updateConnections_.Buffer() + updateConnections_.Size(), loop);
+
+                    for (PODVector<Connection*>::Iterator i = updateConnections_.Begin(); i != updateConnections_.End(); ++i)
+                    {
+                        (*i)->SetQueueMessages(false);
+                        (*i)->SendPackages();
+                    }
+                }
+                else
                 {
-                    i->second_->SendServerUpdate();
-                    i->second_->SendRemoteEvents();
-                    i->second_->SendPackages();
+                    for (HashMap<kNet::MessageConnection*, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                         i != clientConnections_.End(); ++i)
+                    {
+                        i->second_->SendServerUpdate();
+                        i->second_->SendRemoteEvents();
+                        i->second_->SendPackages();
+                    }
                 }
             }
         }
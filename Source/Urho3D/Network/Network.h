@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/HashSet.h"
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../IO/VectorBuffer.h"
 #include "../Network/Connection.h"
@@ -158,6 +159,10 @@ private:
     HashSet<StringHash> blacklistedRemoteEvents_;
     /// Networked scenes.
     HashSet<Scene*> networkScenes_;
+    /// Client connections to update in worker threads.
+    PODVector<Connection*> updateConnections_;
+    /// Mutex for scene objects shared between client connections during a threaded server update.
+    Mutex updateMutex_;
     /// Update FPS.
     int updateFps_;
     /// Simulated latency (send delay) in milliseconds.
@@ -63,9 +63,19 @@ static const int MSG_REMOTEEVENT = 0x14;
 static const int MSG_REMOTENODEEVENT = 0x15;
 /// Server->client: info about package.
 static const int MSG_PACKAGEINFO = 0x16;
+/// Server->client: unreliable node delta update against the last snapshot acknowledged by the client.
+static const int MSG_NODESNAPSHOTDELTA = 0x17;
+/// Server->client: unreliable component delta update against the last snapshot acknowledged by the client.
+static const int MSG_COMPONENTSNAPSHOTDELTA = 0x18;
+/// Server->client: end of a snapshot, with the number of snapshot delta messages in it.
+static const int MSG_SNAPSHOTEND = 0x19;
+/// Client->server: acknowledge a completely received snapshot.
+static const int MSG_SNAPSHOTACK = 0x1a;
 
 /// Fixed content ID for client controls update.
 static const unsigned CONTROLS_CONTENT_ID = 1;
+/// Fixed content ID for snapshot acknowledgement.
+static const unsigned SNAPSHOTACK_CONTENT_ID = 2;
 /// Package file fragment size.
 static const unsigned PACKAGE_FRAGMENT_SIZE = 1024;
 
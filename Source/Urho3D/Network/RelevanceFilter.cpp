@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/Drawable.h"
+#include "../Graphics/Octree.h"
+#include "../Graphics/OctreeQuery.h"
+#include "../Network/Connection.h"
+#include "../Network/RelevanceFilter.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const float DEFAULT_RELEVANCE_RADIUS = 100.0f;
+
+OctreeRelevanceFilter::OctreeRelevanceFilter(Context* context) :
+    RelevanceFilter(context),
+    radius_(DEFAULT_RELEVANCE_RADIUS),
+    viewMask_(DEFAULT_VIEWMASK)
+{
+}
+
+void OctreeRelevanceFilter::GetRelevantNodes(Connection* connection, Scene* scene, HashSet<unsigned>& dest)
+{
+    Octree* octree = scene->GetComponent<Octree>();
+    if (!octree)
+        return;
+
+    SphereOctreeQuery query(drawables_, Sphere(connection->GetPosition(), radius_), DRAWABLE_ANY, viewMask_);
+    octree->GetDrawables(query);
+
+    for (PODVector<Drawable*>::ConstIterator i = drawables_.Begin(); i != drawables_.End(); ++i)
+    {
+        // Find the topmost replicated ancestor, which is treated as one object together with its children
+        Node* object = 0;
+        for (Node* current = (*i)->GetNode(); current && current != scene; current = current->GetParent())
+        {
+            if (current->GetID() < FIRST_LOCAL_ID)
+                object = current;
+        }
+
+        if (!object || dest.Contains(object->GetID()))
+            continue;
+
+        dest.Insert(object->GetID());
+        object->GetChildren(children_, true);
+        for (PODVector<Node*>::ConstIterator j = children_.Begin(); j != children_.End(); ++j)
+        {
+            if ((*j)->GetID() < FIRST_LOCAL_ID)
+                dest.Insert((*j)->GetID());
+        }
+    }
+
+    drawables_.Clear();
+}
+
+void OctreeRelevanceFilter::SetRadius(float radius)
+{
+    radius_ = Max(radius, 0.0f);
+}
+
+}
@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Container/HashSet.h"
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+class Connection;
+class Drawable;
+class Node;
+class Scene;
+
+/// Interest management filter that decides which nodes are replicated to a client connection.
+class URHO3D_API RelevanceFilter : public Object
+{
+    URHO3D_OBJECT(RelevanceFilter, Object);
+
+public:
+    /// Construct.
+    RelevanceFilter(Context* context) :
+        Object(context)
+    {
+    }
+
+    /// Add the IDs of replicated nodes that are relevant to the connection. Dependencies of the nodes, such as their parents, are added automatically. Called once per network update for each connection using the filter, possibly from a worker thread, but never concurrently.
+    virtual void GetRelevantNodes(Connection* connection, Scene* scene, HashSet<unsigned>& dest) = 0;
+};
+
+/// Relevance filter that uses the scene's octree to find the drawables within a radius of the connection's observer position. A drawable's topmost replicated ancestor node is considered an object, and the object is relevant together with all its replicated child nodes. Objects without drawables are not relevant.
+class URHO3D_API OctreeRelevanceFilter : public RelevanceFilter
+{
+    URHO3D_OBJECT(OctreeRelevanceFilter, RelevanceFilter);
+
+public:
+    /// Construct.
+    OctreeRelevanceFilter(Context* context);
+
+    /// Add the IDs of the relevant nodes.
+    virtual void GetRelevantNodes(Connection* connection, Scene* scene, HashSet<unsigned>& dest);
+
+    /// Set the interest radius. Default 100.
+    void SetRadius(float radius);
+    /// Set view mask for the octree query. Default all bits set.
+    void SetViewMask(unsigned mask) { viewMask_ = mask; }
+
+    /// Return the interest radius.
+    float GetRadius() const { return radius_; }
+
+    /// Return view mask.
+    unsigned GetViewMask() const { return viewMask_; }
+
+private:
+    /// Drawables found by the octree query.
+    PODVector<Drawable*> drawables_;
+    /// Child nodes of an object.
+    PODVector<Node*> children_;
+    /// Interest radius.
+    float radius_;
+    /// View mask.
+    unsigned viewMask_;
+};
+
+}
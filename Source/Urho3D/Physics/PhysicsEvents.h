@@ -41,6 +41,38 @@ URHO3D_EVENT(E_PHYSICSPOSTSTEP, PhysicsPostStep)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed payload of the physics pre-step and post-step events.
+struct PhysicsStepEventData
+{
+    URHO3D_EVENT_PAYLOAD(PhysicsStepEventData)
+
+    /// Construct.
+    PhysicsStepEventData(Object* world = 0, float timeStep = 0.0f) :
+        world_(world),
+        timeStep_(timeStep)
+    {
+    }
+
+    /// Copy parameters to a VariantMap.
+    void ToVariantMap(VariantMap& eventData) const
+    {
+        eventData[PhysicsPreStep::P_WORLD] = world_;
+        eventData[PhysicsPreStep::P_TIMESTEP] = timeStep_;
+    }
+
+    /// Copy parameters from a VariantMap.
+    void FromVariantMap(VariantMap& eventData)
+    {
+        world_ = static_cast<Object*>(eventData[PhysicsPreStep::P_WORLD].GetPtr());
+        timeStep_ = eventData[PhysicsPreStep::P_TIMESTEP].GetFloat();
+    }
+
+    /// Physics world (PhysicsWorld or PhysicsWorld2D.)
+    Object* world_;
+    /// Timestep.
+    float timeStep_;
+};
+
 /// Physics collision started. Global event sent by the PhysicsWorld.
 URHO3D_EVENT(E_PHYSICSCOLLISIONSTART, PhysicsCollisionStart)
 {
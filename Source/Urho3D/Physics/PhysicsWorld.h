@@ -55,6 +55,7 @@ class Serializer;
 class XMLElement;
 
 struct CollisionGeometryData;
+struct SceneUpdateEventData;
 
 /// Physics raycast hit.
 struct URHO3D_API PhysicsRaycastResult
@@ -290,7 +291,7 @@ protected:
 
 private:
     /// Handle the scene subsystem update event, step simulation here.
-    void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneSubsystemUpdate(StringHash eventType, SceneUpdateEventData& eventData);
     /// Trigger update before each physics simulation step.
     void PreStep(float timeStep);
     /// Trigger update after each physics simulation step.
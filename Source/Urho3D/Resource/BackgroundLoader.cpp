@@ -25,7 +25,9 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../IO/Log.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/ResourceCache.h"
@@ -36,76 +38,118 @@
 namespace Urho3D
 {
 
+/// Resource loader thread.
+class BackgroundLoaderThread : public Thread, public RefCounted
+{
+public:
+    /// Construct.
+    BackgroundLoaderThread(BackgroundLoader* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Load resources until stopped.
+    virtual void ThreadFunction()
+    {
+        // Init FPU state first
+        InitFPU();
+        owner_->ProcessItems();
+    }
+
+private:
+    /// Background loader.
+    BackgroundLoader* owner_;
+};
+
 BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
-    owner_(owner)
+    owner_(owner),
+    numThreads_(1),
+    shutDown_(false)
 {
 }
 
 BackgroundLoader::~BackgroundLoader()
 {
+    StopThreads();
+
     MutexLock lock(backgroundLoadMutex_);
 
+    pendingItems_.Clear();
     backgroundLoadQueue_.Clear();
 }
 
-void BackgroundLoader::ThreadFunction()
+void BackgroundLoader::SetNumThreads(unsigned num)
 {
-    while (shouldRun_)
+    num = Max(num, 1U);
+    if (num == numThreads_)
+        return;
+
+    numThreads_ = num;
+    if (threads_.Size())
     {
-        backgroundLoadMutex_.Acquire();
+        StopThreads();
 
-        // Search for a queued resource that has not been loaded yet
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-        while (i != backgroundLoadQueue_.End())
-        {
-            if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
-        }
+        MutexLock lock(backgroundLoadMutex_);
+        if (pendingItems_.Size())
+            StartThreads();
+    }
+}
 
-        if (i == backgroundLoadQueue_.End())
+void BackgroundLoader::ProcessItems()
+{
+    while (!shutDown_)
+    {
+        backgroundLoadMutex_.Acquire();
+
+        if (pendingItems_.Empty())
         {
             // No resources to load found
             backgroundLoadMutex_.Release();
             Time::Sleep(5);
+            continue;
         }
-        else
+
+        // Claim the oldest queued resource. Setting the loading state while still holding the mutex ensures that no
+        // other loader thread picks it up
+        Pair<StringHash, StringHash> key = pendingItems_.Front();
+        pendingItems_.PopFront();
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
+        if (i == backgroundLoadQueue_.End())
         {
-            BackgroundLoadItem& item = i->second_;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
             backgroundLoadMutex_.Release();
+            continue;
+        }
 
-            bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
-            {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
-            }
+        BackgroundLoadItem& item = i->second_;
+        Resource* resource = item.resource_;
+        resource->SetAsyncLoadState(ASYNC_LOADING);
+        // We can be sure that the item is not removed from the queue as long as it is in the
+        // "queued" or "loading" state
+        backgroundLoadMutex_.Release();
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.Size())
-            {
-                for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin();
-                     i != item.dependents_.End(); ++i)
-                {
-                    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
-                    if (j != backgroundLoadQueue_.End())
-                        j->second_.dependencies_.Erase(key);
-                }
+        bool success = false;
+        SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
+        if (file)
+            success = resource->BeginLoad(*file);
 
-                item.dependents_.Clear();
+        // Process dependencies now
+        // Need to lock the queue again when manipulating other entries
+        backgroundLoadMutex_.Acquire();
+        if (item.dependents_.Size())
+        {
+            for (HashSet<Pair<StringHash, StringHash> >::Iterator j = item.dependents_.Begin();
+                 j != item.dependents_.End(); ++j)
+            {
+                HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator k = backgroundLoadQueue_.Find(*j);
+                if (k != backgroundLoadQueue_.End())
+                    k->second_.dependencies_.Erase(key);
             }
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
+            item.dependents_.Clear();
         }
+
+        resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+        backgroundLoadMutex_.Release();
     }
 }
 
@@ -146,6 +190,7 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
 
     item.resource_->SetName(name);
     item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
+    pendingItems_.Push(key);
 
     // If this is a resource calling for the background load of more resources, mark the dependency as necessary
     if (caller)
@@ -163,9 +208,10 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
                        " requested for a background loaded resource but was not in the background load queue");
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    // Start the background loader threads now. When queued from a loader thread, the threads are already running
+    // (or being stopped by the main thread, in which case it restarts them)
+    if (Thread::IsMainThread())
+        StartThreads();
 
     return true;
 }
@@ -179,6 +225,8 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
     if (i != backgroundLoadQueue_.End())
     {
+        // Make sure the resource and its dependencies will eventually be loaded
+        StartThreads();
         backgroundLoadMutex_.Release();
 
         {
@@ -217,37 +265,69 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
-    {
-        HiresTimer timer;
+    HiresTimer timer;
 
-        backgroundLoadMutex_.Acquire();
+    backgroundLoadMutex_.Acquire();
 
-        for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-             i != backgroundLoadQueue_.End();)
-        {
-            Resource* resource = i->second_.resource_;
-            unsigned numDeps = i->second_.dependencies_.Size();
-            AsyncLoadState state = resource->GetAsyncLoadState();
-            if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
-                ++i;
-            else
-            {
-                // Finishing a resource may need it to wait for other resources to load, in which case we can not
-                // hold on to the mutex
-                backgroundLoadMutex_.Release();
-                FinishBackgroundLoading(i->second_);
-                backgroundLoadMutex_.Acquire();
-                i = backgroundLoadQueue_.Erase(i);
-            }
+    // Resources may have been queued from outside the main thread while the loader threads were not running
+    if (pendingItems_.Size())
+        StartThreads();
 
-            // Break when the time limit passed so that we keep sufficient FPS
-            if (timer.GetUSec(false) >= maxMs * 1000)
-                break;
+    for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
+         i != backgroundLoadQueue_.End();)
+    {
+        Resource* resource = i->second_.resource_;
+        unsigned numDeps = i->second_.dependencies_.Size();
+        AsyncLoadState state = resource->GetAsyncLoadState();
+        if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
+            ++i;
+        else
+        {
+            // Finishing a resource may need it to wait for other resources to load, in which case we can not
+            // hold on to the mutex
+            backgroundLoadMutex_.Release();
+            FinishBackgroundLoading(i->second_);
+            backgroundLoadMutex_.Acquire();
+            i = backgroundLoadQueue_.Erase(i);
         }
 
-        backgroundLoadMutex_.Release();
+        // Break when the time limit passed so that we keep sufficient FPS
+        if (timer.GetUSec(false) >= maxMs * 1000)
+            break;
+    }
+
+    backgroundLoadMutex_.Release();
+}
+
+void BackgroundLoader::StartThreads()
+{
+    if (threads_.Size())
+        return;
+
+    for (unsigned i = 0; i < numThreads_; ++i)
+    {
+        SharedPtr<BackgroundLoaderThread> thread(new BackgroundLoaderThread(this));
+        thread->Run();
+        threads_.Push(thread);
+    }
+}
+
+void BackgroundLoader::StopThreads()
+{
+    Vector<SharedPtr<BackgroundLoaderThread> > threads;
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        threads.Swap(threads_);
     }
+
+    if (threads.Empty())
+        return;
+
+    // Any resource that is being loaded is finished first; the rest stay in the pending list
+    shutDown_ = true;
+    for (unsigned i = 0; i < threads.Size(); ++i)
+        threads[i]->Stop();
+    shutDown_ = false;
 }
 
 unsigned BackgroundLoader::GetNumQueuedResources() const
@@ -24,15 +24,16 @@
 
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
+#include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../Container/Ptr.h"
 #include "../Container/RefCounted.h"
-#include "../Core/Thread.h"
 #include "../Math/StringHash.h"
 
 namespace Urho3D
 {
 
+class BackgroundLoaderThread;
 class Resource;
 class ResourceCache;
 
@@ -49,19 +50,20 @@ struct BackgroundLoadItem
     bool sendEventOnFailure_;
 };
 
-/// Background loader of resources. Owned by the ResourceCache.
-class BackgroundLoader : public RefCounted, public Thread
+/// Background loader of resources using a pool of loader threads. Owned by the ResourceCache.
+class BackgroundLoader : public RefCounted
 {
+    friend class BackgroundLoaderThread;
+
 public:
     /// Construct.
     BackgroundLoader(ResourceCache* owner);
 
-    /// Destruct. Forcibly clear the load queue.
+    /// Destruct. Stop the loader threads and forcibly clear the load queue.
     ~BackgroundLoader();
 
-    /// Resource background loading loop.
-    virtual void ThreadFunction();
-
+    /// Set number of loader threads. If the threads are running, they are stopped after finishing their current resource and restarted with the new count. Should only be called from the main thread.
+    void SetNumThreads(unsigned num);
     /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
     bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller);
     /// Wait and finish possible loading of a resource when being requested from the cache.
@@ -69,10 +71,18 @@ public:
     /// Process resources that are ready to finish.
     void FinishResources(int maxMs);
 
+    /// Return number of loader threads.
+    unsigned GetNumThreads() const { return numThreads_; }
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
 
 private:
+    /// Resource background loading loop, run by each loader thread.
+    void ProcessItems();
+    /// Start the loader threads if not running yet. Called with the queue mutex held, only from the main thread.
+    void StartThreads();
+    /// Stop the loader threads and wait for them to finish their current resource. Called from the main thread without the queue mutex held.
+    void StopThreads();
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
@@ -82,6 +92,14 @@ private:
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Resources waiting to be picked up by a loader thread, in queuing order.
+    List<Pair<StringHash, StringHash> > pendingItems_;
+    /// Loader threads.
+    Vector<SharedPtr<BackgroundLoaderThread> > threads_;
+    /// Number of loader threads to create.
+    unsigned numThreads_;
+    /// Shutting down flag for the loader threads.
+    volatile bool shutDown_;
 };
 
 }
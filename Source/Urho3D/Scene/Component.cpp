@@ -172,6 +172,8 @@ void Component::PrepareNetworkUpdate()
         return;
 
     unsigned numAttributes = attributes->Size();
+    DirtyBits changedBits;
+    bool latestDataChanged = false;
 
     // Check for attribute changes
     for (unsigned i = 0; i < numAttributes; ++i)
@@ -186,6 +188,10 @@ void Component::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            if (attr.mode_ & AM_LATESTDATA)
+                latestDataChanged = true;
+            else
+                changedBits.Set(i);
 
             // Mark the attribute dirty in all replication states that are tracking this component
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
@@ -205,6 +211,9 @@ void Component::PrepareNetworkUpdate()
         }
     }
 
+    // Encode the changes once for all connections
+    CacheNetworkUpdate(changedBits, latestDataChanged);
+
     networkUpdate_ = false;
 }
 
@@ -37,12 +37,16 @@ LogicComponent::LogicComponent(Context* context) :
     Component(context),
     updateEventMask_(USE_UPDATE | USE_POSTUPDATE | USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE),
     currentEventMask_(0),
-    delayedStartCalled_(false)
+    threadedUpdateMask_(0),
+    delayedStartCalled_(false),
+    threadSafeUpdate_(false),
+    syncUpdateRequested_(false)
 {
 }
 
 LogicComponent::~LogicComponent()
 {
+    SetThreadedUpdateMask(0, 0);
 }
 
 void LogicComponent::OnSetEnabled()
@@ -75,6 +79,26 @@ void LogicComponent::SetUpdateEventMask(unsigned char mask)
     }
 }
 
+void LogicComponent::SetThreadSafeUpdate(bool enable)
+{
+    if (threadSafeUpdate_ != enable)
+    {
+        threadSafeUpdate_ = enable;
+        UpdateEventSubscription();
+    }
+}
+
+void LogicComponent::RequestSyncUpdate()
+{
+    // Only the component's own update touches the flag, so it needs no locking
+    Scene* scene = GetScene();
+    if (scene && !syncUpdateRequested_)
+    {
+        syncUpdateRequested_ = true;
+        scene->RequestSyncUpdate(this);
+    }
+}
+
 void LogicComponent::OnNodeSet(Node* node)
 {
     if (node)
@@ -102,6 +126,7 @@ void LogicComponent::OnSceneSet(Scene* scene)
         UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
 #endif
         currentEventMask_ = 0;
+        SetThreadedUpdateMask(0, 0);
     }
 }
 
@@ -112,11 +137,23 @@ void LogicComponent::UpdateEventSubscription()
         return;
 
     bool enabled = IsEnabledEffective();
+    // Thread-safe components are updated by the scene instead of events, once their delayed start has been called
+    bool threaded = threadSafeUpdate_ && delayedStartCalled_;
 
     bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
+    bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
+    if (threaded)
+    {
+        SetThreadedUpdateMask(scene, (unsigned char)((needUpdate ? USE_UPDATE : 0) | (needPostUpdate ? USE_POSTUPDATE : 0)));
+        needUpdate = false;
+        needPostUpdate = false;
+    }
+    else
+        SetThreadedUpdateMask(scene, 0);
+
     if (needUpdate && !(currentEventMask_ & USE_UPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
+        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_TYPED_HANDLER(LogicComponent, SceneUpdateEventData, HandleSceneUpdate));
         currentEventMask_ |= USE_UPDATE;
     }
     else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
@@ -125,10 +162,9 @@ void LogicComponent::UpdateEventSubscription()
         currentEventMask_ &= ~USE_UPDATE;
     }
 
-    bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
     if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_TYPED_HANDLER(LogicComponent, SceneUpdateEventData, HandleScenePostUpdate));
         currentEventMask_ |= USE_POSTUPDATE;
     }
     else if (!needPostUpdate && (currentEventMask_ & USE_POSTUPDATE))
@@ -145,7 +181,7 @@ void LogicComponent::UpdateEventSubscription()
     bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
     if (needFixedUpdate && !(currentEventMask_ & USE_FIXEDUPDATE))
     {
-        SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPreStep));
+        SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_TYPED_HANDLER(LogicComponent, PhysicsStepEventData, HandlePhysicsPreStep));
         currentEventMask_ |= USE_FIXEDUPDATE;
     }
     else if (!needFixedUpdate && (currentEventMask_ & USE_FIXEDUPDATE))
@@ -157,7 +193,7 @@ void LogicComponent::UpdateEventSubscription()
     bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
     if (needFixedPostUpdate && !(currentEventMask_ & USE_FIXEDPOSTUPDATE))
     {
-        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPostStep));
+        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_TYPED_HANDLER(LogicComponent, PhysicsStepEventData, HandlePhysicsPostStep));
         currentEventMask_ |= USE_FIXEDPOSTUPDATE;
     }
     else if (!needFixedPostUpdate && (currentEventMask_ & USE_FIXEDPOSTUPDATE))
@@ -168,10 +204,37 @@ void LogicComponent::UpdateEventSubscription()
 #endif
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::SetThreadedUpdateMask(Scene* scene, unsigned char mask)
 {
-    using namespace SceneUpdate;
+    if (threadedUpdateScene_.Get() != scene)
+    {
+        // Remove from the previous scene first
+        if (threadedUpdateScene_)
+        {
+            if (threadedUpdateMask_)
+                threadedUpdateScene_->RemoveThreadedLogicComponent(this, threadedUpdateMask_);
+            if (syncUpdateRequested_)
+                threadedUpdateScene_->CancelSyncUpdate(this);
+        }
+        syncUpdateRequested_ = false;
+        threadedUpdateScene_ = scene;
+        threadedUpdateMask_ = 0;
+    }
 
+    if (!scene || mask == threadedUpdateMask_)
+        return;
+
+    unsigned char removed = (unsigned char)(threadedUpdateMask_ & ~mask);
+    unsigned char added = (unsigned char)(mask & ~threadedUpdateMask_);
+    if (removed)
+        scene->RemoveThreadedLogicComponent(this, removed);
+    if (added)
+        scene->AddThreadedLogicComponent(this, added);
+    threadedUpdateMask_ = mask;
+}
+
+void LogicComponent::HandleSceneUpdate(StringHash eventType, SceneUpdateEventData& eventData)
+{
     // Execute user-defined delayed start function before first update
     if (!delayedStartCalled_)
     {
@@ -185,43 +248,47 @@ void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventDa
             currentEventMask_ &= ~USE_UPDATE;
             return;
         }
+
+        // If the update is thread-safe, the scene calls it from now on, already in this frame's thread-safe update phase
+        if (threadSafeUpdate_)
+        {
+            UpdateEventSubscription();
+            return;
+        }
     }
 
     // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    Update(eventData.timeStep_);
 }
 
-void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandleScenePostUpdate(StringHash eventType, SceneUpdateEventData& eventData)
 {
-    using namespace ScenePostUpdate;
-
     // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
+    PostUpdate(eventData.timeStep_);
 }
 
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
 
-void LogicComponent::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandlePhysicsPreStep(StringHash eventType, PhysicsStepEventData& eventData)
 {
-    using namespace PhysicsPreStep;
-
     // Execute user-defined delayed start function before first fixed update if not called yet
     if (!delayedStartCalled_)
     {
         DelayedStart();
         delayedStartCalled_ = true;
+
+        if (threadSafeUpdate_)
+            UpdateEventSubscription();
     }
 
     // Execute user-defined fixed update function
-    FixedUpdate(eventData[P_TIMESTEP].GetFloat());
+    FixedUpdate(eventData.timeStep_);
 }
 
-void LogicComponent::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandlePhysicsPostStep(StringHash eventType, PhysicsStepEventData& eventData)
 {
-    using namespace PhysicsPostStep;
-
     // Execute user-defined fixed post-update function
-    FixedPostUpdate(eventData[P_TIMESTEP].GetFloat());
+    FixedPostUpdate(eventData.timeStep_);
 }
 
 #endif
@@ -27,6 +27,9 @@
 namespace Urho3D
 {
 
+struct PhysicsStepEventData;
+struct SceneUpdateEventData;
+
 /// Bitmask for using the scene update event.
 static const unsigned char USE_UPDATE = 0x1;
 /// Bitmask for using the scene post-update event.
@@ -41,6 +44,8 @@ class URHO3D_API LogicComponent : public Component
 {
     URHO3D_OBJECT(LogicComponent, Component);
 
+    friend class Scene;
+
     /// Construct.
     LogicComponent(Context* context);
     /// Destruct.
@@ -66,13 +71,22 @@ class URHO3D_API LogicComponent : public Component
     virtual void FixedUpdate(float timeStep);
     /// Called on physics post-update, fixed timestep.
     virtual void FixedPostUpdate(float timeStep);
+    /// Called on the main thread after the scene's thread-safe update phase, if requested with RequestSyncUpdate(). Perform structural scene changes and send events here.
+    virtual void SyncUpdate() { }
 
     /// Set what update events should be subscribed to. Use this for optimization: by default all are in use. Note that this is not an attribute and is not saved or network-serialized, therefore it should always be called eg. in the subclass constructor.
     void SetUpdateEventMask(unsigned char mask);
+    /// Set whether Update() and PostUpdate() are thread-safe, so that the scene may call them in worker threads in parallel with other such components. They may then only modify the component's own state and node transform; scene structure changes and events must be deferred to SyncUpdate(). DelayedStart() is still called on the main thread. Like the update event mask, this is not an attribute. Default false.
+    void SetThreadSafeUpdate(bool enable);
+    /// Request SyncUpdate() to be called at the next sync point of the scene update. Is thread-safe.
+    void RequestSyncUpdate();
 
     /// Return what update events are subscribed to.
     unsigned char GetUpdateEventMask() const { return updateEventMask_; }
 
+    /// Return whether Update() and PostUpdate() are thread-safe.
+    bool IsThreadSafeUpdate() const { return threadSafeUpdate_; }
+
     /// Return whether the DelayedStart() function has been called.
     bool IsDelayedStartCalled() const { return delayedStartCalled_; }
 
@@ -85,22 +99,32 @@ protected:
 private:
     /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
     void UpdateEventSubscription();
+    /// Add to or remove from the scene's thread-safe update phases.
+    void SetThreadedUpdateMask(Scene* scene, unsigned char mask);
     /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneUpdate(StringHash eventType, SceneUpdateEventData& eventData);
     /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleScenePostUpdate(StringHash eventType, SceneUpdateEventData& eventData);
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
     /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    void HandlePhysicsPreStep(StringHash eventType, PhysicsStepEventData& eventData);
     /// Handle physics post-step event.
-    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+    void HandlePhysicsPostStep(StringHash eventType, PhysicsStepEventData& eventData);
 #endif
     /// Requested event subscription mask.
     unsigned char updateEventMask_;
     /// Current event subscription mask.
     unsigned char currentEventMask_;
+    /// Current thread-safe update phase mask.
+    unsigned char threadedUpdateMask_;
+    /// Scene whose thread-safe update phases the component has been added to.
+    WeakPtr<Scene> threadedUpdateScene_;
     /// Flag for delayed start.
     bool delayedStartCalled_;
+    /// Thread-safe update flag.
+    bool threadSafeUpdate_;
+    /// Sync update requested flag.
+    bool syncUpdateRequested_;
 };
 
 }
@@ -26,6 +26,7 @@
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
 #include "../Container/Ptr.h"
+#include "../IO/VectorBuffer.h"
 #include "../Math/StringHash.h"
 
 #include <cstring>
@@ -112,6 +113,25 @@ struct URHO3D_API DirtyBits
             return false;
     }
 
+    /// Set the bits that are set in another set of bits.
+    void Merge(const DirtyBits& bits)
+    {
+        for (unsigned i = 0; i < MAX_NETWORK_ATTRIBUTES; ++i)
+        {
+            if (bits.IsSet(i))
+                Set(i);
+        }
+    }
+
+    /// Test for equality with another set of bits.
+    bool operator ==(const DirtyBits& rhs) const
+    {
+        return count_ == rhs.count_ && !memcmp(data_, rhs.data_, MAX_NETWORK_ATTRIBUTES / 8);
+    }
+
+    /// Test for inequality with another set of bits.
+    bool operator !=(const DirtyBits& rhs) const { return !(*this == rhs); }
+
     /// Return number of set bits.
     unsigned Count() const { return count_; }
 
@@ -126,7 +146,8 @@ struct URHO3D_API NetworkState
 {
     /// Construct with defaults.
     NetworkState() :
-        interceptMask_(0)
+        interceptMask_(0),
+        latestDataCached_(false)
     {
     }
 
@@ -142,6 +163,23 @@ struct URHO3D_API NetworkState
     VariantMap previousVars_;
     /// Bitmask for intercepting network messages. Used on the client only.
     unsigned long long interceptMask_;
+    /// Dirty attribute bits of the cached delta update. Empty if no delta update is cached.
+    DirtyBits cachedDeltaBits_;
+    /// Delta update encoded once for all connections with matching dirty bits, excluding the timestamp.
+    VectorBuffer cachedDeltaUpdate_;
+    /// Latest data update encoded once for all connections, excluding the timestamp.
+    VectorBuffer cachedLatestData_;
+    /// Whether the latest data update is cached.
+    bool latestDataCached_;
+};
+
+/// Attribute changes sent in a snapshot delta that the client has not yet acknowledged.
+struct URHO3D_API SnapshotDelta
+{
+    /// Snapshot sequence number.
+    unsigned short sequence_;
+    /// Changed attribute bits.
+    DirtyBits attributes_;
 };
 
 /// Base class for per-user network replication states.
@@ -160,6 +198,8 @@ struct URHO3D_API ComponentReplicationState : public ReplicationState
     WeakPtr<Component> component_;
     /// Dirty attribute bits.
     DirtyBits dirtyAttributes_;
+    /// Unacknowledged snapshot deltas, oldest first. Used only in snapshot delta mode.
+    PODVector<SnapshotDelta> snapshotDeltas_;
 };
 
 /// Per-user node network replication state.
@@ -181,6 +221,8 @@ struct URHO3D_API NodeReplicationState : public ReplicationState
     DirtyBits dirtyAttributes_;
     /// Dirty user vars.
     HashSet<StringHash> dirtyVars_;
+    /// Unacknowledged snapshot deltas, oldest first. Used only in snapshot delta mode.
+    PODVector<SnapshotDelta> snapshotDeltas_;
     /// Components by ID.
     HashMap<unsigned, ComponentReplicationState> componentStates_;
     /// Interest management priority accumulator.
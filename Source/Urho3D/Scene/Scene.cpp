@@ -24,16 +24,19 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/ParallelFor.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
 #include "../Scene/Component.h"
+#include "../Scene/LogicComponent.h"
 #include "../Scene/ObjectAnimation.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
@@ -55,6 +58,222 @@ const char* SUBSYSTEM_CATEGORY = "Subsystem";
 static const float DEFAULT_SMOOTHING_CONSTANT = 50.0f;
 static const float DEFAULT_SNAP_THRESHOLD = 5.0f;
 
+/// Parallel loop body for calling the update functions of thread-safe logic components.
+struct LogicComponentUpdateBody
+{
+    /// Construct.
+    LogicComponentUpdateBody(float timeStep, bool postUpdate) :
+        timeStep_(timeStep),
+        postUpdate_(postUpdate)
+    {
+    }
+
+    /// Update a chunk of components.
+    void operator ()(LogicComponent** start, LogicComponent** end, unsigned threadIndex)
+    {
+        for (LogicComponent** i = start; i < end; ++i)
+        {
+            if (postUpdate_)
+                (*i)->PostUpdate(timeStep_);
+            else
+                (*i)->Update(timeStep_);
+        }
+    }
+
+    /// Timestep.
+    float timeStep_;
+    /// Whether to call PostUpdate() instead of Update().
+    bool postUpdate_;
+};
+
+/// Version of the indexed binary scene format.
+static const unsigned INDEXED_SCENE_VERSION = 1;
+
+/// Attribute column of an indexed binary scene file.
+struct IndexedSceneColumn
+{
+    /// Attribute name hash.
+    StringHash name_;
+    /// Attribute type.
+    VariantType type_;
+    /// Offset of the column data.
+    unsigned offset_;
+    /// Size of the column data.
+    unsigned size_;
+    /// Index of the matching attribute when loading, or M_MAX_UNSIGNED if the attribute no longer exists.
+    unsigned attributeIndex_;
+    /// Values read from the column, one per instance.
+    Vector<Variant> values_;
+    /// Offsets of each instance's value followed by the end of the column, when the object type is unknown.
+    PODVector<unsigned> instanceOffsets_;
+};
+
+/// Objects of the same type in an indexed binary scene file.
+struct IndexedSceneGroup
+{
+    /// Construct.
+    IndexedSceneGroup() :
+        numInstances_(0),
+        columnar_(true),
+        unknownType_(false),
+        offset_(0),
+        size_(0)
+    {
+    }
+
+    /// Object type.
+    StringHash type_;
+    /// Number of instances.
+    unsigned numInstances_;
+    /// Whether attributes are stored in columns. Objects with per-instance attribute lists are instead stored one after another in their old binary format.
+    bool columnar_;
+    /// Whether the object type is not registered when loading. The raw attribute data is then kept, as in the other formats.
+    bool unknownType_;
+    /// Attribute columns.
+    Vector<IndexedSceneColumn> columns_;
+    /// Offset of the object data when not columnar.
+    unsigned offset_;
+    /// Size of the object data when not columnar.
+    unsigned size_;
+    /// Instances when saving.
+    PODVector<const Serializable*> instances_;
+    /// Offsets of the instances' data when loading and not columnar.
+    PODVector<unsigned> instanceOffsets_;
+    /// Sizes of the instances' data when loading and not columnar.
+    PODVector<unsigned> instanceSizes_;
+};
+
+/// Node or component entry of an indexed binary scene file.
+struct IndexedSceneObject
+{
+    /// Node or component ID.
+    unsigned id_;
+    /// Index of the parent node for nodes, or of the owner node for components.
+    unsigned nodeIndex_;
+    /// Index of the type group.
+    unsigned groupIndex_;
+};
+
+/// Parallel loop body for reading the attribute columns of an indexed binary scene file.
+struct IndexedSceneReadBody
+{
+    /// Construct.
+    IndexedSceneReadBody(const unsigned char* data) :
+        data_(data)
+    {
+    }
+
+    /// Read a chunk of columns.
+    void operator ()(IndexedSceneColumn** start, IndexedSceneColumn** end, unsigned threadIndex)
+    {
+        for (IndexedSceneColumn** i = start; i < end; ++i)
+        {
+            IndexedSceneColumn& column = **i;
+            MemoryBuffer buffer(data_ + column.offset_, column.size_);
+            if (column.instanceOffsets_.Empty())
+            {
+                for (unsigned j = 0; j < column.values_.Size(); ++j)
+                    column.values_[j] = buffer.ReadVariant(column.type_);
+            }
+            else
+            {
+                // The object type is unknown, so only find where each value starts
+                unsigned numValues = column.instanceOffsets_.Size() - 1;
+                for (unsigned j = 0; j < numValues; ++j)
+                {
+                    column.instanceOffsets_[j] = column.offset_ + buffer.GetPosition();
+                    buffer.ReadVariant(column.type_);
+                }
+                column.instanceOffsets_[numValues] = column.offset_ + buffer.GetPosition();
+            }
+        }
+    }
+
+    /// File data.
+    const unsigned char* data_;
+};
+
+/// Collect the persistent nodes of a hierarchy in depth-first order.
+static void CollectIndexedSceneNodes(const Node* node, unsigned parentIndex, PODVector<const Node*>& nodes,
+    PODVector<unsigned>& parentIndices)
+{
+    unsigned index = nodes.Size();
+    nodes.Push(node);
+    parentIndices.Push(parentIndex);
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (unsigned i = 0; i < children.Size(); ++i)
+    {
+        if (!children[i]->IsTemporary())
+            CollectIndexedSceneNodes(children[i], index, nodes, parentIndices);
+    }
+}
+
+/// Return the type group index of an object in an indexed binary scene file, adding a new group if necessary.
+static unsigned GetIndexedSceneGroup(const Serializable* object, Vector<IndexedSceneGroup>& groups,
+    HashMap<StringHash, unsigned>& groupIndices)
+{
+    StringHash type = object->GetType();
+    HashMap<StringHash, unsigned>::ConstIterator i = groupIndices.Find(type);
+    unsigned index;
+    if (i != groupIndices.End())
+        index = i->second_;
+    else
+    {
+        index = groups.Size();
+        groupIndices[type] = index;
+        groups.Resize(index + 1);
+        groups[index].type_ = type;
+    }
+
+    IndexedSceneGroup& group = groups[index];
+    ++group.numInstances_;
+    group.instances_.Push(object);
+    // Objects that report their own attribute list can not share columns with the other instances
+    if (object->GetAttributes() != object->GetContext()->GetAttributes(type))
+        group.columnar_ = false;
+
+    return index;
+}
+
+/// Load an object from an indexed binary scene file.
+static bool LoadIndexedSceneObject(Serializable* object, const IndexedSceneGroup& group, unsigned instance,
+    const unsigned char* data, PODVector<const Variant*>& values, bool setInstanceDefault)
+{
+    if (group.unknownType_)
+    {
+        // Join the instance's values in column order, which is the order of the object's binary format
+        VectorBuffer buffer;
+        for (unsigned i = 0; i < group.columns_.Size(); ++i)
+        {
+            const PODVector<unsigned>& offsets = group.columns_[i].instanceOffsets_;
+            buffer.Write(data + offsets[instance], offsets[instance + 1] - offsets[instance]);
+        }
+        buffer.Seek(0);
+        return object->Load(buffer, setInstanceDefault);
+    }
+    else if (group.columnar_)
+    {
+        const Vector<AttributeInfo>* attributes = object->GetAttributes();
+        values.Resize(attributes ? attributes->Size() : 0);
+        for (unsigned i = 0; i < values.Size(); ++i)
+            values[i] = 0;
+        for (unsigned i = 0; i < group.columns_.Size(); ++i)
+        {
+            const IndexedSceneColumn& column = group.columns_[i];
+            if (column.attributeIndex_ < values.Size())
+                values[column.attributeIndex_] = &column.values_[instance];
+        }
+
+        return object->LoadAttributeValues(values, setInstanceDefault);
+    }
+    else
+    {
+        MemoryBuffer buffer(data + group.instanceOffsets_[instance], group.instanceSizes_[instance]);
+        return object->Load(buffer, setInstanceDefault);
+    }
+}
+
 Scene::Scene(Context* context) :
     Node(context),
     replicatedNodeID_(FIRST_REPLICATED_ID),
@@ -69,13 +288,14 @@ Scene::Scene(Context* context) :
     snapThreshold_(DEFAULT_SNAP_THRESHOLD),
     updateEnabled_(true),
     asyncLoading_(false),
-    threadedUpdate_(false)
+    threadedUpdate_(false),
+    batchedTransforms_(false)
 {
     // Assign an ID to self so that nodes can refer to this node as a parent
     SetID(GetFreeNodeID(REPLICATED));
     NodeAdded(this);
 
-    SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(Scene, HandleUpdate));
+    SubscribeToEvent(E_UPDATE, URHO3D_TYPED_HANDLER(Scene, UpdateEventData, HandleUpdate));
     SubscribeToEvent(E_RESOURCEBACKGROUNDLOADED, URHO3D_HANDLER(Scene, HandleResourceBackgroundLoaded));
 }
 
@@ -118,7 +338,8 @@ bool Scene::Load(Deserializer& source, bool setInstanceDefault)
     StopAsyncLoading();
 
     // Check ID
-    if (source.ReadFileID() != "USCN")
+    String fileID = source.ReadFileID();
+    if (fileID != "USCN" && fileID != "USCI")
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid scene file");
         return false;
@@ -129,7 +350,7 @@ bool Scene::Load(Deserializer& source, bool setInstanceDefault)
     Clear();
 
     // Load the whole scene, then perform post-load if successfully loaded
-    if (Node::Load(source, setInstanceDefault))
+    if (fileID == "USCI" ? LoadIndexed(source, setInstanceDefault) : Node::Load(source, setInstanceDefault))
     {
         FinishLoading(&source);
         return true;
@@ -162,6 +383,158 @@ bool Scene::Save(Serializer& dest) const
         return false;
 }
 
+bool Scene::SaveIndexed(Serializer& dest) const
+{
+    URHO3D_PROFILE(SaveSceneIndexed);
+
+    // Collect the persistent nodes in depth-first order followed by their components, and group them by type
+    PODVector<const Node*> nodes;
+    PODVector<unsigned> parentIndices;
+    CollectIndexedSceneNodes(this, M_MAX_UNSIGNED, nodes, parentIndices);
+
+    Vector<IndexedSceneGroup> groups;
+    HashMap<StringHash, unsigned> groupIndices;
+    PODVector<IndexedSceneObject> nodeEntries(nodes.Size());
+    PODVector<IndexedSceneObject> componentEntries;
+
+    for (unsigned i = 0; i < nodes.Size(); ++i)
+    {
+        const Node* node = nodes[i];
+        IndexedSceneObject& entry = nodeEntries[i];
+        entry.id_ = node->GetID();
+        entry.nodeIndex_ = parentIndices[i];
+        entry.groupIndex_ = GetIndexedSceneGroup(node, groups, groupIndices);
+
+        const Vector<SharedPtr<Component> >& components = node->GetComponents();
+        for (unsigned j = 0; j < components.Size(); ++j)
+        {
+            const Component* component = components[j];
+            if (component->IsTemporary())
+                continue;
+
+            IndexedSceneObject componentEntry;
+            componentEntry.id_ = component->GetID();
+            componentEntry.nodeIndex_ = i;
+            componentEntry.groupIndex_ = GetIndexedSceneGroup(component, groups, groupIndices);
+            componentEntries.Push(componentEntry);
+        }
+    }
+
+    // Write the attribute data of each group, either in columns or as whole objects
+    VectorBuffer data;
+    Variant value;
+    for (unsigned i = 0; i < groups.Size(); ++i)
+    {
+        IndexedSceneGroup& group = groups[i];
+
+        if (group.columnar_)
+        {
+            const Vector<AttributeInfo>* attributes = context_->GetAttributes(group.type_);
+            if (!attributes)
+                continue;
+
+            for (unsigned j = 0; j < attributes->Size(); ++j)
+            {
+                const AttributeInfo& attr = attributes->At(j);
+                if (!(attr.mode_ & AM_FILE) || (attr.mode_ & AM_FILEREADONLY) == AM_FILEREADONLY)
+                    continue;
+
+                IndexedSceneColumn column;
+                column.name_ = attr.name_;
+                column.type_ = attr.type_;
+                column.offset_ = data.GetPosition();
+                for (unsigned k = 0; k < group.instances_.Size(); ++k)
+                {
+                    group.instances_[k]->OnGetAttribute(attr, value);
+                    data.WriteVariantData(value);
+                }
+                column.size_ = data.GetPosition() - column.offset_;
+                group.columns_.Push(column);
+            }
+        }
+        else
+        {
+            group.offset_ = data.GetPosition();
+            for (unsigned j = 0; j < group.instances_.Size(); ++j)
+            {
+                // Leave out the type and ID, which are stored in the component entries
+                VectorBuffer objectData;
+                if (!group.instances_[j]->Save(objectData))
+                    return false;
+                unsigned headerSize = Min(objectData.GetSize(), (unsigned)(sizeof(StringHash) + sizeof(unsigned)));
+                data.WriteVLE(objectData.GetSize() - headerSize);
+                data.Write(objectData.GetData() + headerSize, objectData.GetSize() - headerSize);
+            }
+            group.size_ = data.GetPosition() - group.offset_;
+        }
+    }
+
+    // Write the index, then the data
+    if (!dest.WriteFileID("USCI"))
+    {
+        URHO3D_LOGERROR("Could not save scene, writing to stream failed");
+        return false;
+    }
+
+    Deserializer* ptr = dynamic_cast<Deserializer*>(&dest);
+    if (ptr)
+        URHO3D_LOGINFO("Saving indexed scene to " + ptr->GetName());
+
+    dest.WriteUInt(INDEXED_SCENE_VERSION);
+
+    dest.WriteVLE(groups.Size());
+    for (unsigned i = 0; i < groups.Size(); ++i)
+    {
+        const IndexedSceneGroup& group = groups[i];
+        dest.WriteStringHash(group.type_);
+        dest.WriteVLE(group.numInstances_);
+        dest.WriteBool(group.columnar_);
+        if (group.columnar_)
+        {
+            dest.WriteVLE(group.columns_.Size());
+            for (unsigned j = 0; j < group.columns_.Size(); ++j)
+            {
+                const IndexedSceneColumn& column = group.columns_[j];
+                dest.WriteStringHash(column.name_);
+                dest.WriteUByte((unsigned char)column.type_);
+                dest.WriteUInt(column.offset_);
+                dest.WriteUInt(column.size_);
+            }
+        }
+        else
+        {
+            dest.WriteUInt(group.offset_);
+            dest.WriteUInt(group.size_);
+        }
+    }
+
+    dest.WriteVLE(nodeEntries.Size());
+    for (unsigned i = 0; i < nodeEntries.Size(); ++i)
+    {
+        dest.WriteUInt(nodeEntries[i].id_);
+        dest.WriteUInt(nodeEntries[i].nodeIndex_);
+        dest.WriteVLE(nodeEntries[i].groupIndex_);
+    }
+
+    dest.WriteVLE(componentEntries.Size());
+    for (unsigned i = 0; i < componentEntries.Size(); ++i)
+    {
+        dest.WriteUInt(componentEntries[i].id_);
+        dest.WriteUInt(componentEntries[i].nodeIndex_);
+        dest.WriteVLE(componentEntries[i].groupIndex_);
+    }
+
+    dest.WriteUInt(data.GetSize());
+    if (dest.Write(data.GetData(), data.GetSize()) != data.GetSize())
+    {
+        URHO3D_LOGERROR("Could not save scene, writing to stream failed");
+        return false;
+    }
+
+    FinishSaving(&dest);
+    return true;
+}
+
 bool Scene::LoadXML(const XMLElement& source, bool setInstanceDefault)
 {
     URHO3D_PROFILE(LoadSceneXML);
@@ -317,7 +690,14 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
     StopAsyncLoading();
 
     // Check ID
-    bool isSceneFile = file->ReadFileID() == "USCN";
+    String fileID = file->ReadFileID();
+    if (fileID == "USCI")
+    {
+        URHO3D_LOGERROR(file->GetName() + " is an indexed scene file, which can not be loaded asynchronously");
+        return false;
+    }
+
+    bool isSceneFile = fileID == "USCN";
     if (!isSceneFile)
     {
         // In resource load mode can load also object prefabs, which have no identifier
@@ -669,6 +1049,13 @@ void Scene::SetAsyncLoadingMs(int ms)
     asyncLoadingMs_ = Max(ms, 1);
 }
 
+void Scene::SetBatchedTransforms(bool enable)
+{
+    batchedTransforms_ = enable;
+    if (!enable)
+        transformStore_.Clear();
+}
+
 void Scene::SetElapsedTime(float time)
 {
     elapsedTime_ = time;
@@ -771,20 +1158,24 @@ void Scene::Update(float timeStep)
 
     timeStep *= timeScale_;
 
-    using namespace SceneUpdate;
-
-    VariantMap& eventData = GetEventDataMap();
-    eventData[P_SCENE] = this;
-    eventData[P_TIMESTEP] = timeStep;
+    SceneUpdateEventData updateData(this, timeStep);
 
     // Update variable timestep logic
-    SendEvent(E_SCENEUPDATE, eventData);
+    SendTypedEvent(E_SCENEUPDATE, updateData);
+    UpdateThreadedLogicComponents(threadedUpdateComponents_, timeStep, false);
 
     // Update scene attribute animation.
-    SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
+    {
+        using namespace AttributeAnimationUpdate;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_SCENE] = this;
+        eventData[P_TIMESTEP] = timeStep;
+        SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
+    }
 
     // Update scene subsystems. If a physics world is present, it will be updated, triggering fixed timestep logic updates
-    SendEvent(E_SCENESUBSYSTEMUPDATE, eventData);
+    SendTypedEvent(E_SCENESUBSYSTEMUPDATE, updateData);
 
     // Update transform smoothing
     {
@@ -793,15 +1184,20 @@ void Scene::Update(float timeStep)
         float constant = 1.0f - Clamp(powf(2.0f, -timeStep * smoothingConstant_), 0.0f, 1.0f);
         float squaredSnapThreshold = snapThreshold_ * snapThreshold_;
 
-        using namespace UpdateSmoothing;
-
-        smoothingData_[P_CONSTANT] = constant;
-        smoothingData_[P_SQUAREDSNAPTHRESHOLD] = squaredSnapThreshold;
-        SendEvent(E_UPDATESMOOTHING, smoothingData_);
+        UpdateSmoothingEventData smoothingData(constant, squaredSnapThreshold);
+        SendTypedEvent(E_UPDATESMOOTHING, smoothingData);
     }
 
     // Post-update variable timestep logic
-    SendEvent(E_SCENEPOSTUPDATE, eventData);
+    SendTypedEvent(E_SCENEPOSTUPDATE, updateData);
+    UpdateThreadedLogicComponents(threadedPostUpdateComponents_, timeStep, true);
+
+    // Recompute dirty world transforms in hierarchy order, so that rendering does not need to
+    if (batchedTransforms_)
+    {
+        URHO3D_PROFILE(UpdateWorldTransforms);
+        transformStore_.Update(this, GetSubsystem<WorkQueue>());
+    }
 
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
@@ -839,6 +1235,39 @@ void Scene::DelayedMarkedDirty(Component* component)
     delayedDirtyComponents_.Push(component);
 }
 
+void Scene::AddThreadedLogicComponent(LogicComponent* component, unsigned char mask)
+{
+    if (mask & USE_UPDATE)
+        threadedUpdateComponents_.Push(component);
+    if (mask & USE_POSTUPDATE)
+        threadedPostUpdateComponents_.Push(component);
+}
+
+void Scene::RemoveThreadedLogicComponent(LogicComponent* component, unsigned char mask)
+{
+    // Update order does not matter, so the last component can be swapped in
+    if (mask & USE_UPDATE)
+        threadedUpdateComponents_.RemoveSwap(component);
+    if (mask & USE_POSTUPDATE)
+        threadedPostUpdateComponents_.RemoveSwap(component);
+}
+
+void Scene::RequestSyncUpdate(LogicComponent* component)
+{
+    MutexLock lock(sceneMutex_);
+    syncUpdateComponents_.Push(component);
+}
+
+void Scene::CancelSyncUpdate(LogicComponent* component)
+{
+    MutexLock lock(sceneMutex_);
+    for (PODVector<LogicComponent*>::Iterator i = syncUpdateComponents_.Begin(); i != syncUpdateComponents_.End(); ++i)
+    {
+        if (*i == component)
+            *i = 0;
+    }
+}
+
 unsigned Scene::GetFreeNodeID(CreateMode mode)
 {
     if (mode == REPLICATED)
@@ -991,6 +1420,7 @@ void Scene::NodeRemoved(Node* node)
         localNodes_.Erase(id);
 
     node->ResetScene();
+    transformStore_.MarkHierarchyDirty();
 
     // Remove node from tag cache
     if (!node->GetTags().Empty())
@@ -1162,13 +1592,52 @@ void Scene::MarkReplicationDirty(Node* node)
     }
 }
 
-void Scene::HandleUpdate(StringHash eventType, VariantMap& eventData)
+void Scene::UpdateThreadedLogicComponents(PODVector<LogicComponent*>& components, float timeStep, bool postUpdate)
+{
+    if (!components.Empty())
+    {
+        URHO3D_PROFILE(UpdateThreadedLogic);
+
+        WorkQueue* queue = GetSubsystem<WorkQueue>();
+        LogicComponentUpdateBody body(timeStep, postUpdate);
+
+        LogicComponent** start = components.Buffer();
+        LogicComponent** end = start + components.Size();
+        if (queue)
+        {
+            // Delay dirty notifications of drawables and other components until the workers have finished
+            BeginThreadedUpdate();
+            ParallelFor(queue, start, end, body);
+            EndThreadedUpdate();
+        }
+        else
+            body(start, end, 0);
+    }
+
+    // Sync point: call SyncUpdate() for the requests made so far. Requests made during these calls wait for the next sync point
+    unsigned numRequests = syncUpdateComponents_.Size();
+    if (!numRequests)
+        return;
+
+    for (unsigned i = 0; i < numRequests; ++i)
+    {
+        LogicComponent* component = syncUpdateComponents_[i];
+        if (component)
+        {
+            component->syncUpdateRequested_ = false;
+            component->SyncUpdate();
+        }
+    }
+
+    syncUpdateComponents_.Erase(0, numRequests);
+}
+
+void Scene::HandleUpdate(StringHash eventType, UpdateEventData& eventData)
 {
     if (!updateEnabled_)
         return;
 
-    using namespace Update;
-    Update(eventData[P_TIMESTEP].GetFloat());
+    Update(eventData.timeStep_);
 }
 
 void Scene::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
@@ -1270,6 +1739,210 @@ void Scene::FinishAsyncLoading()
     SendEvent(E_ASYNCLOADFINISHED, eventData);
 }
 
+bool Scene::LoadIndexed(Deserializer& source, bool setInstanceDefault)
+{
+    unsigned version = source.ReadUInt();
+    if (version != INDEXED_SCENE_VERSION)
+    {
+        URHO3D_LOGERROR(source.GetName() + " has unsupported indexed scene version " + String(version));
+        return false;
+    }
+
+    // Read the index
+    Vector<IndexedSceneGroup> groups;
+    groups.Resize(source.ReadVLE());
+    for (unsigned i = 0; i < groups.Size(); ++i)
+    {
+        IndexedSceneGroup& group = groups[i];
+        group.type_ = source.ReadStringHash();
+        group.numInstances_ = source.ReadVLE();
+        group.columnar_ = source.ReadBool();
+        if (group.columnar_)
+        {
+            group.columns_.Resize(source.ReadVLE());
+            for (unsigned j = 0; j < group.columns_.Size(); ++j)
+            {
+                IndexedSceneColumn& column = group.columns_[j];
+                column.name_ = source.ReadStringHash();
+                column.type_ = (VariantType)source.ReadUByte();
+                column.offset_ = source.ReadUInt();
+                column.size_ = source.ReadUInt();
+                column.attributeIndex_ = M_MAX_UNSIGNED;
+            }
+        }
+        else
+        {
+            group.offset_ = source.ReadUInt();
+            group.size_ = source.ReadUInt();
+        }
+    }
+
+    PODVector<IndexedSceneObject> nodeEntries(source.ReadVLE());
+    for (unsigned i = 0; i < nodeEntries.Size(); ++i)
+    {
+        nodeEntries[i].id_ = source.ReadUInt();
+        nodeEntries[i].nodeIndex_ = source.ReadUInt();
+        nodeEntries[i].groupIndex_ = source.ReadVLE();
+    }
+
+    PODVector<IndexedSceneObject> componentEntries(source.ReadVLE());
+    for (unsigned i = 0; i < componentEntries.Size(); ++i)
+    {
+        componentEntries[i].id_ = source.ReadUInt();
+        componentEntries[i].nodeIndex_ = source.ReadUInt();
+        componentEntries[i].groupIndex_ = source.ReadVLE();
+    }
+
+    unsigned dataSize = source.ReadUInt();
+    PODVector<unsigned char> data(Min(dataSize, source.GetSize() - source.GetPosition()));
+    if (data.Size() != dataSize || (dataSize && source.Read(&data[0], dataSize) != dataSize))
+    {
+        URHO3D_LOGERROR("Could not load " + source.GetName() + ", unexpected end of file");
+        return false;
+    }
+
+    // Validate the index. Nodes must come after their parent and components must be ordered by their node
+    PODVector<unsigned> instanceCounts(groups.Size());
+    for (unsigned i = 0; i < instanceCounts.Size(); ++i)
+        instanceCounts[i] = 0;
+    bool valid = !nodeEntries.Empty() && nodeEntries[0].groupIndex_ < groups.Size() &&
+        groups[nodeEntries[0].groupIndex_].type_ == GetType();
+    for (unsigned i = 0; valid && i < nodeEntries.Size(); ++i)
+    {
+        const IndexedSceneObject& entry = nodeEntries[i];
+        valid = (!i || entry.nodeIndex_ < i) && entry.groupIndex_ < groups.Size() && groups[entry.groupIndex_].columnar_;
+        if (valid)
+            ++instanceCounts[entry.groupIndex_];
+    }
+    for (unsigned i = 0; valid && i < componentEntries.Size(); ++i)
+    {
+        const IndexedSceneObject& entry = componentEntries[i];
+        valid = entry.nodeIndex_ < nodeEntries.Size() && (!i || entry.nodeIndex_ >= componentEntries[i - 1].nodeIndex_) &&
+            entry.groupIndex_ < groups.Size();
+        if (valid)
+            ++instanceCounts[entry.groupIndex_];
+    }
+    for (unsigned i = 0; valid && i < groups.Size(); ++i)
+    {
+        IndexedSceneGroup& group = groups[i];
+        valid = instanceCounts[i] == group.numInstances_;
+        if (group.columnar_)
+        {
+            for (unsigned j = 0; valid && j < group.columns_.Size(); ++j)
+                valid = group.columns_[j].offset_ <= data.Size() && group.columns_[j].size_ <= data.Size() - group.columns_[j].offset_;
+        }
+        else if (valid && group.offset_ <= data.Size() && group.size_ <= data.Size() - group.offset_)
+        {
+            // Find the whole objects' data
+            MemoryBuffer buffer(&data[group.offset_], group.size_);
+            for (unsigned j = 0; valid && j < group.numInstances_; ++j)
+            {
+                unsigned size = buffer.ReadVLE();
+                unsigned offset = buffer.GetPosition();
+                valid = size <= group.size_ - offset;
+                group.instanceOffsets_.Push(group.offset_ + offset);
+                group.instanceSizes_.Push(size);
+                buffer.Seek(offset + size);
+            }
+        }
+        else
+            valid = false;
+    }
+    if (!valid)
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid indexed scene file");
+        return false;
+    }
+
+    // Match the columns to the current attributes, then read all columns in parallel
+    PODVector<IndexedSceneColumn*> readColumns;
+    for (unsigned i = 0; i < groups.Size(); ++i)
+    {
+        IndexedSceneGroup& group = groups[i];
+        if (!group.columnar_)
+            continue;
+
+        // If the type is unknown, the columns are still read to find the raw data of each instance
+        const Vector<AttributeInfo>* attributes = context_->GetAttributes(group.type_);
+        if (!attributes)
+        {
+            group.unknownType_ = true;
+            for (unsigned j = 0; j < group.columns_.Size(); ++j)
+            {
+                group.columns_[j].instanceOffsets_.Resize(group.numInstances_ + 1);
+                readColumns.Push(&group.columns_[j]);
+            }
+            continue;
+        }
+
+        for (unsigned j = 0; j < group.columns_.Size(); ++j)
+        {
+            IndexedSceneColumn& column = group.columns_[j];
+            for (unsigned k = 0; k < attributes->Size(); ++k)
+            {
+                const AttributeInfo& attr = attributes->At(k);
+                if ((attr.mode_ & AM_FILE) && attr.type_ == column.type_ && StringHash(attr.name_) == column.name_)
+                {
+                    column.attributeIndex_ = k;
+                    column.values_.Resize(group.numInstances_);
+                    readColumns.Push(&column);
+                    break;
+                }
+            }
+        }
+    }
+
+    {
+        URHO3D_PROFILE(ReadAttributeColumns);
+
+        IndexedSceneReadBody body(data.Buffer());
+        WorkQueue* queue = GetSubsystem<WorkQueue>();
+        if (queue)
+            ParallelFor(queue, readColumns.Buffer(), readColumns.Buffer() + readColumns.Size(), body);
+        else
+            body(readColumns.Buffer(), readColumns.Buffer() + readColumns.Size(), 0);
+    }
+
+    // Create the nodes and components in the original order and set their attributes
+    SceneResolver resolver;
+    PODVector<Node*> nodes(nodeEntries.Size());
+    PODVector<const Variant*> values;
+    for (unsigned i = 0; i < instanceCounts.Size(); ++i)
+        instanceCounts[i] = 0;
+    unsigned componentIndex = 0;
+
+    for (unsigned i = 0; i < nodeEntries.Size(); ++i)
+    {
+        const IndexedSceneObject& entry = nodeEntries[i];
+        Node* node = i ? nodes[entry.nodeIndex_]->CreateChild(entry.id_, entry.id_ < FIRST_LOCAL_ID ? REPLICATED : LOCAL) : this;
+        nodes[i] = node;
+        resolver.AddNode(entry.id_, node);
+        if (!LoadIndexedSceneObject(node, groups[entry.groupIndex_], instanceCounts[entry.groupIndex_]++, data.Buffer(), values,
+            setInstanceDefault))
+            return false;
+
+        for (; componentIndex < componentEntries.Size() && componentEntries[componentIndex].nodeIndex_ == i; ++componentIndex)
+        {
+            const IndexedSceneObject& componentEntry = componentEntries[componentIndex];
+            const IndexedSceneGroup& group = groups[componentEntry.groupIndex_];
+            unsigned instance = instanceCounts[componentEntry.groupIndex_]++;
+            Component* newComponent = node->SafeCreateComponent(String::EMPTY, group.type_,
+                componentEntry.id_ < FIRST_LOCAL_ID ? REPLICATED : LOCAL, componentEntry.id_);
+            if (newComponent)
+            {
+                resolver.AddComponent(componentEntry.id_, newComponent);
+                // Do not abort if component fails to load, as its data can be skipped
+                LoadIndexedSceneObject(newComponent, group, instance, data.Buffer(), values, setInstanceDefault);
+            }
+        }
+    }
+
+    resolver.Resolve();
+    ApplyAttributes();
+
+    return true;
+}
+
 void Scene::FinishLoading(Deserializer* source)
 {
     if (source)
@@ -1528,6 +2201,22 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
 #endif
 }
 
+void SceneUpdateEventData::ToVariantMap(VariantMap& eventData) const
+{
+    using namespace SceneUpdate;
+
+    eventData[P_SCENE] = scene_;
+    eventData[P_TIMESTEP] = timeStep_;
+}
+
+void SceneUpdateEventData::FromVariantMap(VariantMap& eventData)
+{
+    using namespace SceneUpdate;
+
+    scene_ = static_cast<Scene*>(eventData[P_SCENE].GetPtr());
+    timeStep_ = eventData[P_TIMESTEP].GetFloat();
+}
+
 void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
@@ -28,13 +28,17 @@
 #include "../Resource/JSONFile.h"
 #include "../Scene/Node.h"
 #include "../Scene/SceneResolver.h"
+#include "../Scene/TransformStore.h"
 
 namespace Urho3D
 {
 
 class File;
+class LogicComponent;
 class PackageFile;
 
+struct UpdateEventData;
+
 static const unsigned FIRST_REPLICATED_ID = 0x1;
 static const unsigned LAST_REPLICATED_ID = 0xffffff;
 static const unsigned FIRST_LOCAL_ID = 0x01000000;
@@ -102,6 +106,8 @@ public:
     virtual bool Load(Deserializer& source, bool setInstanceDefault = false);
     /// Save to binary data. Return true if successful.
     virtual bool Save(Serializer& dest) const;
+    /// Save to binary data in the indexed format, which stores an offset table and the attributes of each object type in columns, allowing them to be read in parallel. The result can be loaded with Load(). Return true if successful.
+    bool SaveIndexed(Serializer& dest) const;
     /// Load from XML data. Removes all existing child nodes and components first. Return true if successful.
     virtual bool LoadXML(const XMLElement& source, bool setInstanceDefault = false);
     /// Load from JSON data. Removes all existing child nodes and components first. Return true if successful.
@@ -154,6 +160,8 @@ public:
     void SetSnapThreshold(float threshold);
     /// Set maximum milliseconds per frame to spend on async scene loading.
     void SetAsyncLoadingMs(int ms);
+    /// Set whether to recompute dirty world transforms in one batched pass after the scene post-update, using worker threads for large hierarchy levels. Default false.
+    void SetBatchedTransforms(bool enable);
     /// Add a required package file for networking. To be called on the server.
     void AddRequiredPackageFile(PackageFile* package);
     /// Clear required package files.
@@ -205,6 +213,12 @@ public:
     /// Return maximum milliseconds per frame to spend on async loading.
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
+    /// Return whether world transforms are recomputed in a batched pass.
+    bool GetBatchedTransforms() const { return batchedTransforms_; }
+
+    /// Return the transform store used for batched world transform updates.
+    const TransformStore& GetTransformStore() const { return transformStore_; }
+
     /// Return required package files.
     const Vector<SharedPtr<PackageFile> >& GetRequiredPackageFiles() const { return requiredPackageFiles_; }
 
@@ -219,6 +233,16 @@ public:
     void EndThreadedUpdate();
     /// Add a component to the delayed dirty notify queue. Is thread-safe.
     void DelayedMarkedDirty(Component* component);
+    /// Mark the node hierarchy changed for batched world transform updates. Called by Node.
+    void MarkTransformHierarchyDirty() { transformStore_.MarkHierarchyDirty(); }
+    /// Add a logic component to the thread-safe update phases given by a mask of USE_UPDATE and USE_POSTUPDATE. Called by LogicComponent.
+    void AddThreadedLogicComponent(LogicComponent* component, unsigned char mask);
+    /// Remove a logic component from the thread-safe update phases given by a mask. Called by LogicComponent.
+    void RemoveThreadedLogicComponent(LogicComponent* component, unsigned char mask);
+    /// Queue a logic component's SyncUpdate() call to the next sync point. Is thread-safe. Called by LogicComponent.
+    void RequestSyncUpdate(LogicComponent* component);
+    /// Cancel a queued SyncUpdate() call. Called by LogicComponent.
+    void CancelSyncUpdate(LogicComponent* component);
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
@@ -257,8 +281,12 @@ public:
     void MarkReplicationDirty(Node* node);
 
 private:
+    /// Call Update() or PostUpdate() of thread-safe logic components in worker threads, then the queued SyncUpdate() calls on the main thread.
+    void UpdateThreadedLogicComponents(PODVector<LogicComponent*>& components, float timeStep, bool postUpdate);
+    /// Load the scene content of an indexed binary scene file, after the file ID.
+    bool LoadIndexed(Deserializer& source, bool setInstanceDefault);
     /// Handle the logic update event to update the scene, if active.
-    void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleUpdate(StringHash eventType, UpdateEventData& eventData);
     /// Handle a background loaded resource completing.
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
     /// Update asynchronous loading.
@@ -304,8 +332,6 @@ private:
     PODVector<Component*> delayedDirtyComponents_;
     /// Mutex for the delayed dirty notification queue.
     Mutex sceneMutex_;
-    /// Preallocated event data map for smoothing update events.
-    VariantMap smoothingData_;
     /// Next free non-local node ID.
     unsigned replicatedNodeID_;
     /// Next free non-local component ID.
@@ -332,6 +358,16 @@ private:
     bool asyncLoading_;
     /// Threaded update flag.
     bool threadedUpdate_;
+    /// Batched world transform update flag.
+    bool batchedTransforms_;
+    /// Node order for batched world transform updates.
+    TransformStore transformStore_;
+    /// Logic components with thread-safe update.
+    PODVector<LogicComponent*> threadedUpdateComponents_;
+    /// Logic components with thread-safe post-update.
+    PODVector<LogicComponent*> threadedPostUpdateComponents_;
+    /// Logic components with a queued SyncUpdate() call. Null for cancelled calls.
+    PODVector<LogicComponent*> syncUpdateComponents_;
 };
 
 /// Register Scene library objects.
@@ -27,6 +27,8 @@
 namespace Urho3D
 {
 
+class Scene;
+
 /// Variable timestep scene update.
 URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
 {
@@ -48,6 +50,61 @@ URHO3D_EVENT(E_UPDATESMOOTHING, UpdateSmoothing)
     URHO3D_PARAM(P_SQUAREDSNAPTHRESHOLD, SquaredSnapThreshold);  // float
 }
 
+/// Typed payload of the scene update events (E_SCENEUPDATE, E_SCENESUBSYSTEMUPDATE and E_SCENEPOSTUPDATE.)
+struct URHO3D_API SceneUpdateEventData
+{
+    URHO3D_EVENT_PAYLOAD(SceneUpdateEventData)
+
+    /// Construct.
+    SceneUpdateEventData(Scene* scene = 0, float timeStep = 0.0f) :
+        scene_(scene),
+        timeStep_(timeStep)
+    {
+    }
+
+    /// Copy parameters to a VariantMap.
+    void ToVariantMap(VariantMap& eventData) const;
+    /// Copy parameters from a VariantMap.
+    void FromVariantMap(VariantMap& eventData);
+
+    /// Scene.
+    Scene* scene_;
+    /// Timestep.
+    float timeStep_;
+};
+
+/// Typed payload of the scene transform smoothing update event.
+struct UpdateSmoothingEventData
+{
+    URHO3D_EVENT_PAYLOAD(UpdateSmoothingEventData)
+
+    /// Construct.
+    UpdateSmoothingEventData(float constant = 0.0f, float squaredSnapThreshold = 0.0f) :
+        constant_(constant),
+        squaredSnapThreshold_(squaredSnapThreshold)
+    {
+    }
+
+    /// Copy parameters to a VariantMap.
+    void ToVariantMap(VariantMap& eventData) const
+    {
+        eventData[UpdateSmoothing::P_CONSTANT] = constant_;
+        eventData[UpdateSmoothing::P_SQUAREDSNAPTHRESHOLD] = squaredSnapThreshold_;
+    }
+
+    /// Copy parameters from a VariantMap.
+    void FromVariantMap(VariantMap& eventData)
+    {
+        constant_ = eventData[UpdateSmoothing::P_CONSTANT].GetFloat();
+        squaredSnapThreshold_ = eventData[UpdateSmoothing::P_SQUAREDSNAPTHRESHOLD].GetFloat();
+    }
+
+    /// Smoothing constant.
+    float constant_;
+    /// Squared snap threshold.
+    float squaredSnapThreshold_;
+};
+
 /// Scene drawable update finished. Custom animation (eg. IK) can be done at this point.
 URHO3D_EVENT(E_SCENEDRAWABLEUPDATEFINISHED, SceneDrawableUpdateFinished)
 {
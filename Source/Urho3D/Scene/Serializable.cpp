@@ -23,8 +23,10 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../IO/BitStream.h"
 #include "../IO/Deserializer.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/Serializer.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONValue.h"
@@ -55,6 +57,137 @@ static unsigned RemapAttributeIndex(const Vector<AttributeInfo>* attributes, con
     return netAttrIndex; // Could not remap
 }
 
+/// Maximum bytes of bit-packed data per quantized network attribute.
+static const unsigned MAX_QUANTIZED_ATTRIBUTE_BYTES = (4 * MAX_QUANTIZATION_BITS + 7) >> 3;
+
+static unsigned GetNumQuantizedBits(const AttributeInfo& attr)
+{
+    unsigned bits = attr.quantization_.bits_;
+    if (!bits)
+        return 0;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        return bits;
+
+    case VAR_VECTOR2:
+        return 2 * bits;
+
+    case VAR_VECTOR3:
+        return 3 * bits;
+
+    case VAR_VECTOR4:
+        return 4 * bits;
+
+    case VAR_QUATERNION:
+        return 2 + 3 * bits;
+
+    default:
+        return 0;
+    }
+}
+
+static bool IsNetworkValueIncluded(const AttributeInfo& attr, unsigned index, const DirtyBits* attributeBits)
+{
+    return attributeBits ? attributeBits->IsSet(index) : (attr.mode_ & AM_LATESTDATA) != 0;
+}
+
+static void WriteQuantizedValue(BitWriter& writer, const AttributeInfo& attr, const Variant& value)
+{
+    const AttributeQuantization& quantization = attr.quantization_;
+    const float* data = 0;
+    unsigned numComponents = 0;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        writer.WriteQuantizedFloat(value.GetFloat(), quantization.min_, quantization.max_, quantization.bits_);
+        return;
+
+    case VAR_VECTOR2:
+        data = value.GetVector2().Data();
+        numComponents = 2;
+        break;
+
+    case VAR_VECTOR3:
+        data = value.GetVector3().Data();
+        numComponents = 3;
+        break;
+
+    case VAR_VECTOR4:
+        data = value.GetVector4().Data();
+        numComponents = 4;
+        break;
+
+    case VAR_QUATERNION:
+        writer.WriteQuantizedQuaternion(value.GetQuaternion(), quantization.bits_);
+        return;
+
+    default:
+        return;
+    }
+
+    for (unsigned i = 0; i < numComponents; ++i)
+        writer.WriteQuantizedFloat(data[i], quantization.min_, quantization.max_, quantization.bits_);
+}
+
+static Variant ReadQuantizedValue(BitReader& reader, const AttributeInfo& attr)
+{
+    const AttributeQuantization& quantization = attr.quantization_;
+    float data[4];
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        return reader.ReadQuantizedFloat(quantization.min_, quantization.max_, quantization.bits_);
+
+    case VAR_VECTOR2:
+        for (unsigned i = 0; i < 2; ++i)
+            data[i] = reader.ReadQuantizedFloat(quantization.min_, quantization.max_, quantization.bits_);
+        return Vector2(data);
+
+    case VAR_VECTOR3:
+        for (unsigned i = 0; i < 3; ++i)
+            data[i] = reader.ReadQuantizedFloat(quantization.min_, quantization.max_, quantization.bits_);
+        return Vector3(data);
+
+    case VAR_VECTOR4:
+        for (unsigned i = 0; i < 4; ++i)
+            data[i] = reader.ReadQuantizedFloat(quantization.min_, quantization.max_, quantization.bits_);
+        return Vector4(data);
+
+    case VAR_QUATERNION:
+        return reader.ReadQuantizedQuaternion(quantization.bits_);
+
+    default:
+        return Variant::EMPTY;
+    }
+}
+
+static void WriteNetworkValues(Serializer& dest, const Vector<AttributeInfo>& attributes, const Vector<Variant>& values,
+    const DirtyBits* attributeBits)
+{
+    unsigned numAttributes = attributes.Size();
+
+    // Quantized attributes go first as one bit-packed block, then the rest at full precision
+    BitWriter writer(dest);
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes[i];
+        if (IsNetworkValueIncluded(attr, i, attributeBits) && GetNumQuantizedBits(attr))
+            WriteQuantizedValue(writer, attr, values[i]);
+    }
+    writer.Flush();
+
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes[i];
+        if (IsNetworkValueIncluded(attr, i, attributeBits) && !GetNumQuantizedBits(attr))
+            dest.WriteVariantData(values[i]);
+    }
+}
+
 Serializable::Serializable(Context* context) :
     Object(context),
     temporary_(false)
@@ -307,6 +440,28 @@ bool Serializable::Load(Deserializer& source, bool setInstanceDefault)
     return true;
 }
 
+bool Serializable::LoadAttributeValues(const PODVector<const Variant*>& values, bool setInstanceDefault)
+{
+    const Vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+        return true;
+
+    unsigned numValues = Min(attributes->Size(), values.Size());
+    for (unsigned i = 0; i < numValues; ++i)
+    {
+        if (!values[i])
+            continue;
+
+        const AttributeInfo& attr = attributes->At(i);
+        OnSetAttribute(attr, *values[i]);
+
+        if (setInstanceDefault)
+            SetInstanceDefault(attr.name_, *values[i]);
+    }
+
+    return true;
+}
+
 bool Serializable::Save(Serializer& dest) const
 {
     const Vector<AttributeInfo>* attributes = GetAttributes();
@@ -762,12 +917,7 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     // First write the change bitfield, then attribute data for non-default attributes
     dest.WriteUByte(timeStamp);
     dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
-
-    for (unsigned i = 0; i < numAttributes; ++i)
-    {
-        if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
-    }
+    WriteNetworkValues(dest, *attributes, networkState_->currentValues_, &attributeBits);
 }
 
 void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp)
@@ -787,13 +937,16 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
     // First write the change bitfield, then attribute data for changed attributes
     // Note: the attribute bits should not contain LATESTDATA attributes
     dest.WriteUByte(timeStamp);
-    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
 
-    for (unsigned i = 0; i < numAttributes; ++i)
+    // If the connection needs the same changes as encoded during the network update preparation, copy them
+    if (networkState_->cachedDeltaBits_.Count() && networkState_->cachedDeltaBits_ == attributeBits)
     {
-        if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+        dest.Write(networkState_->cachedDeltaUpdate_.GetData(), networkState_->cachedDeltaUpdate_.GetSize());
+        return;
     }
+
+    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3);
+    WriteNetworkValues(dest, *attributes, networkState_->currentValues_, &attributeBits);
 }
 
 void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp)
@@ -804,18 +957,58 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
         return;
     }
 
+    const Vector<AttributeInfo>* attributes = networkState_->attributes_;
+    if (!attributes)
+        return;
+
+    dest.WriteUByte(timeStamp);
+
+    if (networkState_->latestDataCached_)
+    {
+        dest.Write(networkState_->cachedLatestData_.GetData(), networkState_->cachedLatestData_.GetSize());
+        return;
+    }
+
+    WriteNetworkValues(dest, *attributes, networkState_->currentValues_, 0);
+}
+
+void Serializable::CacheNetworkUpdate(const DirtyBits& changedBits, bool latestDataChanged)
+{
+    if (!networkState_)
+        return;
+
+    // Encoding once only pays off when several connections need the same data. The cached data reflects the current
+    // values, so it stays valid until they change in a later preparation, which either re-encodes or clears it
+    if (networkState_->replicationStates_.Size() < 2)
+    {
+        networkState_->cachedDeltaBits_.ClearAll();
+        networkState_->latestDataCached_ = false;
+        return;
+    }
+
     const Vector<AttributeInfo>* attributes = networkState_->attributes_;
     if (!attributes)
         return;
 
     unsigned numAttributes = attributes->Size();
 
-    dest.WriteUByte(timeStamp);
+    if (changedBits.Count())
+    {
+        VectorBuffer& dest = networkState_->cachedDeltaUpdate_;
+        dest.Clear();
+        dest.Write(changedBits.data_, (numAttributes + 7) >> 3);
+        WriteNetworkValues(dest, *attributes, networkState_->currentValues_, &changedBits);
 
-    for (unsigned i = 0; i < numAttributes; ++i)
+        networkState_->cachedDeltaBits_ = changedBits;
+    }
+
+    if (latestDataChanged)
     {
-        if (attributes->At(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+        VectorBuffer& dest = networkState_->cachedLatestData_;
+        dest.Clear();
+        WriteNetworkValues(dest, *attributes, networkState_->currentValues_, 0);
+
+        networkState_->latestDataCached_ = true;
     }
 }
 
@@ -827,38 +1020,11 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
 
     unsigned numAttributes = attributes->Size();
     DirtyBits attributeBits;
-    bool changed = false;
 
-    unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
     unsigned char timeStamp = source.ReadUByte();
     source.Read(attributeBits.data_, (numAttributes + 7) >> 3);
 
-    for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
-    {
-        if (attributeBits.IsSet(i))
-        {
-            const AttributeInfo& attr = attributes->At(i);
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
-                changed = true;
-            }
-            else
-            {
-                using namespace InterceptNetworkUpdate;
-
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
-            }
-        }
-    }
-
-    return changed;
+    return ReadNetworkValues(source, *attributes, &attributeBits, timeStamp);
 }
 
 bool Serializable::ReadLatestDataUpdate(Deserializer& source)
@@ -867,34 +1033,58 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
     if (!attributes)
         return false;
 
-    unsigned numAttributes = attributes->Size();
+    unsigned char timeStamp = source.ReadUByte();
+
+    return ReadNetworkValues(source, *attributes, 0, timeStamp);
+}
+
+bool Serializable::ReadNetworkValues(Deserializer& source, const Vector<AttributeInfo>& attributes, const DirtyBits* attributeBits,
+    unsigned char timeStamp)
+{
+    unsigned numAttributes = attributes.Size();
     bool changed = false;
 
     unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
-    unsigned char timeStamp = source.ReadUByte();
 
-    for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
+    // Read the bit-packed block of quantized attributes first, so that all values can be applied in attribute order
+    unsigned numQuantizedBits = 0;
+    for (unsigned i = 0; i < numAttributes; ++i)
     {
-        const AttributeInfo& attr = attributes->At(i);
-        if (attr.mode_ & AM_LATESTDATA)
+        if (IsNetworkValueIncluded(attributes[i], i, attributeBits))
+            numQuantizedBits += GetNumQuantizedBits(attributes[i]);
+    }
+
+    unsigned char quantizedData[MAX_NETWORK_ATTRIBUTES * MAX_QUANTIZED_ATTRIBUTE_BYTES];
+    unsigned quantizedSize = numQuantizedBits ? source.Read(quantizedData, (numQuantizedBits + 7) >> 3) : 0;
+    MemoryBuffer quantizedBuffer(quantizedData, quantizedSize);
+    BitReader reader(quantizedBuffer);
+
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes[i];
+        if (!IsNetworkValueIncluded(attr, i, attributeBits))
+            continue;
+
+        bool quantized = GetNumQuantizedBits(attr) != 0;
+        if (quantized ? reader.IsEof() : source.IsEof())
+            continue;
+
+        if (!(interceptMask & (1ULL << i)))
         {
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
-                changed = true;
-            }
-            else
-            {
-                using namespace InterceptNetworkUpdate;
-
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
-            }
+            OnSetAttribute(attr, quantized ? ReadQuantizedValue(reader, attr) : source.ReadVariant(attr.type_));
+            changed = true;
+        }
+        else
+        {
+            using namespace InterceptNetworkUpdate;
+
+            VariantMap& eventData = GetEventDataMap();
+            eventData[P_SERIALIZABLE] = this;
+            eventData[P_TIMESTAMP] = (unsigned)timeStamp;
+            eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
+            eventData[P_NAME] = attr.name_;
+            eventData[P_VALUE] = quantized ? ReadQuantizedValue(reader, attr) : source.ReadVariant(attr.type_);
+            SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
         }
     }
 
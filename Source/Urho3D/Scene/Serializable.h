@@ -61,6 +61,8 @@ public:
     virtual const Vector<AttributeInfo>* GetNetworkAttributes() const;
     /// Load from binary data. When setInstanceDefault is set to true, after setting the attribute value, store the value as instance's default value. Return true if successful.
     virtual bool Load(Deserializer& source, bool setInstanceDefault = false);
+    /// Load from attribute values that have already been read from binary data. The values are indexed by attribute, with null for attributes that should not be set. Return true if successful.
+    virtual bool LoadAttributeValues(const PODVector<const Variant*>& values, bool setInstanceDefault = false);
     /// Save as binary data. Return true if successful.
     virtual bool Save(Serializer& dest) const;
     /// Load from XML data. When setInstanceDefault is set to true, after setting the attribute value, store the value as instance's default value. Return true if successful.
@@ -101,6 +103,8 @@ public:
     void WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp);
     /// Write a latest data network update.
     void WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp);
+    /// Encode the delta update of attributes changed in a network update preparation, and the latest data update if it changed, once for all connections tracking the object. The cache is cleared instead if there are less than two connections.
+    void CacheNetworkUpdate(const DirtyBits& changedBits, bool latestDataChanged);
     /// Read and apply a network delta update. Return true if attributes were changed.
     bool ReadDeltaUpdate(Deserializer& source);
     /// Read and apply a network latest data update. Return true if attributes were changed.
@@ -135,6 +139,9 @@ protected:
 private:
     /// Set instance-level default value. Allocate the internal data structure as necessary.
     void SetInstanceDefault(const String& name, const Variant& defaultValue);
+    /// Read and apply network attribute values for the set attribute bits, or the latest data attributes if null. Return true if attributes were changed.
+    bool ReadNetworkValues(Deserializer& source, const Vector<AttributeInfo>& attributes, const DirtyBits* attributeBits,
+        unsigned char timeStamp);
     /// Get instance-level default value.
     Variant GetInstanceDefault(const String& name) const;
 
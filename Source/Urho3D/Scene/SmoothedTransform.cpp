@@ -106,7 +106,7 @@ void SmoothedTransform::SetTargetPosition(const Vector3& position)
     // Subscribe to smoothing update if not yet subscribed
     if (!subscribed_)
     {
-        SubscribeToEvent(GetScene(), E_UPDATESMOOTHING, URHO3D_HANDLER(SmoothedTransform, HandleUpdateSmoothing));
+        SubscribeToEvent(GetScene(), E_UPDATESMOOTHING, URHO3D_TYPED_HANDLER(SmoothedTransform, UpdateSmoothingEventData, HandleUpdateSmoothing));
         subscribed_ = true;
     }
 
@@ -120,7 +120,7 @@ void SmoothedTransform::SetTargetRotation(const Quaternion& rotation)
 
     if (!subscribed_)
     {
-        SubscribeToEvent(GetScene(), E_UPDATESMOOTHING, URHO3D_HANDLER(SmoothedTransform, HandleUpdateSmoothing));
+        SubscribeToEvent(GetScene(), E_UPDATESMOOTHING, URHO3D_TYPED_HANDLER(SmoothedTransform, UpdateSmoothingEventData, HandleUpdateSmoothing));
         subscribed_ = true;
     }
 
@@ -169,13 +169,9 @@ void SmoothedTransform::OnNodeSet(Node* node)
     }
 }
 
-void SmoothedTransform::HandleUpdateSmoothing(StringHash eventType, VariantMap& eventData)
+void SmoothedTransform::HandleUpdateSmoothing(StringHash eventType, UpdateSmoothingEventData& eventData)
 {
-    using namespace UpdateSmoothing;
-
-    float constant = eventData[P_CONSTANT].GetFloat();
-    float squaredSnapThreshold = eventData[P_SQUAREDSNAPTHRESHOLD].GetFloat();
-    Update(constant, squaredSnapThreshold);
+    Update(eventData.constant_, eventData.squaredSnapThreshold_);
 }
 
 }
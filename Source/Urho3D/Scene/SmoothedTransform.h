@@ -27,6 +27,8 @@
 namespace Urho3D
 {
 
+struct UpdateSmoothingEventData;
+
 /// No ongoing smoothing.
 static const unsigned SMOOTH_NONE = 0;
 /// Ongoing position smoothing.
@@ -78,7 +80,7 @@ protected:
 
 private:
     /// Handle smoothing update event.
-    void HandleUpdateSmoothing(StringHash eventType, VariantMap& eventData);
+    void HandleUpdateSmoothing(StringHash eventType, UpdateSmoothingEventData& eventData);
 
     /// Target position.
     Vector3 targetPosition_;
@@ -0,0 +1,153 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/ParallelFor.h"
+#include "../Scene/Scene.h"
+#include "../Scene/TransformStore.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Minimum number of nodes per depth level chunk when updating in worker threads.
+static const unsigned TRANSFORM_UPDATE_GRAIN_SIZE = 256;
+
+/// Parallel loop body for updating the world transforms of a depth level.
+struct TransformUpdateBody
+{
+    /// Construct.
+    TransformUpdateBody(TransformStore* store, Node** nodes) :
+        store_(store),
+        nodes_(nodes)
+    {
+    }
+
+    /// Update a chunk of nodes.
+    void operator ()(Node** start, Node** end, unsigned threadIndex)
+    {
+        store_->UpdateNodes((unsigned)(start - nodes_), (unsigned)(end - nodes_));
+    }
+
+    /// Transform store.
+    TransformStore* store_;
+    /// Start of the node array.
+    Node** nodes_;
+};
+
+TransformStore::TransformStore() :
+    hierarchyDirty_(true)
+{
+}
+
+void TransformStore::Update(Scene* scene, WorkQueue* queue)
+{
+    if (hierarchyDirty_)
+        Rebuild(scene);
+
+    if (nodes_.Empty())
+        return;
+
+    // All nodes of one level can be updated independently, as their parents are on the previous levels
+    Node** nodes = nodes_.Buffer();
+    TransformUpdateBody body(this, nodes);
+    for (unsigned i = 0; i + 1 < levelOffsets_.Size(); ++i)
+    {
+        unsigned start = levelOffsets_[i];
+        unsigned end = levelOffsets_[i + 1];
+
+        if (queue && queue->GetNumThreads() && end - start > TRANSFORM_UPDATE_GRAIN_SIZE)
+            ParallelFor(queue, nodes + start, nodes + end, body, TRANSFORM_UPDATE_GRAIN_SIZE);
+        else
+            UpdateNodes(start, end);
+    }
+}
+
+void TransformStore::UpdateNodes(unsigned start, unsigned end)
+{
+    // Marking a node dirty also marks its children, so only the dirty subtrees are recomputed. The parents are on
+    // the previous levels, so their world transforms are already up to date and can be read without recursion
+    for (unsigned i = start; i < end; ++i)
+    {
+        Node* node = nodes_[i];
+        if (!node->dirty_)
+            continue;
+
+        Matrix3x4 transform(node->position_, node->rotation_, node->scale_);
+        Node* parent = node->parent_;
+
+        // Assume the root node (scene) has identity transform
+        if (parent == node->scene_ || !parent)
+        {
+            node->worldTransform_ = transform;
+            node->worldRotation_ = node->rotation_;
+        }
+        else
+        {
+            node->worldTransform_ = parent->worldTransform_ * transform;
+            node->worldRotation_ = parent->worldRotation_ * node->rotation_;
+        }
+
+        node->dirty_ = false;
+    }
+}
+
+void TransformStore::Clear()
+{
+    nodes_.Clear();
+    levelOffsets_.Clear();
+    hierarchyDirty_ = true;
+}
+
+void TransformStore::Rebuild(Scene* scene)
+{
+    nodes_.Clear();
+    levelOffsets_.Clear();
+
+    // Breadth-first traversal, so that each depth level is contiguous
+    const Vector<SharedPtr<Node> >& rootChildren = scene->GetChildren();
+    for (Vector<SharedPtr<Node> >::ConstIterator i = rootChildren.Begin(); i != rootChildren.End(); ++i)
+        nodes_.Push(*i);
+
+    levelOffsets_.Push(0);
+    unsigned levelStart = 0;
+    while (levelStart < nodes_.Size())
+    {
+        unsigned levelEnd = nodes_.Size();
+        levelOffsets_.Push(levelEnd);
+
+        for (unsigned i = levelStart; i < levelEnd; ++i)
+        {
+            const Vector<SharedPtr<Node> >& children = nodes_[i]->GetChildren();
+            for (Vector<SharedPtr<Node> >::ConstIterator j = children.Begin(); j != children.End(); ++j)
+                nodes_.Push(*j);
+        }
+
+        levelStart = levelEnd;
+    }
+
+    hierarchyDirty_ = false;
+}
+
+}
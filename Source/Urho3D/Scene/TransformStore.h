@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2008-2017 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Vector.h"
+
+namespace Urho3D
+{
+
+class Node;
+class Scene;
+class WorkQueue;
+
+/// List of scene nodes ordered by hierarchy depth, so that parents come before children. Recomputes the dirty world transforms of a scene in one pass per depth level, in worker threads when a level has enough nodes. The transforms themselves stay in the nodes.
+class URHO3D_API TransformStore
+{
+public:
+    /// Construct.
+    TransformStore();
+
+    /// Mark the node hierarchy changed. The node order is rebuilt on the next update.
+    void MarkHierarchyDirty() { hierarchyDirty_ = true; }
+    /// Recompute the dirty world transforms of the scene's nodes. Must be called from the main thread.
+    void Update(Scene* scene, WorkQueue* queue);
+    /// Update the world transforms of a range of nodes whose parents have already been updated. Called internally, possibly from worker threads.
+    void UpdateNodes(unsigned start, unsigned end);
+    /// Release the node order and transforms.
+    void Clear();
+
+    /// Return number of nodes.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+
+    /// Return number of hierarchy depth levels.
+    unsigned GetNumLevels() const { return levelOffsets_.Empty() ? 0 : levelOffsets_.Size() - 1; }
+
+private:
+    /// Rebuild the node order from the scene hierarchy.
+    void Rebuild(Scene* scene);
+
+    /// Nodes in depth order.
+    PODVector<Node*> nodes_;
+    /// Start index of each depth level, followed by the node count.
+    PODVector<unsigned> levelOffsets_;
+    /// Hierarchy changed flag.
+    bool hierarchyDirty_;
+};
+
+}
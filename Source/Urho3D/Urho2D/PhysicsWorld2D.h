@@ -32,6 +32,8 @@ namespace Urho3D
 class Camera;
 class RigidBody2D;
 
+struct SceneUpdateEventData;
+
 /// 2D Physics raycast hit.
 struct URHO3D_API PhysicsRaycastResult2D
 {
@@ -211,7 +213,7 @@ protected:
 
 private:
     /// Handle the scene subsystem update event, step simulation here.
-    void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneSubsystemUpdate(StringHash eventType, SceneUpdateEventData& eventData);
     /// Send begin contact events.
     void SendBeginContactEvents();
     /// Send end contact events.